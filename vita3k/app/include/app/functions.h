@@ -48,5 +48,7 @@ void remove_custom_driver(EmuEnvState &emuenv, const std::string &driver);
 
 void set_window_title(EmuEnvState &emuenv);
 void calculate_fps(EmuEnvState &emuenv);
+// Hash the displayed frame for the frame report, when hash-frames is set
+void hash_displayed_frame(EmuEnvState &emuenv);
 
 } // namespace app
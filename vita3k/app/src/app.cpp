@@ -22,9 +22,13 @@
 #include <display/state.h>
 #include <emuenv/state.h>
 #include <io/state.h>
+#include <mem/functions.h>
+#include <renderer/state.h>
+#include <replay/functions.h>
 #include <util/log.h>
 
 #include <SDL.h>
+#include <xxh3.h>
 
 #ifdef ANDROID
 #include <host/dialog/filesystem.h>
@@ -50,6 +54,9 @@ void calculate_fps(EmuEnvState &emuenv) {
         const uint32_t frame_count = static_cast<std::uint32_t>(emuenv.frame_count);
         emuenv.fps = (frame_count * 1000 + ms / 2) / ms;
         emuenv.ms_per_frame = (ms + frame_count / 2) / frame_count;
+        const MemProtectStats protect_stats = take_protect_stats(emuenv.mem);
+        emuenv.protect_faults_per_frame = (protect_stats.faults + frame_count / 2) / frame_count;
+        emuenv.protect_syscalls_per_frame = (protect_stats.syscalls + frame_count / 2) / frame_count;
         emuenv.sdl_ticks = sdl_ticks_now;
         emuenv.frame_count = 0;
         set_window_title(emuenv);
@@ -66,6 +73,20 @@ void calculate_fps(EmuEnvState &emuenv) {
     }
 }
 
+void hash_displayed_frame(EmuEnvState &emuenv) {
+    // the frame render_frame just displayed, not the one the guest is at now
+    const DisplayFrameInfo &frame = emuenv.display.presented_frame;
+    if (!should_hash_frame(emuenv.replay, frame.frame_index))
+        return;
+
+    uint32_t width, height;
+    const std::vector<uint32_t> pixels = emuenv.renderer->dump_frame(frame, width, height);
+    if (pixels.empty())
+        return;
+
+    add_replay_frame_hash(emuenv.replay, frame.frame_index, XXH3_64bits(pixels.data(), pixels.size() * sizeof(uint32_t)));
+}
+
 void set_window_title(EmuEnvState &emuenv) {
     const auto af = emuenv.cfg.current_config.anisotropic_filtering > 1 ? fmt ::format(" | AF {}x", emuenv.cfg.current_config.anisotropic_filtering) : "";
     const auto x = emuenv.display.next_rendered_frame.image_size.x * emuenv.cfg.current_config.resolution_multiplier;
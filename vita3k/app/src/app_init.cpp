@@ -30,6 +30,7 @@
 #include <motion/state.h>
 #include <ngs/state.h>
 #include <renderer/state.h>
+#include <replay/functions.h>
 
 #include <renderer/functions.h>
 #include <util/fs.h>
@@ -564,6 +565,8 @@ bool late_init(EmuEnvState &state) {
             thread->update_status(ThreadStatus::run);
         }
     };
+    state.audio.low_latency = state.cfg.audio_low_latency;
+    state.audio.file_path = state.cfg.audio_file_path.empty() ? fs_utils::path_to_utf8(state.log_path / "audio.wav") : state.cfg.audio_file_path;
     if (!state.audio.init(resume_thread, state.cfg.audio_backend)) {
         LOG_WARN("Failed to initialize audio! Audio will not work.");
     }
@@ -586,6 +589,8 @@ void destroy(EmuEnvState &emuenv, ImGui_State *imgui) {
     if (emuenv.cfg.gdbstub)
         server_close(emuenv);
 
+    finish_replay(emuenv.replay);
+
     // There may be changes that made in the GUI, so we should save, again
     if (emuenv.cfg.overwrite_config)
         config::serialize_config(emuenv.cfg, emuenv.cfg.config_path);
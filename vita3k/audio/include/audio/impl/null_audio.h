@@ -0,0 +1,59 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#pragma once
+
+#include "../state.h"
+
+#include <util/fs.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+
+/**
+ * @brief Backend without a sound device, consuming the mixed audio at the device rate from a software clock
+ *
+ * If a file path is given, the audio is also written to it, as a WAV file if its extension is .wav
+ * and as raw stereo S16 samples otherwise.
+ */
+class NullAudioAdapter : public AudioAdapter {
+    fs::path file_path;
+    fs::ofstream file;
+    uint64_t file_bytes = 0;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool paused = false;
+    bool exiting = false;
+    std::thread thread;
+
+    void run();
+    void write_wav_header();
+    void log_stats(AudioStats &last_stats, double seconds, uint64_t late_restarts);
+
+public:
+    static constexpr int FREQ = 48000;
+    static constexpr uint32_t PERIOD_FRAMES = 256;
+
+    NullAudioAdapter(AudioState &audio_state, const fs::path &file_path = {});
+    ~NullAudioAdapter() override;
+
+    bool init() override;
+    void switch_state(const bool pause) override;
+};
@@ -0,0 +1,107 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#pragma once
+
+#include <util/types.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct AudioState;
+struct AudioOutPort;
+
+struct AudioMixerStats {
+    // frames mixed into the host stream
+    uint64_t mixed_frames = 0;
+    // backend reads and backend reads that found less frames than they needed
+    uint64_t reads = 0;
+    uint64_t underruns = 0;
+    // sum over the backend reads of the mixed frames ready before the read, latency_frames / reads is the average latency
+    uint64_t latency_frames = 0;
+    // time spent mixing, in nanoseconds
+    uint64_t mix_time_ns = 0;
+};
+
+/**
+ * @brief Mixes the output ports into the single host stream on its own thread
+ *
+ * The mixer keeps a small ring of mixed frames topped up, on a fixed period and every time the backend
+ * reads from it, so the backend callback only has to copy frames. Each port has a credit counter of the
+ * guest buffers it may queue, the mixer gives them back as it consumes the port and wakes up the thread
+ * blocked in sceAudioOutOutput.
+ */
+class AudioMixer {
+public:
+    // period_frames is the number of frames the backend reads at once
+    AudioMixer(AudioState &state, uint32_t freq, uint32_t period_frames, bool low_latency);
+    ~AudioMixer();
+
+    void start();
+
+    // Called by the backend, output is nb_frames stereo S16 frames
+    void read(int16_t *output, uint32_t nb_frames);
+
+    // Mix nb_frames of every port into the ring
+    // @return false if there is not enough room in the ring
+    bool mix(uint32_t nb_frames);
+
+    // Guest buffers of port_frames a port can queue before its thread is blocked
+    uint32_t get_max_queued_buffers(uint32_t port_frames) const;
+
+    uint32_t get_latency_frames() const { return target_frames; }
+    AudioMixerStats get_stats() const;
+
+private:
+    uint32_t get_level() const;
+    void run();
+
+    AudioState &state;
+    const uint32_t freq;
+    // frames mixed at once and number of mixed frames the mixer keeps ready for the backend
+    uint32_t mix_frames;
+    uint32_t target_frames;
+
+    // ring of stereo frames, written by the mixer and read by the backend
+    std::vector<int16_t> ring;
+    std::atomic<uint64_t> write_pos = 0;
+    std::atomic<uint64_t> read_pos = 0;
+
+    // only used by the mixer
+    std::vector<std::shared_ptr<AudioOutPort>> ports;
+    std::vector<int32_t> accumulator;
+    std::vector<int16_t> port_buffer;
+    std::vector<int16_t> mixed;
+    std::vector<SceUID> threads_to_resume;
+
+    std::atomic<uint64_t> mixed_frames = 0;
+    std::atomic<uint64_t> reads = 0;
+    std::atomic<uint64_t> underruns = 0;
+    std::atomic<uint64_t> latency_frames = 0;
+    std::atomic<uint64_t> mix_time_ns = 0;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool exiting = false;
+    std::thread thread;
+};
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <audio/mixer.h>
 #include <util/types.h>
 
 #include <SDL_audio.h>
@@ -33,6 +34,16 @@
 typedef std::shared_ptr<SDL_AudioStream> AudioStreamPtr;
 typedef std::function<void(SceUID)> ResumeAudioThread;
 
+struct AudioOutPortStats {
+    // guest buffers output to the port
+    uint64_t output_buffers = 0;
+    // buffers output while the port had no credit left, its thread was blocked until the mixer caught up
+    uint64_t overruns = 0;
+    // frames of the port mixed into the host stream, and frames left in the port after the last mix
+    uint64_t mixed_frames = 0;
+    uint64_t queued_frames = 0;
+};
+
 struct AudioOutPort {
     // Channel range from 0 - 32768
     uint16_t left_channel_volume = SCE_AUDIO_VOLUME_0DB;
@@ -41,10 +52,13 @@ struct AudioOutPort {
     float volume = 1.0f;
     // length of the buffer for each call
     int32_t len_bytes = 0;
-    // number of microseconds a buffer lasts for
-    uint64_t len_microseconds = 0;
-    // last time sceAudioOutOutput was called with this port (timestamp in microseconds)
-    uint64_t last_output = 0;
+    // guest buffers put in the stream and not mixed yet, sceAudioOutOutput blocks once there are max_queued_buffers of them
+    uint32_t queued_buffers = 0;
+    uint32_t max_queued_buffers = 2;
+    // number of mixed bytes a guest buffer gives and mixed bytes not counted as a full buffer yet
+    uint32_t mixed_bytes_per_buffer = 0;
+    uint32_t mixed_bytes = 0;
+    AudioOutPortStats stats;
 
     // current config
     int type = 0;
@@ -76,15 +90,16 @@ struct AudioSpec {
     uint8_t silence;
 };
 
+struct AudioStats {
+    AudioMixerStats mixer;
+    std::map<int, AudioOutPortStats> ports;
+};
+
 struct ThreadState;
 struct AudioState;
 
 // abstract class that need to be overloaded with an audio implementation
 class AudioAdapter {
-private:
-    // buffer used to mix audio
-    std::vector<uint8_t> temp_buffer;
-
 protected:
     AudioState &state;
     // are we using a single stream and mixing everything inside or multiple streams?
@@ -118,7 +133,15 @@ struct AudioState {
     AudioInPort in_port;
     ResumeAudioThread resume_thread;
     std::string audio_backend;
-    float global_volume;
+    float global_volume = 1.0f;
+    // output of the File backend, .wav or raw samples
+    std::string file_path;
+    // mix ahead of the backend by a fraction of its buffer instead of a full buffer
+    bool low_latency = false;
+    // used by the single stream adapters, must be after out_ports to be destroyed first
+    std::unique_ptr<AudioMixer> mixer;
+
+    ~AudioState();
 
     bool init(const ResumeAudioThread &resume_thread, const std::string &adapter_name);
     void set_backend(const std::string &adapter_name);
@@ -127,4 +150,5 @@ struct AudioState {
     void set_volume(AudioOutPort &out_port, float volume);
     void set_global_volume(float volume);
     void switch_state(const bool pause);
+    AudioStats get_stats();
 };
@@ -22,6 +22,7 @@
 #endif
 
 #include <audio/impl/cubeb_audio.h>
+#include <audio/impl/null_audio.h>
 #include <audio/impl/sdl_audio.h>
 
 #include <kernel/thread/thread_state.h>
@@ -32,59 +33,17 @@
 #include <cassert>
 #include <cstring>
 
-static void mix_out_port(uint8_t *stream, uint8_t *temp_buffer, int len, float global_volume, AudioOutPort &port, const ResumeAudioThread &resume_thread) {
-#ifdef TRACY_ENABLE
-    ZoneScopedC(0xF6C2FF); // Tracy - Track function scope with color thistle
-#endif
-
-    // How much data is available?
-    std::unique_lock<std::mutex> lock(port.mutex);
-    const int bytes_available = SDL_AudioStreamAvailable(port.stream.get());
-    assert(bytes_available >= 0);
-
-    // Running out of data?
-    // The (len * 3) is according to the value in sceAudioOutOutput
-    if (bytes_available < len * 3) {
-        // Is there a thread waiting for playback to finish?
-        if (port.thread >= 0) {
-            // Wake the thread up.
-            resume_thread(port.thread);
-            port.thread = -1;
-        }
-    }
-
-    if (bytes_available == 0)
-        return;
-
-    // Mix as much as we need.
-    const int bytes_to_get = std::min(len, bytes_available);
-    const int bytes_got = SDL_AudioStreamGet(port.stream.get(), temp_buffer, bytes_to_get);
-    lock.unlock();
-    if (bytes_got > 0) {
-        SDL_MixAudioFormat(stream, temp_buffer, AUDIO_S16LSB, bytes_got, static_cast<int>(port.volume * global_volume * SDL_MIX_MAXVOLUME));
-    }
-}
-
 void AudioAdapter::audio_callback(uint8_t *stream, int len_bytes) {
 #ifdef TRACY_ENABLE
     tracy::SetThreadName("Host audio thread"); // Tracy - Declare belonging of this function to the audio thread
     ZoneScopedC(0xF6C2FF); // Tracy - Track function scope with color thistle
 #endif
 
-    std::vector<AudioOutPortPtr> ports;
-    {
-        // Read from shared state.
-        const std::lock_guard<std::mutex> lock(state.mutex);
-        ports.reserve(state.out_ports.size());
-        for (const auto &[_, port] : state.out_ports) {
-            ports.push_back(port);
-        }
-    }
-    std::memset(stream, state.spec.silence, len_bytes);
-
-    for (const AudioOutPortPtr &port : ports) {
-        mix_out_port(stream, temp_buffer.data(), len_bytes, state.global_volume, *port.get(), state.resume_thread);
-    }
+    // the ports are mixed by the mixer thread, only copy what it prepared
+    if (state.mixer)
+        state.mixer->read(reinterpret_cast<int16_t *>(stream), len_bytes / (2 * sizeof(int16_t)));
+    else
+        std::memset(stream, state.spec.silence, len_bytes);
 
 #ifdef TRACY_ENABLE
     FrameMarkNamed("Audio"); // Tracy - End discontinuous frame for audio rendering
@@ -105,13 +64,20 @@ void AudioState::set_backend(const std::string &adapter_name) {
     if (adapter_name == this->audio_backend)
         return;
 
-    // first delete all ports then delete the backend
+    // first stop the backend from reading the mixer, delete the mixer and all ports then delete the backend
+    if (adapter)
+        adapter->switch_state(true);
+    mixer.reset();
     out_ports.clear();
     adapter.reset();
     if (adapter_name == "SDL") {
         adapter = std::make_unique<SDLAudioAdapter>(*this);
     } else if (adapter_name == "Cubeb") {
         adapter = std::make_unique<CubebAudioAdapter>(*this);
+    } else if (adapter_name == "Null") {
+        adapter = std::make_unique<NullAudioAdapter>(*this);
+    } else if (adapter_name == "File") {
+        adapter = std::make_unique<NullAudioAdapter>(*this, fs_utils::utf8_to_path(file_path));
     } else {
         LOG_ERROR("Unknown audio adapter {}", adapter_name);
         return;
@@ -125,7 +91,18 @@ void AudioState::set_backend(const std::string &adapter_name) {
         return;
     }
 
-    adapter->temp_buffer.resize(spec.nb_samples * 2 * sizeof(uint16_t));
+    if (adapter->single_stream) {
+        mixer = std::make_unique<AudioMixer>(*this, spec.freq, spec.nb_samples, low_latency);
+        mixer->start();
+    }
+
+    // the backend starts paused, its callback must not run before the mixer exists
+    adapter->switch_state(false);
+}
+
+AudioState::~AudioState() {
+    if (adapter)
+        adapter->switch_state(true);
 }
 
 AudioOutPortPtr AudioState::open_port(int nb_channels, int freq, int nb_sample) {
@@ -136,10 +113,14 @@ AudioOutPortPtr AudioState::open_port(int nb_channels, int freq, int nb_sample)
             return nullptr;
 
         AudioOutPortPtr port = std::make_shared<AudioOutPort>();
-        port->len_microseconds = (nb_sample * 1'000'000ULL) / freq;
         port->len_bytes = static_cast<int>(nb_sample) * nb_channels * sizeof(uint16_t);
         port->stream = stream;
 
+        // a guest buffer gives this many frames once converted to the host format
+        const uint32_t mixed_frames = static_cast<uint32_t>((static_cast<uint64_t>(nb_sample) * spec.freq) / freq);
+        port->mixed_bytes_per_buffer = mixed_frames * 2 * sizeof(int16_t);
+        port->max_queued_buffers = mixer->get_max_queued_buffers(mixed_frames);
+
         return port;
     } else {
         // let the adapter open the port
@@ -150,46 +131,27 @@ AudioOutPortPtr AudioState::open_port(int nb_channels, int freq, int nb_sample)
 }
 
 void AudioState::audio_output(ThreadState &thread, AudioOutPort &out_port, const void *buffer) {
-    if (adapter->single_stream) {
-        // Put audio to the port's stream and see how much is left to play.
-        std::unique_lock<std::mutex> lock(out_port.mutex);
-        SDL_AudioStreamPut(out_port.stream.get(), buffer, out_port.len_bytes);
-        const int available = SDL_AudioStreamAvailable(out_port.stream.get());
-        lock.unlock();
-
-        // If there's lots of audio left to play, stop this thread.
-        // The audio callback will wake it up later when it's running out of data.
-        // the 3*(nb of samples for each callback) is needed for some games with an 480 host audiobuffer
-        // sample size (what SDL audio gives us) to make sure this does not happen
-        // we are supposed to wait for the existing samples to be processed (except the ones just passed)
-        // but this would give a bad audio because the host buffer size is different compared to the guest buffer size
-        // so we need to cache more data to make sure we always have enough
-        if (available >= 3 * spec.nb_samples * 2 * sizeof(uint16_t)) {
-            out_port.thread = thread.id;
-
-            std::unique_lock<std::mutex> mlock(thread.mutex);
-            thread.update_status(ThreadStatus::wait);
-            thread.status_cond.wait(mlock, [&]() { return thread.status == ThreadStatus::run; });
-        }
-    } else {
+    if (!adapter->single_stream) {
         adapter->audio_output(thread, out_port, buffer);
+        return;
     }
 
-    uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-    uint64_t diff = now - out_port.last_output;
-    uint64_t to_wait = out_port.len_microseconds - diff;
-    if (diff < out_port.len_microseconds && to_wait > 1000) {
-        // This is what we should be waiting to be perfectly accurate
-        // However, doing so would cause the host audio buffer to often lack samples to output
-        // This is because the PS Vita and the host audio parameters do not match exactly
-        // So instead only wait 50% of the time
-        // also don't sleep for less than 0.5 ms
-        // to_wait /= 2;
-        to_wait /= 4;
-        std::this_thread::sleep_for(std::chrono::microseconds(to_wait));
-        out_port.last_output = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-    } else {
-        out_port.last_output = now;
+    std::unique_lock<std::mutex> lock(out_port.mutex);
+    if (buffer) {
+        SDL_AudioStreamPut(out_port.stream.get(), buffer, out_port.len_bytes);
+        out_port.queued_buffers++;
+        out_port.stats.output_buffers++;
+    }
+
+    // Block the thread while the port has used all its credits
+    // The mixer gives them back as it consumes the port and wakes the thread up
+    if (out_port.queued_buffers >= out_port.max_queued_buffers) {
+        out_port.stats.overruns++;
+        std::unique_lock<std::mutex> thread_lock(thread.mutex);
+        out_port.thread = thread.id;
+        thread.update_status(ThreadStatus::wait);
+        lock.unlock();
+        thread.status_cond.wait(thread_lock, [&]() { return thread.status == ThreadStatus::run; });
     }
 }
 
@@ -216,3 +178,16 @@ void AudioState::set_global_volume(float volume) {
 void AudioState::switch_state(const bool pause) {
     adapter->switch_state(pause);
 }
+
+AudioStats AudioState::get_stats() {
+    AudioStats stats;
+    if (mixer)
+        stats.mixer = mixer->get_stats();
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &[id, port] : out_ports) {
+        const std::lock_guard<std::mutex> port_lock(port->mutex);
+        stats.ports.emplace(id, port->stats);
+    }
+    return stats;
+}
@@ -0,0 +1,184 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#include "audio/impl/null_audio.h"
+
+#include <kernel/timer_service.h>
+
+#include <util/log.h>
+
+using namespace std::chrono_literals;
+
+// the counters are logged at this interval, there is nothing else to tell how the audio behaves without a device
+static constexpr auto REPORT_INTERVAL = 10s;
+
+// after a stall longer than this the clock is restarted, instead of consuming the missed periods in a burst
+static constexpr uint32_t MAX_LATE_PERIODS = 4;
+
+template <typename T>
+static void write_le(fs::ofstream &file, T value) {
+    uint8_t bytes[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); i++)
+        bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+    file.write(reinterpret_cast<const char *>(bytes), sizeof(T));
+}
+
+NullAudioAdapter::NullAudioAdapter(AudioState &audio_state, const fs::path &file_path)
+    : AudioAdapter(audio_state)
+    , file_path(file_path) {}
+
+NullAudioAdapter::~NullAudioAdapter() {
+    if (thread.joinable()) {
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            exiting = true;
+        }
+        cond.notify_one();
+        thread.join();
+    }
+
+    if (file.is_open() && (file_path.extension() == ".wav")) {
+        // the sizes are only known now
+        file.seekp(0);
+        write_wav_header();
+    }
+}
+
+void NullAudioAdapter::write_wav_header() {
+    constexpr uint16_t CHANNELS = 2;
+    constexpr uint16_t BITS_PER_SAMPLE = 16;
+    const uint32_t data_size = static_cast<uint32_t>(std::min<uint64_t>(file_bytes, UINT32_MAX - 36));
+
+    file.write("RIFF", 4);
+    write_le<uint32_t>(file, 36 + data_size);
+    file.write("WAVEfmt ", 8);
+    write_le<uint32_t>(file, 16);
+    // PCM
+    write_le<uint16_t>(file, 1);
+    write_le<uint16_t>(file, CHANNELS);
+    write_le<uint32_t>(file, FREQ);
+    write_le<uint32_t>(file, FREQ * CHANNELS * BITS_PER_SAMPLE / 8);
+    write_le<uint16_t>(file, CHANNELS * BITS_PER_SAMPLE / 8);
+    write_le<uint16_t>(file, BITS_PER_SAMPLE);
+    file.write("data", 4);
+    write_le<uint32_t>(file, data_size);
+}
+
+bool NullAudioAdapter::init() {
+    if (!file_path.empty()) {
+        file.open(file_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            LOG_ERROR("Could not open audio output file {}", file_path);
+            return false;
+        }
+        if (file_path.extension() == ".wav")
+            write_wav_header();
+        LOG_INFO("Writing audio output to {}", file_path);
+    }
+
+    state.spec = {
+        .freq = FREQ,
+        .nb_samples = PERIOD_FRAMES,
+        .silence = 0
+    };
+
+    // started paused, the audio state resumes it once everything is ready
+    paused = true;
+    thread = std::thread(&NullAudioAdapter::run, this);
+
+    return true;
+}
+
+void NullAudioAdapter::switch_state(const bool pause) {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        paused = pause;
+    }
+    cond.notify_one();
+}
+
+void NullAudioAdapter::log_stats(AudioStats &last_stats, double seconds, uint64_t late_restarts) {
+    const AudioStats stats = state.get_stats();
+    const uint64_t reads = stats.mixer.reads - last_stats.mixer.reads;
+    const uint64_t latency_frames = stats.mixer.latency_frames - last_stats.mixer.latency_frames;
+    LOG_INFO("Null audio: {} underruns, {:.2f} ms of mixed audio ahead of the device, {} clock restarts",
+        stats.mixer.underruns - last_stats.mixer.underruns,
+        reads ? (latency_frames * 1000.0) / (reads * FREQ) : 0.0, late_restarts);
+
+    for (const auto &[id, port] : stats.ports) {
+        const auto last_port = last_stats.ports.find(id);
+        const AudioOutPortStats previous = (last_port != last_stats.ports.end()) ? last_port->second : AudioOutPortStats{};
+        LOG_INFO("Null audio: port {}: {:.0f} frames/s, {} buffers output, {} overruns, {} frames queued",
+            id, (port.mixed_frames - previous.mixed_frames) / seconds, port.output_buffers - previous.output_buffers,
+            port.overruns - previous.overruns, port.queued_frames);
+    }
+
+    last_stats = stats;
+}
+
+void NullAudioAdapter::run() {
+    using Clock = TimerService::Clock;
+    const auto get_period_end = [](uint64_t frames) { return std::chrono::nanoseconds(frames * 1'000'000'000ULL / FREQ); };
+    const auto period = get_period_end(PERIOD_FRAMES);
+
+    std::vector<int16_t> buffer(PERIOD_FRAMES * 2);
+    auto start = Clock::now();
+    uint64_t frames = 0;
+    uint64_t late_restarts = 0;
+
+    auto last_report = Clock::now();
+    AudioStats last_stats;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!exiting) {
+        if (paused) {
+            cond.wait(lock, [&] { return exiting || !paused; });
+            start = Clock::now();
+            frames = 0;
+            continue;
+        }
+        lock.unlock();
+
+        if (Clock::now() - last_report >= REPORT_INTERVAL) {
+            log_stats(last_stats, std::chrono::duration<double>(Clock::now() - last_report).count(), late_restarts);
+            last_report = Clock::now();
+        }
+
+        frames += PERIOD_FRAMES;
+        const auto deadline = start + get_period_end(frames);
+        const auto now = Clock::now();
+        if (now - deadline > MAX_LATE_PERIODS * period) {
+            start = now;
+            frames = 0;
+            late_restarts++;
+        } else {
+            get_timer_service().sleep_until(deadline);
+        }
+
+        // the callback runs with the mutex locked, so that the backend is really stopped once switch_state returns
+        lock.lock();
+        if (paused || exiting)
+            continue;
+
+        audio_callback(reinterpret_cast<uint8_t *>(buffer.data()), static_cast<int>(buffer.size() * sizeof(int16_t)));
+        if (file.is_open()) {
+            file.write(reinterpret_cast<const char *>(buffer.data()), buffer.size() * sizeof(int16_t));
+            file_bytes += buffer.size() * sizeof(int16_t);
+        }
+    }
+}
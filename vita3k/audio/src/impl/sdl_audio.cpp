@@ -63,8 +63,6 @@ bool SDLAudioAdapter::init() {
         .silence = spec.silence
     };
 
-    SDL_PauseAudioDevice(device_id, 0);
-
     return true;
 }
 
@@ -0,0 +1,262 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#include <audio/mixer.h>
+#include <audio/state.h>
+
+#ifdef TRACY_ENABLE
+#include <tracy/Tracy.hpp>
+#endif
+
+#include <kernel/timer_service.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+// port volumes are applied in 2.14 fixed point, so that the full volume still fits in a signed 16 bits lane
+static constexpr int MIX_VOLUME_SHIFT = 14;
+static constexpr int32_t MIX_VOLUME_UNITY = 1 << MIX_VOLUME_SHIFT;
+
+// acc[i] += (src[i] * volume) >> MIX_VOLUME_SHIFT
+static void mix_s16(int32_t *acc, const int16_t *src, const uint32_t count, const int16_t volume) {
+    uint32_t i = 0;
+#if defined(__aarch64__)
+    for (; i + 8 <= count; i += 8) {
+        const int16x8_t samples = vld1q_s16(src + i);
+        const int32x4_t low = vshrq_n_s32(vmull_n_s16(vget_low_s16(samples), volume), MIX_VOLUME_SHIFT);
+        const int32x4_t high = vshrq_n_s32(vmull_n_s16(vget_high_s16(samples), volume), MIX_VOLUME_SHIFT);
+        vst1q_s32(acc + i, vaddq_s32(vld1q_s32(acc + i), low));
+        vst1q_s32(acc + i + 4, vaddq_s32(vld1q_s32(acc + i + 4), high));
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    const __m128i volumes = _mm_set1_epi16(volume);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        // 32 bits products from their low and high halves
+        const __m128i products_low = _mm_mullo_epi16(samples, volumes);
+        const __m128i products_high = _mm_mulhi_epi16(samples, volumes);
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(products_low, products_high), MIX_VOLUME_SHIFT);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(products_low, products_high), MIX_VOLUME_SHIFT);
+        __m128i *dst = reinterpret_cast<__m128i *>(acc + i);
+        _mm_storeu_si128(dst, _mm_add_epi32(_mm_loadu_si128(dst), low));
+        _mm_storeu_si128(dst + 1, _mm_add_epi32(_mm_loadu_si128(dst + 1), high));
+    }
+#endif
+    for (; i < count; i++)
+        acc[i] += (src[i] * volume) >> MIX_VOLUME_SHIFT;
+}
+
+// dst[i] = saturate(src[i])
+static void clamp_s16(int16_t *dst, const int32_t *src, const uint32_t count) {
+    uint32_t i = 0;
+#if defined(__aarch64__)
+    for (; i + 8 <= count; i += 8)
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(vld1q_s32(src + i)), vqmovn_s32(vld1q_s32(src + i + 4))));
+#elif defined(__SSE2__) || defined(_M_X64)
+    for (; i + 8 <= count; i += 8) {
+        const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packs_epi32(low, high));
+    }
+#endif
+    for (; i < count; i++)
+        dst[i] = static_cast<int16_t>(std::clamp<int32_t>(src[i], INT16_MIN, INT16_MAX));
+}
+
+AudioMixer::AudioMixer(AudioState &state, uint32_t freq, uint32_t period_frames, bool low_latency)
+    : state(state)
+    , freq(freq) {
+    if (low_latency) {
+        // mix in quarters of the backend period and keep only one period ahead of it
+        mix_frames = std::max<uint32_t>(period_frames / 4, 64);
+        target_frames = period_frames + mix_frames;
+    } else {
+        mix_frames = period_frames;
+        target_frames = 2 * period_frames;
+    }
+
+    ring.resize((target_frames + period_frames) * 2);
+    accumulator.resize(mix_frames * 2);
+    port_buffer.resize(mix_frames * 2);
+    mixed.resize(mix_frames * 2);
+}
+
+AudioMixer::~AudioMixer() {
+    if (!thread.joinable())
+        return;
+
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        exiting = true;
+    }
+    cond.notify_one();
+    thread.join();
+}
+
+void AudioMixer::start() {
+    thread = std::thread(&AudioMixer::run, this);
+}
+
+uint32_t AudioMixer::get_level() const {
+    return static_cast<uint32_t>(write_pos.load(std::memory_order_acquire) - read_pos.load(std::memory_order_acquire));
+}
+
+uint32_t AudioMixer::get_max_queued_buffers(uint32_t port_frames) const {
+    // enough for the port to cover what the mixer keeps ahead, plus the buffer being mixed
+    return std::max<uint32_t>((target_frames + port_frames - 1) / std::max<uint32_t>(port_frames, 1) + 1, 2);
+}
+
+AudioMixerStats AudioMixer::get_stats() const {
+    return {
+        .mixed_frames = mixed_frames.load(std::memory_order_relaxed),
+        .reads = reads.load(std::memory_order_relaxed),
+        .underruns = underruns.load(std::memory_order_relaxed),
+        .latency_frames = latency_frames.load(std::memory_order_relaxed),
+        .mix_time_ns = mix_time_ns.load(std::memory_order_relaxed),
+    };
+}
+
+bool AudioMixer::mix(uint32_t nb_frames) {
+#ifdef TRACY_ENABLE
+    ZoneScopedC(0xF6C2FF); // Tracy - Track function scope with color thistle
+#endif
+
+    const uint32_t capacity = static_cast<uint32_t>(ring.size() / 2);
+    if ((nb_frames > mix_frames) || (get_level() + nb_frames > capacity))
+        return false;
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        const std::lock_guard<std::mutex> lock(state.mutex);
+        ports.clear();
+        for (const auto &[_, port] : state.out_ports)
+            ports.push_back(port);
+    }
+
+    const uint32_t nb_samples = nb_frames * 2;
+    std::fill_n(accumulator.begin(), nb_samples, 0);
+    threads_to_resume.clear();
+    for (const auto &port : ports) {
+        const float volume = std::clamp(port->volume * state.global_volume, 0.0f, 1.0f);
+        const int16_t fixed_volume = static_cast<int16_t>(std::lround(volume * MIX_VOLUME_UNITY));
+
+        std::unique_lock<std::mutex> lock(port->mutex);
+        const int bytes_available = SDL_AudioStreamAvailable(port->stream.get());
+        const int bytes_to_get = std::min(static_cast<int>(nb_samples * sizeof(int16_t)), bytes_available);
+        const int bytes_got = (bytes_to_get > 0) ? std::max(SDL_AudioStreamGet(port->stream.get(), port_buffer.data(), bytes_to_get), 0) : 0;
+
+        port->stats.mixed_frames += bytes_got / (2 * sizeof(int16_t));
+        port->stats.queued_frames = (bytes_available - bytes_got) / (2 * sizeof(int16_t));
+
+        // give back the credits of the guest buffers fully mixed
+        port->mixed_bytes += bytes_got;
+        while ((port->queued_buffers > 0) && (port->mixed_bytes >= port->mixed_bytes_per_buffer)) {
+            port->mixed_bytes -= port->mixed_bytes_per_buffer;
+            port->queued_buffers--;
+        }
+        // the resampler does not give exactly the expected number of bytes, resync once the port is empty
+        if (bytes_available == bytes_got) {
+            port->queued_buffers = 0;
+            port->mixed_bytes = 0;
+        }
+
+        if ((port->thread >= 0) && (port->queued_buffers < port->max_queued_buffers)) {
+            threads_to_resume.push_back(port->thread);
+            port->thread = -1;
+        }
+        lock.unlock();
+
+        if ((bytes_got > 0) && (fixed_volume > 0))
+            mix_s16(accumulator.data(), port_buffer.data(), bytes_got / sizeof(int16_t), fixed_volume);
+    }
+
+    // the threads set their wait status before releasing the port mutex, they cannot miss this
+    if (state.resume_thread) {
+        for (const SceUID thread_id : threads_to_resume)
+            state.resume_thread(thread_id);
+    }
+
+    clamp_s16(mixed.data(), accumulator.data(), nb_samples);
+
+    const uint64_t position = write_pos.load(std::memory_order_relaxed);
+    const uint32_t offset = position % capacity;
+    const uint32_t first_frames = std::min(nb_frames, capacity - offset);
+    memcpy(&ring[offset * 2], mixed.data(), first_frames * 2 * sizeof(int16_t));
+    memcpy(ring.data(), &mixed[first_frames * 2], (nb_frames - first_frames) * 2 * sizeof(int16_t));
+    write_pos.store(position + nb_frames, std::memory_order_release);
+
+    mixed_frames.fetch_add(nb_frames, std::memory_order_relaxed);
+    mix_time_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(), std::memory_order_relaxed);
+    return true;
+}
+
+void AudioMixer::read(int16_t *output, uint32_t nb_frames) {
+    const uint32_t capacity = static_cast<uint32_t>(ring.size() / 2);
+    const uint64_t position = read_pos.load(std::memory_order_relaxed);
+    const uint64_t level = write_pos.load(std::memory_order_acquire) - position;
+    const uint32_t frames = static_cast<uint32_t>(std::min<uint64_t>(nb_frames, level));
+    reads.fetch_add(1, std::memory_order_relaxed);
+    latency_frames.fetch_add(level, std::memory_order_relaxed);
+
+    const uint32_t offset = position % capacity;
+    const uint32_t first_frames = std::min(frames, capacity - offset);
+    memcpy(output, &ring[offset * 2], first_frames * 2 * sizeof(int16_t));
+    memcpy(&output[first_frames * 2], ring.data(), (frames - first_frames) * 2 * sizeof(int16_t));
+    read_pos.store(position + frames, std::memory_order_release);
+
+    if (frames < nb_frames) {
+        memset(&output[frames * 2], 0, (nb_frames - frames) * 2 * sizeof(int16_t));
+        underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // let the mixer top the ring up right away
+    const std::lock_guard<std::mutex> lock(mutex);
+    cond.notify_one();
+}
+
+void AudioMixer::run() {
+#ifdef TRACY_ENABLE
+    tracy::SetThreadName("Audio mixer thread");
+#endif
+
+    const auto period = std::chrono::microseconds(mix_frames * 1'000'000ULL / freq);
+    const auto needs_mix = [&] { return get_level() + mix_frames <= target_frames; };
+
+    auto next_period = TimerService::Clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!exiting) {
+        lock.unlock();
+        while (needs_mix() && mix(mix_frames)) {
+        }
+        lock.lock();
+
+        next_period += period;
+        const auto now = TimerService::Clock::now();
+        if (next_period < now)
+            next_period = now + period;
+
+        get_timer_service().wait_until(cond, lock, next_period, [&] { return exiting || needs_mix(); });
+    }
+}
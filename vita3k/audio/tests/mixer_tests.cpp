@@ -0,0 +1,171 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#include <audio/state.h>
+#include <testutil/benchmark.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <random>
+#include <thread>
+
+static AudioOutPortPtr add_port(AudioState &state, const AudioMixer &mixer, int id, uint32_t nb_frames, float volume) {
+    const AudioStreamPtr stream(SDL_NewAudioStream(AUDIO_S16LSB, 2, 48000, AUDIO_S16LSB, 2, 48000), SDL_FreeAudioStream);
+    AudioOutPortPtr port = std::make_shared<AudioOutPort>();
+    port->stream = stream;
+    port->volume = volume;
+    port->len_bytes = nb_frames * 2 * sizeof(int16_t);
+    port->mixed_bytes_per_buffer = port->len_bytes;
+    port->max_queued_buffers = mixer.get_max_queued_buffers(nb_frames);
+    state.out_ports.emplace(id, port);
+    return port;
+}
+
+static void put_buffer(AudioOutPort &port, const std::vector<int16_t> &samples) {
+    SDL_AudioStreamPut(port.stream.get(), samples.data(), port.len_bytes);
+    port.queued_buffers++;
+}
+
+TEST(audio_mixer, mixes_ports_with_volume_and_saturation) {
+    AudioState state;
+    AudioMixer mixer(state, 48000, 256, false);
+    auto &loud = *add_port(state, mixer, 1, 256, 1.0f);
+    auto &quiet = *add_port(state, mixer, 2, 256, 0.5f);
+
+    std::vector<int16_t> loud_samples(512), quiet_samples(512);
+    for (int i = 0; i < 512; i++) {
+        loud_samples[i] = static_cast<int16_t>((i % 2) ? 30000 - i * 100 : -i * 37);
+        quiet_samples[i] = static_cast<int16_t>((i % 2) ? 20000 : -i * 11);
+    }
+    put_buffer(loud, loud_samples);
+    put_buffer(quiet, quiet_samples);
+
+    ASSERT_TRUE(mixer.mix(256));
+    std::vector<int16_t> output(512);
+    mixer.read(output.data(), 256);
+
+    for (int i = 0; i < 512; i++) {
+        const int32_t expected = std::clamp<int32_t>(loud_samples[i] + (quiet_samples[i] * 8192 >> 14), INT16_MIN, INT16_MAX);
+        ASSERT_EQ(output[i], expected) << "at sample " << i;
+    }
+    ASSERT_EQ(mixer.get_stats().underruns, 0);
+}
+
+TEST(audio_mixer, gives_credits_back_as_it_mixes) {
+    AudioState state;
+    std::vector<SceUID> resumed;
+    state.resume_thread = [&](SceUID thread_id) { resumed.push_back(thread_id); };
+
+    AudioMixer mixer(state, 48000, 256, false);
+    auto &port = *add_port(state, mixer, 1, 128, 1.0f);
+    ASSERT_EQ(port.max_queued_buffers, 5);
+
+    const std::vector<int16_t> samples(256, 1000);
+    for (int i = 0; i < 5; i++)
+        put_buffer(port, samples);
+    port.thread = 42;
+
+    // one buffer and a half, only one credit is given back
+    ASSERT_TRUE(mixer.mix(192));
+    ASSERT_EQ(port.queued_buffers, 4);
+    ASSERT_EQ(resumed, std::vector<SceUID>{ 42 });
+    ASSERT_EQ(port.thread, -1);
+
+    ASSERT_TRUE(mixer.mix(192));
+    ASSERT_EQ(port.queued_buffers, 2);
+
+    // the ring only holds what the backend has not read yet
+    ASSERT_TRUE(mixer.mix(256));
+    ASSERT_FALSE(mixer.mix(256));
+
+    // once the port is drained, every credit is back
+    std::vector<int16_t> output(512);
+    mixer.read(output.data(), 256);
+    ASSERT_TRUE(mixer.mix(256));
+    ASSERT_EQ(port.queued_buffers, 0);
+    ASSERT_EQ(resumed.size(), 1);
+}
+
+TEST(audio_mixer, counts_underruns) {
+    AudioState state;
+    AudioMixer mixer(state, 48000, 256, true);
+    ASSERT_EQ(mixer.get_latency_frames(), 256 + 64);
+
+    ASSERT_TRUE(mixer.mix(64));
+    std::vector<int16_t> output(512, 123);
+    mixer.read(output.data(), 256);
+    ASSERT_EQ(mixer.get_stats().underruns, 1);
+    ASSERT_EQ(std::count(output.begin(), output.end(), 0), 512);
+}
+
+TEST(audio_mixer, thread_keeps_up_with_backend) {
+    AudioState state;
+    AudioMixer mixer(state, 48000, 256, false);
+    auto &port = *add_port(state, mixer, 1, 256, 1.0f);
+    const std::vector<int16_t> samples(512, 1000);
+    mixer.start();
+
+    // simulate a backend reading 256 frames every 5.3 ms while a guest keeps the port filled
+    std::vector<int16_t> output(512);
+    const auto period = std::chrono::microseconds(256 * 1'000'000 / 48000);
+    auto next = std::chrono::steady_clock::now() + 2 * period;
+    for (int i = 0; i < 40; i++) {
+        {
+            const std::lock_guard<std::mutex> lock(port.mutex);
+            while (port.queued_buffers < port.max_queued_buffers)
+                put_buffer(port, samples);
+        }
+        std::this_thread::sleep_until(next);
+        next += period;
+        mixer.read(output.data(), 256);
+    }
+
+    ASSERT_EQ(mixer.get_stats().underruns, 0);
+    ASSERT_EQ(output[0], 1000);
+}
+
+BENCHMARK_TEST(audio_mixer, mix) {
+    constexpr int PORT_COUNT = 8;
+    constexpr uint32_t PERIOD = 256;
+    constexpr int PERIOD_COUNT = 48000 * 60 / PERIOD;
+
+    AudioState state;
+    AudioMixer mixer(state, 48000, PERIOD, false);
+    std::vector<int16_t> samples(PERIOD * 2);
+    std::mt19937 rng(42);
+    for (auto &sample : samples)
+        sample = static_cast<int16_t>(rng());
+
+    std::vector<AudioOutPortPtr> ports;
+    for (int i = 0; i < PORT_COUNT; i++)
+        ports.push_back(add_port(state, mixer, i, PERIOD, 0.7f));
+
+    std::vector<int16_t> output(PERIOD * 2);
+    for (int i = 0; i < PERIOD_COUNT; i++) {
+        for (auto &port : ports)
+            put_buffer(*port, samples);
+        mixer.mix(PERIOD);
+        mixer.read(output.data(), PERIOD);
+    }
+
+    const auto stats = mixer.get_stats();
+    // 60 s of audio from PORT_COUNT ports
+    testutil::record_time("mix_time", std::chrono::nanoseconds(stats.mix_time_ns));
+    testutil::record_time<std::chrono::nanoseconds>("period", std::chrono::nanoseconds(stats.mix_time_ns / PERIOD_COUNT));
+}
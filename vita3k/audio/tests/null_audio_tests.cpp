@@ -0,0 +1,123 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#include <audio/state.h>
+
+#include <util/fs.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+// keeps the port full, like a guest thread blocked by its credits
+class PortFeeder {
+    std::atomic<bool> exiting = false;
+    std::thread thread;
+
+public:
+    PortFeeder(AudioState &state, int16_t value) {
+        const AudioStreamPtr stream(SDL_NewAudioStream(AUDIO_S16LSB, 2, 48000, AUDIO_S16LSB, 2, 48000), SDL_FreeAudioStream);
+        AudioOutPortPtr port = std::make_shared<AudioOutPort>();
+        port->stream = stream;
+        port->len_bytes = 256 * 2 * sizeof(int16_t);
+        port->mixed_bytes_per_buffer = port->len_bytes;
+        port->max_queued_buffers = state.mixer->get_max_queued_buffers(256);
+        {
+            const std::lock_guard<std::mutex> lock(state.mutex);
+            state.out_ports.emplace(1, port);
+        }
+
+        thread = std::thread([this, port, value] {
+            const std::vector<int16_t> samples(512, value);
+            while (!exiting) {
+                {
+                    const std::lock_guard<std::mutex> lock(port->mutex);
+                    while (port->queued_buffers < port->max_queued_buffers) {
+                        SDL_AudioStreamPut(port->stream.get(), samples.data(), port->len_bytes);
+                        port->queued_buffers++;
+                        port->stats.output_buffers++;
+                    }
+                }
+                std::this_thread::sleep_for(1ms);
+            }
+        });
+    }
+
+    ~PortFeeder() {
+        exiting = true;
+        thread.join();
+    }
+};
+
+TEST(null_audio, consumes_at_device_rate) {
+    AudioState state;
+    ASSERT_TRUE(state.init({}, "Null"));
+    ASSERT_EQ(state.spec.freq, 48000);
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        PortFeeder feeder(state, 1000);
+        std::this_thread::sleep_for(500ms);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // the ports are not touched any more, read them before the port is mixed to its end
+    const AudioStats stats = state.get_stats();
+    const double rate = stats.mixer.reads * 256 / seconds;
+    ASSERT_NEAR(rate, 48000, 48000 * 0.05);
+    ASSERT_GT(stats.ports.at(1).mixed_frames, 48000 * 0.4);
+    // the first reads can happen before the feeder filled the port
+    ASSERT_LE(stats.mixer.underruns, 2);
+}
+
+TEST(null_audio, writes_wav_file) {
+    const fs::path path = fs::temp_directory_path() / fs::unique_path("vita3k-audio-%%%%%%%%.wav");
+    {
+        AudioState state;
+        state.file_path = path.string();
+        ASSERT_TRUE(state.init({}, "File"));
+
+        PortFeeder feeder(state, 1000);
+        std::this_thread::sleep_for(200ms);
+    }
+
+    fs::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    fs::remove(path);
+
+    ASSERT_GT(data.size(), 44 + 48000 / 10 * 4);
+    const auto read_u32 = [&](size_t offset) { return data[offset] | (data[offset + 1] << 8) | (data[offset + 2] << 16) | (static_cast<uint32_t>(data[offset + 3]) << 24); };
+    const auto read_u16 = [&](size_t offset) { return data[offset] | (data[offset + 1] << 8); };
+    ASSERT_EQ(std::string(data.begin(), data.begin() + 4), "RIFF");
+    ASSERT_EQ(read_u32(4), data.size() - 8);
+    ASSERT_EQ(std::string(data.begin() + 8, data.begin() + 16), "WAVEfmt ");
+    ASSERT_EQ(read_u16(22), 2);
+    ASSERT_EQ(read_u32(24), 48000);
+    ASSERT_EQ(read_u16(34), 16);
+    ASSERT_EQ(std::string(data.begin() + 36, data.begin() + 40), "data");
+    ASSERT_EQ(read_u32(40), data.size() - 44);
+
+    // the audio of the port is in the file
+    std::vector<int16_t> samples((data.size() - 44) / sizeof(int16_t));
+    memcpy(samples.data(), &data[44], samples.size() * sizeof(int16_t));
+    ASSERT_GT(std::count(samples.begin(), samples.end(), 1000), 48000 / 10 * 2);
+}
@@ -28,6 +28,7 @@ struct AVFormatContext;
 struct AVCodecParserContext;
 struct AVCodec;
 struct SwrContext;
+struct SwsContext;
 
 union DecoderSize {
     struct {
@@ -285,3 +286,8 @@ int convert_yuv_to_jpeg(const uint8_t *yuv, uint8_t *jpeg, uint32_t width, uint3
 void copy_yuv_data_from_frame(AVFrame *frame, uint8_t *dest, const uint32_t width, const uint32_t height, bool is_p3);
 void calculate_pitch_info(uint32_t width, uint32_t height, int downscale_ratio, DecoderColorSpace color_space, bool use_standard_decoder, MJpegPitch output_pitch[4]);
 std::string codec_error_name(int error);
+
+// Return a swscale context converting between the given sizes and AVPixelFormats.
+// Contexts are kept in a small per-thread LRU cache (a context can't be used by two threads at once),
+// the returned context is owned by the cache and stays valid until the next call from the same thread.
+SwsContext *get_sws_context(int src_width, int src_height, int src_format, int dst_width, int dst_height, int dst_format, int flags);
@@ -62,7 +62,7 @@ void convert_yuv_to_rgb(const uint8_t *yuv, uint8_t *rgba, uint32_t frame_width,
         return;
     }
 
-    SwsContext *context = sws_getContext(width, height, format, width, height, is_bgra ? AV_PIX_FMT_BGRA : AV_PIX_FMT_RGBA, SWS_FULL_CHR_H_INT | SWS_ACCURATE_RND, nullptr, nullptr, nullptr);
+    SwsContext *context = get_sws_context(width, height, format, width, height, is_bgra ? AV_PIX_FMT_BGRA : AV_PIX_FMT_RGBA, SWS_FULL_CHR_H_INT | SWS_ACCURATE_RND);
     assert(context);
 
     const uint8_t *slices[] = {
@@ -87,7 +87,6 @@ void convert_yuv_to_rgb(const uint8_t *yuv, uint8_t *rgba, uint32_t frame_width,
 
     int error = sws_scale(context, slices, strides, 0, height, dst_slices, dst_strides);
     assert(error == height);
-    sws_freeContext(context);
 }
 
 void convert_rgb_to_yuv(const uint8_t *rgba, uint8_t *yuv, uint32_t width, uint32_t height, const DecoderColorSpace color_space, int32_t in_pitch) {
@@ -122,8 +121,8 @@ void convert_rgb_to_yuv(const uint8_t *rgba, uint8_t *yuv, uint32_t width, uint3
         return;
     }
 
-    SwsContext *context = sws_getContext(width, height, AV_PIX_FMT_RGBA, width, height, format,
-        SWS_FULL_CHR_H_INT | SWS_ACCURATE_RND, nullptr, nullptr, nullptr);
+    SwsContext *context = get_sws_context(width, height, AV_PIX_FMT_RGBA, width, height, format,
+        SWS_FULL_CHR_H_INT | SWS_ACCURATE_RND);
     assert(context);
 
     const uint8_t *slices[] = {
@@ -147,7 +146,6 @@ void convert_rgb_to_yuv(const uint8_t *rgba, uint8_t *yuv, uint32_t width, uint3
     };
 
     int error = sws_scale(context, slices, strides, 0, height, dst_slices, dst_strides);
-    sws_freeContext(context);
     assert(error == height);
 }
 
@@ -0,0 +1,83 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <codec/state.h>
+
+extern "C" {
+#include <libswscale/swscale.h>
+}
+
+#include <list>
+#include <utility>
+
+namespace {
+
+struct SwsContextKey {
+    int src_width;
+    int src_height;
+    int src_format;
+    int dst_width;
+    int dst_height;
+    int dst_format;
+    int flags;
+
+    bool operator==(const SwsContextKey &) const = default;
+};
+
+class SwsContextCache {
+    // creating a context is expensive and each conversion path only uses a few different ones
+    static constexpr size_t max_contexts = 8;
+
+    // most recently used context first
+    std::list<std::pair<SwsContextKey, SwsContext *>> contexts;
+
+public:
+    ~SwsContextCache() {
+        for (auto &[key, context] : contexts)
+            sws_freeContext(context);
+    }
+
+    SwsContext *get(const SwsContextKey &key) {
+        for (auto it = contexts.begin(); it != contexts.end(); ++it) {
+            if (it->first == key) {
+                contexts.splice(contexts.begin(), contexts, it);
+                return it->second;
+            }
+        }
+
+        SwsContext *context = sws_getContext(key.src_width, key.src_height, static_cast<AVPixelFormat>(key.src_format),
+            key.dst_width, key.dst_height, static_cast<AVPixelFormat>(key.dst_format), key.flags, nullptr, nullptr, nullptr);
+        if (!context)
+            return nullptr;
+
+        if (contexts.size() >= max_contexts) {
+            sws_freeContext(contexts.back().second);
+            contexts.pop_back();
+        }
+        contexts.emplace_front(key, context);
+
+        return context;
+    }
+};
+
+thread_local SwsContextCache sws_context_cache;
+
+} // namespace
+
+SwsContext *get_sws_context(int src_width, int src_height, int src_format, int dst_width, int dst_height, int dst_format, int flags) {
+    return sws_context_cache.get({ src_width, src_height, src_format, dst_width, dst_height, dst_format, flags });
+}
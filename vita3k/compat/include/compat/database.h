@@ -0,0 +1,94 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <util/fs.h>
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace compat {
+
+enum CompatibilityState {
+    UNKNOWN = -1,
+    NOTHING,
+    BOOTABLE,
+    INTRO,
+    MENU,
+    INGAME_LESS,
+    INGAME_MORE,
+    PLAYABLE,
+};
+
+struct Compatibility {
+    uint32_t issue_id;
+    CompatibilityState state = UNKNOWN;
+    time_t updated_at;
+};
+
+/**
+ * @brief Compatibility database as an array sorted by title ID
+ *
+ * The array is also the content of the binary cache of the XML database, loading the cache
+ * is a single read and lookups are binary searches.
+ */
+class CompatDatabase {
+public:
+    struct Entry {
+        char title_id[16];
+        Compatibility compat;
+    };
+
+    // Attributes of the <compatibility> node of the XML database
+    struct Info {
+        uint32_t version = 0;
+        uint32_t issue_count = 0;
+        std::string updated_at;
+    };
+
+    /**
+     * @brief Parse the downloaded XML database
+     *
+     * @param log_warn Log the issues of the database (invalid title IDs, missing labels, duplicates)
+     */
+    bool parse_xml(const std::vector<char> &xml, bool log_warn);
+
+    /**
+     * @brief Load the binary cache written by save_cache
+     *
+     * @param xml_hash Hash of the XML database, the cache of another database is rejected
+     */
+    bool load_cache(const fs::path &path, uint64_t xml_hash);
+    bool save_cache(const fs::path &path, uint64_t xml_hash) const;
+
+    const Compatibility *find(const std::string &title_id) const;
+    bool contains(const std::string &title_id) const { return find(title_id) != nullptr; }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    void clear();
+
+    const Info &get_info() const { return info; }
+
+private:
+    Info info;
+    std::vector<Entry> entries;
+};
+
+} // namespace compat
@@ -17,33 +17,16 @@
 
 #pragma once
 
-#include <cstdint>
+#include <compat/database.h>
+
 #include <imgui.h>
 #include <map>
-#include <string>
 
 namespace compat {
 
-enum CompatibilityState {
-    UNKNOWN = -1,
-    NOTHING,
-    BOOTABLE,
-    INTRO,
-    MENU,
-    INGAME_LESS,
-    INGAME_MORE,
-    PLAYABLE,
-};
-
-struct Compatibility {
-    uint32_t issue_id;
-    CompatibilityState state = UNKNOWN;
-    time_t updated_at;
-};
-
 struct CompatState {
     bool compat_db_loaded = false;
-    std::map<std::string, Compatibility> app_compat_db;
+    CompatDatabase app_compat_db;
     std::map<CompatibilityState, ImVec4> compat_color{
         { UNKNOWN, ImVec4(0.54f, 0.54f, 0.54f, 1.f) },
         { NOTHING, ImVec4(1.00f, 0.00f, 0.00f, 1.f) }, // #ff0000
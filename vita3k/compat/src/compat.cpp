@@ -27,17 +27,8 @@
 #include <util/net_utils.h>
 #include <miniz.h>
 
-#include <pugixml.hpp>
-
-enum LabelIdState {
-    Nothing = 1260231569, // 0x4b1d9b91
-    Bootable = 1344750319, // 0x502742ef
-    Intro = 1260231381, // 0x4B9F5E5D
-    Menu = 1344751053, // 0x4F1B9135
-    Ingame_Less = 1344752299, // 0x4F7B6B3B
-    Ingame_More = 1260231985, // 0x4B2A9819
-    Playable = 920344019, // 0x36db55d3
-};
+#define XXH_INLINE_ALL
+#include <xxhash.h>
 
 namespace compat {
 
@@ -88,80 +79,54 @@ bool load_app_compat_db(GuiState &gui, EmuEnvState &emuenv) {
         return false;
     }
 
-    // Parse and load file of compatibility database
-    pugi::xml_document doc;
-    pugi::xml_parse_result result = doc.load_file(app_compat_db_path.c_str());
-    if (!result) {
-        LOG_ERROR("Compatibility database {} could not be loaded: {}", app_compat_db_path, result.description());
+    // Read file of compatibility database, its hash tells if the binary cache is still the one of it
+    fs::ifstream xml_file(app_compat_db_path, std::ios::in | std::ios::binary | std::ios::ate);
+    std::vector<char> xml(xml_file ? static_cast<size_t>(xml_file.tellg()) : 0);
+    xml_file.seekg(0);
+    if (!xml_file || !xml_file.read(xml.data(), xml.size())) {
+        LOG_ERROR("Compatibility database {} could not be read.", app_compat_db_path);
         return false;
     }
+    const auto xml_hash = XXH3_64bits(xml.data(), xml.size());
+
+    // Clear old compat database
+    gui.compat.compat_db_loaded = false;
+    auto &app_compat_db = gui.compat.app_compat_db;
+
+    // Parse the database only when it changed since the cache was written
+    const auto app_compat_db_cache_path = emuenv.cache_path / "app_compat_db.bin";
+    if (!app_compat_db.load_cache(app_compat_db_cache_path, xml_hash)) {
+        if (!app_compat_db.parse_xml(xml, emuenv.cfg.log_compat_warn)) {
+            LOG_ERROR("Compatibility database {} could not be loaded.", app_compat_db_path);
+            return false;
+        }
+        if (!app_compat_db.save_cache(app_compat_db_cache_path, xml_hash))
+            LOG_WARN("Failed to write compatibility database cache {}.", app_compat_db_cache_path);
+    }
 
     // Check compatibility database version
-    const auto compatibility = doc.child("compatibility");
-    const auto version = compatibility.attribute("version").as_uint();
-    db_issue_count = compatibility.attribute("issue_count").as_uint();
-    if (db_version != version) {
-        LOG_WARN("Compatibility database version {} is outdated, download it again.", version);
+    const auto &db_info = app_compat_db.get_info();
+    db_issue_count = db_info.issue_count;
+    if (db_version != db_info.version) {
+        LOG_WARN("Compatibility database version {} is outdated, download it again.", db_info.version);
+        app_compat_db.clear();
         return update_app_compat_db(gui, emuenv);
     }
 
     // Check if compatibility database is up to date in first load
     if (db_updated_at.empty()) {
-        db_updated_at = compatibility.attribute("db_updated_at").as_string();
+        db_updated_at = db_info.updated_at;
         if (update_app_compat_db(gui, emuenv))
             return true;
     }
 
-    // Clear old compat database
-    gui.compat.compat_db_loaded = false;
-    gui.compat.app_compat_db.clear();
-
-    //  Load compatibility database
-    for (const auto &app : doc.child("compatibility")) {
-        const std::string title_id = app.attribute("title_id").as_string();
-        const auto issue_id = app.child("issue_id").text().as_uint();
-
-        // Check if title ID is valid
-        if ((title_id.find("PCS") == std::string::npos) && (title_id != "NPXS10007")) {
-            LOG_WARN_IF(emuenv.cfg.log_compat_warn, "Title ID {} is invalid. Please check GitHub issue {} and verify it!", title_id, issue_id);
-            continue;
-        }
-
-        auto state = CompatibilityState::UNKNOWN;
-        const auto labels = app.child("labels");
-        if (!labels.empty()) {
-            for (const auto &label : labels) {
-                const auto label_id = static_cast<LabelIdState>(label.text().as_uint());
-                switch (label_id) {
-                case LabelIdState::Nothing: state = NOTHING; break;
-                case LabelIdState::Bootable: state = BOOTABLE; break;
-                case LabelIdState::Intro: state = INTRO; break;
-                case LabelIdState::Menu: state = MENU; break;
-                case LabelIdState::Ingame_Less: state = INGAME_LESS; break;
-                case LabelIdState::Ingame_More: state = INGAME_MORE; break;
-                case LabelIdState::Playable: state = PLAYABLE; break;
-                default: break;
-                }
-            }
-        }
-        const auto updated_at = app.child("updated_at").text().as_llong();
-
-        // Check if app missing a status label
-        if (state == UNKNOWN)
-            LOG_WARN_IF(emuenv.cfg.log_compat_warn, "App with Title ID {} has an issue but no status label. Please check GitHub issue {} and request a status label be added.", title_id, issue_id);
-
-        // Check if app already exists in compatibility database
-        if (gui.compat.app_compat_db.contains(title_id))
-            LOG_WARN_IF(emuenv.cfg.log_compat_warn, "App with Title ID {} already exists in compatibility database. Please check and close GitHub issue {}.", title_id, gui.compat.app_compat_db[title_id].issue_id);
-
-        gui.compat.app_compat_db[title_id] = { issue_id, state, updated_at };
-    }
-
     // Update compatibility status of all user apps
-    for (auto &app : gui.app_selector.user_apps)
-        app.compat = gui.compat.app_compat_db.contains(app.title_id) ? gui.compat.app_compat_db[app.title_id].state : CompatibilityState::UNKNOWN;
+    for (auto &app : gui.app_selector.user_apps) {
+        const auto compat = app_compat_db.find(app.title_id);
+        app.compat = compat ? compat->state : CompatibilityState::UNKNOWN;
+    }
 
-    return !gui.compat.app_compat_db.empty();
+    return !app_compat_db.empty();
 }
 
 static const std::string latest_link = "https://api.github.com/repos/Vita3K/compatibility/releases/latest";
@@ -0,0 +1,193 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <compat/database.h>
+
+#include <util/log.h>
+
+#include <pugixml.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+enum LabelIdState {
+    Nothing = 1260231569, // 0x4b1d9b91
+    Bootable = 1344750319, // 0x502742ef
+    Intro = 1260231381, // 0x4B9F5E5D
+    Menu = 1344751053, // 0x4F1B9135
+    Ingame_Less = 1344752299, // 0x4F7B6B3B
+    Ingame_More = 1260231985, // 0x4B2A9819
+    Playable = 920344019, // 0x36db55d3
+};
+
+namespace compat {
+
+static constexpr uint32_t CACHE_VERSION = 1;
+
+struct CacheHeader {
+    char magic[4];
+    uint32_t cache_version;
+    uint64_t xml_hash;
+    uint32_t db_version;
+    uint32_t issue_count;
+    char updated_at[32];
+    uint64_t entry_count;
+};
+
+// The entries are read and written as they are in memory
+static_assert(sizeof(CompatDatabase::Entry) == 32);
+
+static int compare_title_id(const CompatDatabase::Entry &entry, const char *title_id) {
+    return strncmp(entry.title_id, title_id, sizeof(entry.title_id));
+}
+
+bool CompatDatabase::parse_xml(const std::vector<char> &xml, bool log_warn) {
+    clear();
+
+    pugi::xml_document doc;
+    const auto result = doc.load_buffer(xml.data(), xml.size());
+    if (!result) {
+        LOG_ERROR("Compatibility database could not be parsed: {}", result.description());
+        return false;
+    }
+
+    const auto compatibility = doc.child("compatibility");
+    info.version = compatibility.attribute("version").as_uint();
+    info.issue_count = compatibility.attribute("issue_count").as_uint();
+    info.updated_at = compatibility.attribute("db_updated_at").as_string();
+
+    for (const auto &app : compatibility) {
+        const std::string title_id = app.attribute("title_id").as_string();
+        const auto issue_id = app.child("issue_id").text().as_uint();
+
+        // Check if title ID is valid
+        if (((title_id.find("PCS") == std::string::npos) && (title_id != "NPXS10007")) || (title_id.size() >= sizeof(Entry::title_id))) {
+            LOG_WARN_IF(log_warn, "Title ID {} is invalid. Please check GitHub issue {} and verify it!", title_id, issue_id);
+            continue;
+        }
+
+        auto state = CompatibilityState::UNKNOWN;
+        for (const auto &label : app.child("labels")) {
+            const auto label_id = static_cast<LabelIdState>(label.text().as_uint());
+            switch (label_id) {
+            case LabelIdState::Nothing: state = NOTHING; break;
+            case LabelIdState::Bootable: state = BOOTABLE; break;
+            case LabelIdState::Intro: state = INTRO; break;
+            case LabelIdState::Menu: state = MENU; break;
+            case LabelIdState::Ingame_Less: state = INGAME_LESS; break;
+            case LabelIdState::Ingame_More: state = INGAME_MORE; break;
+            case LabelIdState::Playable: state = PLAYABLE; break;
+            default: break;
+            }
+        }
+        const auto updated_at = app.child("updated_at").text().as_llong();
+
+        // Check if app missing a status label
+        if (state == UNKNOWN)
+            LOG_WARN_IF(log_warn, "App with Title ID {} has an issue but no status label. Please check GitHub issue {} and request a status label be added.", title_id, issue_id);
+
+        Entry entry{};
+        memcpy(entry.title_id, title_id.data(), title_id.size());
+        entry.compat = { issue_id, state, static_cast<time_t>(updated_at) };
+        entries.push_back(entry);
+    }
+
+    // the last issue of a title ID is the one kept, like the map the database used to be
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return compare_title_id(a, b.title_id) < 0;
+    });
+    std::vector<Entry> unique_entries;
+    unique_entries.reserve(entries.size());
+    for (const auto &entry : entries) {
+        if (!unique_entries.empty() && (compare_title_id(unique_entries.back(), entry.title_id) == 0)) {
+            LOG_WARN_IF(log_warn, "App with Title ID {} already exists in compatibility database. Please check and close GitHub issue {}.", entry.title_id, unique_entries.back().compat.issue_id);
+            unique_entries.back() = entry;
+        } else
+            unique_entries.push_back(entry);
+    }
+    entries = std::move(unique_entries);
+
+    return true;
+}
+
+bool CompatDatabase::load_cache(const fs::path &path, uint64_t xml_hash) {
+    clear();
+
+    fs::ifstream cache(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!cache.is_open())
+        return false;
+    const uint64_t file_size = cache.tellg();
+    cache.seekg(0);
+
+    CacheHeader header;
+    if (!cache.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        return false;
+    if ((memcmp(header.magic, "V3KC", sizeof(header.magic)) != 0) || (header.cache_version != CACHE_VERSION) || (header.xml_hash != xml_hash))
+        return false;
+    // do not trust the entry count of a corrupted cache to size the entries
+    if (header.entry_count != (file_size - sizeof(header)) / sizeof(Entry))
+        return false;
+
+    entries.resize(header.entry_count);
+    if (!cache.read(reinterpret_cast<char *>(entries.data()), entries.size() * sizeof(Entry))) {
+        entries.clear();
+        return false;
+    }
+
+    info.version = header.db_version;
+    info.issue_count = header.issue_count;
+    info.updated_at.assign(header.updated_at, strnlen(header.updated_at, sizeof(header.updated_at)));
+    return true;
+}
+
+bool CompatDatabase::save_cache(const fs::path &path, uint64_t xml_hash) const {
+    fs::ofstream cache(path, std::ios::out | std::ios::binary);
+    if (!cache.is_open())
+        return false;
+
+    CacheHeader header{};
+    memcpy(header.magic, "V3KC", sizeof(header.magic));
+    header.cache_version = CACHE_VERSION;
+    header.xml_hash = xml_hash;
+    header.db_version = info.version;
+    header.issue_count = info.issue_count;
+    strncpy(header.updated_at, info.updated_at.c_str(), sizeof(header.updated_at) - 1);
+    header.entry_count = entries.size();
+
+    cache.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    cache.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(Entry));
+    return cache.good();
+}
+
+const Compatibility *CompatDatabase::find(const std::string &title_id) const {
+    if (title_id.size() >= sizeof(Entry::title_id))
+        return nullptr;
+
+    const auto entry = std::lower_bound(entries.begin(), entries.end(), title_id, [](const Entry &entry, const std::string &title_id) {
+        return compare_title_id(entry, title_id.c_str()) < 0;
+    });
+    if ((entry == entries.end()) || (compare_title_id(*entry, title_id.c_str()) != 0))
+        return nullptr;
+    return &entry->compat;
+}
+
+void CompatDatabase::clear() {
+    info = {};
+    entries.clear();
+}
+
+} // namespace compat
@@ -0,0 +1,172 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <compat/database.h>
+#include <testutil/benchmark.h>
+
+#include <gtest/gtest.h>
+
+using namespace compat;
+
+namespace {
+
+struct FixtureIssue {
+    std::string title_id;
+    uint32_t issue_id;
+    uint32_t label;
+    int64_t updated_at;
+};
+
+constexpr uint32_t LABEL_PLAYABLE = 920344019;
+constexpr uint32_t LABEL_MENU = 1344751053;
+constexpr uint32_t LABEL_OTHER = 123;
+
+// Same layout as the database released by the compatibility repository
+std::vector<char> make_xml(const std::vector<FixtureIssue> &issues) {
+    std::string xml = fmt::format(R"(<?xml version="1.0"?><compatibility version="1" db_updated_at="01-02-2024 03:04:05" issue_count="{}">)", issues.size());
+    for (const auto &issue : issues) {
+        xml += fmt::format(R"(<title title_id="{}"><issue_id>{}</issue_id><labels><label>{}</label><label>{}</label></labels><updated_at>{}</updated_at></title>)",
+            issue.title_id, issue.issue_id, LABEL_OTHER, issue.label, issue.updated_at);
+    }
+    xml += "</compatibility>";
+    return std::vector<char>(xml.begin(), xml.end());
+}
+
+std::vector<FixtureIssue> make_issues(uint32_t count) {
+    std::vector<FixtureIssue> issues;
+    for (uint32_t i = 0; i < count; i++) {
+        // not in title ID order, like the issue order of the released database
+        const uint32_t title = (i * 7919) % count;
+        issues.push_back({ fmt::format("PCS{}{:05}", "ABEG"[title % 4], title), i + 1, (title % 2) ? LABEL_PLAYABLE : LABEL_MENU, 1700000000 + i });
+    }
+    return issues;
+}
+
+} // namespace
+
+class CompatDatabaseTest : public testing::Test {
+protected:
+    void SetUp() override {
+        cache_path = fs::temp_directory_path() / fmt::format("vita3k-compat-test-{}.bin", testing::UnitTest::GetInstance()->random_seed());
+    }
+
+    void TearDown() override {
+        fs::remove(cache_path);
+    }
+
+    fs::path cache_path;
+};
+
+TEST_F(CompatDatabaseTest, parses_xml) {
+    const auto xml = make_xml({
+        { "PCSE00002", 2, LABEL_MENU, 200 },
+        { "PCSB00001", 1, LABEL_PLAYABLE, 100 },
+        { "NPXS10007", 3, LABEL_PLAYABLE, 300 },
+        { "NPXS10001", 4, LABEL_PLAYABLE, 400 },
+        { "PCSE00002", 5, LABEL_PLAYABLE, 500 },
+        { "PCSF00003", 6, LABEL_OTHER, 600 },
+    });
+
+    CompatDatabase db;
+    ASSERT_TRUE(db.parse_xml(xml, false));
+    ASSERT_EQ(db.get_info().version, 1);
+    ASSERT_EQ(db.get_info().issue_count, 6);
+    ASSERT_EQ(db.get_info().updated_at, "01-02-2024 03:04:05");
+
+    // system apps other than NPXS10007 are not listed
+    ASSERT_EQ(db.size(), 4);
+    ASSERT_FALSE(db.contains("NPXS10001"));
+    ASSERT_FALSE(db.contains("PCSE0000"));
+    ASSERT_FALSE(db.contains("PCSE000020"));
+
+    const auto playable = db.find("PCSB00001");
+    ASSERT_NE(playable, nullptr);
+    ASSERT_EQ(playable->issue_id, 1);
+    ASSERT_EQ(playable->state, PLAYABLE);
+    ASSERT_EQ(playable->updated_at, 100);
+
+    // the last issue of a title is kept
+    ASSERT_EQ(db.find("PCSE00002")->issue_id, 5);
+    ASSERT_EQ(db.find("NPXS10007")->state, PLAYABLE);
+    ASSERT_EQ(db.find("PCSF00003")->state, UNKNOWN);
+
+    ASSERT_FALSE(db.parse_xml({}, false));
+    ASSERT_TRUE(db.empty());
+}
+
+TEST_F(CompatDatabaseTest, cache_is_tied_to_xml_hash) {
+    const auto issues = make_issues(1000);
+    CompatDatabase db;
+    ASSERT_TRUE(db.parse_xml(make_xml(issues), false));
+    ASSERT_TRUE(db.save_cache(cache_path, 42));
+
+    CompatDatabase cached;
+    ASSERT_FALSE(cached.load_cache(cache_path, 43));
+    ASSERT_TRUE(cached.empty());
+    ASSERT_TRUE(cached.load_cache(cache_path, 42));
+    ASSERT_EQ(cached.size(), db.size());
+    ASSERT_EQ(cached.get_info().updated_at, db.get_info().updated_at);
+    ASSERT_EQ(cached.get_info().issue_count, db.get_info().issue_count);
+
+    for (const auto &issue : issues) {
+        const auto compat = cached.find(issue.title_id);
+        ASSERT_NE(compat, nullptr);
+        ASSERT_EQ(compat->issue_id, issue.issue_id);
+        ASSERT_EQ(compat->state, issue.label == LABEL_PLAYABLE ? PLAYABLE : MENU);
+        ASSERT_EQ(compat->updated_at, issue.updated_at);
+    }
+
+    // truncated cache
+    fs::resize_file(cache_path, fs::file_size(cache_path) - 1);
+    ASSERT_FALSE(cached.load_cache(cache_path, 42));
+
+    // entry count bigger than the file
+    ASSERT_TRUE(db.save_cache(cache_path, 42));
+    {
+        fs::fstream cache(cache_path, std::ios::in | std::ios::out | std::ios::binary);
+        const uint64_t entry_count = UINT64_MAX / 2;
+        // offset of entry_count in the cache header
+        cache.seekp(56);
+        cache.write(reinterpret_cast<const char *>(&entry_count), sizeof(entry_count));
+    }
+    ASSERT_FALSE(cached.load_cache(cache_path, 42));
+    ASSERT_TRUE(cached.empty());
+}
+
+BENCHMARK_TEST_F(CompatDatabaseTest, load) {
+    const auto issues = make_issues(10000);
+    const auto xml = make_xml(issues);
+
+    CompatDatabase db;
+    bool parsed = false;
+    testutil::measure("parse_xml", [&] { parsed = db.parse_xml(xml, false); });
+    ASSERT_TRUE(parsed);
+    ASSERT_TRUE(db.save_cache(cache_path, 1));
+
+    bool loaded = false;
+    testutil::measure("load_cache", [&] { loaded = db.load_cache(cache_path, 1); });
+    ASSERT_TRUE(loaded);
+
+    size_t found = 0;
+    testutil::measure("lookups", [&] {
+        for (const auto &issue : issues)
+            found += db.contains(issue.title_id);
+    });
+    ASSERT_EQ(found, issues.size());
+
+    testutil::record("xml_kb", xml.size() / 1024);
+}
@@ -79,6 +79,9 @@ enum ScreenshotFormat {
     code(int, "gpu-idx", 0, gpu_idx)                                                                    \
     code(bool, "high-accuracy", false, high_accuracy)                                                   \
     code(float, "resolution-multiplier", 1.0f, resolution_multiplier)                                   \
+    code(bool, "dynamic-resolution", false, dynamic_resolution)                                         \
+    code(int, "dynamic-resolution-min-scale", 50, dynamic_resolution_min_scale)                         \
+    code(int, "dynamic-resolution-target-fps", 60, dynamic_resolution_target_fps)                       \
     code(bool, "disable-surface-sync", true, disable_surface_sync)                                      \
     code(std::string, "screen-filter", "Bilinear", screen_filter)                                       \
     code(bool, "v-sync", true, v_sync)                                                                  \
@@ -95,6 +98,8 @@ enum ScreenshotFormat {
     code(bool, "boot-apps-full-screen", false, boot_apps_full_screen)                                   \
     code(std::string, "audio-backend", "SDL", audio_backend)                                            \
     code(int, "audio-volume", 100, audio_volume)                                                        \
+    code(bool, "audio-low-latency", false, audio_low_latency)                                           \
+    code(std::string, "audio-file-path", std::string{}, audio_file_path)                                \
     code(bool, "ngs-enable", true, ngs_enable)                                                          \
     code(std::string, "audio-drv", "auto", audio_drv)                                                   \
     code(int, "sys-button", static_cast<int>(SCE_SYSTEM_PARAM_ENTER_BUTTON_CROSS), sys_button)          \
@@ -164,9 +169,13 @@ enum ScreenshotFormat {
     code(bool, "shader-cache", true, shader_cache)                                                      \
     code(bool, "spirv-shader", false, spirv_shader)                                                     \
     code(bool, "fps-hack", false, fps_hack)                                                             \
+    code(std::string, "guest-clock-mode", "real-time", guest_clock_mode)                                \
+    code(float, "guest-clock-speed", 1.0f, guest_clock_speed)                                           \
     code(bool, "acceleration-and-gyroscope", true, tiltsens)                                            \
     code(int, "acceleration-pos", 0, tiltpos)                                                           \
     code(bool, "invert-gyro", false, invert_gyro)                                                       \
+    code(int, "input-sampling-rate", 500, input_sampling_rate)                                          \
+    code(bool, "log-input-latency", false, log_input_latency)                                           \
     code(int, "screenmode-pos", 0, screenmode_pos)                                                      \
     code(uint64_t, "current-ime-lang", 4, current_ime_lang)                                             \
     code(int, "psn-signed-in", false, psn_signed_in)                                                    \
@@ -75,6 +75,12 @@ private:
             pkg_path = rhs.pkg_path;
         if (rhs.pkg_zrif.has_value())
             pkg_zrif = rhs.pkg_zrif;
+        if (rhs.record_input_path.has_value())
+            record_input_path = rhs.record_input_path;
+        if (rhs.replay_input_path.has_value())
+            replay_input_path = rhs.replay_input_path;
+        if (rhs.frame_report_path.has_value())
+            frame_report_path = rhs.frame_report_path;
 
         if (!rhs.config_path.empty())
             config_path = rhs.config_path;
@@ -86,6 +92,7 @@ private:
         app_args = rhs.app_args;
         load_app_list = rhs.load_app_list;
         self_path = rhs.self_path;
+        hash_frames = rhs.hash_frames;
     }
 
 public:
@@ -97,6 +104,9 @@ public:
     std::optional<std::string> pkg_path;
     std::optional<std::string> pkg_zrif;
     std::optional<std::string> pup_path;
+    std::optional<std::string> record_input_path;
+    std::optional<std::string> replay_input_path;
+    std::optional<std::string> frame_report_path;
 
     // Setting not present in the YAML file
     fs::path config_path = {};
@@ -107,6 +117,7 @@ public:
     bool fullscreen = false;
     bool console = false;
     bool load_app_list = false;
+    bool hash_frames = false;
 
     fs::path get_pref_path() const {
         return fs_utils::utf8_to_path(pref_path);
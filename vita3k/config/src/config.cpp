@@ -162,12 +162,23 @@ ExitCode init_config(Config &cfg, int argc, char **argv, const Root &root_paths)
         ->default_str({})->group("Input");
     input_pkg->needs(input_zrif);
     input_zrif->needs(input_pkg);
+    auto record_input = input->add_option("--record-input", command_line.record_input_path, "Record the input of the app to the given file, use with guest-clock-mode deterministic")
+        ->default_str({})->group("Replay");
+    auto replay_input = input->add_option("--replay-input", command_line.replay_input_path, "Replay the input recorded with --record-input instead of reading the controllers, quit at its end")
+        ->default_str({})->group("Replay");
+    record_input->excludes(replay_input);
+    auto frame_report = input->add_option("--frame-report", command_line.frame_report_path, "Write the frame time statistics of the run to the given file when quitting")
+        ->default_str({})->group("Replay");
+    input->add_flag("--hash-frames", command_line.hash_frames, "Add the hash of each displayed frame to the frame report, to compare two runs with the same settings")
+        ->needs(frame_report)->group("Replay");
 
     auto config = app.add_option_group("Configuration", "Modify Vita3K's config.yml file");
     config->add_flag("--" + cfg[e_archive_log] + ",-A", command_line.archive_log, "Make a duplicate of the log file with TITLE_ID and Game ID as title")
         ->group("Logging");
     config->add_option("--" + cfg[e_backend_renderer] + ",-B", command_line.backend_renderer, "Renderer backend to use")
         ->ignore_case()->check(CLI::IsMember(std::set<std::string>{ "OpenGL", "Vulkan" }))->group("Vita Emulation");
+    config->add_option("--" + cfg[e_audio_backend], command_line.audio_backend, "Audio backend to use\nNull consumes the audio without a sound device, File also writes it to audio-file-path")
+        ->check(CLI::IsMember(std::set<std::string>{ "SDL", "Cubeb", "Null", "File" }))->group("Vita Emulation");
     config->add_flag("--" + cfg[e_color_surface_debug] + ",-C", command_line.color_surface_debug, "Save color surfaces")
         ->group("Vita Emulation");
     config->add_option("--config-location,-c", command_line.config_path, "Get a configuration file from a given location. If a filename is given, it must end with \".yml\", otherwise it will be assumed to be a directory. \nDefault loaded: <Vita3K>/config.yml \nDefaults: <Vita3K>/data/config/default.yml")
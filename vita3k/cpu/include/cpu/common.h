@@ -31,6 +31,7 @@ struct CPUState;
 struct CPUContext;
 struct CPUInterface;
 struct ThreadState;
+class JitInvalidationQueue;
 
 typedef std::function<void(CPUState &cpu, uint32_t, Address)> CallSVC;
 
@@ -42,6 +43,7 @@ typedef void *ExclusiveMonitorPtr;
 struct CPUProtocolBase {
     virtual void call_svc(CPUState &cpu, uint32_t svc, Address pc, ThreadState &thread) = 0;
     virtual Address get_watch_memory_addr(Address addr) = 0;
+    virtual JitInvalidationQueue *get_jit_invalidation_queue() = 0;
 #ifdef USE_DYNARMIC
     virtual ExclusiveMonitorPtr get_exclusive_monitor() = 0;
 #endif
@@ -48,6 +48,7 @@ CPUContext save_context(CPUState &state);
 void load_context(CPUState &state, const CPUContext &ctx);
 std::size_t get_processor_id(CPUState &state);
 void invalidate_jit_cache(CPUState &state, Address start, size_t length);
+void apply_jit_invalidations(CPUState &state);
 
 uint32_t read_fpscr(CPUState &state);
 void write_fpscr(CPUState &state, uint32_t value);
@@ -60,6 +61,7 @@ uint32_t stack_free(CPUState &state, size_t size);
 ExclusiveMonitorPtr new_exclusive_monitor(int max_num_cores);
 void free_exclusive_monitor(ExclusiveMonitorPtr monitor);
 void clear_exclusive(ExclusiveMonitorPtr monitor, std::size_t core_num);
+void clear_exclusive(CPUState &state);
 
 // Debugging helpers
 std::string disassemble(CPUState &state, uint64_t at, bool thumb, uint16_t *insn_size = nullptr);
@@ -99,4 +99,6 @@ public:
 
     std::size_t processor_id() const override;
     void invalidate_jit_cache(Address start, size_t length) override;
+    void clear_exclusive() override;
+    void halt_for_invalidation() override;
 };
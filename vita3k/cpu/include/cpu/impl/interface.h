@@ -55,6 +55,10 @@ struct CPUInterface {
     virtual CPUContext save_context() = 0;
     virtual void load_context(const CPUContext &ctx) = 0;
     virtual void invalidate_jit_cache(Address start, size_t length) = 0;
+    // Drop the reservation of the last exclusive load, including the one held by the JIT itself
+    virtual void clear_exclusive() = 0;
+    // Leave the translated code as soon as possible to apply pending invalidations, thread safe
+    virtual void halt_for_invalidation() = 0;
 
     virtual bool is_thumb_mode() = 0;
     virtual int step() = 0;
@@ -95,6 +95,8 @@ public:
     CPUContext save_context() override;
     void load_context(const CPUContext &ctx) override;
     void invalidate_jit_cache(Address start, size_t length) override;
+    void clear_exclusive() override;
+    void halt_for_invalidation() override;
 
     bool hit_breakpoint() override;
     void trigger_breakpoint() override;
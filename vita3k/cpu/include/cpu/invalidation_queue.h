@@ -0,0 +1,106 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#pragma once
+
+#include <mem/util.h> // Address.
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Guest code ranges to invalidate, shared by the JITs of all the threads
+ *
+ * Ranges are posted from any thread and stamped with an increasing epoch. Each JIT is a consumer
+ * which collects the ranges posted since the epoch it last applied and invalidates them itself at its
+ * next dispatch boundary, a running JIT is kicked out of its translated code to reach one.
+ * Overlapping and adjacent ranges are merged, so the many small patches of a module load
+ * cost a single invalidation per JIT.
+ */
+class JitInvalidationQueue {
+public:
+    using Epoch = uint64_t;
+
+    struct Range {
+        Address start;
+        uint64_t end; // exclusive, a range can end at the top of the address space
+
+        bool operator==(const Range &) const = default;
+    };
+
+    class Consumer {
+        friend class JitInvalidationQueue;
+
+        // makes the JIT of the consumer reach a dispatch boundary, called from the posting thread
+        std::function<void()> kick;
+        Epoch applied = 0;
+    };
+
+    /**
+     * @brief Register a consumer, it has nothing pending until the next post
+     *
+     * The consumer must be detached before being destroyed.
+     */
+    void attach(Consumer &consumer, std::function<void()> &&kick);
+    void detach(Consumer &consumer);
+
+    /**
+     * @brief Invalidate a guest range in every attached JIT
+     *
+     * The code must be written before posting. Every consumer applies the range before
+     * running any guest code again.
+     * @return The epoch of the range
+     */
+    Epoch post(Address start, size_t length);
+
+    // Cheap check done by a consumer at each dispatch boundary
+    bool is_pending(const Consumer &consumer) const {
+        return epoch.load(std::memory_order_acquire) != consumer.applied;
+    }
+
+    /**
+     * @brief Take the ranges posted since the last collect of consumer
+     *
+     * Must only be called from the thread of the consumer.
+     * @return The ranges, merged and sorted by address
+     */
+    std::vector<Range> collect(Consumer &consumer);
+
+    Epoch get_epoch() const {
+        return epoch.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Entry {
+        Epoch epoch;
+        Range range;
+    };
+
+    Epoch get_min_applied() const;
+    void prune();
+
+    mutable std::mutex mutex;
+    std::atomic<Epoch> epoch = 0;
+    // sorted by epoch, entries every consumer applied are dropped
+    std::deque<Entry> entries;
+    std::vector<Consumer *> consumers;
+};
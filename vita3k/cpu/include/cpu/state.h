@@ -19,6 +19,7 @@
 
 #include <cpu/common.h>
 #include <cpu/disasm/state.h>
+#include <cpu/invalidation_queue.h>
 #include <mem/block.h>
 #include <mem/state.h>
 #include <util/types.h>
@@ -35,6 +36,8 @@ struct CPUState {
     Address halt_instruction_pc; // thumb mode pc
 
     CPUInterfacePtr cpu;
+    JitInvalidationQueue *invalidation_queue = nullptr;
+    JitInvalidationQueue::Consumer invalidation;
     bool svc_called;
     uint32_t svc;
 };
@@ -32,6 +32,9 @@
 #include <string>
 
 static void delete_cpu_state(CPUState *state) {
+    // the queue can kick the cpu until it is detached
+    if (state->invalidation_queue)
+        state->invalidation_queue->detach(state->invalidation);
     delete state;
 }
 
@@ -79,14 +82,22 @@ CPUStatePtr init_cpu(CPUBackend backend, bool cpu_opt, bool cpu_unsafe, SceUID t
         return nullptr;
     }
 
+    state->invalidation_queue = protocol->get_jit_invalidation_queue();
+    if (state->invalidation_queue) {
+        CPUInterface *cpu = state->cpu.get();
+        state->invalidation_queue->attach(state->invalidation, [cpu] { cpu->halt_for_invalidation(); });
+    }
+
     return state;
 }
 
 int run(CPUState &state) {
+    apply_jit_invalidations(state);
     return state.cpu->run();
 }
 
 int step(CPUState &state) {
+    apply_jit_invalidations(state);
     return state.cpu->step();
 }
 
@@ -194,6 +205,18 @@ void invalidate_jit_cache(CPUState &state, Address start, size_t length) {
     state.cpu->invalidate_jit_cache(start, length);
 }
 
+void clear_exclusive(CPUState &state) {
+    state.cpu->clear_exclusive();
+}
+
+void apply_jit_invalidations(CPUState &state) {
+    if (!state.invalidation_queue || !state.invalidation_queue->is_pending(state.invalidation))
+        return;
+
+    for (const auto &range : state.invalidation_queue->collect(state.invalidation))
+        state.cpu->invalidate_jit_cache(range.start, static_cast<size_t>(range.end - range.start));
+}
+
 std::string disassemble(CPUState &state, uint64_t at, bool thumb, uint16_t *insn_size) {
     MemState &mem = *state.mem;
     const uint8_t *const code = Ptr<const uint8_t>(static_cast<Address>(at)).get(mem);
@@ -306,12 +306,16 @@ std::unique_ptr<Dynarmic::A32::Jit> DynarmicCPU::make_jit() {
         config.detect_misaligned_access_via_page_table = 8 | 16 | 32 | 64 | 128;
         config.only_detect_misalignment_via_page_table_on_page_boundary = true;
     }
-    if (!log_mem && cpu_opt) {
+    const bool use_fastmem = !log_mem && cpu_opt;
+    if (use_fastmem) {
         config.fastmem_pointer = std::bit_cast<uintptr_t>(parent->mem->memory.get());
     }
     config.optimizations = cpu_opt ? Dynarmic::all_safe_optimizations : Dynarmic::no_optimizations;  
-    config.fastmem_exclusive_access = false; // if this and below set true native buffer works but only 1-3 fps, weird
-    config.recompile_on_exclusive_fastmem_failure = false; // this one
+    // Guest atomics (LDREX/STREX) are only emitted inline without the global monitor (unsafe cpu optimizations):
+    // there is a monitor slot per guest thread and every inline store would have to clear all of them.
+    // An exclusive access faulting on a protected page goes through the callbacks for this time only
+    config.fastmem_exclusive_access = use_fastmem && cpu_unsafe;
+    config.recompile_on_exclusive_fastmem_failure = false;
     config.hook_hint_instructions = true;
     config.global_monitor = monitor;
     config.coprocessors[15] = cp15;
@@ -351,6 +355,8 @@ int DynarmicCPU::run() {
     parent->svc_called = false;
     Dynarmic::HaltReason halt_reason;
     do {
+        // the queue halts the jit with CacheInvalidation when another thread posted a range
+        apply_jit_invalidations(*parent);
         halt_reason = jit->Run();
     } while (halt_reason == Dynarmic::HaltReason::Step || halt_reason == Dynarmic::HaltReason::CacheInvalidation);
     return halted;
@@ -501,6 +507,14 @@ void DynarmicCPU::invalidate_jit_cache(Address start, size_t length) {
     jit->InvalidateCacheRange(start, length);
 }
 
+void DynarmicCPU::clear_exclusive() {
+    jit->ClearExclusiveState();
+}
+
+void DynarmicCPU::halt_for_invalidation() {
+    jit->HaltExecution(Dynarmic::HaltReason::CacheInvalidation);
+}
+
 // TODO: proper abstraction
 ExclusiveMonitorPtr new_exclusive_monitor(int max_num_cores) {
     return new Dynarmic::ExclusiveMonitor(max_num_cores);
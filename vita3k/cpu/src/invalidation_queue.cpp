@@ -0,0 +1,108 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#include <cpu/invalidation_queue.h>
+
+#include <algorithm>
+
+void JitInvalidationQueue::attach(Consumer &consumer, std::function<void()> &&kick) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    consumer.kick = std::move(kick);
+    // a new JIT has nothing translated yet
+    consumer.applied = epoch.load(std::memory_order_relaxed);
+    consumers.push_back(&consumer);
+}
+
+void JitInvalidationQueue::detach(Consumer &consumer) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    std::erase(consumers, &consumer);
+    consumer.kick = nullptr;
+    prune();
+}
+
+JitInvalidationQueue::Epoch JitInvalidationQueue::post(Address start, size_t length) {
+    if (length == 0)
+        return get_epoch();
+
+    const Range range = { start, static_cast<uint64_t>(start) + length };
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    const Epoch last_epoch = epoch.load(std::memory_order_relaxed);
+    const Epoch new_epoch = last_epoch + 1;
+
+    if (!consumers.empty()) {
+        // the last entry can still grow as long as no consumer collected it
+        Entry *last = entries.empty() ? nullptr : &entries.back();
+        const auto collected = [&](const Consumer *consumer) { return consumer->applied >= last->epoch; };
+        if (last && std::none_of(consumers.begin(), consumers.end(), collected)
+            && std::max<uint64_t>(last->range.start, range.start) <= std::min(last->range.end, range.end)) {
+            last->range.start = std::min(last->range.start, range.start);
+            last->range.end = std::max(last->range.end, range.end);
+            last->epoch = new_epoch;
+        } else {
+            entries.push_back({ new_epoch, range });
+        }
+    }
+
+    epoch.store(new_epoch, std::memory_order_release);
+
+    // consumers with something pending were already kicked and have not reached a boundary yet
+    for (Consumer *consumer : consumers) {
+        if (consumer->applied == last_epoch)
+            consumer->kick();
+    }
+
+    return new_epoch;
+}
+
+std::vector<JitInvalidationQueue::Range> JitInvalidationQueue::collect(Consumer &consumer) {
+    std::vector<Range> ranges;
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = entries.rbegin(); it != entries.rend() && it->epoch > consumer.applied; ++it)
+        ranges.push_back(it->range);
+    consumer.applied = epoch.load(std::memory_order_relaxed);
+    prune();
+
+    if (ranges.size() > 1) {
+        std::sort(ranges.begin(), ranges.end(), [](const Range &a, const Range &b) { return a.start < b.start; });
+        size_t last = 0;
+        for (size_t i = 1; i < ranges.size(); i++) {
+            if (ranges[i].start <= ranges[last].end)
+                ranges[last].end = std::max(ranges[last].end, ranges[i].end);
+            else
+                ranges[++last] = ranges[i];
+        }
+        ranges.resize(last + 1);
+    }
+
+    return ranges;
+}
+
+JitInvalidationQueue::Epoch JitInvalidationQueue::get_min_applied() const {
+    Epoch min_applied = epoch.load(std::memory_order_relaxed);
+    for (const Consumer *consumer : consumers)
+        min_applied = std::min(min_applied, consumer->applied);
+    return min_applied;
+}
+
+void JitInvalidationQueue::prune() {
+    const Epoch min_applied = get_min_applied();
+    while (!entries.empty() && entries.front().epoch <= min_applied)
+        entries.pop_front();
+}
@@ -392,6 +392,15 @@ void UnicornCPU::invalidate_jit_cache(Address start, size_t length) {
     uc_ctl_remove_cache(uc.get(), start, start + length);
 }
 
+void UnicornCPU::clear_exclusive() {
+    // unicorn gives no access to its reservation
+}
+
+void UnicornCPU::halt_for_invalidation() {
+    // the kernel runs the cpu again when it stops without a svc, the ranges are applied then
+    stop();
+}
+
 bool UnicornCPU::hit_breakpoint() {
     return did_break;
 }
@@ -0,0 +1,152 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <cpu/functions.h>
+#include <cpu/state.h>
+#include <mem/functions.h>
+#include <mem/ptr.h>
+#include <mem/state.h>
+#include <testutil/benchmark.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int MAX_CORE_COUNT = 16;
+
+// loop:
+//   ldrex r2, [r0]
+//   add r2, r2, #1
+//   strex r3, r2, [r0]
+//   cmp r3, #0
+//   bne loop
+//   subs r1, r1, #1
+//   bne loop
+//   svc #0
+constexpr uint32_t ATOMIC_INCREMENT_CODE[] = {
+    0xE1902F9F,
+    0xE2822001,
+    0xE1803F92,
+    0xE3530000,
+    0x1AFFFFFA,
+    0xE2511001,
+    0x1AFFFFF8,
+    0xEF000000,
+};
+
+struct TestProtocol : CPUProtocolBase {
+    ExclusiveMonitorPtr monitor = new_exclusive_monitor(MAX_CORE_COUNT);
+
+    ~TestProtocol() override {
+        free_exclusive_monitor(monitor);
+    }
+
+    void call_svc(CPUState &cpu, uint32_t svc, Address pc, ThreadState &thread) override {}
+
+    Address get_watch_memory_addr(Address addr) override {
+        return addr;
+    }
+
+    JitInvalidationQueue *get_jit_invalidation_queue() override {
+        return nullptr;
+    }
+
+    ExclusiveMonitorPtr get_exclusive_monitor() override {
+        return monitor;
+    }
+};
+
+MemState &get_test_mem() {
+    // the access violation handler is process wide, keep a single memory state for all the tests
+    static MemState mem;
+    static const bool initialized = init(mem, false);
+    EXPECT_TRUE(initialized);
+    return mem;
+}
+
+// Each guest thread increments the same word with LDREX/STREX, return the time taken by all of them
+std::chrono::steady_clock::duration run_atomic_increment(bool cpu_opt, bool cpu_unsafe, int thread_count, uint32_t increments) {
+    MemState &mem = get_test_mem();
+    TestProtocol protocol;
+
+    const Address code = alloc(mem, sizeof(ATOMIC_INCREMENT_CODE), "atomic increment code");
+    memcpy(Ptr<uint32_t>(code).get(mem), ATOMIC_INCREMENT_CODE, sizeof(ATOMIC_INCREMENT_CODE));
+    const Address counter = alloc(mem, sizeof(uint32_t), "atomic increment counter");
+    *Ptr<uint32_t>(counter).get(mem) = 0;
+
+    std::vector<CPUStatePtr> cpus;
+    for (int i = 0; i < thread_count; i++) {
+        auto cpu = init_cpu(CPUBackend::Dynarmic, cpu_opt, cpu_unsafe, i + 1, i, mem, &protocol);
+        EXPECT_TRUE(cpu);
+        write_reg(*cpu, 0, counter);
+        write_reg(*cpu, 1, increments);
+        write_pc(*cpu, code);
+        cpus.push_back(std::move(cpu));
+    }
+
+    const auto elapsed = testutil::elapsed([&] {
+        std::vector<std::thread> threads;
+        for (auto &cpu : cpus) {
+            threads.emplace_back([&cpu] {
+                run(*cpu);
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+    });
+
+    for (auto &cpu : cpus)
+        EXPECT_TRUE(cpu->svc_called);
+    EXPECT_EQ(*Ptr<uint32_t>(counter).get(mem), thread_count * increments);
+
+    cpus.clear();
+    free(mem, counter);
+    free(mem, code);
+    return elapsed;
+}
+
+} // namespace
+
+TEST(cpu_exclusive, fastmem_atomic_increment_is_exact) {
+    run_atomic_increment(true, false, 4, 20000);
+}
+
+TEST(cpu_exclusive, unsafe_inline_atomic_increment_is_exact) {
+    run_atomic_increment(true, true, 4, 20000);
+}
+
+TEST(cpu_exclusive, callback_atomic_increment_is_exact) {
+    run_atomic_increment(false, false, 4, 20000);
+}
+
+BENCHMARK_TEST(cpu_exclusive, atomic_increment) {
+    constexpr uint32_t INCREMENTS = 1'000'000;
+    for (const int thread_count : { 1, 2, 4, 8 }) {
+        // without unsafe optimizations the exclusive accesses go through the callbacks and the global monitor,
+        // with them they are emitted inline on fastmem
+        const auto callbacks = run_atomic_increment(true, false, thread_count, INCREMENTS);
+        const auto inline_access = run_atomic_increment(true, true, thread_count, INCREMENTS);
+        testutil::record_time<std::chrono::milliseconds>("callbacks_" + std::to_string(thread_count) + "_threads", callbacks);
+        testutil::record_time<std::chrono::milliseconds>("inline_" + std::to_string(thread_count) + "_threads", inline_access);
+    }
+}
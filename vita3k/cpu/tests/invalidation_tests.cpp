@@ -0,0 +1,248 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#include <cpu/functions.h>
+#include <cpu/invalidation_queue.h>
+#include <cpu/state.h>
+#include <mem/functions.h>
+#include <mem/ptr.h>
+#include <mem/state.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Range = JitInvalidationQueue::Range;
+
+constexpr uint32_t encode_movw_r0(uint16_t imm) {
+    return 0xE3000000 | ((imm >> 12) << 16) | (imm & 0xFFF);
+}
+
+// movw r0, #generation (patched)
+// svc #0
+constexpr uint32_t PATCHED_CODE[] = {
+    encode_movw_r0(0),
+    0xEF000000,
+};
+
+struct TestProtocol : CPUProtocolBase {
+    ExclusiveMonitorPtr monitor = new_exclusive_monitor(16);
+    JitInvalidationQueue queue;
+
+    ~TestProtocol() override {
+        free_exclusive_monitor(monitor);
+    }
+
+    void call_svc(CPUState &cpu, uint32_t svc, Address pc, ThreadState &thread) override {}
+
+    Address get_watch_memory_addr(Address addr) override {
+        return addr;
+    }
+
+    JitInvalidationQueue *get_jit_invalidation_queue() override {
+        return &queue;
+    }
+
+    ExclusiveMonitorPtr get_exclusive_monitor() override {
+        return monitor;
+    }
+};
+
+MemState &get_test_mem() {
+    // the access violation handler is process wide, keep a single memory state for all the tests
+    static MemState mem;
+    static const bool initialized = init(mem, false);
+    EXPECT_TRUE(initialized);
+    return mem;
+}
+
+} // namespace
+
+TEST(jit_invalidation_queue, merges_ranges_and_kicks_once) {
+    JitInvalidationQueue queue;
+    JitInvalidationQueue::Consumer consumer;
+    int kicks = 0;
+    queue.attach(consumer, [&] { kicks++; });
+    ASSERT_FALSE(queue.is_pending(consumer));
+
+    // the stubs patched by a module load
+    queue.post(0x81000000, 12);
+    queue.post(0x8100000C, 12);
+    queue.post(0x81000004, 4);
+    queue.post(0x82000000, 4);
+    queue.post(0x81FFFFFE, 4);
+    queue.post(0x90000000, 0);
+    ASSERT_EQ(kicks, 1);
+    ASSERT_TRUE(queue.is_pending(consumer));
+
+    const std::vector<Range> expected = { { 0x81000000, 0x81000018 }, { 0x81FFFFFE, 0x82000004 } };
+    ASSERT_EQ(queue.collect(consumer), expected);
+    ASSERT_FALSE(queue.is_pending(consumer));
+    ASSERT_TRUE(queue.collect(consumer).empty());
+
+    // the end of the address space does not wrap around
+    queue.post(0xFFFFFFF0, 16);
+    ASSERT_EQ(kicks, 2);
+    ASSERT_EQ(queue.collect(consumer), (std::vector<Range>{ { 0xFFFFFFF0, 0x100000000 } }));
+
+    queue.detach(consumer);
+}
+
+TEST(jit_invalidation_queue, every_consumer_applies_every_range) {
+    JitInvalidationQueue queue;
+    JitInvalidationQueue::Consumer first, second;
+    int first_kicks = 0, second_kicks = 0;
+    queue.attach(first, [&] { first_kicks++; });
+    queue.attach(second, [&] { second_kicks++; });
+
+    queue.post(0x1000, 4);
+    ASSERT_EQ(queue.collect(first), (std::vector<Range>{ { 0x1000, 0x1004 } }));
+
+    // collected by the first consumer, the range can no longer grow
+    queue.post(0x1004, 4);
+    ASSERT_EQ(first_kicks, 2);
+    ASSERT_EQ(second_kicks, 1);
+    ASSERT_EQ(queue.collect(first), (std::vector<Range>{ { 0x1004, 0x1008 } }));
+    ASSERT_EQ(queue.collect(second), (std::vector<Range>{ { 0x1000, 0x1008 } }));
+
+    // a new jit has nothing translated yet
+    queue.post(0x2000, 4);
+    JitInvalidationQueue::Consumer late;
+    queue.attach(late, [] {});
+    ASSERT_FALSE(queue.is_pending(late));
+
+    queue.detach(late);
+    queue.detach(second);
+    queue.detach(first);
+}
+
+TEST(jit_invalidation_queue, concurrent_posts_reach_every_consumer) {
+    constexpr int CONSUMER_COUNT = 4;
+    constexpr int PATCH_COUNT = 20000;
+    constexpr Address CODE_SIZE = 256;
+
+    // the guest code, one version per word, and the posted version the consumers must not be behind of
+    std::vector<std::atomic<uint32_t>> code(CODE_SIZE);
+    std::atomic<uint32_t> published = 0;
+    std::atomic<bool> done = false;
+    std::atomic<int> stale = 0;
+    JitInvalidationQueue queue;
+
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < CONSUMER_COUNT; i++) {
+        consumers.emplace_back([&, i] {
+            JitInvalidationQueue::Consumer consumer;
+            queue.attach(consumer, [] {});
+
+            // word address -> version translated from it
+            std::unordered_map<Address, uint32_t> translated;
+            std::mt19937 rng(i);
+            while (!done) {
+                // dispatch boundary
+                const uint32_t version = published.load(std::memory_order_acquire);
+                if (queue.is_pending(consumer)) {
+                    for (const auto &range : queue.collect(consumer)) {
+                        for (uint64_t address = range.start; address < range.end; address++)
+                            translated.erase(static_cast<Address>(address));
+                    }
+                }
+
+                // run some blocks, the last patched word must be at least at the published version
+                for (int j = 0; j < 16; j++) {
+                    const Address address = rng() % CODE_SIZE;
+                    if (!translated.contains(address))
+                        translated[address] = code[address].load(std::memory_order_relaxed);
+                }
+                const Address last_patched = version % CODE_SIZE;
+                if (version && translated.contains(last_patched) && translated[last_patched] < version)
+                    stale++;
+            }
+
+            queue.detach(consumer);
+        });
+    }
+
+    std::mt19937 rng(42);
+    for (uint32_t version = 1; version <= PATCH_COUNT; version++) {
+        const Address address = version % CODE_SIZE;
+        code[address].store(version, std::memory_order_relaxed);
+        // sometimes patch a wider range around it, like a module being relocated
+        const Address length = (rng() % 8 == 0) ? std::min<Address>(rng() % 32, CODE_SIZE - address) : 1;
+        queue.post(address, std::max<Address>(length, 1));
+        published.store(version, std::memory_order_release);
+        if (version % 64 == 0)
+            std::this_thread::yield();
+    }
+    done = true;
+    for (auto &consumer : consumers)
+        consumer.join();
+
+    ASSERT_EQ(stale, 0);
+}
+
+TEST(jit_invalidation_queue, cross_thread_code_patching) {
+    constexpr int THREAD_COUNT = 4;
+    constexpr uint16_t GENERATION_COUNT = 2000;
+    MemState &mem = get_test_mem();
+    TestProtocol protocol;
+
+    const Address code = alloc(mem, sizeof(PATCHED_CODE), "patched code");
+    uint32_t *const code_ptr = Ptr<uint32_t>(code).get(mem);
+    memcpy(code_ptr, PATCHED_CODE, sizeof(PATCHED_CODE));
+
+    std::atomic<uint16_t> published = 0;
+    std::atomic<int> stale = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREAD_COUNT; i++) {
+        threads.emplace_back([&, i] {
+            auto cpu = init_cpu(CPUBackend::Dynarmic, true, false, i + 1, i, mem, &protocol);
+            ASSERT_TRUE(cpu);
+
+            // the code translated by this thread is patched by the main thread while it runs
+            uint16_t generation;
+            do {
+                generation = published.load(std::memory_order_acquire);
+                write_pc(*cpu, code);
+                run(*cpu);
+                ASSERT_TRUE(cpu->svc_called);
+                if (read_reg(*cpu, 0) < generation)
+                    stale++;
+            } while (read_reg(*cpu, 0) != GENERATION_COUNT);
+        });
+    }
+
+    for (uint16_t generation = 1; generation <= GENERATION_COUNT; generation++) {
+        code_ptr[0] = encode_movw_r0(generation);
+        protocol.queue.post(code, sizeof(uint32_t));
+        published.store(generation, std::memory_order_release);
+        if (generation % 64 == 0)
+            std::this_thread::yield();
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    ASSERT_EQ(stale, 0);
+    free(mem, code);
+}
@@ -25,3 +25,7 @@ std::array<ControllerBinding, 15> get_controller_bindings_ext(EmuEnvState &emuen
 SceCtrlExternalInputMode get_type_of_controller(const int idx);
 int ctrl_get(const SceUID thread_id, EmuEnvState &emuenv, int port, SceCtrlData2 *pData, SceUInt32 count, bool negative, bool is_peek, bool is_v2, bool from_ext);
 void refresh_controllers(CtrlState &state, EmuEnvState &emuenv);
+// Read the pad state from SDL and buffer it, at most input-sampling-rate times per second. Must be called from the main thread
+void poll_ctrl(EmuEnvState &emuenv);
+// Record the pad state of vsync vcount while recording input, called before vcount is visible to the guest
+void ctrl_vsync_update(EmuEnvState &emuenv, uint64_t vcount);
@@ -23,6 +23,7 @@
 #include <SDL_haptic.h>
 #include <SDL_joystick.h>
 
+#include <array>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -53,6 +54,28 @@ struct SDL_JoystickGUIDComparator {
 
 typedef std::map<SDL_JoystickGUID, Controller, SDL_JoystickGUIDComparator> ControllerList;
 
+// Pad state polled by the main thread, before the input mode and the negative logic are applied
+struct CtrlSample {
+    uint64_t timestamp;
+    // buttons with the sceCtrl*Buffer mapping
+    uint32_t buttons;
+    // buttons with the sceCtrl*Buffer2 and sceCtrl*BufferExt mapping (L1/R1/L2/R2/L3/R3)
+    uint32_t buttons_ext;
+    uint8_t lx;
+    uint8_t ly;
+    uint8_t rx;
+    uint8_t ry;
+};
+
+// enough to hold one second of samples at the maximum sampling rate
+constexpr size_t CTRL_SAMPLE_BUFFER_SIZE = 1024;
+
+struct CtrlSampleBuffer {
+    std::array<CtrlSample, CTRL_SAMPLE_BUFFER_SIZE> samples;
+    // total number of samples written, the last one is at (count - 1) % CTRL_SAMPLE_BUFFER_SIZE
+    uint64_t count = 0;
+};
+
 struct CtrlState {
     std::mutex mutex;
     ControllerList controllers;
@@ -66,4 +89,15 @@ struct CtrlState {
 
     // last vsync the data was read
     uint64_t last_vcount[5] = {};
+
+    // last pad state of ports 1 to 4 polled from SDL by the main thread
+    std::array<CtrlSample, SCE_CTRL_MAX_WIRELESS_NUM> polled_samples = {};
+
+    // pad state history of ports 1 to 4, at most input-sampling-rate samples per second
+    std::array<CtrlSampleBuffer, SCE_CTRL_MAX_WIRELESS_NUM> sample_buffers;
+
+    // time between the polling and the guest read, only measured with log-input-latency
+    uint64_t latency_total = 0;
+    uint64_t latency_max = 0;
+    uint32_t latency_reads = 0;
 };
@@ -24,9 +24,13 @@
 #include <display/functions.h>
 #include <display/state.h>
 #include <kernel/state.h>
+#include <replay/functions.h>
+#include <rtc/clock.h>
+#include <util/log.h>
 
 #include <SDL_keyboard.h>
 
+#include <algorithm>
 #include <array>
 
 #ifdef ANDROID
@@ -381,6 +385,182 @@ static void retrieve_ctrl_data(EmuEnvState &emuenv, int port, bool is_v2, bool n
         buttons ^= ~0;
 }
 
+static uint64_t get_timestamp() {
+    return get_guest_clock().now();
+}
+
+// Pad state of port, with both button mappings, ctrl mutex must be held
+static CtrlSample get_ctrl_sample(EmuEnvState &emuenv, int port) {
+    CtrlState &state = emuenv.ctrl;
+    CtrlSample sample{};
+
+    // both button mappings are kept, the axes are the same for both
+    std::array<float, 4> axes;
+    std::array<float, 4> axes_ext;
+    axes.fill(0);
+    axes_ext.fill(0);
+
+    if (port == 1) {
+        apply_keyboard(&sample.buttons, axes.data(), false, emuenv);
+        apply_keyboard(&sample.buttons_ext, axes_ext.data(), true, emuenv);
+    }
+    for (const auto &[_, controller] : state.controllers) {
+        if (controller.port == port) {
+            apply_controller(emuenv, &sample.buttons, axes.data(), controller.controller.get(), false);
+            apply_controller(emuenv, &sample.buttons_ext, axes_ext.data(), controller.controller.get(), true);
+        }
+    }
+
+    sample.lx = float_to_byte(axes[0]);
+    sample.ly = float_to_byte(axes[1]);
+    sample.rx = float_to_byte(axes[2]);
+    sample.ry = float_to_byte(axes[3]);
+    return sample;
+}
+
+void poll_ctrl(EmuEnvState &emuenv) {
+    CtrlState &state = emuenv.ctrl;
+    // samples are stamped when SDL is read, so the guest sees how old the state really is
+    const uint64_t timestamp = get_timestamp();
+    const bool buffered = emuenv.cfg.input_sampling_rate > 0;
+    const uint64_t period = buffered ? 1000000 / std::clamp(emuenv.cfg.input_sampling_rate, 60, 1000) : 0;
+
+    std::lock_guard<std::mutex> guard(state.mutex);
+    for (int port = 1; port <= SCE_CTRL_MAX_WIRELESS_NUM; port++) {
+        CtrlSample sample = get_ctrl_sample(emuenv, port);
+        sample.timestamp = timestamp;
+        state.polled_samples[port - 1] = sample;
+
+        // polls closer than the sampling period are dropped, so that the buffer always holds one second of input
+        CtrlSampleBuffer &buffer = state.sample_buffers[port - 1];
+        if (!buffered || (buffer.count > 0 && timestamp - buffer.samples[(buffer.count - 1) % CTRL_SAMPLE_BUFFER_SIZE].timestamp < period))
+            continue;
+
+        buffer.samples[buffer.count % CTRL_SAMPLE_BUFFER_SIZE] = sample;
+        buffer.count++;
+    }
+}
+
+static void record_latency(CtrlState &state, uint64_t latency) {
+    state.latency_total += latency;
+    state.latency_max = std::max(state.latency_max, latency);
+    if (++state.latency_reads < 1000)
+        return;
+
+    LOG_INFO("Input latency over {} reads: average {} us, max {} us", state.latency_reads, state.latency_total / state.latency_reads, state.latency_max);
+    state.latency_total = 0;
+    state.latency_max = 0;
+    state.latency_reads = 0;
+}
+
+// Apply the input mode, the negative logic and the common dialog to a sample
+static void fill_ctrl_data(SceCtrlData2 &data, const CtrlSample &sample, SceCtrlPadInputMode mode, bool dialog_running, bool negative, bool is_v2) {
+    data.buttons = dialog_running ? 0 : (is_v2 ? sample.buttons_ext : sample.buttons);
+    if (negative)
+        data.buttons ^= ~0;
+
+    if (mode == SCE_CTRL_MODE_DIGITAL) {
+        data.lx = 0x80;
+        data.ly = 0x80;
+        data.rx = 0x80;
+        data.ry = 0x80;
+    } else if (dialog_running) {
+        data.lx = data.ly = data.rx = data.ry = float_to_byte(0);
+    } else {
+        data.lx = sample.lx;
+        data.ly = sample.ly;
+        data.rx = sample.rx;
+        data.ry = sample.ry;
+    }
+}
+
+// Fill pData with the pad state at each of the last nb_returned_data vsyncs, the most recent first
+static bool read_ctrl_samples(EmuEnvState &emuenv, int port, SceCtrlData2 *pData, int nb_returned_data, bool negative, bool is_v2, bool from_ext) {
+    if (port == 0) {
+        port++;
+    }
+    CtrlState &state = emuenv.ctrl;
+    const bool dialog_running = emuenv.common_dialog.status == SCE_COMMON_DIALOG_STATUS_RUNNING;
+    const uint64_t now = get_timestamp();
+
+    std::lock_guard<std::mutex> guard(state.mutex);
+    const CtrlSampleBuffer &buffer = state.sample_buffers[port - 1];
+    if (buffer.count == 0)
+        return false;
+
+    const SceCtrlPadInputMode mode = from_ext ? state.input_mode_ext : state.input_mode;
+    const uint64_t oldest = buffer.count > CTRL_SAMPLE_BUFFER_SIZE ? buffer.count - CTRL_SAMPLE_BUFFER_SIZE : 0;
+
+    // index of the sample following the one being returned
+    uint64_t next = buffer.count;
+    for (int i = 0; i < nb_returned_data; i++) {
+        // 1 vsync = 1/60 sec = 16 667 us
+        const uint64_t target = now - i * 16667ULL;
+        while (next > oldest + 1 && buffer.samples[(next - 1) % CTRL_SAMPLE_BUFFER_SIZE].timestamp > target)
+            next--;
+
+        const CtrlSample &sample = buffer.samples[(next - 1) % CTRL_SAMPLE_BUFFER_SIZE];
+        SceCtrlData2 &data = pData[i];
+
+        data.timeStamp = sample.timestamp;
+        // keep the timestamps strictly decreasing when the same sample is returned several times
+        if (i > 0)
+            data.timeStamp = std::min(data.timeStamp, pData[i - 1].timeStamp - 1);
+
+        fill_ctrl_data(data, sample, mode, dialog_running, negative, is_v2);
+    }
+
+    if (emuenv.cfg.log_input_latency)
+        record_latency(state, now - pData[0].timeStamp);
+
+    return true;
+}
+
+// Same as read_ctrl_samples with the pad state recorded on each vsync, while recording or replaying input
+static void read_replay_samples(EmuEnvState &emuenv, int port, SceCtrlData2 *pData, int nb_returned_data, bool negative, bool is_v2, bool from_ext) {
+    if (port == 0) {
+        port++;
+    }
+    CtrlState &state = emuenv.ctrl;
+    const bool dialog_running = emuenv.common_dialog.status == SCE_COMMON_DIALOG_STATUS_RUNNING;
+    const SceCtrlPadInputMode mode = from_ext ? state.input_mode_ext : state.input_mode;
+    const uint64_t vcount = emuenv.display.vblank_count.load();
+    const uint64_t now = get_timestamp();
+
+    for (int i = 0; i < nb_returned_data; i++) {
+        const replay::PadInput pad = get_replay_pad(emuenv.replay, vcount >= static_cast<uint64_t>(i) ? vcount - i : 0, port - 1);
+        CtrlSample sample{};
+        sample.buttons = pad.buttons;
+        sample.buttons_ext = pad.buttons_ext;
+        sample.lx = pad.lx;
+        sample.ly = pad.ly;
+        sample.rx = pad.rx;
+        sample.ry = pad.ry;
+
+        // 1 vsync = 1/60 sec = 16 667 us
+        pData[i].timeStamp = now - i * 16667ULL;
+        fill_ctrl_data(pData[i], sample, mode, dialog_running, negative, is_v2);
+    }
+}
+
+void ctrl_vsync_update(EmuEnvState &emuenv, uint64_t vcount) {
+    if (emuenv.replay.mode != ReplayMode::Record)
+        return;
+
+    std::lock_guard<std::mutex> guard(emuenv.ctrl.mutex);
+    for (int port = 1; port <= SCE_CTRL_MAX_WIRELESS_NUM; port++) {
+        const CtrlSample &sample = emuenv.ctrl.polled_samples[port - 1];
+        replay::PadInput pad;
+        pad.buttons = sample.buttons;
+        pad.buttons_ext = sample.buttons_ext;
+        pad.lx = sample.lx;
+        pad.ly = sample.ly;
+        pad.rx = sample.rx;
+        pad.ry = sample.ry;
+        record_pad(emuenv.replay, vcount, port - 1, pad);
+    }
+}
+
 int ctrl_get(const SceUID thread_id, EmuEnvState &emuenv, int port, SceCtrlData2 *pData, SceUInt32 count, bool negative, bool is_peek, bool is_v2, bool from_ext) {
     if (port > 1 && !emuenv.cfg.current_config.pstv_mode) {
         const char *export_name = "sceCtrl*Buffer*";
@@ -406,9 +586,15 @@ int ctrl_get(const SceUID thread_id, EmuEnvState &emuenv, int port, SceCtrlData2
         state.last_vcount[port] = vblank_count;
     }
 
-    std::chrono::time_point<std::chrono::steady_clock> ts = std::chrono::steady_clock::now();
-    uint64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(ts.time_since_epoch()).count();
-    pData->timeStamp = timestamp;
+    if (emuenv.replay.mode != ReplayMode::Off) {
+        read_replay_samples(emuenv, port, pData, nb_returned_data, negative, is_v2, from_ext);
+        return nb_returned_data;
+    }
+
+    if (emuenv.cfg.input_sampling_rate > 0 && read_ctrl_samples(emuenv, port, pData, nb_returned_data, negative, is_v2, from_ext))
+        return nb_returned_data;
+
+    pData->timeStamp = get_timestamp();
     retrieve_ctrl_data(emuenv, port, is_v2, negative, from_ext, pData->buttons, pData->lx, pData->ly, pData->rx, pData->ry);
 
     for (int i = 1; i < nb_returned_data; i++) {
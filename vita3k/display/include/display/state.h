@@ -44,6 +44,8 @@ struct DisplayFrameInfo {
     uint32_t pitch = 0;
     uint32_t pixelformat = SCE_DISPLAY_PIXELFORMAT_A8B8G8R8;
     SceIVector2 image_size = { 0, 0 };
+    // guest flip which set this frame, counted from 1
+    uint64_t frame_index = 0;
 };
 
 struct PredictedDisplayFrame {
@@ -58,6 +60,8 @@ struct DisplayState {
     std::mutex display_info_mutex;
     // the next frame which will actually be displayed by the renderer
     DisplayFrameInfo next_rendered_frame;
+    // the last frame displayed by the renderer, only used on the main thread
+    DisplayFrameInfo presented_frame;
 
     std::mutex mutex;
     std::unique_ptr<std::thread> vblank_thread;
@@ -22,10 +22,16 @@
 #include <emuenv/state.h>
 #include <kernel/state.h>
 #include <renderer/state.h>
+#include <rtc/clock.h>
 
 #include <chrono>
+#include <ctrl/functions.h>
 #include <motion/functions.h>
+#include <replay/functions.h>
 #include <touch/functions.h>
+#include <util/log.h>
+
+#include <SDL_events.h>
 
 // Code heavily influenced by PPSSSPP's SceDisplay.cpp
 
@@ -39,14 +45,27 @@ static constexpr uint8_t max_expected_swapchain_size = 6;
 
 static void vblank_sync_thread(EmuEnvState &emuenv) {
     DisplayState &display = emuenv.display;
+    GuestClock &clock = get_guest_clock();
 
     while (!display.abort.load()) {
+        const uint64_t vcount = display.vblank_count + 1;
+        sync_replay_vblank(emuenv.replay, vcount, emuenv.kernel.is_threads_paused(), display.abort);
+
+        // in deterministic mode, guest time moves by one frame on each vblank
+        clock.advance(TARGET_MICRO_PER_FRAME);
+
         {
             const std::lock_guard<std::mutex> guard(display.mutex);
 
+            // the input of the vblank must be there before the guest can see its count
+            // maybe we should also use a mutex for this part, but it shouldn't be an issue
+            ctrl_vsync_update(emuenv, vcount);
+            touch_vsync_update(emuenv, vcount);
+            refresh_motion(emuenv.motion, emuenv.ctrl, emuenv.replay, vcount);
+
             {
                 const std::lock_guard<std::mutex> guard_info(display.display_info_mutex);
-                ++display.vblank_count;
+                display.vblank_count = vcount;
 
                 // in this case, even though no new game frames are being rendered, we still need to update the screen
                 if (emuenv.kernel.is_threads_paused() || (emuenv.common_dialog.status == SCE_COMMON_DIALOG_STATUS_RUNNING))
@@ -57,9 +76,12 @@ static void vblank_sync_thread(EmuEnvState &emuenv) {
                         emuenv.renderer->should_display = true;
             }
 
-            // maybe we should also use a mutex for this part, but it shouldn't be an issue
-            touch_vsync_update(emuenv);
-            refresh_motion(emuenv.motion, emuenv.ctrl);
+            if (is_replay_over(emuenv.replay, vcount)) {
+                LOG_INFO("End of the replayed input at vblank {}, quitting", vcount);
+                SDL_Event event{};
+                event.type = SDL_QUIT;
+                SDL_PushEvent(&event);
+            }
 
             // Notify Vblank callback in each VBLANK start
             for (auto &[_, cb] : display.vblank_callbacks)
@@ -77,9 +99,13 @@ static void vblank_sync_thread(EmuEnvState &emuenv) {
                 }
             }
         }
-        const auto time_ms = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-        const auto time_left = TARGET_MICRO_PER_FRAME - (time_ms % TARGET_MICRO_PER_FRAME);
-        std::this_thread::sleep_for(std::chrono::microseconds(time_left));
+        if (clock.get_mode() == GuestClockMode::REAL_TIME) {
+            const auto time_ms = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            const auto time_left = TARGET_MICRO_PER_FRAME - (time_ms % TARGET_MICRO_PER_FRAME);
+            std::this_thread::sleep_for(std::chrono::microseconds(time_left));
+        } else {
+            std::this_thread::sleep_for(clock.to_host(TARGET_MICRO_PER_FRAME));
+        }
     }
 }
 
@@ -58,6 +58,7 @@ struct RegMgrState;
 struct SfoFile;
 struct GDBState;
 struct HTTPState;
+struct ReplayState;
 
 #ifdef ANDROID
 struct libadreno_var {
@@ -113,6 +114,7 @@ private:
     std::unique_ptr<SfoFile> _sfo_handle;
     std::unique_ptr<GDBState> _gdb;
     std::unique_ptr<HTTPState> _http;
+    std::unique_ptr<ReplayState> _replay;
 #ifdef ANDROID
     std::unique_ptr<libadreno_var> _libadreno;
 #endif
@@ -151,6 +153,8 @@ public:
     float fps_values[20] = {};
     uint32_t current_fps_offset = 0;
     uint32_t ms_per_frame = 0;
+    uint32_t protect_faults_per_frame = 0;
+    uint32_t protect_syscalls_per_frame = 0;
     WindowPtr window = WindowPtr(nullptr, nullptr);
     renderer::Backend backend_renderer{};
     RendererPtr renderer{};
@@ -181,6 +185,7 @@ public:
     uint32_t res_height_dpi_scale = 0;
     GDBState &gdb;
     HTTPState &http;
+    ReplayState &replay;
 #ifdef ANDROID
     libadreno_var &libadreno; 
 #endif
@@ -35,6 +35,7 @@
 #include <packages/sfo.h>
 #include <regmgr/state.h>
 #include <renderer/state.h>
+#include <replay/state.h>
 #include <touch/state.h>
 
 #include <gdbstub/state.h>
@@ -83,7 +84,9 @@ EmuEnvState::EmuEnvState()
     , _gdb(new GDBState)
     , gdb(*_gdb)
     , _http(new HTTPState)
-    , http(*_http) 
+    , http(*_http)
+    , _replay(new ReplayState)
+    , replay(*_replay)
 #ifdef ANDROID
     , _libadreno(new libadreno_var)
     , libadreno(*_libadreno)
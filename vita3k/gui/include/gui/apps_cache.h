@@ -0,0 +1,79 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#pragma once
+
+#include <compat/database.h>
+#include <util/fs.h>
+
+#include <ctime>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gui {
+
+struct App {
+    std::string app_ver;
+    std::string category;
+    std::string content_id;
+    std::string addcont;
+    std::string savedata;
+    std::string parental_level;
+    std::string stitle;
+    std::string title;
+    std::string title_id;
+    std::string path;
+    time_t last_time;
+    compat::CompatibilityState compat;
+    // last write time of the param.sfo the fields were read from, the cached entry is reused while it matches
+    time_t param_time = 0;
+};
+
+/**
+ * @brief Read the apps saved by write_apps_cache
+ *
+ * Fails when the cache is missing, truncated, of an older version or of another language than sys_lang.
+ * cache_lang is set to the language of the cache as soon as it is read.
+ */
+bool read_apps_cache(const fs::path &cache_path, uint32_t sys_lang, uint32_t &cache_lang, std::vector<App> &apps);
+
+// Save apps with their param.sfo time so that the next scan can reuse them
+bool write_apps_cache(const fs::path &cache_path, uint32_t lang, const std::vector<App> &apps);
+
+// Last write time of the param.sfo of the app installed in app_dir, 0 when it has none
+time_t get_param_time(const fs::path &app_dir);
+
+/**
+ * @brief List the apps installed in apps_dir
+ *
+ * The apps of cached_apps whose param.sfo did not change are moved to apps, the other ones are read with read_app.
+ * An app without param.sfo is reused until one is added.
+ * apps is left as is when apps_dir does not exist.
+ * @return true when apps differs from cached_apps and the cache must be written again
+ */
+bool scan_apps(const fs::path &apps_dir, std::vector<App> &cached_apps, std::vector<App> &apps, const std::function<App(const std::string &)> &read_app);
+
+/**
+ * @brief Find the app with app_path in apps
+ *
+ * index maps paths to positions in apps. A hit is checked against the list and a miss rebuilds it,
+ * so the index does not need to be updated when apps is sorted or changed.
+ */
+App *find_app(std::vector<App> &apps, std::unordered_map<std::string, size_t> &index, const std::string &app_path);
+
+} // namespace gui
@@ -25,6 +25,7 @@
 #include <imgui.h>
 #include <imgui_memory_editor.h>
 
+#include <gui/apps_cache.h>
 #include <gui/imgui_impl_sdl_state.h>
 
 #include <atomic>
@@ -54,21 +55,6 @@ enum SortType {
     TITLE_ID
 };
 
-struct App {
-    std::string app_ver;
-    std::string category;
-    std::string content_id;
-    std::string addcont;
-    std::string savedata;
-    std::string parental_level;
-    std::string stitle;
-    std::string title;
-    std::string title_id;
-    std::string path;
-    time_t last_time;
-    compat::CompatibilityState compat;
-};
-
 struct AppInfo {
     std::string trophy;
     tm updated;
@@ -101,6 +87,9 @@ struct IconAsyncLoader {
 struct AppsSelector {
     std::vector<App> sys_apps;
     std::vector<App> user_apps;
+    // position of the apps by path, rebuilt by get_app_index when the lists change
+    std::unordered_map<std::string, size_t> sys_apps_index;
+    std::unordered_map<std::string, size_t> user_apps_index;
     uint32_t apps_cache_lang;
     AppInfo app_info;
     std::optional<IconAsyncLoader> icon_async_loader;
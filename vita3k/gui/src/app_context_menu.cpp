@@ -356,8 +356,9 @@ void draw_app_context_menu(GuiState &gui, EmuEnvState &emuenv, const std::string
 
     const auto is_commercial_app = title_id.starts_with("PCS") || (title_id == "NPXS10007");
     const auto is_system_app = title_id.starts_with("NPXS") && (title_id != "NPXS10007");
-    const auto has_state_report = gui.compat.compat_db_loaded ? gui.compat.app_compat_db.contains(title_id) : false;
-    const auto compat_state = has_state_report ? gui.compat.app_compat_db[title_id].state : compat::UNKNOWN;
+    const auto state_report = gui.compat.compat_db_loaded ? gui.compat.app_compat_db.find(title_id) : nullptr;
+    const auto has_state_report = state_report != nullptr;
+    const auto compat_state = has_state_report ? state_report->state : compat::UNKNOWN;
     const auto &compat_state_color = gui.compat.compat_color[compat_state];
     const auto &compat_state_str = has_state_report ? lang_compat.states[compat_state] : lang_compat.states[compat::UNKNOWN];
 
@@ -381,7 +382,7 @@ void draw_app_context_menu(GuiState &gui, EmuEnvState &emuenv, const std::string
                     ImGui::Spacing();
                     if (has_state_report) {
                         tm updated_at_tm = {};
-                        SAFE_LOCALTIME(&gui.compat.app_compat_db[title_id].updated_at, &updated_at_tm);
+                        SAFE_LOCALTIME(&state_report->updated_at, &updated_at_tm);
                         auto UPDATED_AT = get_date_time(gui, emuenv, updated_at_tm);
                         ImGui::Spacing();
                         const auto updated_at_str = fmt::format("{} {} {} {}", lang.info["updated"].c_str(), UPDATED_AT[DateTime::DATE_MINI], UPDATED_AT[DateTime::CLOCK], is_12_hour_format ? UPDATED_AT[DateTime::DAY_MOMENT] : "");
@@ -404,7 +405,7 @@ void draw_app_context_menu(GuiState &gui, EmuEnvState &emuenv, const std::string
                             copy_vita3k_summary();
                         if (ImGui::MenuItem(lang.main["open_state_report"].c_str())) {
                             copy_vita3k_summary();
-                            open_path(fmt::format("{}/{}", ISSUES_URL, gui.compat.app_compat_db[title_id].issue_id));
+                            open_path(fmt::format("{}/{}", ISSUES_URL, state_report->issue_id));
                         }
                     } else {
                         if (ImGui::MenuItem(lang.main["create_state_report"].c_str())) {
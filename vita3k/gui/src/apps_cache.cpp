@@ -0,0 +1,186 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#include <gui/apps_cache.h>
+
+#include <util/log.h>
+
+#include <algorithm>
+
+namespace gui {
+
+static constexpr uint32_t APPS_CACHE_VERSION = 2;
+
+bool read_apps_cache(const fs::path &cache_path, uint32_t sys_lang, uint32_t &cache_lang, std::vector<App> &apps) {
+    fs::ifstream apps_cache(cache_path, std::ios::in | std::ios::binary);
+    if (!apps_cache.is_open())
+        return false;
+
+    // Read size of apps list
+    size_t size;
+    apps_cache.read((char *)&size, sizeof(size));
+
+    // Check version of cache
+    uint32_t versionInFile;
+    apps_cache.read((char *)&versionInFile, sizeof(uint32_t));
+    if (!apps_cache || (versionInFile != APPS_CACHE_VERSION)) {
+        LOG_WARN("Current version of cache: {}, is outdated, recreate it.", versionInFile);
+        return false;
+    }
+
+    // Read language of cache
+    apps_cache.read((char *)&cache_lang, sizeof(uint32_t));
+    if (cache_lang != sys_lang) {
+        LOG_WARN("Current lang of cache: {}, is different configuration: {}, recreate it.", cache_lang, sys_lang);
+        return false;
+    }
+
+    // Read App info value
+    for (size_t a = 0; a < size; a++) {
+        auto read = [&apps_cache]() {
+            size_t size = 0;
+
+            apps_cache.read((char *)&size, sizeof(size));
+            if (!apps_cache)
+                return std::string();
+
+            std::vector<char> buffer(size); // dont trust std::string to hold buffer enough
+            apps_cache.read(buffer.data(), size);
+
+            return std::string(buffer.begin(), buffer.end());
+        };
+
+        App app{};
+
+        app.app_ver = read();
+        app.category = read();
+        app.content_id = read();
+        app.addcont = read();
+        app.savedata = read();
+        app.parental_level = read();
+        app.stitle = read();
+        app.title = read();
+        app.title_id = read();
+        app.path = read();
+        apps_cache.read((char *)&app.param_time, sizeof(app.param_time));
+
+        if (!apps_cache) {
+            LOG_WARN("Cache of apps is truncated, recreate it.");
+            apps.clear();
+            return false;
+        }
+
+        apps.push_back(std::move(app));
+    }
+
+    return true;
+}
+
+bool write_apps_cache(const fs::path &cache_path, uint32_t lang, const std::vector<App> &apps) {
+    fs::ofstream apps_cache(cache_path, std::ios::out | std::ios::binary);
+    if (!apps_cache.is_open())
+        return false;
+
+    // Write Size of apps list
+    const auto size = apps.size();
+    apps_cache.write((const char *)&size, sizeof(size));
+
+    // Write version of cache
+    const uint32_t versionInFile = APPS_CACHE_VERSION;
+    apps_cache.write((const char *)&versionInFile, sizeof(uint32_t));
+
+    // Write language of cache
+    apps_cache.write((const char *)&lang, sizeof(uint32_t));
+
+    // Write Apps list
+    for (const App &app : apps) {
+        auto write = [&apps_cache](const std::string &i) {
+            const auto size = i.length();
+
+            apps_cache.write((const char *)&size, sizeof(size));
+            apps_cache.write(i.c_str(), size);
+        };
+
+        write(app.app_ver);
+        write(app.category);
+        write(app.content_id);
+        write(app.addcont);
+        write(app.savedata);
+        write(app.parental_level);
+        write(app.stitle);
+        write(app.title);
+        write(app.title_id);
+        write(app.path);
+        apps_cache.write((const char *)&app.param_time, sizeof(app.param_time));
+    }
+
+    return static_cast<bool>(apps_cache);
+}
+
+time_t get_param_time(const fs::path &app_dir) {
+    boost::system::error_code ec;
+    const auto param_time = fs::last_write_time(app_dir / "sce_sys/param.sfo", ec);
+    return ec ? 0 : param_time;
+}
+
+bool scan_apps(const fs::path &apps_dir, std::vector<App> &cached_apps, std::vector<App> &apps, const std::function<App(const std::string &)> &read_app) {
+    if (!fs::exists(apps_dir))
+        return false;
+
+    std::unordered_map<std::string, App *> cached_apps_index;
+    for (auto &app : cached_apps)
+        cached_apps_index.emplace(app.path, &app);
+
+    apps.clear();
+    apps.reserve(cached_apps.size());
+    size_t parsed_count = 0;
+    for (const auto &app : fs::directory_iterator(apps_dir)) {
+        if (!app.path().empty() && fs::is_directory(app.path())
+            && !app.path().filename_is_dot() && !app.path().filename_is_dot_dot()) {
+            const auto app_path = app.path().stem().generic_string();
+            const auto cached_app = cached_apps_index.find(app_path);
+            const auto param_time = get_param_time(app.path());
+            if ((cached_app != cached_apps_index.end()) && (cached_app->second->param_time == param_time)) {
+                apps.push_back(std::move(*cached_app->second));
+            } else {
+                apps.push_back(read_app(app_path));
+                parsed_count++;
+            }
+        }
+    }
+
+    return (parsed_count != 0) || (apps.size() != cached_apps.size());
+}
+
+App *find_app(std::vector<App> &apps, std::unordered_map<std::string, size_t> &index, const std::string &app_path) {
+    const auto app_index = index.find(app_path);
+    if ((app_index != index.end()) && (app_index->second < apps.size()) && (apps[app_index->second].path == app_path))
+        return &apps[app_index->second];
+
+    const auto app = std::find_if(apps.begin(), apps.end(), [&](const App &a) {
+        return a.path == app_path;
+    });
+    if (app == apps.end())
+        return nullptr;
+
+    index.clear();
+    for (size_t i = 0; i < apps.size(); i++)
+        index.emplace(apps[i].path, i);
+
+    return &(*app);
+}
+
+} // namespace gui
@@ -18,16 +18,15 @@
 #include "private.h"
 
 #include <algorithm>
-#include <boost/algorithm/string/trim.hpp>
 #include <boost/range/numeric.hpp>
 
 #include <gui/functions.h>
 
 #include <config/state.h>
 #include <dialog/state.h>
+#include <packages/content_index.h>
 #include <packages/sfo.h>
 
-#include <io/VitaIoDevice.h>
 #include <io/functions.h>
 
 #include <util/safe_time.h>
@@ -94,72 +93,55 @@ struct SaveData {
 };
 
 static std::vector<SaveData> save_data_list;
+static std::vector<std::string> save_data_ids;
 
-static void get_save_data_list(GuiState &gui, EmuEnvState &emuenv) {
-    save_data_list.clear();
-
-    fs::path SAVE_PATH{ emuenv.pref_path / "ux0/user" / emuenv.io.user_id / "savedata" };
-    if (!fs::exists(SAVE_PATH))
-        return;
-
-    for (const auto &save : fs::directory_iterator(SAVE_PATH)) {
-        const auto title_id = save.path().stem().generic_string();
-        if (fs::is_directory(save.path()) && !fs::is_empty(save.path()) && get_app_index(gui, title_id)) {
-            tm updated_tm = {};
+static std::map<std::string, size_t> apps_size;
+static std::map<std::string, std::string> space;
 
-            const auto last_written = fs::last_write_time(save);
-            SAFE_LOCALTIME(&last_written, &updated_tm);
+// Sizes are computed in the background, the lists are filled in as the results come
+static std::unique_ptr<ContentIndexer> content_indexer;
+static int content_indexer_lang;
+static std::map<fs::path, ContentInfo> contents_info;
 
-            const auto size = get_recursive_directory_size(save);
-            save_data_list.push_back({ get_app_index(gui, title_id)->title, title_id, size, updated_tm });
-        }
-    }
-    std::sort(save_data_list.begin(), save_data_list.end(), [](const SaveData &sa, const SaveData &sb) {
-        return sa.title < sb.title;
-    });
+static size_t get_content_size(const fs::path &path) {
+    const auto info = contents_info.find(path);
+    return info != contents_info.end() ? info->second.size : 0;
 }
 
-static std::map<std::string, size_t> apps_size;
-static std::map<std::string, std::string> space;
-
 void init_content_manager(GuiState &gui, EmuEnvState &emuenv) {
     space.clear();
 
     const auto free_size{ fs::space(emuenv.pref_path).free };
     space["free"] = get_unit_size(free_size);
 
-    const auto query_app = [&gui, &emuenv] {
-        const auto &directory_list = gui.app_selector.user_apps;
-        const auto pred = [&](const auto acc, const auto &app) {
-            apps_size[app.path] = get_app_size(gui, emuenv, app.path);
-            return acc + apps_size[app.path];
-        };
-        return boost::accumulate(directory_list, boost::uintmax_t{}, pred);
-    };
+    // the cache of the indexer holds titles in the system language
+    if (!content_indexer || (content_indexer_lang != emuenv.cfg.sys_lang)) {
+        content_indexer = std::make_unique<ContentIndexer>(emuenv.cfg.sys_lang);
+        content_indexer_lang = emuenv.cfg.sys_lang;
+    }
+    contents_info.clear();
+    apps_size.clear();
+    save_data_list.clear();
+    save_data_ids.clear();
+    space["app"] = space["savedata"] = space["themes"] = "-";
 
-    const auto query_savedata = [] {
-        const auto &directory_list = save_data_list;
-        const auto pred = [](const auto acc, const auto &save) { return acc + save.size; };
-        return boost::accumulate(directory_list, boost::uintmax_t{}, pred);
-    };
+    for (const auto &app : gui.app_selector.user_apps) {
+        content_indexer->request(emuenv.pref_path / "ux0/app" / app.path);
+        content_indexer->request(emuenv.pref_path / "ux0/addcont" / app.title_id);
+    }
 
-    const auto query_themes = [&emuenv] {
-        const auto THEME_PATH{ emuenv.pref_path / "ux0/theme" };
-        if (fs::exists(THEME_PATH) && !fs::is_empty(THEME_PATH)) {
-            return get_recursive_directory_size(THEME_PATH);
+    const fs::path SAVE_PATH{ emuenv.pref_path / "ux0/user" / emuenv.io.user_id / "savedata" };
+    if (fs::exists(SAVE_PATH)) {
+        for (const auto &save : fs::directory_iterator(SAVE_PATH)) {
+            const auto title_id = save.path().stem().generic_string();
+            if (fs::is_directory(save.status()) && get_app_index(gui, title_id)) {
+                content_indexer->request(save.path());
+                save_data_ids.push_back(title_id);
+            }
         }
-        return boost::uintmax_t{};
-    };
-
-    const auto get_list_size_or_dash = [](const auto query) {
-        const auto list_size = query();
-        return list_size ? get_unit_size(list_size) : "-";
-    };
+    }
 
-    space["app"] = get_list_size_or_dash(query_app);
-    get_save_data_list(gui, emuenv);
-    space["savedata"] = get_list_size_or_dash(query_savedata);
-    space["themes"] = get_list_size_or_dash(query_themes);
+    content_indexer->request(emuenv.pref_path / "ux0/theme");
 }
 
 static std::map<std::string, bool> contents_selected;
@@ -194,34 +176,71 @@ struct AddCont {
 static std::map<std::string, AddCont> addcont_info;
 
 static void get_content_info(GuiState &gui, EmuEnvState &emuenv) {
-    const auto APP_PATH{ emuenv.pref_path / "ux0/app" / app_selected };
-    if (fs::exists(APP_PATH) && !fs::is_empty(APP_PATH)) {
-        gui.app_selector.app_info.size = get_recursive_directory_size(APP_PATH);
-    }
+    gui.app_selector.app_info.size = get_content_size(emuenv.pref_path / "ux0/app" / app_selected);
 
     addcont_info.clear();
     const auto ADDCONT_PATH{ emuenv.pref_path / "ux0/addcont" / app_selected };
     if (fs::exists(ADDCONT_PATH) && !fs::is_empty(ADDCONT_PATH)) {
-        for (const auto &addcont : fs::directory_iterator(ADDCONT_PATH)) {
-            const auto content_id = addcont.path().stem().string();
-
-            const auto last_written = fs::last_write_time(addcont);
-            SAFE_LOCALTIME(&last_written, &addcont_info[content_id].date);
-
-            const auto addcont_size = get_recursive_directory_size(addcont);
-            addcont_info[content_id].size = get_unit_size(addcont_size);
-
-            const auto content_path{ fs::path("addcont") / app_selected / content_id };
-            vfs::FileBuffer params;
-            if (vfs::read_file(VitaIoDevice::ux0, params, emuenv.pref_path, content_path / "sce_sys/param.sfo")) {
-                SfoFile sfo_handle;
-                sfo::load(sfo_handle, params);
-                if (!sfo::get_data_by_key(addcont_info[content_id].name, sfo_handle, fmt::format("TITLE_{:0>2d}", emuenv.cfg.sys_lang)))
-                    sfo::get_data_by_key(addcont_info[content_id].name, sfo_handle, "TITLE");
-            }
-            boost::trim(addcont_info[content_id].name);
+        for (const auto &addcont : fs::directory_iterator(ADDCONT_PATH))
+            content_indexer->request(addcont.path());
+    }
+}
+
+// Fill the lists in with the sizes indexed since the last frame
+static void update_contents_info(GuiState &gui, EmuEnvState &emuenv) {
+    if (!content_indexer)
+        return;
+
+    auto results = content_indexer->poll();
+    if (results.empty())
+        return;
+
+    const auto ADDCONT_PATH{ emuenv.pref_path / "ux0/addcont" / app_selected };
+    for (auto &info : results) {
+        if (!app_selected.empty() && (info.path.parent_path() == ADDCONT_PATH)) {
+            auto &addcont = addcont_info[info.path.stem().string()];
+            addcont.name = info.title;
+            addcont.size = get_unit_size(info.size);
+            SAFE_LOCALTIME(&info.updated, &addcont.date);
         }
+        auto path = info.path;
+        contents_info[path] = std::move(info);
     }
+
+    const auto get_list_size_or_dash = [](const auto list_size) {
+        return list_size ? get_unit_size(list_size) : "-";
+    };
+
+    boost::uintmax_t apps_total = 0;
+    for (const auto &app : gui.app_selector.user_apps) {
+        apps_size[app.path] = get_content_size(emuenv.pref_path / "ux0/app" / app.path) + get_content_size(emuenv.pref_path / "ux0/addcont" / app.title_id);
+        apps_total += apps_size[app.path];
+    }
+    space["app"] = get_list_size_or_dash(apps_total);
+
+    save_data_list.clear();
+    boost::uintmax_t savedata_total = 0;
+    const fs::path SAVE_PATH{ emuenv.pref_path / "ux0/user" / emuenv.io.user_id / "savedata" };
+    for (const auto &title_id : save_data_ids) {
+        const auto info = contents_info.find(SAVE_PATH / title_id);
+        const auto app_index = get_app_index(gui, title_id);
+        if ((info == contents_info.end()) || !info->second.size || !app_index)
+            continue;
+
+        tm updated_tm = {};
+        SAFE_LOCALTIME(&info->second.updated, &updated_tm);
+        save_data_list.push_back({ app_index->title, title_id, info->second.size, updated_tm });
+        savedata_total += info->second.size;
+    }
+    std::sort(save_data_list.begin(), save_data_list.end(), [](const SaveData &sa, const SaveData &sb) {
+        return sa.title < sb.title;
+    });
+    space["savedata"] = get_list_size_or_dash(savedata_total);
+
+    space["themes"] = get_list_size_or_dash(get_content_size(emuenv.pref_path / "ux0/theme"));
+
+    if (!app_selected.empty())
+        gui.app_selector.app_info.size = get_content_size(emuenv.pref_path / "ux0/app" / app_selected);
 }
 
 static bool popup, content_delete, set_scroll_pos;
@@ -252,6 +271,8 @@ void draw_content_manager(GuiState &gui, EmuEnvState &emuenv) {
     const auto has_background = gui.apps_background.contains("NPXS10026");
     const auto is_12_hour_format = emuenv.cfg.sys_time_format == SCE_SYSTEM_PARAM_TIME_FORMAT_12HOUR;
 
+    update_contents_info(gui, emuenv);
+
     ImGui::SetNextWindowPos(WINDOW_POS, ImGuiCond_Always);
     ImGui::SetNextWindowSize(WINDOW_SIZE, ImGuiCond_Always);
     ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.f);
@@ -33,24 +33,13 @@ std::string fw_version;
 bool delete_pup_file;
 fs::path pup_path = "";
 
-static void get_firmware_version(EmuEnvState &emuenv) {
-    fs::ifstream versionFile(emuenv.pref_path / "PUP_DEC/PUP/version.txt");
-
-    if (versionFile.is_open()) {
-        std::getline(versionFile, fw_version);
-        versionFile.close();
-    } else
-        LOG_WARN("Firmware Version file not found!");
-
-    fs::remove_all(emuenv.pref_path / "PUP_DEC");
-}
-
 void draw_firmware_install_dialog(GuiState &gui, EmuEnvState &emuenv) {
     host::dialog::filesystem::Result result = host::dialog::filesystem::Result::CANCEL;
 
     static std::mutex install_mutex;
     static bool draw_file_dialog = true;
     static bool finished_installing = false;
+    static bool install_failed = false;
     static std::atomic<uint32_t> progress(0);
     static const auto progress_callback = [&](uint32_t updated_progress) {
         progress = updated_progress;
@@ -75,10 +64,14 @@ void draw_firmware_install_dialog(GuiState &gui, EmuEnvState &emuenv) {
 
         if (result == host::dialog::filesystem::Result::SUCCESS) {
             std::thread installation([&emuenv]() {
-                install_pup(emuenv.pref_path, pup_path, progress_callback);
+                std::string installed_version;
+                const bool installed = install_pup(emuenv.pref_path, pup_path, installed_version, progress_callback);
+                if (installed && installed_version.empty())
+                    LOG_WARN("Firmware Version file not found!");
                 std::lock_guard<std::mutex> lock(install_mutex);
                 finished_installing = true;
-                get_firmware_version(emuenv);
+                install_failed = !installed;
+                fw_version = installed_version;
             });
             installation.detach();
         } else if (result == host::dialog::filesystem::Result::CANCEL) {
@@ -118,8 +111,9 @@ void draw_firmware_install_dialog(GuiState &gui, EmuEnvState &emuenv) {
         if (ImGui::BeginPopupModal("firmware_installation", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoDecoration)) {
             ImGui::SetWindowFontScale(RES_SCALE.x);
             const auto POS_BUTTON = (WINDOW_SIZE.x / 2.f) - (BUTTON_SIZE.x / 2.f) + (10.f * SCALE.x);
-            ImGui::SetCursorPosX((WINDOW_SIZE.x / 2.f) - (ImGui::CalcTextSize(lang["successed_install_firmware"].c_str()).x / 2.f));
-            ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%s", lang["successed_install_firmware"].c_str());
+            const auto &install_result = install_failed ? lang["failed_install_firmware"] : lang["successed_install_firmware"];
+            ImGui::SetCursorPosX((WINDOW_SIZE.x / 2.f) - (ImGui::CalcTextSize(install_result.c_str()).x / 2.f));
+            ImGui::TextColored(GUI_COLOR_TEXT_TITLE, "%s", install_result.c_str());
             ImGui::Spacing();
             ImGui::Separator();
             ImGui::Spacing();
@@ -141,8 +135,10 @@ void draw_firmware_install_dialog(GuiState &gui, EmuEnvState &emuenv) {
 #ifdef ANDROID
             delete_pup_file = false;
 #else
-            ImGui::Checkbox(lang["delete_firmware"].c_str(), &delete_pup_file);
-            ImGui::Spacing();
+            if (!install_failed) {
+                ImGui::Checkbox(lang["delete_firmware"].c_str(), &delete_pup_file);
+                ImGui::Spacing();
+            }
 #endif
             ImGui::SetCursorPos(ImVec2(POS_BUTTON, ImGui::GetWindowSize().y - BUTTON_SIZE.y - (20.f * SCALE.y)));
             if (ImGui::Button(common["ok"].c_str(), BUTTON_SIZE)) {
@@ -439,106 +439,57 @@ std::string get_sys_lang_name(uint32_t lang_id) {
     return current_sys_lang->second;
 }
 
-static bool get_user_apps(GuiState &gui, EmuEnvState &emuenv) {
-    const auto apps_cache_path{ emuenv.pref_path / "ux0/temp/apps.dat" };
-    fs::ifstream apps_cache(apps_cache_path, std::ios::in | std::ios::binary);
-    if (apps_cache.is_open()) {
-        gui.app_selector.user_apps.clear();
-        // Read size of apps list
-        size_t size;
-        apps_cache.read((char *)&size, sizeof(size));
-
-        // Check version of cache
-        uint32_t versionInFile;
-        apps_cache.read((char *)&versionInFile, sizeof(uint32_t));
-        if (versionInFile != 1) {
-            LOG_WARN("Current version of cache: {}, is outdated, recreate it.", versionInFile);
-            return false;
-        }
-
-        // Read language of cache
-        apps_cache.read((char *)&gui.app_selector.apps_cache_lang, sizeof(uint32_t));
-        if (gui.app_selector.apps_cache_lang != emuenv.cfg.sys_lang) {
-            LOG_WARN("Current lang of cache: {}, is different configuration: {}, recreate it.", get_sys_lang_name(gui.app_selector.apps_cache_lang), get_sys_lang_name(emuenv.cfg.sys_lang));
-            return false;
-        }
-
-        // Read App info value
-        for (size_t a = 0; a < size; a++) {
-            auto read = [&apps_cache]() {
-                size_t size;
+static App read_app_param(EmuEnvState &emuenv, const std::string &app_path) {
+    emuenv.app_path = app_path;
+    vfs::FileBuffer param;
+    if (vfs::read_app_file(param, emuenv.pref_path, app_path, "sce_sys/param.sfo")) {
+        sfo::get_param_info(emuenv.app_info, param, emuenv.cfg.sys_lang);
+    } else {
+        emuenv.app_info.app_addcont = emuenv.app_info.app_savedata = emuenv.app_info.app_short_title = emuenv.app_info.app_title = emuenv.app_info.app_title_id = emuenv.app_path; // Use app path as TitleID, addcont, Savedata, Short title and Title
+        emuenv.app_info.app_version = emuenv.app_info.app_category = emuenv.app_info.app_parental_level = "N/A";
+    }
+    App app{ emuenv.app_info.app_version, emuenv.app_info.app_category, emuenv.app_info.app_content_id, emuenv.app_info.app_addcont, emuenv.app_info.app_savedata, emuenv.app_info.app_parental_level, emuenv.app_info.app_short_title, emuenv.app_info.app_title, emuenv.app_info.app_title_id, emuenv.app_path };
+    app.param_time = param.empty() ? 0 : get_param_time(emuenv.pref_path / "ux0/app" / app_path);
 
-                apps_cache.read((char *)&size, sizeof(size));
+    return app;
+}
 
-                std::vector<char> buffer(size); // dont trust std::string to hold buffer enough
-                apps_cache.read(buffer.data(), size);
+// Read the cached user apps, fail when there are none for the current language
+static bool read_user_apps_cache(GuiState &gui, EmuEnvState &emuenv, std::vector<App> &apps) {
+    return read_apps_cache(emuenv.pref_path / "ux0/temp/apps.dat", emuenv.cfg.sys_lang, gui.app_selector.apps_cache_lang, apps);
+}
 
-                return std::string(buffer.begin(), buffer.end());
-            };
+// List the installed apps, the apps whose param.sfo did not change since they were cached are not parsed again
+static void scan_user_apps(GuiState &gui, EmuEnvState &emuenv, std::vector<App> &cached_apps) {
+    const auto changed = scan_apps(emuenv.pref_path / "ux0/app", cached_apps, gui.app_selector.user_apps, [&](const std::string &app_path) {
+        return read_app_param(emuenv, app_path);
+    });
 
-            App app;
+    if (changed)
+        save_apps_cache(gui, emuenv);
+}
 
-            app.app_ver = read();
-            app.category = read();
-            app.content_id = read();
-            app.addcont = read();
-            app.savedata = read();
-            app.parental_level = read();
-            app.stitle = read();
-            app.title = read();
-            app.title_id = read();
-            app.path = read();
+static bool get_user_apps(GuiState &gui, EmuEnvState &emuenv) {
+    std::vector<App> cached_apps;
+    if (!read_user_apps_cache(gui, emuenv, cached_apps))
+        return false;
 
-            gui.app_selector.user_apps.push_back(app);
-        }
+    scan_user_apps(gui, emuenv, cached_apps);
+    if (gui.app_selector.user_apps.empty())
+        return false;
 
-        init_apps_icon(gui, emuenv, gui.app_selector.user_apps);
-        load_and_update_compat_user_apps(gui, emuenv);
-    }
+    init_apps_icon(gui, emuenv, gui.app_selector.user_apps);
+    load_and_update_compat_user_apps(gui, emuenv);
 
-    return !gui.app_selector.user_apps.empty();
+    return true;
 }
 
 void save_apps_cache(GuiState &gui, EmuEnvState &emuenv) {
     const auto temp_path{ emuenv.pref_path / "ux0/temp" };
     fs::create_directories(temp_path);
 
-    fs::ofstream apps_cache(temp_path / "apps.dat", std::ios::out | std::ios::binary);
-    if (apps_cache.is_open()) {
-        // Write Size of apps list
-        const auto size = gui.app_selector.user_apps.size();
-        apps_cache.write((char *)&size, sizeof(size));
-
-        // Write version of cache
-        const uint32_t versionInFile = 1;
-        apps_cache.write((const char *)&versionInFile, sizeof(uint32_t));
-
-        // Write language of cache
-        gui.app_selector.apps_cache_lang = emuenv.cfg.sys_lang;
-        apps_cache.write((char *)&gui.app_selector.apps_cache_lang, sizeof(uint32_t));
-
-        // Write Apps list
-        for (const App &app : gui.app_selector.user_apps) {
-            auto write = [&apps_cache](const std::string &i) {
-                const auto size = i.length();
-
-                apps_cache.write((const char *)&size, sizeof(size));
-                apps_cache.write(i.c_str(), size);
-            };
-
-            write(app.app_ver);
-            write(app.category);
-            write(app.content_id);
-            write(app.addcont);
-            write(app.savedata);
-            write(app.parental_level);
-            write(app.stitle);
-            write(app.title);
-            write(app.title_id);
-            write(app.path);
-        }
-        apps_cache.close();
-    }
+    gui.app_selector.apps_cache_lang = emuenv.cfg.sys_lang;
+    write_apps_cache(temp_path / "apps.dat", gui.app_selector.apps_cache_lang, gui.app_selector.user_apps);
 }
 
 void init_home(GuiState &gui, EmuEnvState &emuenv) {
@@ -592,41 +543,21 @@ std::map<std::string, ImGui_Texture>::const_iterator get_app_icon(GuiState &gui,
 }
 
 App *get_app_index(GuiState &gui, const std::string &app_path) {
-    auto &app_type = app_path.starts_with("NPXS") && (app_path != "NPXS10007") ? gui.app_selector.sys_apps : gui.app_selector.user_apps;
-    const auto app_index = std::find_if(app_type.begin(), app_type.end(), [&](const App &a) {
-        return a.path == app_path;
-    });
+    const auto is_sys = app_path.starts_with("NPXS") && (app_path != "NPXS10007");
+    auto &app_type = is_sys ? gui.app_selector.sys_apps : gui.app_selector.user_apps;
+    auto &app_index = is_sys ? gui.app_selector.sys_apps_index : gui.app_selector.user_apps_index;
 
-    return (app_index != app_type.end()) ? &(*app_index) : nullptr;
+    return find_app(app_type, app_index, app_path);
 }
 
 void get_app_param(GuiState &gui, EmuEnvState &emuenv, const std::string &app_path) {
-    emuenv.app_path = app_path;
-    vfs::FileBuffer param;
-    if (vfs::read_app_file(param, emuenv.pref_path, app_path, "sce_sys/param.sfo")) {
-        sfo::get_param_info(emuenv.app_info, param, emuenv.cfg.sys_lang);
-    } else {
-        emuenv.app_info.app_addcont = emuenv.app_info.app_savedata = emuenv.app_info.app_short_title = emuenv.app_info.app_title = emuenv.app_info.app_title_id = emuenv.app_path; // Use app path as TitleID, addcont, Savedata, Short title and Title
-        emuenv.app_info.app_version = emuenv.app_info.app_category = emuenv.app_info.app_parental_level = "N/A";
-    }
-    gui.app_selector.user_apps.push_back({ emuenv.app_info.app_version, emuenv.app_info.app_category, emuenv.app_info.app_content_id, emuenv.app_info.app_addcont, emuenv.app_info.app_savedata, emuenv.app_info.app_parental_level, emuenv.app_info.app_short_title, emuenv.app_info.app_title, emuenv.app_info.app_title_id, emuenv.app_path });
+    gui.app_selector.user_apps.push_back(read_app_param(emuenv, app_path));
 }
 
 void get_user_apps_title(GuiState &gui, EmuEnvState &emuenv) {
-    const fs::path app_path{ emuenv.pref_path / "ux0/app" };
-    if (!fs::exists(app_path))
-        return;
-
-    gui.app_selector.user_apps.clear();
-    for (const auto &app : fs::directory_iterator(app_path)) {
-        if (!app.path().empty() && fs::is_directory(app.path())
-            && !app.path().filename_is_dot() && !app.path().filename_is_dot_dot()) {
-            const auto app_path = app.path().stem().generic_string();
-            get_app_param(gui, emuenv, app_path);
-        }
-    }
-
-    save_apps_cache(gui, emuenv);
+    std::vector<App> cached_apps;
+    read_user_apps_cache(gui, emuenv, cached_apps);
+    scan_user_apps(gui, emuenv, cached_apps);
 }
 
 void get_sys_apps_title(GuiState &gui, EmuEnvState &emuenv) {
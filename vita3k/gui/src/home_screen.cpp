@@ -55,7 +55,15 @@ void init_user_apps(GuiState &gui, EmuEnvState &emuenv) {
 
         gui.app_selector.is_app_list_sorted = false;
         init_last_time_apps(gui, emuenv);
-        load_and_update_compat_user_apps(gui, emuenv);
+
+        // once loaded, the compatibility database is only applied to the refreshed list
+        if (gui.compat.compat_db_loaded) {
+            for (auto &app : gui.app_selector.user_apps) {
+                const auto compat = gui.compat.app_compat_db.find(app.title_id);
+                app.compat = compat ? compat->state : compat::UNKNOWN;
+            }
+        } else
+            load_and_update_compat_user_apps(gui, emuenv);
 
         init_apps_icon(gui, emuenv, gui.app_selector.user_apps);
 
@@ -77,13 +85,14 @@ void init_user_apps(GuiState &gui, EmuEnvState &emuenv) {
 }
 
 void init_last_time_apps(GuiState &gui, EmuEnvState &emuenv) {
+    std::unordered_map<std::string, time_t> last_time_used;
+    for (const auto &time_app : gui.time_apps[emuenv.io.user_id])
+        last_time_used.emplace(time_app.app, time_app.last_time_used);
+
     const auto last_time_apps = [&](std::vector<gui::App> &apps_list) {
         for (auto &app : apps_list) {
-            const auto TIME_APP_INDEX = std::find_if(gui.time_apps[emuenv.io.user_id].begin(), gui.time_apps[emuenv.io.user_id].end(), [&](const TimeApp &t) {
-                return t.app == app.path;
-            });
-
-            app.last_time = (TIME_APP_INDEX != gui.time_apps[emuenv.io.user_id].end()) ? TIME_APP_INDEX->last_time_used : 0;
+            const auto TIME_APP_INDEX = last_time_used.find(app.path);
+            app.last_time = (TIME_APP_INDEX != last_time_used.end()) ? TIME_APP_INDEX->second : 0;
         }
     };
 
@@ -899,7 +908,8 @@ void draw_home_screen(GuiState &gui, EmuEnvState &emuenv) {
 
             // Draw the compatibility badge for commercial apps when they are within the visible area.
             if (element_is_within_visible_area && (app.title_id.starts_with("PCS") || (app.title_id == "NPXS10007"))) {
-                const auto compat_state = (gui.compat.compat_db_loaded ? gui.compat.app_compat_db.contains(app.title_id) : false) ? gui.compat.app_compat_db[app.title_id].state : compat::UNKNOWN;
+                const auto state_report = gui.compat.compat_db_loaded ? gui.compat.app_compat_db.find(app.title_id) : nullptr;
+                const auto compat_state = state_report ? state_report->state : compat::UNKNOWN;
                 const auto &compat_state_vec4 = gui.compat.compat_color[compat_state];
                 const ImU32 compat_state_color = IM_COL32((int)(compat_state_vec4.x * 255.0f), (int)(compat_state_vec4.y * 255.0f), (int)(compat_state_vec4.z * 255.0f), (int)(compat_state_vec4.w * 255.0f));
                 const auto current_pos = ImGui::GetCursorPos();
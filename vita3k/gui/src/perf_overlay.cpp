@@ -18,6 +18,7 @@
 #include "private.h"
 
 #include <config/state.h>
+#include <renderer/state.h>
 
 namespace gui {
 static const ImVec2 PERF_OVERLAY_PAD = ImVec2(2.f, 2.f);
@@ -55,9 +56,16 @@ void draw_perf_overlay(GuiState &gui, EmuEnvState &emuenv) {
 
     const auto FPS_TEXT = emuenv.cfg.performance_overlay_detail == MINIMUM ? fmt::format("FPS: {}", emuenv.fps) : fmt::format("FPS: {} {}: {}", emuenv.fps, lang["avg"], emuenv.avg_fps);
     const auto MIN_MAX_FPS_TEXT = fmt::format("{}: {} {}: {}", lang["min"], emuenv.min_fps, lang["max"], emuenv.max_fps);
+    // Memory write tracking cost, per frame
+    const auto PROTECT_TEXT = fmt::format("{}: {} {}: {}", lang["faults"], emuenv.protect_faults_per_frame, lang["syscalls"], emuenv.protect_syscalls_per_frame);
+    // GPU memory, only known by the backends tracking it
+    renderer::GpuMemoryStats gpu_memory;
+    const bool show_gpu_memory = emuenv.cfg.performance_overlay_detail == MAXIMUM && emuenv.renderer && emuenv.renderer->get_gpu_memory_stats(gpu_memory);
+    constexpr uint64_t MiB = 1024 * 1024;
+    const auto GPU_MEMORY_TEXT = show_gpu_memory ? fmt::format("{}: {}/{} MiB {}: {} {}: {}", lang["vram"], gpu_memory.usage / MiB, gpu_memory.budget / MiB, lang["textures"], gpu_memory.texture_cache / MiB, lang["surfaces"], gpu_memory.surface_cache / MiB) : std::string();
     const auto TOTAL_WINDOW_PADDING = ImVec2(ImGui::GetStyle().WindowPadding.x * 2, ImGui::GetStyle().WindowPadding.y * 2);
-    const auto MAX_TEXT_WIDTH_SCALED = std::max(ImGui::CalcTextSize(FPS_TEXT.c_str()).x, emuenv.cfg.performance_overlay_detail == MINIMUM ? 0.f : ImGui::CalcTextSize(MIN_MAX_FPS_TEXT.c_str()).x) * FONT_SCALE;
-    const auto MAX_TEXT_HEIGHT_SCALED = SCALED_FONT_SIZE + (emuenv.cfg.performance_overlay_detail >= MEDIUM ? SCALED_FONT_SIZE + (ImGui::GetStyle().ItemSpacing.y * 2.f) : 0.f);
+    const auto MAX_TEXT_WIDTH_SCALED = std::max({ ImGui::CalcTextSize(FPS_TEXT.c_str()).x, emuenv.cfg.performance_overlay_detail == MINIMUM ? 0.f : ImGui::CalcTextSize(MIN_MAX_FPS_TEXT.c_str()).x, emuenv.cfg.performance_overlay_detail == MAXIMUM ? ImGui::CalcTextSize(PROTECT_TEXT.c_str()).x : 0.f, show_gpu_memory ? ImGui::CalcTextSize(GPU_MEMORY_TEXT.c_str()).x : 0.f }) * FONT_SCALE;
+    const auto MAX_TEXT_HEIGHT_SCALED = SCALED_FONT_SIZE + (emuenv.cfg.performance_overlay_detail >= MEDIUM ? SCALED_FONT_SIZE + (ImGui::GetStyle().ItemSpacing.y * 2.f) : 0.f) + (emuenv.cfg.performance_overlay_detail == MAXIMUM ? SCALED_FONT_SIZE + (ImGui::GetStyle().ItemSpacing.y * 2.f) : 0.f) + (show_gpu_memory ? SCALED_FONT_SIZE + (ImGui::GetStyle().ItemSpacing.y * 2.f) : 0.f);
     const auto WINDOW_SIZE = ImVec2(MAX_TEXT_WIDTH_SCALED + TOTAL_WINDOW_PADDING.x, MAX_TEXT_HEIGHT_SCALED + TOTAL_WINDOW_PADDING.y);
     const auto MAIN_WINDOW_SIZE = ImVec2(WINDOW_SIZE.x + TOTAL_WINDOW_PADDING.x, WINDOW_SIZE.y + TOTAL_WINDOW_PADDING.y + (emuenv.cfg.performance_overlay_detail == MAXIMUM ? WINDOW_SIZE.y : 0.f));
     const auto WINDOW_POS = get_perf_pos(MAIN_WINDOW_SIZE, emuenv, SCALE);
@@ -75,6 +83,14 @@ void draw_perf_overlay(GuiState &gui, EmuEnvState &emuenv) {
         ImGui::Separator();
         ImGui::Text("%s", MIN_MAX_FPS_TEXT.c_str());
     }
+    if (emuenv.cfg.performance_overlay_detail == PerformanceOverlayDetail::MAXIMUM) {
+        ImGui::Separator();
+        ImGui::Text("%s", PROTECT_TEXT.c_str());
+    }
+    if (show_gpu_memory) {
+        ImGui::Separator();
+        ImGui::Text("%s", GPU_MEMORY_TEXT.c_str());
+    }
     ImGui::EndChild();
     ImGui::PopStyleVar();
     ImGui::PopStyleColor();
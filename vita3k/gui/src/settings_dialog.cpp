@@ -232,6 +232,7 @@ CPUBackend set_cpu_backend(std::string &cpu_backend) { // has static
 }
 
 static int current_aniso_filter_log, max_aniso_filter_log, audio_backend_idx, current_user_lang;
+static const char *LIST_BACKEND_AUDIO[] = { "SDL", "Cubeb", "Null", "File" };
 std::vector<std::string> list_user_lang;  // has static
 
 /**
@@ -299,7 +300,8 @@ void init_config(GuiState &gui, EmuEnvState &emuenv, const std::string &app_path
     config_cpu_backend = set_cpu_backend(config.cpu_backend);
     current_aniso_filter_log = static_cast<int>(log2f(static_cast<float>(config.anisotropic_filtering)));
     max_aniso_filter_log = static_cast<int>(log2f(static_cast<float>(emuenv.renderer->get_max_anisotropic_filtering())));
-    audio_backend_idx = (emuenv.cfg.audio_backend == "SDL") ? 0 : 1;
+    const auto audio_backend = std::find(std::begin(LIST_BACKEND_AUDIO), std::end(LIST_BACKEND_AUDIO), emuenv.cfg.audio_backend);
+    audio_backend_idx = (audio_backend != std::end(LIST_BACKEND_AUDIO)) ? static_cast<int>(std::distance(std::begin(LIST_BACKEND_AUDIO), audio_backend)) : 0;
 #ifndef __APPLE__
     if (string_utils::toupper(config.backend_renderer) == "OPENGL")
         emuenv.backend_renderer = renderer::Backend::OpenGL;
@@ -523,6 +525,7 @@ void set_config(EmuEnvState &emuenv, const std::string &app_path, bool custom) {
     emuenv.renderer->res_multiplier = emuenv.cfg.current_config.resolution_multiplier;
     emuenv.renderer->set_anisotropic_filtering(emuenv.cfg.current_config.anisotropic_filtering);
     emuenv.renderer->set_stretch_display(emuenv.cfg.stretch_the_display_area);
+    emuenv.renderer->set_dynamic_resolution(emuenv.cfg.dynamic_resolution, emuenv.cfg.dynamic_resolution_min_scale / 100.0f, emuenv.cfg.dynamic_resolution_target_fps);
     emuenv.renderer->get_texture_cache()->set_replacement_state(emuenv.cfg.current_config.import_textures, emuenv.cfg.current_config.export_textures, emuenv.cfg.current_config.export_as_png);
     emuenv.renderer->set_async_compilation(emuenv.cfg.current_config.async_pipeline_compilation);
     emuenv.display.fps_hack = emuenv.cfg.current_config.fps_hack;
@@ -861,6 +864,18 @@ void draw_settings_dialog(GuiState &gui, EmuEnvState &emuenv) {
         ImGui::SetCursorPosX((ImGui::GetWindowWidth() / 2.f) - (ImGui::CalcTextSize(res_scal.c_str()).x / 2.f) - (35.f * SCALE.x));
         ImGui::Text("%s", res_scal.c_str());
         ImGui::Spacing();
+
+        if (is_vulkan) {
+            ImGui::Checkbox(lang.gpu["dynamic_resolution"].c_str(), &emuenv.cfg.dynamic_resolution);
+            SetTooltipEx(lang.gpu["dynamic_resolution_description"].c_str());
+            if (emuenv.cfg.dynamic_resolution) {
+                ImGui::PushItemWidth(-100.f * SCALE.x);
+                ImGui::SliderInt(lang.gpu["dynamic_resolution_min_scale"].c_str(), &emuenv.cfg.dynamic_resolution_min_scale, 25, 100, "%d%%");
+                ImGui::SliderInt(lang.gpu["dynamic_resolution_target_fps"].c_str(), &emuenv.cfg.dynamic_resolution_target_fps, 20, 120);
+                ImGui::PopItemWidth();
+            }
+            ImGui::Spacing();
+        }
         
         ImGui::Spacing();
         ImGui::Separator();
@@ -1040,7 +1055,6 @@ void draw_settings_dialog(GuiState &gui, EmuEnvState &emuenv) {
         ImGui::Spacing();
         if (!emuenv.io.app_path.empty())
             ImGui::BeginDisabled();
-        static const char *LIST_BACKEND_AUDIO[] = { "SDL", "Cubeb" };
         if (ImGui::Combo(lang.audio["audio_backend"].c_str(), &audio_backend_idx, LIST_BACKEND_AUDIO, IM_ARRAYSIZE(LIST_BACKEND_AUDIO)))
             emuenv.cfg.audio_backend = LIST_BACKEND_AUDIO[audio_backend_idx];
         SetTooltipEx(lang.audio["select_audio_backend"].c_str());
@@ -0,0 +1,209 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#include <gui/apps_cache.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+
+using namespace gui;
+
+namespace {
+
+App make_app(const std::string &path, const std::string &title, time_t param_time) {
+    App app{};
+    app.app_ver = "01.00";
+    app.category = "gd";
+    app.content_id = "EP0000-" + path + "_00-0000000000000000";
+    app.title = title;
+    app.stitle = title.substr(0, 4);
+    app.title_id = path;
+    app.path = path;
+    app.param_time = param_time;
+    return app;
+}
+
+void install_app(const fs::path &apps_dir, const std::string &path, bool with_param = true) {
+    fs::create_directories(apps_dir / path / "sce_sys");
+    if (with_param)
+        std::ofstream((apps_dir / path / "sce_sys/param.sfo").string(), std::ios::binary) << "sfo";
+}
+
+std::set<std::string> paths_of(const std::vector<App> &apps) {
+    std::set<std::string> paths;
+    for (const auto &app : apps)
+        paths.insert(app.path);
+    return paths;
+}
+
+} // namespace
+
+class AppsCacheTest : public testing::Test {
+protected:
+    void SetUp() override {
+        root = fs::temp_directory_path() / fmt::format("vita3k-apps-cache-test-{}", testing::UnitTest::GetInstance()->random_seed());
+        fs::remove_all(root);
+        fs::create_directories(root / "app");
+        cache_path = root / "apps.dat";
+    }
+
+    void TearDown() override {
+        fs::remove_all(root);
+    }
+
+    // read the app like a parse of its param.sfo would
+    App read_app(const std::string &path) {
+        read_paths.push_back(path);
+        return make_app(path, "parsed", get_param_time(root / "app" / path));
+    }
+
+    std::vector<App> scan(std::vector<App> &cached_apps, bool &changed) {
+        std::vector<App> apps;
+        changed = scan_apps(root / "app", cached_apps, apps, [this](const std::string &path) { return read_app(path); });
+        return apps;
+    }
+
+    fs::path root;
+    fs::path cache_path;
+    std::vector<std::string> read_paths;
+};
+
+TEST_F(AppsCacheTest, cache_round_trip) {
+    const std::vector<App> apps = { make_app("PCSE00001", "First", 100), make_app("PCSE00002", "", 0), make_app("PCSB00003", std::string(300, 't'), 300) };
+    ASSERT_TRUE(write_apps_cache(cache_path, 1, apps));
+
+    uint32_t cache_lang = 0;
+    std::vector<App> read;
+    ASSERT_TRUE(read_apps_cache(cache_path, 1, cache_lang, read));
+    ASSERT_EQ(cache_lang, 1);
+    ASSERT_EQ(read.size(), apps.size());
+    for (size_t i = 0; i < apps.size(); i++) {
+        ASSERT_EQ(read[i].app_ver, apps[i].app_ver);
+        ASSERT_EQ(read[i].category, apps[i].category);
+        ASSERT_EQ(read[i].content_id, apps[i].content_id);
+        ASSERT_EQ(read[i].stitle, apps[i].stitle);
+        ASSERT_EQ(read[i].title, apps[i].title);
+        ASSERT_EQ(read[i].title_id, apps[i].title_id);
+        ASSERT_EQ(read[i].path, apps[i].path);
+        ASSERT_EQ(read[i].param_time, apps[i].param_time);
+    }
+}
+
+TEST_F(AppsCacheTest, invalid_caches_are_rejected) {
+    std::vector<App> read;
+    uint32_t cache_lang = 0;
+    ASSERT_FALSE(read_apps_cache(cache_path, 1, cache_lang, read));
+
+    const std::vector<App> apps = { make_app("PCSE00001", "First", 100), make_app("PCSE00002", "Second", 200) };
+    ASSERT_TRUE(write_apps_cache(cache_path, 1, apps));
+
+    // other language
+    ASSERT_FALSE(read_apps_cache(cache_path, 2, cache_lang, read));
+    ASSERT_EQ(cache_lang, 1);
+    ASSERT_TRUE(read.empty());
+
+    // truncated in the last app
+    fs::resize_file(cache_path, fs::file_size(cache_path) - 1);
+    ASSERT_FALSE(read_apps_cache(cache_path, 1, cache_lang, read));
+    ASSERT_TRUE(read.empty());
+
+    // older version, written right after the app count
+    ASSERT_TRUE(write_apps_cache(cache_path, 1, apps));
+    {
+        std::fstream cache(cache_path.string(), std::ios::in | std::ios::out | std::ios::binary);
+        cache.seekp(sizeof(size_t));
+        const uint32_t version = 1;
+        cache.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    }
+    ASSERT_FALSE(read_apps_cache(cache_path, 1, cache_lang, read));
+    ASSERT_TRUE(read.empty());
+}
+
+TEST_F(AppsCacheTest, scan_reads_only_changed_apps) {
+    install_app(root / "app", "PCSE00001");
+    install_app(root / "app", "PCSE00002");
+    install_app(root / "app", "PCSE00003");
+    install_app(root / "app", "PCSE00004", false);
+
+    // PCSE00001 and PCSE00004 (without param.sfo) are up to date, PCSE00002 changed, PCSE00003 is new and PCSE00005 was removed
+    std::vector<App> cached_apps = {
+        make_app("PCSE00001", "cached", get_param_time(root / "app/PCSE00001")),
+        make_app("PCSE00002", "cached", get_param_time(root / "app/PCSE00002") - 10),
+        make_app("PCSE00004", "cached", 0),
+        make_app("PCSE00005", "cached", 100),
+    };
+
+    bool changed = false;
+    auto apps = scan(cached_apps, changed);
+    ASSERT_TRUE(changed);
+    ASSERT_EQ(paths_of(apps), (std::set<std::string>{ "PCSE00001", "PCSE00002", "PCSE00003", "PCSE00004" }));
+    ASSERT_EQ(std::set<std::string>(read_paths.begin(), read_paths.end()), (std::set<std::string>{ "PCSE00002", "PCSE00003" }));
+    for (const auto &app : apps)
+        ASSERT_EQ(app.title, (app.path == "PCSE00001") || (app.path == "PCSE00004") ? "cached" : "parsed");
+
+    // nothing changed since
+    read_paths.clear();
+    std::vector<App> rescanned_cache = apps;
+    apps = scan(rescanned_cache, changed);
+    ASSERT_FALSE(changed);
+    ASSERT_TRUE(read_paths.empty());
+
+    // a removed app only changes the list
+    fs::remove_all(root / "app/PCSE00003");
+    rescanned_cache = apps;
+    apps = scan(rescanned_cache, changed);
+    ASSERT_TRUE(changed);
+    ASSERT_TRUE(read_paths.empty());
+    ASSERT_EQ(paths_of(apps), (std::set<std::string>{ "PCSE00001", "PCSE00002", "PCSE00004" }));
+
+    // an added param.sfo is read
+    install_app(root / "app", "PCSE00004");
+    rescanned_cache = apps;
+    apps = scan(rescanned_cache, changed);
+    ASSERT_TRUE(changed);
+    ASSERT_EQ(read_paths, std::vector<std::string>{ "PCSE00004" });
+}
+
+TEST_F(AppsCacheTest, scan_without_apps_directory) {
+    fs::remove_all(root / "app");
+
+    std::vector<App> cached_apps = { make_app("PCSE00001", "cached", 100) };
+    std::vector<App> apps = { make_app("PCSE00002", "listed", 200) };
+    ASSERT_FALSE(scan_apps(root / "app", cached_apps, apps, [this](const std::string &path) { return read_app(path); }));
+    ASSERT_EQ(paths_of(apps), std::set<std::string>{ "PCSE00002" });
+    ASSERT_TRUE(read_paths.empty());
+}
+
+TEST(apps_cache, find_app_follows_list_changes) {
+    std::vector<App> apps = { make_app("PCSE00003", "C", 0), make_app("PCSE00001", "A", 0), make_app("PCSE00002", "B", 0) };
+    std::unordered_map<std::string, size_t> index;
+
+    ASSERT_EQ(find_app(apps, index, "PCSE00001"), &apps[1]);
+    ASSERT_EQ(index.size(), 3);
+    ASSERT_EQ(find_app(apps, index, "PCSE00004"), nullptr);
+
+    std::sort(apps.begin(), apps.end(), [](const App &a, const App &b) { return a.path < b.path; });
+    ASSERT_EQ(find_app(apps, index, "PCSE00003"), &apps[2]);
+    ASSERT_EQ(find_app(apps, index, "PCSE00001"), &apps[0]);
+
+    apps.erase(apps.begin());
+    ASSERT_EQ(find_app(apps, index, "PCSE00001"), nullptr);
+    ASSERT_EQ(find_app(apps, index, "PCSE00002"), &apps[0]);
+    ASSERT_EQ(find_app(apps, index, "PCSE00003"), &apps[1]);
+}
@@ -37,6 +37,8 @@
 #include <packages/sfo.h>
 #include <renderer/state.h>
 #include <renderer/texture_cache.h>
+#include <replay/functions.h>
+#include <rtc/clock.h>
 
 #include <modules/module_parent.h>
 #include <string>
@@ -411,6 +413,15 @@ static ExitCode load_app_impl(SceUID &main_module_id, EmuEnvState &emuenv) {
     const auto call_import = [&emuenv](CPUState &cpu, uint32_t nid, SceUID thread_id) {
         ::call_import(emuenv, cpu, nid, thread_id);
     };
+    // set before the kernel takes its start tick so that it is read from the same clock
+    const GuestClockMode clock_mode = parse_guest_clock_mode(emuenv.cfg.guest_clock_mode);
+    get_guest_clock().set_mode(clock_mode, emuenv.cfg.guest_clock_speed);
+    if (clock_mode != GuestClockMode::REAL_TIME)
+        LOG_INFO("Guest clock: {} at {}x speed", emuenv.cfg.guest_clock_mode, emuenv.cfg.guest_clock_speed);
+
+    if (!init_replay(emuenv.replay, emuenv.cfg, emuenv.io.title_id))
+        return FileNotFound;
+
     if (!emuenv.kernel.init(emuenv.mem, call_import, emuenv.kernel.cpu_backend, emuenv.kernel.cpu_opt)) {
         LOG_WARN("Failed to init kernel!");
         return KernelInitFailed;
@@ -551,8 +562,14 @@ static void take_screenshot(EmuEnvState &emuenv) {
         return;
     }
 
+    DisplayFrameInfo frame_info;
+    {
+        std::lock_guard<std::mutex> guard(emuenv.display.display_info_mutex);
+        frame_info = emuenv.display.next_rendered_frame;
+    }
+
     uint32_t width, height;
-    std::vector<uint32_t> frame = emuenv.renderer->dump_frame(emuenv.display, width, height);
+    std::vector<uint32_t> frame = emuenv.renderer->dump_frame(frame_info, width, height);
 
     if (frame.empty() || frame.size() != width * height) {
         LOG_ERROR("Failed to take screenshot");
@@ -593,7 +610,11 @@ static void take_screenshot(EmuEnvState &emuenv) {
 }
 
 bool handle_events(EmuEnvState &emuenv, GuiState &gui) {
-    refresh_controllers(emuenv.ctrl, emuenv);
+    {
+        // the sampling thread reads the controller list concurrently
+        std::lock_guard<std::mutex> guard(emuenv.ctrl.mutex);
+        refresh_controllers(emuenv.ctrl, emuenv);
+    }
     const auto allow_switch_state = !emuenv.io.title_id.empty() && !gui.vita_area.app_close && !gui.vita_area.home_screen && !gui.vita_area.user_management && !gui.configuration_menu.custom_settings_dialog && !gui.configuration_menu.settings_dialog && !gui.controls_menu.controls_dialog && gui::get_sys_apps_state(gui);
 
     const auto ui_navigation = [&emuenv, &gui, allow_switch_state](const uint32_t sce_ctrl_btn) {
@@ -825,6 +846,9 @@ bool handle_events(EmuEnvState &emuenv, GuiState &gui) {
         }
     }
 
+    // the events are pumped, hand the pad state to the sampling thread
+    poll_ctrl(emuenv);
+
     return true;
 }
 
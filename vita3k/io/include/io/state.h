@@ -21,8 +21,10 @@
 #include <io/types.h>
 #include <io/util.h>
 
+#include <algorithm>
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 // Class for all needed information to access files on Vita3K.
 class FileStats : public VitaStats {
@@ -68,14 +70,23 @@ public:
     SceOff tell() const;
 };
 
-// Class for implementing Directory structure; path names are wide for Windows, normal for else
+struct DirEntry {
+    std::string name;
+    SceIoStat stat;
+    // Changed by the emulator since it was stat
+    bool changed = false;
+};
+
+// Class for implementing Directory structure.
+// The entries and their stats are read in one pass when the directory is opened
 class DirStats : public VitaStats {
-    // Shared directory pointer
-    DirPtr dir_ptr;
+    std::vector<DirEntry> entries;
+    size_t next_entry = 0;
+    bool has_changed_entries = false;
 
 public:
-    DirStats(const char *vita, const std::string &t, const fs::path &file, DirPtr ptr) {
-        dir_ptr = std::move(ptr);
+    DirStats(const char *vita, const std::string &t, const fs::path &file, std::vector<DirEntry> &&dir_entries) {
+        entries = std::move(dir_entries);
 
         file_info.vita_loc = vita;
         file_info.translated = t;
@@ -85,8 +96,42 @@ public:
         file_info.access_mode = SCE_S_IFDIR | SCE_S_IRUSR;
     }
 
-    auto get_dir_ptr() const {
-        return get_system_dir_ptr(dir_ptr);
+    // Return nullptr once all the entries have been read
+    DirEntry *get_next_entry() {
+        return next_entry < entries.size() ? &entries[next_entry++] : nullptr;
+    }
+
+    // Mark the entry with this name to be stat again if it was not read yet
+    void invalidate_entry(const std::string &name) {
+        const auto entry = std::find_if(entries.begin() + next_entry, entries.end(), [&](const DirEntry &entry) { return entry.name == name; });
+        if (entry != entries.end()) {
+            entry->changed = true;
+            has_changed_entries = true;
+        }
+    }
+
+    // Mark all the entries not read yet to be stat again
+    void invalidate_entries() {
+        for (auto entry = entries.begin() + next_entry; entry != entries.end(); ++entry)
+            entry->changed = true;
+        has_changed_entries = next_entry < entries.size();
+    }
+
+    bool needs_refresh() const {
+        return has_changed_entries;
+    }
+
+    // Stat again the changed entries not read yet and drop the ones stat_entry fails on
+    template <typename StatEntry>
+    void refresh(StatEntry stat_entry) {
+        const auto removed = std::remove_if(entries.begin() + next_entry, entries.end(), [&](DirEntry &entry) {
+            if (!entry.changed)
+                return false;
+            entry.changed = false;
+            return !stat_entry(entry);
+        });
+        entries.erase(removed, entries.end());
+        has_changed_entries = false;
     }
 
     bool is_directory() const {
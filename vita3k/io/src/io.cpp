@@ -32,17 +32,21 @@
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 #else
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #endif
 
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <iterator>
 #include <string>
 
-#if defined(__aarch64__) && defined(__APPLE__)
+#if defined(__APPLE__)
+// the stat functions always use 64-bit offsets on macOS
 #define stat64 stat
+#define fstatat64 fstatat
 #endif
 
 // ****************************
@@ -277,6 +281,28 @@ fs::path expand_path(IOState &io, const char *path, const fs::path &pref_path) {
     return device::construct_emulated_path(device, translated_path, pref_path, io.redirect_stdio).string();
 }
 
+// Mark for a new stat the entries of the open directories that a change to the host path affects.
+// tree_changed is set when the path was created, removed or renamed: the write time of its parent
+// changed too and the open directories inside it may have lost their entries
+static void invalidate_dir_entries(IOState &io, const fs::path &path, const bool tree_changed) {
+    if (io.dir_entries.empty())
+        return;
+
+    const fs::path changed = fs::path(path).remove_trailing_separator();
+    const fs::path parent = changed.parent_path();
+    const std::string changed_prefix = changed.generic_path().string() + '/';
+    for (auto &[fd, dir] : io.dir_entries) {
+        // directories are opened with a trailing separator
+        const fs::path dir_path = fs::path(dir.get_system_location()).remove_trailing_separator();
+        if (dir_path == parent)
+            dir.invalidate_entry(changed.filename().string());
+        else if (tree_changed && (dir_path == parent.parent_path()))
+            dir.invalidate_entry(parent.filename().string());
+        else if (tree_changed && (dir_path.generic_path().string() + '/').starts_with(changed_prefix))
+            dir.invalidate_entries();
+    }
+}
+
 SceUID open_file(IOState &io, const char *path, const int flags, const fs::path &pref_path, const char *export_name) {
     auto device = device::get_device(path);
     auto device_for_icase = device;
@@ -350,6 +376,8 @@ SceUID open_file(IOState &io, const char *path, const int flags, const fs::path
     FileStats f{ path, normalized_path, system_path, flags };
     const auto fd = io.next_fd++;
     io.std_files.emplace(fd, f);
+    if (can_write(flags))
+        invalidate_dir_entries(io, system_path, true);
 
     LOG_TRACE_IF(log_file_op, "{}: Opening file {} ({}), fd: {}", export_name, path, normalized_path, log_hex(fd));
     return fd;
@@ -379,7 +407,7 @@ int read_file(void *data, IOState &io, const SceUID fd, const SceSize size, cons
     return IO_ERROR(SCE_ERROR_ERRNO_EBADFD);
 }
 
-int write_file(SceUID fd, const void *data, const SceSize size, const IOState &io, const char *export_name) {
+int write_file(SceUID fd, const void *data, const SceSize size, IOState &io, const char *export_name) {
     assert(data != nullptr);
     assert(size >= 0);
 
@@ -417,6 +445,8 @@ int write_file(SceUID fd, const void *data, const SceSize size, const IOState &i
 
     if (file->second.can_write_file()) {
         const auto written = file->second.write(data, 1, size);
+        if (written > 0)
+            invalidate_dir_entries(io, file->second.get_system_location(), false);
         LOG_TRACE_IF(log_file_op, "{}: Writing to fd: {}, size: {}", export_name, log_hex(fd), size);
         return static_cast<int>(written);
     }
@@ -424,7 +454,7 @@ int write_file(SceUID fd, const void *data, const SceSize size, const IOState &i
     return IO_ERROR(SCE_ERROR_ERRNO_EBADFD);
 }
 
-int truncate_file(const SceUID fd, unsigned long long length, const IOState &io, const char *export_name) {
+int truncate_file(const SceUID fd, unsigned long long length, IOState &io, const char *export_name) {
     if (fd < 0)
         return IO_ERROR(SCE_ERROR_ERRNO_EBADFD);
 
@@ -432,6 +462,8 @@ int truncate_file(const SceUID fd, unsigned long long length, const IOState &io,
     if (file == io.std_files.end())
         return IO_ERROR(SCE_ERROR_ERRNO_EBADFD);
     auto trunc = file->second.truncate(length);
+    if (trunc == 0)
+        invalidate_dir_entries(io, file->second.get_system_location(), false);
     LOG_TRACE_IF(log_file_op, "{}: Truncating fd: {}, to size: {}", export_name, log_hex(fd), length);
     return trunc;
 }
@@ -476,6 +508,99 @@ SceOff tell_file(IOState &io, const SceUID fd, const char *export_name) {
     return std_file->second.tell();
 }
 
+#ifdef _WIN32
+typedef struct _stati64 HostStat;
+#else
+typedef struct stat64 HostStat;
+#endif
+
+static void host_stat_to_sce(const HostStat &sb, SceIoStat *statp) {
+    const std::uint64_t last_access_time_ticks = (uint64_t)sb.st_atime * VITA_CLOCKS_PER_SEC;
+    const std::uint64_t creation_time_ticks = (uint64_t)sb.st_ctime * VITA_CLOCKS_PER_SEC;
+    const std::uint64_t last_modification_time_ticks = (uint64_t)sb.st_mtime * VITA_CLOCKS_PER_SEC;
+
+#ifndef WIN32
+#undef st_atime
+#undef st_mtime
+#undef st_ctime
+#endif
+
+    statp->st_mode = SCE_S_IRUSR | SCE_S_IRGRP | SCE_S_IROTH | SCE_S_IXUSR | SCE_S_IXGRP | SCE_S_IXOTH;
+
+    if ((sb.st_mode & S_IFMT) == S_IFREG) {
+        statp->st_size = sb.st_size;
+        statp->st_attr = SCE_SO_IFREG;
+        statp->st_mode |= SCE_S_IFREG;
+    }
+    if ((sb.st_mode & S_IFMT) == S_IFDIR) {
+        statp->st_attr = SCE_SO_IFDIR;
+        statp->st_mode |= SCE_S_IFDIR;
+    }
+
+    __RtcTicksToPspTime(&statp->st_atime, last_access_time_ticks);
+    __RtcTicksToPspTime(&statp->st_mtime, last_modification_time_ticks);
+    __RtcTicksToPspTime(&statp->st_ctime, creation_time_ticks);
+}
+
+static int stat_host_file(const fs::path &path, SceIoStat *statp) {
+    HostStat sb;
+#ifdef _WIN32
+    if (_wstati64(path.generic_path().wstring().c_str(), &sb) < 0)
+        return -1;
+#else
+    if (stat64(path.generic_path().string().c_str(), &sb) < 0)
+        return -1;
+#endif
+
+    host_stat_to_sce(sb, statp);
+    return 0;
+}
+
+// Read the entries of a directory with their stats in a single pass
+static bool read_dir_entries(const fs::path &dir_path, std::vector<DirEntry> &entries) {
+#ifdef _WIN32
+    const DirPtr dir = create_shared_dir(dir_path);
+    if (!dir)
+        return false;
+
+    while (const auto d = get_system_dir_ptr(dir)) {
+        DirEntry entry{ get_file_in_dir(d), {} };
+        if (entry.name == "." || entry.name == "..")
+            continue;
+
+        // the file may have been removed in the meantime
+        if (stat_host_file(dir_path / entry.name, &entry.stat) == 0)
+            entries.push_back(std::move(entry));
+    }
+#else
+    // the entries are stat relative to the directory, the host path is only resolved once
+    const int dir_fd = open(dir_path.generic_path().string().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0)
+        return false;
+
+    // readdir fills its buffer with large getdents calls
+    const std::shared_ptr<DIR> dir(fdopendir(dir_fd), closedir);
+    if (!dir) {
+        close(dir_fd);
+        return false;
+    }
+
+    while (const dirent *d = readdir(dir.get())) {
+        if (!strcmp(d->d_name, ".") || !strcmp(d->d_name, ".."))
+            continue;
+
+        HostStat sb;
+        if (fstatat64(dir_fd, d->d_name, &sb, 0) < 0)
+            continue;
+
+        DirEntry &entry = entries.emplace_back(DirEntry{ d->d_name, {} });
+        host_stat_to_sce(sb, &entry.stat);
+    }
+#endif
+
+    return true;
+}
+
 int stat_file(IOState &io, const char *file, SceIoStat *statp, const fs::path &pref_path, const char *export_name, const SceUID fd) {
     assert(statp != nullptr);
 
@@ -528,45 +653,8 @@ int stat_file(IOState &io, const char *file, SceIoStat *statp, const fs::path &p
         statp->st_attr = fd_file->second.get_file_mode();
     }
 
-    std::uint64_t last_access_time_ticks;
-    std::uint64_t creation_time_ticks;
-    std::uint64_t last_modification_time_ticks;
-
-#ifdef _WIN32
-    struct _stati64 sb;
-    if (_wstati64(file_path.generic_path().wstring().c_str(), &sb) < 0)
+    if (stat_host_file(file_path, statp) < 0)
         return IO_ERROR_UNK();
-#else
-    struct stat64 sb;
-    if (stat64(file_path.generic_path().string().c_str(), &sb) < 0)
-        return IO_ERROR_UNK();
-#endif
-
-    last_access_time_ticks = (uint64_t)sb.st_atime * VITA_CLOCKS_PER_SEC;
-    creation_time_ticks = (uint64_t)sb.st_ctime * VITA_CLOCKS_PER_SEC;
-    last_modification_time_ticks = (uint64_t)sb.st_mtime * VITA_CLOCKS_PER_SEC;
-
-#ifndef WIN32
-#undef st_atime
-#undef st_mtime
-#undef st_ctime
-#endif
-
-    statp->st_mode = SCE_S_IRUSR | SCE_S_IRGRP | SCE_S_IROTH | SCE_S_IXUSR | SCE_S_IXGRP | SCE_S_IXOTH;
-
-    if (fs::is_regular_file(file_path)) {
-        statp->st_size = fs::file_size(file_path);
-        statp->st_attr = SCE_SO_IFREG;
-        statp->st_mode |= SCE_S_IFREG;
-    }
-    if (fs::is_directory(file_path)) {
-        statp->st_attr = SCE_SO_IFDIR;
-        statp->st_mode |= SCE_S_IFDIR;
-    }
-
-    __RtcTicksToPspTime(&statp->st_atime, last_access_time_ticks);
-    __RtcTicksToPspTime(&statp->st_mtime, last_modification_time_ticks);
-    __RtcTicksToPspTime(&statp->st_ctime, creation_time_ticks);
 
     return 0;
 }
@@ -624,6 +712,7 @@ int remove_file(IOState &io, const char *file, const fs::path &pref_path, const
         return IO_ERROR(SCE_ERROR_ERRNO_ENOENT);
     }
 
+    invalidate_dir_entries(io, emulated_path, true);
     return 0;
 }
 
@@ -665,6 +754,8 @@ int rename(IOState &io, const char *old_name, const char *new_name, const fs::pa
         return IO_ERROR(SCE_ERROR_ERRNO_ENOENT);
     }
 
+    invalidate_dir_entries(io, emulated_old_path, true);
+    invalidate_dir_entries(io, emulated_new_path, true);
     return 0;
 }
 
@@ -698,16 +789,15 @@ SceUID open_dir(IOState &io, const char *path, const fs::path &pref_path, const
         }
     }
 
-    const DirPtr opened = create_shared_dir(dir_path);
-    if (!opened) {
+    std::vector<DirEntry> entries;
+    if (!read_dir_entries(dir_path, entries)) {
         LOG_ERROR("Failed to open directory at: {} (target path: {})", dir_path, path);
         return IO_ERROR(SCE_ERROR_ERRNO_ENOENT);
     }
 
     const auto normalized = device::construct_normalized_path(device, translated_path);
-    const DirStats d{ path, normalized, dir_path, opened };
     const auto fd = io.next_fd++;
-    io.dir_entries.emplace(fd, d);
+    io.dir_entries.emplace(fd, DirStats{ path, normalized, dir_path, std::move(entries) });
 
     LOG_TRACE_IF(log_file_op, "{}: Opening dir {} ({}), fd: {}", export_name, path, normalized, log_hex(fd));
 
@@ -726,24 +816,24 @@ SceUID read_dir(IOState &io, const SceUID fd, SceIoDirent *dent, const fs::path
         if (!dir->second.is_directory())
             return IO_ERROR(SCE_ERROR_ERRNO_EBADFD);
 
-        const auto d = dir->second.get_dir_ptr();
-        if (!d)
-            return 0;
-
-        const auto d_name_utf8 = get_file_in_dir(d);
-        strncpy(dent->d_name, d_name_utf8.c_str(), sizeof(dent->d_name));
+        // files changed by the emulator since the directory was read are stat again, removed ones are skipped
+        if (dir->second.needs_refresh()) {
+            const fs::path &dir_path = dir->second.get_system_location();
+            dir->second.refresh([&](DirEntry &entry) {
+                entry.stat = {};
+                return stat_host_file(dir_path / entry.name, &entry.stat) >= 0;
+            });
+        }
 
-        const auto cur_path = dir->second.get_system_location() / d_name_utf8;
-        if (!(cur_path.filename_is_dot() || cur_path.filename_is_dot_dot())) {
-            const auto file_path = std::string(dir->second.get_vita_loc()) + '/' + d_name_utf8;
+        if (DirEntry *entry = dir->second.get_next_entry()) {
+            strncpy(dent->d_name, entry->name.c_str(), sizeof(dent->d_name) - 1);
+            dent->d_stat = entry->stat;
 
-            LOG_TRACE_IF(log_file_op, "{}: Reading entry {} of fd: {}", export_name, file_path, log_hex(fd));
-            if (stat_file(io, file_path.c_str(), &dent->d_stat, pref_path, export_name) < 0)
-                return IO_ERROR(SCE_ERROR_ERRNO_EMFILE);
-            else
-                return 1; // move to the next file
+            LOG_TRACE_IF(log_file_op, "{}: Reading entry {}/{} of fd: {}", export_name, dir->second.get_vita_loc(), entry->name, log_hex(fd));
+            return 1; // move to the next file
         }
-        return read_dir(io, fd, dent, pref_path, export_name);
+
+        return 0;
     }
 
     return IO_ERROR(SCE_ERROR_ERRNO_EBADFD);
@@ -795,8 +885,17 @@ int create_dir(IOState &io, const char *dir, int mode, const fs::path &pref_path
     }
 
     const auto emulated_path = device::construct_emulated_path(device, translated_path, pref_path, io.redirect_stdio);
-    if (recursive)
-        return fs::create_directories(emulated_path);
+    if (recursive) {
+        // the first directory created is the only one that can be listed already
+        fs::path first_created = fs::path(emulated_path).remove_trailing_separator();
+        while (first_created.has_parent_path() && !fs::exists(first_created.parent_path()))
+            first_created = first_created.parent_path();
+
+        const bool created = fs::create_directories(emulated_path);
+        if (created)
+            invalidate_dir_entries(io, first_created, true);
+        return created;
+    }
     if (fs::exists(emulated_path))
         return IO_ERROR(SCE_ERROR_ERRNO_EEXIST);
 
@@ -811,6 +910,7 @@ int create_dir(IOState &io, const char *dir, int mode, const fs::path &pref_path
         return IO_ERROR(SCE_ERROR_ERRNO_ENOENT);
     }
 
+    invalidate_dir_entries(io, emulated_path, true);
     return 0;
 }
 
@@ -843,11 +943,13 @@ int remove_dir(IOState &io, const char *dir, const fs::path &pref_path, const ch
 
     LOG_TRACE_IF(log_file_op, "{}: Removing dir {} ({})", export_name, dir, device::construct_normalized_path(device, translated_path));
 
-    if (!fs::remove_all(device::construct_emulated_path(device, translated_path, pref_path, io.redirect_stdio))) {
+    const auto emulated_path = device::construct_emulated_path(device, translated_path, pref_path, io.redirect_stdio);
+    if (!fs::remove_all(emulated_path)) {
         LOG_ERROR("Cannot remove dir: {} ({})", dir, device::construct_normalized_path(device, translated_path));
         return IO_ERROR(SCE_ERROR_ERRNO_ENOENT);
     }
 
+    invalidate_dir_entries(io, emulated_path, true);
     return 0;
 }
 
@@ -0,0 +1,168 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <io/functions.h>
+#include <io/state.h>
+#include <testutil/benchmark.h>
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <map>
+#include <string>
+
+class IoDirTest : public testing::Test {
+protected:
+    void SetUp() override {
+        pref_path = fs::temp_directory_path() / fs::unique_path("vita3k-io-test-%%%%-%%%%");
+        dir_path = pref_path / "ux0" / "data" / "dirtest";
+        fs::create_directories(dir_path);
+    }
+
+    void TearDown() override {
+        fs::remove_all(pref_path);
+    }
+
+    void create_file(const std::string &name, const size_t size) {
+        std::ofstream file((dir_path / name).string(), std::ios::binary);
+        file << std::string(size, 'a');
+    }
+
+    // name -> stat of every entry of the directory
+    std::map<std::string, SceIoStat> list_dir() {
+        std::map<std::string, SceIoStat> entries;
+        const SceUID fd = open_dir(io, "ux0:data/dirtest", pref_path, "test");
+        EXPECT_GE(fd, 0);
+
+        SceIoDirent dent;
+        while (read_dir(io, fd, &dent, pref_path, "test") > 0)
+            entries.emplace(dent.d_name, dent.d_stat);
+
+        EXPECT_EQ(close_dir(io, fd, "test"), 0);
+        return entries;
+    }
+
+    IOState io;
+    fs::path pref_path;
+    fs::path dir_path;
+};
+
+TEST_F(IoDirTest, lists_entries_with_stats) {
+    create_file("a.bin", 10);
+    create_file("b.bin", 2000);
+    fs::create_directory(dir_path / "sub");
+
+    const auto entries = list_dir();
+    ASSERT_EQ(entries.size(), 3);
+    EXPECT_EQ(entries.at("a.bin").st_size, 10);
+    EXPECT_EQ(entries.at("a.bin").st_attr, SCE_SO_IFREG);
+    EXPECT_EQ(entries.at("b.bin").st_size, 2000);
+    EXPECT_EQ(entries.at("sub").st_attr, SCE_SO_IFDIR);
+    EXPECT_TRUE(entries.at("sub").st_mode & SCE_S_IFDIR);
+
+    // same result as stat
+    SceIoStat stat;
+    ASSERT_EQ(stat_file(io, "ux0:data/dirtest/b.bin", &stat, pref_path, "test"), 0);
+    EXPECT_EQ(memcmp(&stat, &entries.at("b.bin"), sizeof(stat)), 0);
+}
+
+TEST_F(IoDirTest, sees_emulator_writes_while_open) {
+    create_file("a.bin", 10);
+    create_file("b.bin", 10);
+
+    const SceUID dir_fd = open_dir(io, "ux0:data/dirtest", pref_path, "test");
+    ASSERT_GE(dir_fd, 0);
+
+    // change both files after the directory was read
+    ASSERT_EQ(remove_file(io, "ux0:data/dirtest/a.bin", pref_path, "test"), 0);
+    const SceUID fd = open_file(io, "ux0:data/dirtest/b.bin", SCE_O_WRONLY | SCE_O_APPEND, pref_path, "test");
+    ASSERT_GE(fd, 0);
+    const std::string data(100, 'b');
+    ASSERT_EQ(write_file(fd, data.data(), data.size(), io, "test"), 100);
+    close_file(io, fd, "test");
+
+    SceIoDirent dent;
+    ASSERT_EQ(read_dir(io, dir_fd, &dent, pref_path, "test"), 1);
+    EXPECT_STREQ(dent.d_name, "b.bin");
+    EXPECT_EQ(dent.d_stat.st_size, 110);
+    ASSERT_EQ(read_dir(io, dir_fd, &dent, pref_path, "test"), 0);
+    EXPECT_EQ(close_dir(io, dir_fd, "test"), 0);
+}
+
+TEST_F(IoDirTest, failed_changes_keep_the_entries) {
+    create_file("a.bin", 10);
+
+    const SceUID dir_fd = open_dir(io, "ux0:data/dirtest", pref_path, "test");
+    ASSERT_GE(dir_fd, 0);
+    const DirStats &dir = io.dir_entries.at(dir_fd);
+
+    EXPECT_LT(remove_file(io, "ux0:data/dirtest/missing.bin", pref_path, "test"), 0);
+    EXPECT_LT(create_dir(io, "ux0:data/dirtest", 0, pref_path, "test", false), 0);
+    EXPECT_LT(rename(io, "ux0:data/dirtest/missing.bin", "ux0:data/dirtest/b.bin", pref_path, "test"), 0);
+    EXPECT_FALSE(dir.needs_refresh());
+
+    ASSERT_EQ(create_dir(io, "ux0:data/dirtest/sub", 0, pref_path, "test", false), 0);
+    EXPECT_EQ(close_dir(io, dir_fd, "test"), 0);
+    EXPECT_EQ(list_dir().size(), 2);
+}
+
+TEST_F(IoDirTest, only_changes_to_listed_entries_refresh) {
+    create_file("a.bin", 10);
+    create_file("b.bin", 10);
+    fs::create_directories(pref_path / "ux0" / "data" / "other");
+
+    const SceUID dir_fd = open_dir(io, "ux0:data/dirtest", pref_path, "test");
+    ASSERT_GE(dir_fd, 0);
+    DirStats &dir = io.dir_entries.at(dir_fd);
+
+    // files of other directories are not listed
+    const SceUID other_fd = open_file(io, "ux0:data/other/c.bin", SCE_O_WRONLY | SCE_O_CREAT, pref_path, "test");
+    ASSERT_GE(other_fd, 0);
+    ASSERT_EQ(write_file(other_fd, "c", 1, io, "test"), 1);
+    close_file(io, other_fd, "test");
+    EXPECT_FALSE(dir.needs_refresh());
+
+    // directories created after the listing was read are not part of it
+    ASSERT_EQ(create_dir(io, "ux0:data/dirtest/sub/deep", 0, pref_path, "test", true), 1);
+    EXPECT_FALSE(dir.needs_refresh());
+
+    const SceUID fd = open_file(io, "ux0:data/dirtest/b.bin", SCE_O_WRONLY | SCE_O_APPEND, pref_path, "test");
+    ASSERT_GE(fd, 0);
+    EXPECT_TRUE(dir.needs_refresh());
+    close_file(io, fd, "test");
+
+    // only b.bin is stat again
+    int stat_count = 0;
+    dir.refresh([&](DirEntry &entry) {
+        EXPECT_EQ(entry.name, "b.bin");
+        stat_count++;
+        return true;
+    });
+    EXPECT_EQ(stat_count, 1);
+    EXPECT_FALSE(dir.needs_refresh());
+    EXPECT_EQ(close_dir(io, dir_fd, "test"), 0);
+}
+
+BENCHMARK_TEST_F(IoDirTest, list) {
+    constexpr int file_count = 10000;
+    for (int i = 0; i < file_count; i++)
+        create_file("file" + std::to_string(i), i % 100);
+
+    std::map<std::string, SceIoStat> entries;
+    testutil::measure("list", [&] { entries = list_dir(); });
+    ASSERT_EQ(entries.size(), file_count);
+}
@@ -29,6 +29,7 @@ struct CPUProtocol : public CPUProtocolBase {
     ~CPUProtocol() override = default;
     void call_svc(CPUState &cpu, uint32_t svc, Address pc, ThreadState &thread) override;
     Address get_watch_memory_addr(Address addr) override;
+    JitInvalidationQueue *get_jit_invalidation_queue() override;
 #ifdef USE_DYNARMIC
     ExclusiveMonitorPtr get_exclusive_monitor() override;
 #endif
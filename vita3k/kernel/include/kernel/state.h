@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <cpu/invalidation_queue.h>
 #include <kernel/callback.h>
 #include <kernel/cpu_protocol.h>
 #include <kernel/debugger.h>
@@ -31,6 +32,7 @@
 #include <util/types.h>
 
 #include <atomic>
+#include <functional>
 #include <map>
 #include <mutex>
 #include <vector>
@@ -60,6 +62,7 @@ typedef unordered_map_fast<uint32_t, Address> ExportNids;
 
 typedef std::map<Address, uint32_t> NotFoundVars;
 typedef std::unique_ptr<CPUProtocol> CPUProtocolPtr;
+typedef std::function<void(SceUID)> ThreadExitHandler;
 
 struct CodecEngineBlock {
     uint32_t size;
@@ -140,6 +143,7 @@ struct KernelState {
 #ifdef USE_DYNARMIC
     ExclusiveMonitorPtr exclusive_monitor;
 #endif
+    JitInvalidationQueue jit_invalidation_queue;
 
     ObjectStore obj_store;
 
@@ -162,6 +166,9 @@ struct KernelState {
     Ptr<Ptr<void>> get_thread_tls_addr(MemState &mem, SceUID thread_id, int key);
 
     void exit_delete_all_threads();
+    // handler is called with the id of every guest thread which exits from now on, from its host thread
+    void add_thread_exit_handler(ThreadExitHandler handler);
+    void run_thread_exit_handlers(SceUID thread_id);
     bool is_threads_paused() { return !paused_threads_status.empty(); }
     void pause_threads();
     void resume_threads();
@@ -173,4 +180,7 @@ struct KernelState {
 private:
     std::atomic<SceUID> next_uid{ 1 };
     std::map<SceUID, ThreadStatus> paused_threads_status;
+    // not protected by mutex, the handlers may need to look up threads
+    std::mutex thread_exit_handlers_mutex;
+    std::vector<ThreadExitHandler> thread_exit_handlers;
 };
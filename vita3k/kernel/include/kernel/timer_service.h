@@ -0,0 +1,145 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief Single host thread expiring the guest delays and wait timeouts
+ *
+ * Timers are kept in a hierarchical timer wheel. The service thread sleeps until shortly
+ * before the next expiry and spins the rest, so guest threads are woken up on time
+ * instead of paying the host timer slack on each of their own timed waits.
+ * The service thread never takes the locks of the waiting threads, a timed out wait is
+ * posted to its condition variable until the waiting thread takes it.
+ */
+class TimerService {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = uint64_t;
+
+    TimerService();
+    ~TimerService();
+
+    /**
+     * @brief Run callback on the service thread once deadline is reached
+     *
+     * The callback must be short, it delays the expiry of the other timers.
+     */
+    TimerId add(Clock::time_point deadline, std::function<void()> &&callback);
+
+    /**
+     * @brief Remove a timer
+     *
+     * @return false if the callback already ran or is running
+     */
+    bool cancel(TimerId id);
+
+    /**
+     * @brief Block the calling thread until deadline
+     *
+     * The thread is woken up ahead of the deadline by the wake up latency measured on the previous sleeps
+     * and spins the rest.
+     */
+    void sleep_until(Clock::time_point deadline);
+
+    /**
+     * @brief Replacement for cond.wait_until(lock, deadline, pred) expired by the service
+     *
+     * cond must be notified with lock's mutex held or with pred becoming true, like with wait_until.
+     * @return The value of pred on return
+     */
+    template <typename Predicate>
+    bool wait_until(std::condition_variable &cond, std::unique_lock<std::mutex> &lock, Clock::time_point deadline, Predicate pred) {
+        if (deadline == Clock::time_point::max()) {
+            cond.wait(lock, pred);
+            return true;
+        }
+        if (pred())
+            return true;
+
+        std::atomic<bool> expired = false;
+        const TimerId id = add_wakeup(deadline, cond, expired);
+        cond.wait(lock, [&] { return expired.load(std::memory_order_acquire) || pred(); });
+
+        // stop the wake up, it is posted again until then
+        cancel(id);
+
+        return pred();
+    }
+
+    template <typename Predicate>
+    bool wait_for(std::condition_variable &cond, std::unique_lock<std::mutex> &lock, std::chrono::microseconds timeout, Predicate pred) {
+        return wait_until(cond, lock, deadline_after(timeout), pred);
+    }
+
+    // Clamped to Clock::time_point::max(), guest timeouts can be close to the maximum value
+    static Clock::time_point deadline_after(std::chrono::microseconds timeout);
+
+private:
+    static constexpr uint32_t WHEEL_BITS = 6;
+    static constexpr uint32_t WHEEL_SIZE = 1 << WHEEL_BITS;
+    static constexpr uint32_t WHEEL_LEVELS = 4;
+
+    struct Timer {
+        TimerId id;
+        Clock::time_point deadline;
+        uint64_t tick;
+        std::function<void()> callback;
+        // set for the wake up of a wait_until, posted on the service thread until cancelled
+        std::condition_variable *cond = nullptr;
+        std::atomic<bool> *expired = nullptr;
+    };
+
+    TimerId add_wakeup(Clock::time_point deadline, std::condition_variable &cond, std::atomic<bool> &expired);
+    TimerId add_timer(Timer &&timer);
+    uint64_t get_tick(Clock::time_point time) const;
+    void insert(Timer &&timer);
+    void advance(uint64_t now_tick);
+    Clock::time_point get_next_expiry();
+    void run();
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    Clock::time_point epoch;
+    uint64_t current_tick = 0;
+    // wheel[level][slot], a slot of a level spans a full turn of the level below
+    std::array<std::array<std::vector<Timer>, WHEEL_SIZE>, WHEEL_LEVELS> wheel;
+    std::array<uint64_t, WHEEL_LEVELS> occupied_slots = {};
+    // timers of the current tick, expired on their exact deadline
+    std::vector<Timer> due;
+    // timers neither expired nor cancelled, cancelled timers are dropped when their slot is reached
+    std::unordered_set<TimerId> pending;
+    TimerId next_id = 1;
+    Clock::time_point next_wake = Clock::time_point::max();
+    // how late sleep_until returns from its wait, in nanoseconds
+    std::atomic<int64_t> wake_latency;
+    bool exiting = false;
+    std::thread thread;
+};
+
+TimerService &get_timer_service();
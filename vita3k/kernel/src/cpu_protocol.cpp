@@ -59,12 +59,18 @@ void CPUProtocol::call_svc(CPUState &cpu, uint32_t svc, Address pc, ThreadState
     // ARM recommends clearing exclusive state inside interrupt handler
     clear_exclusive(kernel->exclusive_monitor, get_processor_id(cpu));
 #endif
+    // the JIT keeps its own reservation when it ignores the global monitor
+    clear_exclusive(cpu);
 }
 
 Address CPUProtocol::get_watch_memory_addr(Address addr) {
     return kernel->debugger.get_watch_memory_addr(addr);
 }
 
+JitInvalidationQueue *CPUProtocol::get_jit_invalidation_queue() {
+    return &kernel->jit_invalidation_queue;
+}
+
 #ifdef USE_DYNARMIC
 ExclusiveMonitorPtr CPUProtocol::get_exclusive_monitor() {
     return kernel->exclusive_monitor;
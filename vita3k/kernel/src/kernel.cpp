@@ -71,6 +71,8 @@ static int SDLCALL thread_function(void *data) {
     thread->run_loop();
     const uint32_t r0 = read_reg(*thread->cpu, 0);
 
+    params.kernel->run_thread_exit_handlers(thread->id);
+
     std::lock_guard<std::mutex> lock(params.kernel->mutex);
     params.kernel->threads.erase(thread->id);
     params.kernel->corenum_allocator.free_corenum(get_processor_id(*thread->cpu));
@@ -122,10 +124,8 @@ void KernelState::set_memory_watch(bool enabled) {
 }
 
 void KernelState::invalidate_jit_cache(Address start, size_t length) {
-    std::lock_guard<std::mutex> lock(mutex);
-    for (const auto &[_, thread] : threads) {
-        ::invalidate_jit_cache(*thread->cpu, start, length);
-    }
+    // applied by each thread before it runs guest code again
+    jit_invalidation_queue.post(start, length);
 }
 
 ThreadStatePtr KernelState::get_thread(SceUID thread_id) {
@@ -171,6 +171,17 @@ void KernelState::exit_delete_all_threads() {
     }
 }
 
+void KernelState::add_thread_exit_handler(ThreadExitHandler handler) {
+    const std::lock_guard<std::mutex> lock(thread_exit_handlers_mutex);
+    thread_exit_handlers.push_back(std::move(handler));
+}
+
+void KernelState::run_thread_exit_handlers(SceUID thread_id) {
+    const std::lock_guard<std::mutex> lock(thread_exit_handlers_mutex);
+    for (const ThreadExitHandler &handler : thread_exit_handlers)
+        handler(thread_id);
+}
+
 void KernelState::pause_threads() {
     const std::lock_guard<std::mutex> lock(mutex);
     for (auto [_, thread] : threads) {
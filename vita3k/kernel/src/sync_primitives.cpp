@@ -18,8 +18,10 @@
 #include <cpu/functions.h>
 #include <kernel/state.h>
 #include <kernel/sync_primitives.h>
+#include <kernel/timer_service.h>
 
 #include <kernel/types.h>
+#include <rtc/clock.h>
 #include <util/lock_and_find.h>
 #include <util/log.h>
 
@@ -83,9 +85,9 @@ inline int handle_timeout(const ThreadStatePtr &thread, std::unique_lock<std::mu
     SceUInt *const timeout) {
     if (timeout) {
         bool status = false;
-        auto start = std::chrono::steady_clock::now();
+        const uint64_t start = get_guest_clock().now();
         if (*timeout > 0) {
-            status = thread->status_cond.wait_for(primitive_lock, std::chrono::microseconds{ *timeout }, [&] { return thread->status == ThreadStatus::run; });
+            status = get_timer_service().wait_for(thread->status_cond, primitive_lock, get_guest_clock().to_host(*timeout), [&] { return thread->status == ThreadStatus::run; });
         }
 
         if (!status) {
@@ -99,8 +101,7 @@ inline int handle_timeout(const ThreadStatePtr &thread, std::unique_lock<std::mu
 
             return RET_ERROR(SCE_KERNEL_ERROR_WAIT_TIMEOUT);
         } else {
-            auto end = std::chrono::steady_clock::now();
-            uint32_t real_timeout = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+            const uint64_t real_timeout = get_guest_clock().now() - start;
             if (real_timeout > *timeout) {
                 *timeout = 0;
             } else {
@@ -311,9 +312,7 @@ SceInt32 simple_event_delete(KernelState &kernel, const char *export_name, SceUI
 // *********
 
 inline uint64_t get_current_time() {
-    return std::chrono::duration_cast<std::chrono::microseconds>(
-        std::chrono::high_resolution_clock::now().time_since_epoch())
-        .count();
+    return get_guest_clock().now();
 }
 
 SceUID timer_create(KernelState &kernel, MemState &mem, const char *export_name, const char *name, SceUID thread_id, SceUInt32 attr) {
@@ -464,7 +463,7 @@ SceInt32 timer_waitorpoll(KernelState &kernel, const char *export_name, SceUID t
         while (!got_event) {
             uint64_t wait_time = timer->next_event - current_time;
             // wait before we got an event and we are the first thread in the waiting list
-            timer->condvar.wait_for(lock, std::chrono::microseconds(wait_time), [&] {
+            get_timer_service().wait_for(timer->condvar, lock, get_guest_clock().to_host(wait_time), [&] {
                 return (*timer->waiting_threads->begin()).thread->id == thread_id;
             });
             current_time = get_current_time();
@@ -1758,7 +1757,7 @@ SceSize msgpipe_recv(KernelState &kernel, const char *export_name, SceUID thread
             return finish();
         } else { // There's a timeout - wait until we can fill buffer or timeout
             msgpipe_lock.unlock(); // Unlock message pipe object, else we'll deadlock
-            auto status = thread->status_cond.wait_for(thread_lock, std::chrono::microseconds{ *pTimeout }, [&] { return thread->status == ThreadStatus::run; });
+            auto status = get_timer_service().wait_for(thread->status_cond, thread_lock, get_guest_clock().to_host(*pTimeout), [&] { return thread->status == ThreadStatus::run; });
             if (msgpipe->beingDeleted) {
                 std::atomic_fetch_add(&msgpipe->remainingThreads, static_cast<size_t>(-1));
                 return SCE_KERNEL_ERROR_WAIT_DELETE;
@@ -1862,7 +1861,7 @@ SceSize msgpipe_send(KernelState &kernel, const char *export_name, SceUID thread
             return finish();
         } else { // There's a timeout - wait until we can fill buffer or timeout
             msgpipe_lock.unlock(); // Unlock message pipe object, else we'll deadlock
-            auto status = thread->status_cond.wait_for(thread_lock, std::chrono::microseconds{ *pTimeout }, [&] { return thread->status == ThreadStatus::run; });
+            auto status = get_timer_service().wait_for(thread->status_cond, thread_lock, get_guest_clock().to_host(*pTimeout), [&] { return thread->status == ThreadStatus::run; });
             if (msgpipe->beingDeleted) {
                 std::atomic_fetch_add(&msgpipe->remainingThreads, static_cast<size_t>(-1));
                 return SCE_KERNEL_ERROR_WAIT_DELETE;
@@ -0,0 +1,263 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <kernel/timer_service.h>
+
+#include <algorithm>
+#include <bit>
+
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+// Resolution of the wheel, timers of the same tick are sorted by their exact deadline
+constexpr auto TIMER_TICK = std::chrono::microseconds(16);
+
+// Below this the service thread spins instead of sleeping, the host wakes sleeping threads up late
+#ifdef _WIN32
+constexpr auto TIMER_SPIN_THRESHOLD = std::chrono::microseconds(1500);
+#else
+constexpr auto TIMER_SPIN_THRESHOLD = std::chrono::microseconds(100);
+#endif
+
+// Initial and maximum estimate of the time needed to wake up a thread blocked on a condition variable, spun by sleep_until
+constexpr auto TIMER_WAKE_LATENCY = std::chrono::microseconds(50);
+constexpr auto TIMER_MAX_WAKE_LATENCY = std::chrono::microseconds(1000);
+
+// A wake up is posted again after this delay until the waiting thread takes it,
+// the first one is lost if the thread was about to block on its condition variable
+constexpr auto TIMER_WAKEUP_RETRY = std::chrono::microseconds(50);
+
+TimerService::TimerService()
+    : epoch(Clock::now())
+    , wake_latency(std::chrono::nanoseconds(TIMER_WAKE_LATENCY).count()) {
+    thread = std::thread(&TimerService::run, this);
+}
+
+TimerService::~TimerService() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        exiting = true;
+    }
+    cond.notify_one();
+    thread.join();
+}
+
+TimerService::Clock::time_point TimerService::deadline_after(std::chrono::microseconds timeout) {
+    const auto now = Clock::now();
+    if (timeout >= std::chrono::duration_cast<std::chrono::microseconds>(Clock::time_point::max() - now))
+        return Clock::time_point::max();
+    return now + timeout;
+}
+
+TimerService::TimerId TimerService::add(Clock::time_point deadline, std::function<void()> &&callback) {
+    return add_timer({ 0, deadline, get_tick(deadline), std::move(callback) });
+}
+
+TimerService::TimerId TimerService::add_wakeup(Clock::time_point deadline, std::condition_variable &cond, std::atomic<bool> &expired) {
+    return add_timer({ 0, deadline, get_tick(deadline), {}, &cond, &expired });
+}
+
+TimerService::TimerId TimerService::add_timer(Timer &&timer) {
+    const Clock::time_point deadline = timer.deadline;
+    std::unique_lock<std::mutex> lock(mutex);
+    timer.id = next_id++;
+    const TimerId id = timer.id;
+    pending.insert(id);
+    insert(std::move(timer));
+
+    // the service thread only has to be woken up if this timer expires before its planned wake up
+    if (deadline < next_wake) {
+        next_wake = deadline;
+        lock.unlock();
+        cond.notify_one();
+    }
+    return id;
+}
+
+bool TimerService::cancel(TimerId id) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    return pending.erase(id) != 0;
+}
+
+void TimerService::sleep_until(Clock::time_point deadline) {
+    // the end of the delay is spun on, the wake up of this thread is not precise enough
+    const auto latency = std::chrono::nanoseconds(wake_latency.load(std::memory_order_relaxed));
+    const auto wake = deadline - latency;
+    if (Clock::now() < wake) {
+        std::mutex sleep_mutex;
+        std::condition_variable sleep_cond;
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        wait_until(sleep_cond, lock, wake, [] { return false; });
+
+        // follow the late wake ups quickly and the early ones slowly, so that the estimate stays close to the worst case
+        const auto late = std::clamp<Clock::duration>(Clock::now() - wake, Clock::duration::zero(), TIMER_MAX_WAKE_LATENCY);
+        const auto next_latency = late > latency ? latency + (late - latency) / 2 : latency - (latency - late) / 16;
+        wake_latency.store(std::chrono::duration_cast<std::chrono::nanoseconds>(next_latency).count(), std::memory_order_relaxed);
+    }
+
+    while (Clock::now() < deadline)
+        std::this_thread::yield();
+}
+
+uint64_t TimerService::get_tick(Clock::time_point time) const {
+    if (time <= epoch)
+        return 0;
+    if (time == Clock::time_point::max())
+        return UINT64_MAX;
+    return static_cast<uint64_t>((time - epoch) / TIMER_TICK);
+}
+
+void TimerService::insert(Timer &&timer) {
+    if (timer.tick <= current_tick) {
+        due.push_back(std::move(timer));
+        return;
+    }
+
+    // the level is the one whose turn covers the distance to the deadline
+    const uint64_t delta = timer.tick - current_tick;
+    uint32_t level = 0;
+    while ((level < WHEEL_LEVELS - 1) && (delta >= (uint64_t(1) << (WHEEL_BITS * (level + 1)))))
+        level++;
+
+    uint64_t unit = timer.tick >> (WHEEL_BITS * level);
+    // farther than the wheel can hold, park it in the last slot and cascade it again from there
+    if (delta >= (uint64_t(1) << (WHEEL_BITS * WHEEL_LEVELS)))
+        unit = (current_tick >> (WHEEL_BITS * level)) + WHEEL_SIZE;
+
+    const uint32_t slot = unit & (WHEEL_SIZE - 1);
+    wheel[level][slot].push_back(std::move(timer));
+    occupied_slots[level] |= uint64_t(1) << slot;
+}
+
+void TimerService::advance(uint64_t now_tick) {
+    if (now_tick <= current_tick)
+        return;
+
+    const uint64_t old_tick = current_tick;
+    current_tick = now_tick;
+
+    // go through the slots reached since the last advance, the timers in them are moved down the wheel or to due
+    for (uint32_t level = 0; level < WHEEL_LEVELS; level++) {
+        const uint32_t shift = WHEEL_BITS * level;
+        const uint64_t old_unit = old_tick >> shift;
+        const uint64_t new_unit = now_tick >> shift;
+        const uint64_t slot_count = std::min<uint64_t>(new_unit - old_unit, WHEEL_SIZE);
+        for (uint64_t i = 1; i <= slot_count; i++) {
+            const uint32_t slot = (old_unit + i) & (WHEEL_SIZE - 1);
+            if (!(occupied_slots[level] & (uint64_t(1) << slot)))
+                continue;
+
+            std::vector<Timer> timers;
+            std::swap(timers, wheel[level][slot]);
+            occupied_slots[level] &= ~(uint64_t(1) << slot);
+            for (auto &timer : timers) {
+                if (pending.contains(timer.id))
+                    insert(std::move(timer));
+            }
+        }
+    }
+}
+
+TimerService::Clock::time_point TimerService::get_next_expiry() {
+    auto next_expiry = Clock::time_point::max();
+
+    std::erase_if(due, [&](const Timer &timer) { return !pending.contains(timer.id); });
+    for (const auto &timer : due)
+        next_expiry = std::min(next_expiry, timer.deadline);
+
+    // the timers of a slot are looked at when the slot is reached
+    for (uint32_t level = 0; level < WHEEL_LEVELS; level++) {
+        if (!occupied_slots[level])
+            continue;
+
+        const uint32_t shift = WHEEL_BITS * level;
+        const uint64_t unit = current_tick >> shift;
+        const uint32_t first = (unit + 1) & (WHEEL_SIZE - 1);
+        const uint64_t distance = std::countr_zero(std::rotr(occupied_slots[level], static_cast<int>(first))) + 1;
+        const Clock::time_point slot_start = epoch + static_cast<int64_t>((unit + distance) << shift) * TIMER_TICK;
+        next_expiry = std::min(next_expiry, slot_start);
+    }
+
+    return next_expiry;
+}
+
+void TimerService::run() {
+#ifdef __linux__
+    // the default 50 us of slack would be added to every sleep of this thread
+    prctl(PR_SET_TIMERSLACK, 1);
+#endif
+
+    std::vector<Timer> expired;
+    std::vector<Timer> posted;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!exiting) {
+        const auto now = Clock::now();
+        advance(get_tick(now));
+
+        for (auto it = due.begin(); it != due.end();) {
+            if ((it->deadline <= now) && it->cond && pending.contains(it->id)) {
+                // the waiting thread may have checked its predicate and not be blocked yet,
+                // without taking its lock the wake up is posted again until it is cancelled
+                it->expired->store(true, std::memory_order_release);
+                it->cond->notify_all();
+                posted.push_back(std::move(*it));
+                it = due.erase(it);
+            } else if ((it->deadline <= now) && pending.erase(it->id)) {
+                expired.push_back(std::move(*it));
+                it = due.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        for (auto &timer : posted) {
+            timer.deadline = now + TIMER_WAKEUP_RETRY;
+            timer.tick = get_tick(timer.deadline);
+            insert(std::move(timer));
+        }
+        posted.clear();
+
+        if (!expired.empty()) {
+            std::sort(expired.begin(), expired.end(), [](const Timer &a, const Timer &b) { return a.deadline < b.deadline; });
+
+            // a timer being expired cannot be cancelled, its owner waits for the callback to be done
+            lock.unlock();
+            for (auto &timer : expired)
+                timer.callback();
+            expired.clear();
+            lock.lock();
+            continue;
+        }
+
+        next_wake = get_next_expiry();
+        if (next_wake == Clock::time_point::max()) {
+            cond.wait(lock);
+        } else if (next_wake - now > TIMER_SPIN_THRESHOLD) {
+            cond.wait_until(lock, next_wake - TIMER_SPIN_THRESHOLD);
+        } else {
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+        }
+    }
+}
+
+TimerService &get_timer_service() {
+    static TimerService service;
+    return service;
+}
@@ -0,0 +1,213 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <kernel/timer_service.h>
+#include <testutil/benchmark.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <random>
+#include <string>
+
+using namespace std::chrono_literals;
+using Clock = TimerService::Clock;
+
+TEST(timer_service, expires_in_deadline_order) {
+    TimerService service;
+    std::mutex mutex;
+    std::vector<int> order;
+    std::atomic<int> expired = 0;
+
+    const auto start = Clock::now();
+    // spread over several levels of the wheel
+    const std::vector<std::chrono::microseconds> delays = { 30ms, 5us, 2ms, 700us, 90ms, 40us, 300ms };
+    for (size_t i = 0; i < delays.size(); i++) {
+        service.add(start + delays[i], [&, i] {
+            const std::lock_guard<std::mutex> lock(mutex);
+            ASSERT_GE(Clock::now(), start + delays[i]);
+            order.push_back(static_cast<int>(i));
+            expired++;
+        });
+    }
+
+    while (expired != static_cast<int>(delays.size()))
+        std::this_thread::sleep_for(1ms);
+
+    ASSERT_EQ(order, (std::vector<int>{ 1, 5, 3, 2, 0, 4, 6 }));
+}
+
+TEST(timer_service, cancelled_timer_does_not_expire) {
+    TimerService service;
+    std::atomic<bool> expired = false;
+
+    const auto id = service.add(Clock::now() + 20ms, [&] { expired = true; });
+    ASSERT_TRUE(service.cancel(id));
+    ASSERT_FALSE(service.cancel(id));
+
+    std::this_thread::sleep_for(40ms);
+    ASSERT_FALSE(expired);
+}
+
+TEST(timer_service, wait_until_returns_on_notify_or_timeout) {
+    TimerService service;
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool ready = false;
+
+    // timeout
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        const auto deadline = Clock::now() + 2ms;
+        ASSERT_FALSE(service.wait_until(cond, lock, deadline, [&] { return ready; }));
+        ASSERT_GE(Clock::now(), deadline);
+        ASSERT_TRUE(lock.owns_lock());
+    }
+
+    // notified long before the timeout
+    std::thread notifier([&] {
+        std::this_thread::sleep_for(5ms);
+        const std::lock_guard<std::mutex> lock(mutex);
+        ready = true;
+        cond.notify_all();
+    });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        const auto start = Clock::now();
+        ASSERT_TRUE(service.wait_for(cond, lock, 10s, [&] { return ready; }));
+        ASSERT_LT(Clock::now() - start, 5s);
+    }
+    notifier.join();
+
+    // guest timeouts close to the maximum value do not overflow
+    ASSERT_EQ(TimerService::deadline_after(std::chrono::microseconds(INT64_MAX)), Clock::time_point::max());
+}
+
+TEST(timer_service, timeout_does_not_wait_for_the_waiting_lock) {
+    TimerService service;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::atomic<bool> waiting = false;
+
+    std::thread waiter([&] {
+        std::unique_lock<std::mutex> lock(mutex);
+        waiting = true;
+        ASSERT_FALSE(service.wait_for(cond, lock, 2ms, [] { return false; }));
+    });
+    while (!waiting)
+        std::this_thread::yield();
+
+    // the lock is held past the timeout, the timers expiring after it must not wait for the lock to be released
+    std::atomic<bool> expired = false;
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        service.add(Clock::now() + 5ms, [&] { expired = true; });
+        const auto held_until = Clock::now() + 200ms;
+        while (!expired && (Clock::now() < held_until))
+            std::this_thread::sleep_for(1ms);
+        ASSERT_TRUE(expired);
+    }
+    waiter.join();
+}
+
+TEST(timer_service, concurrent_timeouts) {
+    TimerService service;
+    std::vector<std::thread> threads;
+    std::atomic<int> early = 0;
+    for (int i = 0; i < 8; i++) {
+        threads.emplace_back([&, i] {
+            std::mt19937 rng(i);
+            std::mutex mutex;
+            std::condition_variable cond;
+            for (int j = 0; j < 200; j++) {
+                // short timeouts often expire while the thread is still about to block
+                const auto deadline = Clock::now() + std::chrono::microseconds(rng() % 100);
+                std::unique_lock<std::mutex> lock(mutex);
+                service.wait_until(cond, lock, deadline, [] { return false; });
+                if (Clock::now() < deadline)
+                    early++;
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    ASSERT_EQ(early, 0);
+}
+
+TEST(timer_service, concurrent_sleeps) {
+    TimerService service;
+    std::vector<std::thread> threads;
+    std::atomic<int> late = 0;
+    for (int i = 0; i < 8; i++) {
+        threads.emplace_back([&, i] {
+            std::mt19937 rng(i);
+            for (int j = 0; j < 50; j++) {
+                const auto deadline = Clock::now() + std::chrono::microseconds(rng() % 2000);
+                service.sleep_until(deadline);
+                if (Clock::now() < deadline)
+                    late++;
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    // never woken up early
+    ASSERT_EQ(late, 0);
+}
+
+// The overshoot counts are recorded as "<name>_le_<bucket>us" properties of the test
+static void record_jitter_histogram(const std::string &name, const std::function<void(Clock::time_point)> &sleep_until) {
+    constexpr int SAMPLE_COUNT = 2000;
+    constexpr int64_t BUCKETS_US[] = { 5, 10, 25, 50, 100, 250, 500, 1000, INT64_MAX };
+    int counts[std::size(BUCKETS_US)] = {};
+
+    std::mt19937 rng(42);
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+        // short delays like the ones used for audio and frame pacing
+        const auto deadline = Clock::now() + std::chrono::microseconds(50 + rng() % 950);
+        sleep_until(deadline);
+        const auto overshoot = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - deadline).count();
+        counts[std::lower_bound(std::begin(BUCKETS_US), std::end(BUCKETS_US), overshoot) - std::begin(BUCKETS_US)]++;
+    }
+
+    for (size_t i = 0; i < std::size(BUCKETS_US); i++) {
+        if (BUCKETS_US[i] == INT64_MAX)
+            testutil::record(name + "_over_1000us", counts[i]);
+        else
+            testutil::record(name + "_le_" + std::to_string(BUCKETS_US[i]) + "us", counts[i]);
+    }
+}
+
+BENCHMARK_TEST(timer_service, jitter) {
+    record_jitter_histogram("sleep_for", [](Clock::time_point deadline) {
+        std::this_thread::sleep_for(deadline - Clock::now());
+    });
+
+    record_jitter_histogram("condition_variable_wait_until", [](Clock::time_point deadline) {
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait_until(lock, deadline, [] { return false; });
+    });
+
+    TimerService service;
+    record_jitter_histogram("timer_service_sleep_until", [&](Clock::time_point deadline) {
+        service.sleep_until(deadline);
+    });
+}
@@ -376,6 +376,7 @@ struct LangState {
             { "firmware_installation", "Firmware Installation" },
             { "firmware_installing", "Installation in progress, please wait..." },
             { "successed_install_firmware", "Firmware successfully installed." },
+            { "failed_install_firmware", "Failed to install the firmware." },
             { "firmware_version", "Firmware version:" },
             { "no_font_exist", "No firmware font package present, please download and install it." },
             { "download_firmware_font_package", "Download Firmware Font Package" },
@@ -446,7 +447,12 @@ struct LangState {
     std::map<std::string, std::string> performance_overlay = {
         { "avg", "Avg" },
         { "min", "Min" },
-        { "max", "Max" }
+        { "max", "Max" },
+        { "vram", "VRAM" },
+        { "textures", "Tex" },
+        { "surfaces", "Surf" },
+        { "faults", "Faults" },
+        { "syscalls", "Syscalls" }
     };
     struct Settings {
         std::map<std::string, std::string> main = { { "title", "Settings" } };
@@ -560,6 +566,10 @@ struct LangState {
             { "screen_filter_description", "Set post-processing filter to apply." },
             { "internal_resolution_upscaling", "Internal Resolution Upscaling" },
             { "internal_resolution_upscaling_description", "Enable upscaling for Vita3K.\nExperimental: games are not guaranteed to render properly at more than 1x." },
+            { "dynamic_resolution", "Dynamic Resolution" },
+            { "dynamic_resolution_description", "Lower the internal resolution in heavy scenes to keep the frame rate,\nthe image is upscaled with the screen filter.\nSurfaces read back by the game keep the full resolution." },
+            { "dynamic_resolution_min_scale", "Minimum Scale" },
+            { "dynamic_resolution_target_fps", "Target FPS" },
             { "anisotropic_filtering", "Anisotropic Filtering" },
             { "anisotropic_filtering_description", "Anisotropic filtering is a technique to enhance the image quality of surfaces\nwhich are sloped relative to the viewer.\nIt has no drawback but can impact performance." },
             { "texture_replacement", "Texture Replacement" },
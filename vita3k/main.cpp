@@ -232,9 +232,12 @@ int main(int argc, char *argv[]) {
             }
             if (cfg.pup_path.has_value()) {
                 LOG_INFO("Installing firmware file {}", *cfg.pup_path);
-                install_pup(cfg.get_pref_path(), *cfg.pup_path, [](uint32_t progress) {
+                std::string firmware_version;
+                const bool installed = install_pup(cfg.get_pref_path(), *cfg.pup_path, firmware_version, [](uint32_t progress) {
                     LOG_INFO("Firmware installation progress: {}%", progress);
                 });
+                if (!installed)
+                    LOG_ERROR("Failed to install firmware file {}", *cfg.pup_path);
             }
             if (cfg.pkg_path.has_value() && cfg.pkg_zrif.has_value()) {
                 LOG_INFO("Installing pkg from {} ", *cfg.pkg_path);
@@ -571,6 +574,7 @@ int main(int argc, char *argv[]) {
         const SceFVector2 viewport_pos = { emuenv.viewport_pos.x, emuenv.viewport_pos.y };
         const SceFVector2 viewport_size = { emuenv.viewport_size.x, emuenv.viewport_size.y };
         emuenv.renderer->render_frame(viewport_pos, viewport_size, emuenv.display, emuenv.gxm, emuenv.mem);
+        app::hash_displayed_frame(emuenv);
         // Calculate FPS
         app::calculate_fps(emuenv);
 
@@ -20,13 +20,28 @@
 #include <cstdint>
 #include <vector>
 
+// Bit set = free slot, the most significant bit of each word is the lowest offset.
+// The searches are accelerated by summaries derived from `words`: one bit per fully used word,
+// one bit per group of 64 fully used words and the longest free run of each word.
+// The summaries only ever over-estimate the free space, so a word freed by writing to `words`
+// directly is still found, but allocations must go through the functions below.
 struct BitmapAllocator {
     std::vector<std::uint32_t> words;
     std::size_t max_offset;
 
 protected:
+    std::vector<std::uint64_t> full_words;
+    std::vector<std::uint64_t> full_word_groups;
+    std::vector<std::uint8_t> largest_free_run;
+
     int force_fill(const std::uint32_t offset, const int size, const bool or_mode = false);
 
+    void rebuild_summary();
+    void update_summary(const std::size_t first_word, const std::size_t last_word);
+
+    // Index of the first word at or after word_index that may have a free bit, words.size() if there is none
+    std::size_t find_non_full_word(const std::size_t word_index) const;
+
 public:
     BitmapAllocator() = default;
     explicit BitmapAllocator(const std::size_t total_bits);
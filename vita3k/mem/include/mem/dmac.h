@@ -0,0 +1,30 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#pragma once
+
+#include <mem/util.h>
+
+struct MemState;
+
+// Copy and fill of guest memory done for the DMA controller functions.
+// Transfers of 1 MiB and more are split in chunks shared between the calling thread and a small pool of host threads,
+// the functions only return once the whole transfer is done.
+
+// Copy size bytes from src to dst, overlapping ranges are copied like memmove does
+void dmac_memcpy(MemState &mem, Address dst, Address src, uint32_t size);
+// Fill size bytes at dst with the low byte of value
+void dmac_memset(MemState &mem, Address dst, int value, uint32_t size);
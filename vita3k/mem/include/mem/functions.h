@@ -37,18 +37,28 @@ enum struct MemPerm {
     ReadWrite = ReadOnly | WriteOnly
 };
 
+struct MemProtectStats {
+    uint32_t faults = 0;
+    uint32_t syscalls = 0;
+};
+
 bool init(MemState &state, const bool use_page_table);
 Address alloc(MemState &state, uint32_t size, const char *name, Address start_addr = user_main_memory_start);
 Address alloc_aligned(MemState &state, uint32_t size, const char *name, unsigned int alignment, Address start_addr = user_main_memory_start);
 void protect_inner(MemState &state, Address addr, uint32_t size, const MemPerm perm);
 void unprotect_inner(MemState &state, Address addr, uint32_t size);
 bool add_protect(MemState &state, Address addr, const uint32_t size, const MemPerm perm, const ProtectCallback& callback);
+// Number of access faults and protection syscalls since the last call
+MemProtectStats take_protect_stats(MemState &state);
 void add_external_mapping(MemState &mem, Address addr, uint32_t size, uint8_t *addr_ptr);
 void remove_external_mapping(MemState &mem, uint8_t *addr_ptr, uint32_t size);
 bool is_protecting(MemState &state, Address addr, MemPerm *perm = nullptr);
 bool is_valid_addr(const MemState &state, Address addr);
 bool is_valid_addr_range(const MemState &state, Address start, Address end);
 bool handle_access_violation(MemState &state, uint8_t *addr, bool write) noexcept;
+// Same as a fault on every protected page of [addr, addr + size), for host code about to access the whole range.
+// Adjacent segments are unprotected together
+void handle_access_range(MemState &state, Address addr, uint32_t size, bool write);
 Block alloc_block(MemState &mem, uint32_t size, const char *name, Address start_addr = user_main_memory_start);
 Address alloc_at(MemState &state, Address address, uint32_t size, const char *name);
 Address try_alloc_at(MemState &state, Address address, uint32_t size, const char *name);
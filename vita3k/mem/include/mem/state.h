@@ -21,9 +21,11 @@
 #include <mem/functions.h>
 #include <mem/util.h>
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 struct AllocMemPage {
     uint32_t allocated : 4;
@@ -72,6 +74,11 @@ struct MemState {
     BitmapAllocator allocator;
     ProtectSegmentTrees protect_tree;
 
+    // Protection state of each guest page (see mem.cpp), it can be read without the protect mutex
+    std::unique_ptr<std::atomic<uint32_t>[]> page_protect_state;
+    std::atomic<uint32_t> protect_fault_count = 0;
+    std::atomic<uint32_t> protect_syscall_count = 0;
+
     PageNameMap page_name_map;
 
     bool use_page_table = false;
@@ -17,9 +17,28 @@
 
 #include <mem/allocator.h>
 
+#include <algorithm>
+#include <bit>
+
+static std::uint8_t get_largest_free_run(std::uint32_t word) {
+    int largest = 0;
+
+    while (word != 0) {
+        word <<= std::countl_zero(word);
+
+        const int run = std::countl_one(word);
+        largest = std::max(largest, run);
+
+        word = (run == 32) ? 0 : (word << run);
+    }
+
+    return static_cast<std::uint8_t>(largest);
+}
+
 BitmapAllocator::BitmapAllocator(const std::size_t total_bits)
     : words((total_bits >> 5) + ((total_bits % 32 != 0) ? 1 : 0), 0xFFFFFFFF)
     , max_offset(total_bits) {
+    rebuild_summary();
 }
 
 void BitmapAllocator::set_maximum(const std::size_t total_bits) {
@@ -35,10 +54,82 @@ void BitmapAllocator::set_maximum(const std::size_t total_bits) {
     }
 
     max_offset = total_bits;
+
+    rebuild_summary();
 }
 
 void BitmapAllocator::reset() {
     words.clear();
+
+    rebuild_summary();
+}
+
+void BitmapAllocator::rebuild_summary() {
+    // The padding bits past the last word are marked as full so the searches never pick them
+    full_words.assign((words.size() + 63) >> 6, ~0ULL);
+    full_word_groups.assign((full_words.size() + 63) >> 6, ~0ULL);
+    largest_free_run.assign(words.size(), 0);
+
+    for (std::size_t i = 0; i < words.size(); i++) {
+        full_words[i >> 6] &= ~(1ULL << (i & 63));
+    }
+
+    if (!words.empty()) {
+        update_summary(0, words.size() - 1);
+    }
+}
+
+void BitmapAllocator::update_summary(const std::size_t first_word, const std::size_t last_word) {
+    for (std::size_t i = first_word; i <= last_word; i++) {
+        const std::uint64_t bit = 1ULL << (i & 63);
+
+        if (words[i] == 0) {
+            full_words[i >> 6] |= bit;
+        } else {
+            full_words[i >> 6] &= ~bit;
+        }
+
+        largest_free_run[i] = get_largest_free_run(words[i]);
+    }
+
+    for (std::size_t group = first_word >> 6; group <= (last_word >> 6); group++) {
+        const std::uint64_t bit = 1ULL << (group & 63);
+
+        if (full_words[group] == ~0ULL) {
+            full_word_groups[group >> 6] |= bit;
+        } else {
+            full_word_groups[group >> 6] &= ~bit;
+        }
+    }
+}
+
+std::size_t BitmapAllocator::find_non_full_word(const std::size_t word_index) const {
+    std::size_t group = word_index >> 6;
+    if (group >= full_words.size()) {
+        return words.size();
+    }
+
+    // Look in the rest of the current group first
+    const std::uint64_t free_in_group = ~full_words[group] & (~0ULL << (word_index & 63));
+    if (free_in_group != 0) {
+        return (group << 6) + std::countr_zero(free_in_group);
+    }
+
+    // Then skip over whole groups of full words
+    group++;
+
+    while ((group >> 6) < full_word_groups.size()) {
+        const std::uint64_t free_groups = ~full_word_groups[group >> 6] & (~0ULL << (group & 63));
+
+        if (free_groups != 0) {
+            group = (group & ~63ULL) + std::countr_zero(free_groups);
+            return (group << 6) + std::countr_zero(~full_words[group]);
+        }
+
+        group = (group & ~63ULL) + 64;
+    }
+
+    return words.size();
 }
 
 int BitmapAllocator::force_fill(const std::uint32_t offset, const int size, const bool or_mode) {
@@ -58,6 +149,8 @@ int BitmapAllocator::force_fill(const std::uint32_t offset, const int size, cons
             *word = wval & (~mask);
         }
 
+        update_summary(offset >> 5, offset >> 5);
+
         return std::min<int>(size, (words.size() << 5) - set_bit);
     }
 
@@ -85,6 +178,8 @@ int BitmapAllocator::force_fill(const std::uint32_t offset, const int size, cons
         }
     }
 
+    update_summary(offset >> 5, (word - words.data()) - 1);
+
     return std::min<int>(size, (words.size() << 5) - set_bit);
 }
 
@@ -101,75 +196,93 @@ int BitmapAllocator::allocate_from(const std::uint32_t start_offset, int &size,
         return -1;
     }
 
-    std::uint32_t *word = &words[0] + (start_offset >> 5);
-
-    // We have arrived at le word that still have free position (bit 1)
-    std::uint32_t *word_end = &words[words.size() - 1];
-
-    int bflmin = 0xFFFFFF;
-    int bofmin = -1;
-    std::uint32_t *wordmin = nullptr;
-
-    // Keep finding
-    while (word <= word_end) {
-        std::uint32_t wv = *word;
-
-        if (wv != 0) {
-            // Still have free stuff
-            int bflen = 0;
-            int boff = 0;
-            std::uint32_t *bword = nullptr;
-
-            int cursor = 31;
-
-            while (cursor >= 0) {
-                if (((wv >> cursor) & 1) == 1) {
-                    boff = cursor;
-                    bflen = 0;
-                    bword = word;
-
-                    while (cursor >= 0 && (((wv >> cursor) & 1) == 1)) {
-                        bflen++;
-                        cursor--;
-
-                        if (cursor < 0 && (word + 1 <= word_end)) {
-                            cursor = 31;
-                            word++;
-                            wv = *word;
-                        }
-                    }
-
-                    if (bflen >= size) {
-                        if (!best_fit) {
-                            // Force allocate and then return
-                            const int offset = static_cast<int>(31 - boff + ((bword - &words[0]) << 5));
-                            if ((static_cast<std::size_t>(offset) + size) <= max_offset) {
-                                size = force_fill(static_cast<const std::uint32_t>(offset), size, false);
-                                return offset;
-                            }
-                        } else {
-                            if (bflen < bflmin) {
-                                bflmin = bflen;
-                                bofmin = boff;
-                                wordmin = bword;
-                            }
-                        }
-                    }
+    const std::size_t total_bits = words.size() << 5;
+
+    // The search always begins at the start of the word holding start_offset
+    std::size_t cursor = static_cast<std::size_t>(start_offset >> 5) << 5;
+
+    std::size_t best_length = 0xFFFFFF;
+    std::size_t best_offset = total_bits;
+
+    while (cursor < total_bits) {
+        // Find the beginning of the next free run, skipping full words through the summary
+        std::size_t word_index = cursor >> 5;
+        std::uint32_t wv = words[word_index] & (0xFFFFFFFFU >> (cursor & 31));
+
+        while (wv == 0) {
+            word_index = find_non_full_word(word_index + 1);
+            if (word_index >= words.size()) {
+                break;
+            }
+
+            wv = words[word_index];
+        }
+
+        if (wv == 0) {
+            break;
+        }
+
+        const std::size_t run_offset = (word_index << 5) + std::countl_zero(wv);
+
+        // Find where the run ends. First fit only needs to know the run is long enough
+        std::size_t run_end;
+        const std::uint32_t used = ~words[word_index] & (0xFFFFFFFFU >> (run_offset & 31));
+
+        if (used != 0) {
+            run_end = (word_index << 5) + std::countl_zero(used);
+        } else {
+            std::size_t next = word_index + 1;
+
+            while ((next < words.size()) && (words[next] == 0xFFFFFFFFU) && (best_fit || ((next << 5) < run_offset + size))) {
+                next++;
+            }
+
+            if (next >= words.size()) {
+                run_end = total_bits;
+            } else if (words[next] == 0xFFFFFFFFU) {
+                run_end = next << 5;
+            } else {
+                run_end = (next << 5) + std::countl_one(words[next]);
+            }
+        }
+
+        const std::size_t run_length = run_end - run_offset;
+
+        if (static_cast<int>(run_length) >= size) {
+            if (!best_fit) {
+                // Force allocate and then return. Any later run would start even further
+                if ((run_offset + size) <= max_offset) {
+                    size = force_fill(static_cast<std::uint32_t>(run_offset), size, false);
+                    return static_cast<int>(run_offset);
                 }
 
-                cursor--;
+                return -1;
+            }
+
+            if (run_length < best_length) {
+                best_length = run_length;
+                best_offset = run_offset;
             }
         }
 
-        word++;
+        cursor = run_end;
+
+        // The other runs inside the word this one ended in are all too short,
+        // only the one touching the end of the word can still grow into the next word
+        if (cursor < total_bits) {
+            const std::size_t end_word = cursor >> 5;
+
+            if (static_cast<int>(largest_free_run[end_word]) < size) {
+                cursor = std::max(cursor, ((end_word + 1) << 5) - std::countr_one(words[end_word]));
+            }
+        }
     }
 
-    if (best_fit && bofmin != -1) {
+    if (best_fit && (best_offset != total_bits)) {
         // Force allocate and then return
-        const int offset = static_cast<int>(31 - bofmin + ((wordmin - &words[0]) << 5));
-        if ((static_cast<std::size_t>(offset) + size) <= max_offset) {
-            size = force_fill(static_cast<std::uint32_t>(offset), size, false);
-            return offset;
+        if ((best_offset + size) <= max_offset) {
+            size = force_fill(static_cast<std::uint32_t>(best_offset), size, false);
+            return static_cast<int>(best_offset);
         }
     }
 
@@ -185,12 +298,6 @@ int BitmapAllocator::allocate_at(const std::uint32_t start_offset, int size) {
     return 0;
 }
 
-static int number_of_set_bits(std::uint32_t i) {
-    i = i - ((i >> 1) & 0x55555555);
-    i = (i & 0x33333333) + ((i >> 2) & 0x33333333);
-    return (((i + (i >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
-}
-
 int BitmapAllocator::free_slot_count(const std::uint32_t offset, const std::uint32_t offset_end) const {
     if (offset >= offset_end) {
         return -1;
@@ -203,20 +310,32 @@ int BitmapAllocator::free_slot_count(const std::uint32_t offset, const std::uint
         return -1;
     }
 
-    std::uint32_t start_bit = offset;
+    const std::uint32_t start_bit = offset;
     const std::uint32_t end_bit = end_off >= words.size() ? max_offset : offset_end;
 
-    std::uint32_t free_count = 0;
+    if (start_bit >= end_bit) {
+        return 0;
+    }
+
+    // Mask of the bits in [from, to) of a word, with 0 <= from < to <= 32
+    const auto range_mask = [](const std::uint32_t from, const std::uint32_t to) {
+        const std::uint32_t tail = (to == 32) ? 0 : (0xFFFFFFFFU >> to);
+        return (0xFFFFFFFFU >> from) & ~tail;
+    };
 
-    while (start_bit < end_bit) {
-        const std::uint32_t next_end_bit = std::min<std::uint32_t>(((start_bit + 32) >> 5) << 5, end_bit);
+    const std::size_t first_word = start_bit >> 5;
+    const std::size_t last_word = (end_bit - 1) >> 5;
+
+    if (first_word == last_word) {
+        return std::popcount(words[first_word] & range_mask(start_bit & 31, ((end_bit - 1) & 31) + 1));
+    }
 
-        const int left_shift = start_bit & 31;
-        const int right_shift = (31 - (next_end_bit - 1) & 31);
-        std::uint32_t word_to_scan = words[start_bit >> 5] << left_shift >> right_shift >> left_shift;
-        free_count += number_of_set_bits(word_to_scan);
+    int free_count = std::popcount(words[first_word] & range_mask(start_bit & 31, 32));
+    free_count += std::popcount(words[last_word] & range_mask(0, ((end_bit - 1) & 31) + 1));
 
-        start_bit = next_end_bit;
+    // Full words in between are skipped through the summary
+    for (std::size_t i = find_non_full_word(first_word + 1); i < last_word; i = find_non_full_word(i + 1)) {
+        free_count += std::popcount(words[i]);
     }
 
     return free_count;
@@ -0,0 +1,247 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <mem/dmac.h>
+#include <mem/functions.h>
+#include <mem/ptr.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define DMAC_STREAMING_STORES
+#endif
+
+// Transfers smaller than this are done inline, the cost of waking up the workers is not worth it
+constexpr uint32_t DMAC_INLINE_TRANSFER_SIZE = 1024 * 1024;
+// Below this size the destination likely stays in the host cache, so normal stores are faster
+constexpr uint32_t DMAC_STREAMING_TRANSFER_SIZE = 8 * 1024 * 1024;
+// Size of the pieces a big transfer is split in
+constexpr uint32_t DMAC_CHUNK_SIZE = 256 * 1024;
+constexpr unsigned int DMAC_MAX_WORKERS = 4;
+
+// Copy that bypasses the host cache for the bulk of the transfer, the destination is not read again soon
+static void stream_copy(uint8_t *dst, const uint8_t *src, size_t size) {
+#ifdef DMAC_STREAMING_STORES
+    const size_t head = std::min<size_t>((16 - (reinterpret_cast<uintptr_t>(dst) & 15)) & 15, size);
+    memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    size -= head;
+
+    for (; size >= 64; size -= 64, dst += 64, src += 64) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 32));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i *>(dst), a);
+        _mm_stream_si128(reinterpret_cast<__m128i *>(dst + 16), b);
+        _mm_stream_si128(reinterpret_cast<__m128i *>(dst + 32), c);
+        _mm_stream_si128(reinterpret_cast<__m128i *>(dst + 48), d);
+    }
+    _mm_sfence();
+#endif
+    memcpy(dst, src, size);
+}
+
+static void stream_fill(uint8_t *dst, uint8_t value, size_t size) {
+#ifdef DMAC_STREAMING_STORES
+    const size_t head = std::min<size_t>((16 - (reinterpret_cast<uintptr_t>(dst) & 15)) & 15, size);
+    memset(dst, value, head);
+    dst += head;
+    size -= head;
+
+    const __m128i pattern = _mm_set1_epi8(static_cast<char>(value));
+    for (; size >= 64; size -= 64, dst += 64) {
+        _mm_stream_si128(reinterpret_cast<__m128i *>(dst), pattern);
+        _mm_stream_si128(reinterpret_cast<__m128i *>(dst + 16), pattern);
+        _mm_stream_si128(reinterpret_cast<__m128i *>(dst + 32), pattern);
+        _mm_stream_si128(reinterpret_cast<__m128i *>(dst + 48), pattern);
+    }
+    _mm_sfence();
+#endif
+    memset(dst, value, size);
+}
+
+// Small pool of host threads playing the role of the DMA controller channels.
+// The calling thread works on the transfer too and only returns once every chunk is done
+class DmacEngine {
+public:
+    DmacEngine() {
+        // no worker on a single core host, the calling thread does everything
+        const unsigned int worker_count = std::min(std::thread::hardware_concurrency() / 2, DMAC_MAX_WORKERS);
+        for (unsigned int i = 0; i < worker_count; i++)
+            workers.emplace_back(&DmacEngine::worker_loop, this);
+    }
+
+    ~DmacEngine() {
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            exiting = true;
+        }
+        job_cond.notify_all();
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    // Run process(offset, size) on every chunk of [0, size)
+    void run(size_t size, const std::function<void(size_t, size_t)> &process) {
+        const size_t chunk_count = (size + DMAC_CHUNK_SIZE - 1) / DMAC_CHUNK_SIZE;
+
+        Transfer transfer{ process, size, chunk_count };
+        if (workers.empty()) {
+            for (size_t chunk = 0; chunk < chunk_count; chunk++)
+                run_chunk(transfer, chunk);
+            return;
+        }
+
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            // the calling thread takes the first chunk, the workers take the others
+            for (size_t chunk = 1; chunk < chunk_count; chunk++)
+                jobs.push_back({ &transfer, chunk });
+        }
+        job_cond.notify_all();
+
+        run_chunk(transfer, 0);
+
+        // help with the remaining chunks instead of sleeping
+        while (true) {
+            Job job{};
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                auto it = std::find_if(jobs.begin(), jobs.end(), [&](const Job &job) { return job.transfer == &transfer; });
+                if (it == jobs.end()) {
+                    transfer_cond.wait(lock, [&] { return transfer.chunks_left == 0; });
+                    return;
+                }
+                job = *it;
+                jobs.erase(it);
+            }
+            run_chunk(transfer, job.chunk);
+        }
+    }
+
+private:
+    struct Transfer {
+        const std::function<void(size_t, size_t)> &process;
+        size_t size;
+        size_t chunks_left;
+    };
+
+    struct Job {
+        Transfer *transfer;
+        size_t chunk;
+    };
+
+    void run_chunk(Transfer &transfer, size_t chunk) {
+        const size_t offset = chunk * DMAC_CHUNK_SIZE;
+        transfer.process(offset, std::min<size_t>(DMAC_CHUNK_SIZE, transfer.size - offset));
+
+        bool done;
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            done = (--transfer.chunks_left == 0);
+        }
+        if (done)
+            transfer_cond.notify_all();
+    }
+
+    void worker_loop() {
+        while (true) {
+            Job job{};
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                job_cond.wait(lock, [&] { return exiting || !jobs.empty(); });
+                if (exiting)
+                    return;
+                job = jobs.front();
+                jobs.pop_front();
+            }
+            run_chunk(*job.transfer, job.chunk);
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable job_cond;
+    std::condition_variable transfer_cond;
+    std::deque<Job> jobs;
+    std::vector<std::thread> workers;
+    bool exiting = false;
+};
+
+static DmacEngine &get_dmac_engine() {
+    static DmacEngine engine;
+    return engine;
+}
+
+void dmac_memcpy(MemState &mem, Address dst, Address src, uint32_t size) {
+    if (size == 0)
+        return;
+
+    // trigger the write tracking of the whole range at once instead of faulting on each page
+    handle_access_range(mem, src, size, false);
+    handle_access_range(mem, dst, size, true);
+
+    uint8_t *dst_ptr = Ptr<uint8_t>(dst).get(mem);
+    const uint8_t *src_ptr = Ptr<const uint8_t>(src).get(mem);
+
+    // computed on 64 bits, a range can end at the top of the address space
+    const bool overlap = (uint64_t(dst) < uint64_t(src) + size) && (uint64_t(src) < uint64_t(dst) + size);
+    if (size < DMAC_INLINE_TRANSFER_SIZE || overlap) {
+        memmove(dst_ptr, src_ptr, size);
+        return;
+    }
+
+    const bool streaming = size >= DMAC_STREAMING_TRANSFER_SIZE;
+    get_dmac_engine().run(size, [=](size_t offset, size_t chunk_size) {
+        if (streaming)
+            stream_copy(dst_ptr + offset, src_ptr + offset, chunk_size);
+        else
+            memcpy(dst_ptr + offset, src_ptr + offset, chunk_size);
+    });
+}
+
+void dmac_memset(MemState &mem, Address dst, int value, uint32_t size) {
+    if (size == 0)
+        return;
+
+    handle_access_range(mem, dst, size, true);
+
+    uint8_t *dst_ptr = Ptr<uint8_t>(dst).get(mem);
+    const uint8_t byte = static_cast<uint8_t>(value);
+
+    if (size < DMAC_INLINE_TRANSFER_SIZE) {
+        memset(dst_ptr, byte, size);
+        return;
+    }
+
+    const bool streaming = size >= DMAC_STREAMING_TRANSFER_SIZE;
+    get_dmac_engine().run(size, [=](size_t offset, size_t chunk_size) {
+        if (streaming)
+            stream_fill(dst_ptr + offset, byte, chunk_size);
+        else
+            memset(dst_ptr + offset, byte, chunk_size);
+    });
+}
@@ -41,6 +41,12 @@
 constexpr uint32_t STANDARD_PAGE_SIZE = KiB(4);
 uint64_t TOTAL_MEM_SIZE = GiB(4);
 constexpr bool LOG_PROTECT = false;
+// Layout of a page_protect_state entry. The generation is increased on every change,
+// so a fault handler can tell if the page was handled by another thread while it was waiting
+constexpr uint32_t PAGE_PROTECTED = 1 << 0;
+constexpr uint32_t PAGE_WATCH_WRITE = 1 << 1;
+constexpr uint32_t PAGE_WATCH_READ = 1 << 2;
+constexpr uint32_t PAGE_GENERATION_SHIFT = 8;
 constexpr bool PAGE_NAME_TRACKING = false;
 
 // TODO: support multiple handlers
@@ -60,6 +66,33 @@ std::string get_error_msg() {
 }
 #endif
 
+static void set_page_protect_state(MemState &state, Address addr, uint32_t size, const uint32_t flags) {
+    if (size == 0)
+        return;
+
+    const uint32_t first_page = addr / state.page_size;
+    const uint32_t last_page = (addr + size - 1) / state.page_size;
+    for (uint32_t page = first_page; page <= last_page; page++) {
+        std::atomic<uint32_t> &page_state = state.page_protect_state[page];
+        uint32_t old_state = page_state.load(std::memory_order_relaxed);
+        uint32_t new_state;
+        do {
+            new_state = (((old_state >> PAGE_GENERATION_SHIFT) + 1) << PAGE_GENERATION_SHIFT) | flags;
+        } while (!page_state.compare_exchange_weak(old_state, new_state, std::memory_order_release, std::memory_order_relaxed));
+    }
+}
+
+static uint32_t get_page_protect_flags(const MemPerm perm) {
+    switch (perm) {
+    case MemPerm::None:
+        return PAGE_PROTECTED | PAGE_WATCH_READ | PAGE_WATCH_WRITE;
+    case MemPerm::ReadOnly:
+        return PAGE_PROTECTED | PAGE_WATCH_WRITE;
+    default:
+        return 0;
+    }
+}
+
 bool init(MemState &state, const bool use_page_table) {
 #ifdef WIN32
     SYSTEM_INFO system_info = {};
@@ -118,6 +151,9 @@ bool init(MemState &state, const bool use_page_table) {
 
     state.allocator.set_maximum(table_length);
 
+    // indexed by guest address, which is 32-bit whatever the size of the host mapping
+    state.page_protect_state = std::make_unique<std::atomic<uint32_t>[]>((1ULL << 32) / state.page_size);
+
     const auto handler = [&state](uint8_t *addr, bool write) noexcept {
         return handle_access_violation(state, addr, write);
     };
@@ -129,6 +165,7 @@ bool init(MemState &state, const bool use_page_table) {
     DWORD old_protect = 0;
     const BOOL ret = VirtualProtect(state.memory.get(), state.page_size, PAGE_NOACCESS, &old_protect);
     LOG_CRITICAL_IF(!ret, "VirtualAlloc failed: {}", get_error_msg());
+    set_page_protect_state(state, 0, state.page_size, get_page_protect_flags(MemPerm::None));
 #else
     // const int ret = mprotect(state.memory.get(), state.page_size, PROT_NONE);
     // LOG_CRITICAL_IF(ret == -1, "mprotect failed: {}", get_error_msg());
@@ -191,6 +228,7 @@ Address alloc_inner(MemState &state, uint32_t start_page, int page_count, const
     const int ret = mprotect(memory, size, PROT_READ | PROT_WRITE);
     LOG_CRITICAL_IF(ret == -1, "mprotect failed: {}", get_error_msg());
 #endif
+    set_page_protect_state(state, addr, size, 0);
     std::memset(memory, 0, size);
 
     AllocMemPage &page = state.alloc_table[page_num];
@@ -240,6 +278,7 @@ void unprotect_inner(MemState &state, Address addr, uint32_t size) {
         fmt::print("Unprotect: {} {}\n", log_hex(addr), size);
     }
     uint8_t *addr_ptr = state.use_page_table ? state.page_table[addr / STANDARD_PAGE_SIZE] : state.memory.get();
+    state.protect_syscall_count++;
 
 #ifdef WIN32
     DWORD old_protect = 0;
@@ -249,10 +288,12 @@ void unprotect_inner(MemState &state, Address addr, uint32_t size) {
     const int ret = mprotect(&addr_ptr[addr], size, PROT_READ | PROT_WRITE);
     LOG_CRITICAL_IF(ret == -1, "mprotect failed: {}", get_error_msg());
 #endif
+    set_page_protect_state(state, addr, size, 0);
 }
 
 void protect_inner(MemState &state, Address addr, uint32_t size, const MemPerm perm) {
     uint8_t *addr_ptr = state.use_page_table ? state.page_table[addr / STANDARD_PAGE_SIZE] : state.memory.get();
+    state.protect_syscall_count++;
 
 #ifdef WIN32
     DWORD old_protect = 0;
@@ -262,6 +303,7 @@ void protect_inner(MemState &state, Address addr, uint32_t size, const MemPerm p
     const int ret = mprotect(&addr_ptr[addr], size, (perm == MemPerm::None) ? PROT_NONE : ((perm == MemPerm::ReadOnly) ? PROT_READ : (PROT_READ | PROT_WRITE)));
     LOG_CRITICAL_IF(ret == -1, "mprotect failed: {}", get_error_msg());
 #endif
+    set_page_protect_state(state, addr, size, get_page_protect_flags(perm));
 }
 
 bool handle_access_violation(MemState &state, uint8_t *addr, bool write) noexcept {
@@ -269,10 +311,10 @@ bool handle_access_violation(MemState &state, uint8_t *addr, bool write) noexcep
     const uintptr_t fault_addr = reinterpret_cast<uintptr_t>(addr);
 
     Address vaddr = 0;
-    const std::unique_lock<std::mutex> lock(state.protect_mutex);
     if (fault_addr < memory_addr || fault_addr >= memory_addr + TOTAL_MEM_SIZE) {
         if (state.use_page_table) {
             // this may come from an external mapping
+            const std::lock_guard<std::mutex> lock(state.protect_mutex);
             uint64_t addr_val = std::bit_cast<uint64_t>(addr);
             auto it = state.external_mapping.lower_bound(addr_val);
             if (it != state.external_mapping.end() && addr_val < it->first + it->second.size) {
@@ -294,6 +336,26 @@ bool handle_access_violation(MemState &state, uint8_t *addr, bool write) noexcep
         fmt::print("Access: {}\n", log_hex(vaddr));
     }
 
+    // When several threads fault on the same page, only the first one has something to do,
+    // the others only need to retry their access once the page is unprotected
+    std::atomic<uint32_t> &page_state = state.page_protect_state[vaddr / state.page_size];
+    const uint32_t fault_page_state = page_state.load(std::memory_order_acquire);
+
+    const std::unique_lock<std::mutex> lock(state.protect_mutex);
+    const uint32_t current_page_state = page_state.load(std::memory_order_acquire);
+    if (current_page_state != fault_page_state) {
+        return true;
+    }
+
+    if (!(current_page_state & PAGE_PROTECTED)) {
+        // Either another thread unprotected the page between the fault and the state read, or the page was protected
+        // without going through add_protect. Unprotecting it again is harmless in the first case, and in the second
+        // one retrying the access would fault forever
+        unprotect_inner(state, align_down(vaddr, state.page_size), state.page_size);
+        LOG_TRACE("Fault on an untracked page. Address=0x{:X}", vaddr);
+        return true;
+    }
+
     auto it = state.protect_tree.lower_bound(vaddr);
     if (it == state.protect_tree.end()) {
         // HACK: keep going
@@ -310,8 +372,9 @@ bool handle_access_violation(MemState &state, uint8_t *addr, bool write) noexcep
         return true;
     }
 
-    Address previous_beg = it->first;
-    for (auto& [block_addr, block] : info.blocks) {
+    state.protect_fault_count++;
+
+    for (auto &[block_addr, block] : info.blocks) {
         block.callback(vaddr, write);
     }
 
@@ -321,6 +384,58 @@ bool handle_access_violation(MemState &state, uint8_t *addr, bool write) noexcep
     return true;
 }
 
+void handle_access_range(MemState &state, Address addr, uint32_t size, bool write) {
+    if (size == 0) {
+        return;
+    }
+
+    // Most of the time nothing in the range is watched, no need to lock anything then
+    const uint32_t watch_flag = write ? PAGE_WATCH_WRITE : PAGE_WATCH_READ;
+    bool is_watched = false;
+    for (uint32_t page = addr / state.page_size; page <= (addr + size - 1) / state.page_size && !is_watched; page++) {
+        is_watched = state.page_protect_state[page].load(std::memory_order_acquire) & watch_flag;
+    }
+    if (!is_watched) {
+        return;
+    }
+
+    const std::lock_guard<std::mutex> lock(state.protect_mutex);
+
+    // The tree is in reverse order, so this is the last segment starting before the end of the range
+    auto it = state.protect_tree.lower_bound(addr + size - 1);
+
+    Address unprotect_start = 0;
+    Address unprotect_end = 0;
+    while (it != state.protect_tree.end() && it->first + it->second.size > addr) {
+        ProtectSegmentInfo &info = it->second;
+
+        // a read only protection is only there to track writes
+        if (!write && info.perm != MemPerm::None) {
+            ++it;
+            continue;
+        }
+
+        const Address access_addr = std::max(addr, it->first);
+        for (auto &[block_addr, block] : info.blocks) {
+            block.callback(access_addr, write);
+        }
+
+        if (unprotect_start != it->first + info.size) {
+            if (unprotect_end != unprotect_start) {
+                unprotect_inner(state, unprotect_start, unprotect_end - unprotect_start);
+            }
+            unprotect_end = it->first + info.size;
+        }
+        unprotect_start = it->first;
+
+        it = state.protect_tree.erase(it);
+    }
+
+    if (unprotect_end != unprotect_start) {
+        unprotect_inner(state, unprotect_start, unprotect_end - unprotect_start);
+    }
+}
+
 bool add_protect(MemState &state, Address addr, const uint32_t size, const MemPerm perm, const ProtectCallback &callback) {
     const std::lock_guard<std::mutex> lock(state.protect_mutex);
     ProtectSegmentInfo protect(size, perm);
@@ -361,18 +476,22 @@ bool add_protect(MemState &state, Address addr, const uint32_t size, const MemPe
     return true;
 }
 
-bool is_protecting(MemState &state, Address addr, MemPerm *perm) {
-    const std::lock_guard<std::mutex> lock(state.protect_mutex);
-    auto ite = state.protect_tree.lower_bound(addr);
+MemProtectStats take_protect_stats(MemState &state) {
+    MemProtectStats stats;
+    stats.faults = state.protect_fault_count.exchange(0);
+    stats.syscalls = state.protect_syscall_count.exchange(0);
+    return stats;
+}
 
-    if (ite != state.protect_tree.end() && addr < ite->first + ite->second.size) {
-        if (perm)
-            *perm = ite->second.perm;
+bool is_protecting(MemState &state, Address addr, MemPerm *perm) {
+    const uint32_t page_state = state.page_protect_state[addr / state.page_size].load(std::memory_order_acquire);
+    if (!(page_state & PAGE_PROTECTED))
+        return false;
 
-        return true;
-    }
+    if (perm)
+        *perm = (page_state & PAGE_WATCH_READ) ? MemPerm::None : MemPerm::ReadOnly;
 
-    return false;
+    return true;
 }
 
 void add_external_mapping(MemState &mem, Address addr, uint32_t size, uint8_t *addr_ptr) {
@@ -15,7 +15,9 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
+#include <algorithm>
 #include <list>
+#include <random>
 #include <mem/allocator.h>
 #include <mem/util.h>
 
@@ -243,3 +245,112 @@ TEST(bitmap_allocator, count_unaligned) {
     // 4 valid bits + 12 bits + 5 valid bits = 21
     ASSERT_EQ(alloc.free_slot_count(22, 92), 21);
 }
+
+// Straightforward bit by bit model of the allocator, used to check the summary accelerated searches
+struct ReferenceAllocator {
+    std::vector<bool> free_bits;
+    std::size_t max_offset;
+
+    explicit ReferenceAllocator(const std::size_t total_bits)
+        : free_bits(((total_bits + 31) >> 5) << 5, true)
+        , max_offset(total_bits) {
+    }
+
+    int allocate_from(const std::uint32_t start_offset, const int size, const bool best_fit) {
+        std::size_t best_length = 0xFFFFFF;
+        int best_offset = -1;
+
+        std::size_t i = (start_offset >> 5) << 5;
+        while (i < free_bits.size()) {
+            if (!free_bits[i]) {
+                i++;
+                continue;
+            }
+
+            const std::size_t begin = i;
+            while (i < free_bits.size() && free_bits[i]) {
+                i++;
+            }
+
+            const std::size_t length = i - begin;
+            if (static_cast<int>(length) < size) {
+                continue;
+            }
+
+            if (!best_fit) {
+                best_offset = static_cast<int>(begin);
+                break;
+            }
+
+            if (length < best_length) {
+                best_length = length;
+                best_offset = static_cast<int>(begin);
+            }
+        }
+
+        if (best_offset < 0 || static_cast<std::size_t>(best_offset) + size > max_offset) {
+            return -1;
+        }
+
+        std::fill_n(free_bits.begin() + best_offset, size, false);
+        return best_offset;
+    }
+
+    void free(const std::uint32_t offset, const int size) {
+        std::fill_n(free_bits.begin() + offset, size, true);
+    }
+
+    int free_slot_count(const std::uint32_t offset, const std::uint32_t offset_end) const {
+        return static_cast<int>(std::count(free_bits.begin() + offset, free_bits.begin() + std::min<std::size_t>(offset_end, max_offset), true));
+    }
+};
+
+TEST(bitmap_allocator, fragmented_matches_reference) {
+    // Not a multiple of 32 and spanning several summary groups
+    constexpr int MEM_SIZE = 64 * 64 * 32 + 45;
+    constexpr int TEST_EPOCH = 20000;
+
+    std::mt19937 rng(1234);
+    BitmapAllocator allocator(MEM_SIZE);
+    ReferenceAllocator reference(MEM_SIZE);
+
+    struct Page {
+        int n;
+        int size;
+    };
+
+    std::vector<Page> pages;
+
+    for (int i = 0; i < TEST_EPOCH; ++i) {
+        // Keep the bitmap mostly full so most searches have to cross fragmented areas
+        const bool do_free = !pages.empty() && (rng() % 100 < 45);
+
+        if (do_free) {
+            const std::size_t index = rng() % pages.size();
+            allocator.free(pages[index].n, pages[index].size);
+            reference.free(pages[index].n, pages[index].size);
+            pages[index] = pages.back();
+            pages.pop_back();
+        } else {
+            // Mostly small blocks, sometimes larger ones spanning several words
+            int size = (rng() % 8 == 0) ? static_cast<int>(rng() % 300 + 1) : static_cast<int>(rng() % 12 + 1);
+            const std::uint32_t start = (rng() % 4 == 0) ? rng() % MEM_SIZE : 0;
+            const bool best_fit = rng() % 2;
+
+            const int expected = reference.allocate_from(start, size, best_fit);
+            const int offset = allocator.allocate_from(start, size, best_fit);
+            ASSERT_EQ(offset, expected);
+
+            if (offset >= 0) {
+                pages.push_back({ offset, size });
+            }
+        }
+
+        if (i % 97 == 0) {
+            const std::uint32_t begin = rng() % MEM_SIZE;
+            const std::uint32_t end = begin + rng() % (MEM_SIZE - begin) + 1;
+            ASSERT_EQ(allocator.free_slot_count(begin, end), reference.free_slot_count(begin, end));
+            ASSERT_EQ(allocator.free_slot_count(0, MEM_SIZE), reference.free_slot_count(0, MEM_SIZE));
+        }
+    }
+}
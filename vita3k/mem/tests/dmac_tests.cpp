@@ -0,0 +1,183 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#include "test_mem.h"
+
+#include <mem/dmac.h>
+#include <mem/functions.h>
+#include <mem/ptr.h>
+#include <mem/state.h>
+#include <mem/util.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+// the sizes go through the inline copy, the chunked copy with a partial last chunk and the streaming stores
+const uint32_t SIZES[] = { 1, 3, 4095, 4097, MiB(1) - 1, MiB(1), MiB(1) + 3, MiB(8) + 17 };
+// guard bytes around the destination that must not be written
+constexpr uint32_t GUARD = 64;
+
+class DmacTest : public testing::Test {
+protected:
+    void SetUp() override {
+        addr = alloc(mem, BUFFER_SIZE, "dmac test");
+        ASSERT_NE(addr, 0);
+    }
+
+    void TearDown() override {
+        free(mem, addr);
+    }
+
+    uint8_t *ptr(Address address) {
+        return Ptr<uint8_t>(address).get(mem);
+    }
+
+    // fill the buffer with random bytes and return them
+    std::vector<uint8_t> randomize(uint32_t seed) {
+        std::mt19937_64 rng(seed);
+        std::vector<uint8_t> data(BUFFER_SIZE);
+        for (size_t i = 0; i < data.size(); i += sizeof(uint64_t)) {
+            const uint64_t value = rng();
+            memcpy(data.data() + i, &value, sizeof(value));
+        }
+        memcpy(ptr(addr), data.data(), data.size());
+        return data;
+    }
+
+    void expect_buffer(const std::vector<uint8_t> &expected) {
+        ASSERT_EQ(memcmp(ptr(addr), expected.data(), expected.size()), 0);
+    }
+
+    static constexpr uint32_t BUFFER_SIZE = MiB(20);
+
+    MemState &mem = get_test_mem();
+    Address addr = 0;
+};
+
+} // namespace
+
+TEST_F(DmacTest, copy_sizes) {
+    for (const uint32_t size : SIZES) {
+        SCOPED_TRACE(size);
+        auto expected = randomize(size);
+
+        // unaligned source and destination in separate halves of the buffer
+        const uint32_t src = GUARD + 5;
+        const uint32_t dst = BUFFER_SIZE / 2 + GUARD + 3;
+        memcpy(expected.data() + dst, expected.data() + src, size);
+
+        dmac_memcpy(mem, addr + dst, addr + src, size);
+        expect_buffer(expected);
+    }
+}
+
+TEST_F(DmacTest, overlapping_copies) {
+    for (const uint32_t size : SIZES) {
+        for (const int32_t shift : { -4099, -1, 1, 17, 4099 }) {
+            SCOPED_TRACE(testing::Message() << "size " << size << ", shift " << shift);
+            auto expected = randomize(size + shift);
+
+            const uint32_t src = GUARD + 4099;
+            const uint32_t dst = src + shift;
+            memmove(expected.data() + dst, expected.data() + src, size);
+
+            dmac_memcpy(mem, addr + dst, addr + src, size);
+            expect_buffer(expected);
+        }
+    }
+}
+
+TEST_F(DmacTest, copy_to_itself) {
+    const auto expected = randomize(1);
+    dmac_memcpy(mem, addr, addr, MiB(2));
+    expect_buffer(expected);
+}
+
+TEST_F(DmacTest, fill_sizes) {
+    for (const uint32_t size : SIZES) {
+        SCOPED_TRACE(size);
+        auto expected = randomize(size);
+
+        // only the low byte of the value is used
+        const uint32_t dst = GUARD + 7;
+        memset(expected.data() + dst, 0xAB, size);
+
+        dmac_memset(mem, addr + dst, 0x1AB, size);
+        expect_buffer(expected);
+    }
+}
+
+TEST_F(DmacTest, zero_size_does_nothing) {
+    const auto expected = randomize(1);
+
+    int calls = 0;
+    add_protect(mem, addr, mem.page_size, MemPerm::None, [&](Address, bool) {
+        calls++;
+        return true;
+    });
+
+    dmac_memcpy(mem, addr, addr + mem.page_size, 0);
+    dmac_memcpy(mem, addr + mem.page_size, addr, 0);
+    dmac_memset(mem, addr, 0, 0);
+    ASSERT_EQ(calls, 0);
+    ASSERT_TRUE(is_protecting(mem, addr));
+
+    handle_access_range(mem, addr, mem.page_size, true);
+    expect_buffer(expected);
+}
+
+TEST_F(DmacTest, protected_ranges_are_reported) {
+    auto expected = randomize(1);
+
+    // a read only source is only tracked for writes, a destination and a source without access are reported
+    int src_calls = 0;
+    int dst_calls = 0;
+    add_protect(mem, addr, mem.page_size * 2, MemPerm::ReadOnly, [&](Address, bool) {
+        src_calls++;
+        return true;
+    });
+    add_protect(mem, addr + mem.page_size * 4, mem.page_size * 2, MemPerm::ReadOnly, [&](Address, bool write) {
+        EXPECT_TRUE(write);
+        dst_calls++;
+        return true;
+    });
+
+    memcpy(expected.data() + mem.page_size * 4 + 1, expected.data() + 1, mem.page_size + 10);
+    dmac_memcpy(mem, addr + mem.page_size * 4 + 1, addr + 1, mem.page_size + 10);
+    ASSERT_EQ(src_calls, 0);
+    ASSERT_EQ(dst_calls, 1);
+    ASSERT_TRUE(is_protecting(mem, addr));
+    ASSERT_FALSE(is_protecting(mem, addr + mem.page_size * 4));
+
+    int none_calls = 0;
+    add_protect(mem, addr + mem.page_size * 8, mem.page_size, MemPerm::None, [&](Address, bool write) {
+        EXPECT_FALSE(write);
+        none_calls++;
+        return true;
+    });
+    memcpy(expected.data() + mem.page_size * 10, expected.data() + mem.page_size * 8, 16);
+    dmac_memcpy(mem, addr + mem.page_size * 10, addr + mem.page_size * 8, 16);
+    ASSERT_EQ(none_calls, 1);
+
+    handle_access_range(mem, addr, mem.page_size * 2, true);
+    ASSERT_EQ(src_calls, 1);
+    expect_buffer(expected);
+}
@@ -0,0 +1,190 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "test_mem.h"
+
+#include <mem/functions.h>
+#include <mem/ptr.h>
+#include <mem/state.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
+
+TEST(mem_protect, write_triggers_callback_once) {
+    MemState &mem = get_test_mem();
+    const Address addr = alloc(mem, mem.page_size * 2, "protect test");
+    ASSERT_NE(addr, 0);
+
+    int calls = 0;
+    add_protect(mem, addr, mem.page_size, MemPerm::ReadOnly, [&](Address, bool write) {
+        EXPECT_TRUE(write);
+        calls++;
+        return true;
+    });
+
+    MemPerm perm;
+    ASSERT_TRUE(is_protecting(mem, addr, &perm));
+    ASSERT_EQ(perm, MemPerm::ReadOnly);
+    ASSERT_FALSE(is_protecting(mem, addr + mem.page_size));
+
+    // reading is allowed
+    ASSERT_EQ(*Ptr<uint32_t>(addr).get(mem), 0);
+    ASSERT_EQ(calls, 0);
+
+    *Ptr<uint32_t>(addr).get(mem) = 1;
+    *Ptr<uint32_t>(addr + 4).get(mem) = 2;
+    ASSERT_EQ(calls, 1);
+    ASSERT_FALSE(is_protecting(mem, addr));
+
+    free(mem, addr);
+}
+
+TEST(mem_protect, neighbour_segments_are_kept) {
+    MemState &mem = get_test_mem();
+    const Address addr = alloc(mem, mem.page_size * 5, "protect neighbour test");
+    ASSERT_NE(addr, 0);
+
+    std::atomic<int> calls[5] = {};
+    for (uint32_t i = 0; i < 4; i++) {
+        add_protect(mem, addr + i * mem.page_size, mem.page_size, MemPerm::ReadOnly, [&calls, i](Address, bool) {
+            calls[i]++;
+            return true;
+        });
+    }
+    add_protect(mem, addr + 4 * mem.page_size, mem.page_size, MemPerm::None, [&calls](Address, bool) {
+        calls[4]++;
+        return true;
+    });
+
+    MemPerm perm;
+    ASSERT_TRUE(is_protecting(mem, addr + 4 * mem.page_size, &perm));
+    ASSERT_EQ(perm, MemPerm::None);
+
+    // sequential writes only report the segments they touch
+    *Ptr<uint8_t>(addr).get(mem) = 1;
+    *Ptr<uint8_t>(addr + mem.page_size).get(mem) = 1;
+    ASSERT_EQ(calls[0], 1);
+    ASSERT_EQ(calls[1], 1);
+    for (uint32_t i = 2; i < 5; i++) {
+        ASSERT_EQ(calls[i], 0);
+        ASSERT_TRUE(is_protecting(mem, addr + i * mem.page_size));
+    }
+
+    // host side access to the whole range
+    handle_access_range(mem, addr, mem.page_size * 5, true);
+    for (uint32_t i = 0; i < 5; i++) {
+        ASSERT_EQ(calls[i], 1);
+        ASSERT_FALSE(is_protecting(mem, addr + i * mem.page_size));
+    }
+
+    free(mem, addr);
+}
+
+TEST(mem_protect, untracked_protection_is_lifted) {
+    MemState &mem = get_test_mem();
+    const Address addr = alloc(mem, mem.page_size * 2, "protect untracked test");
+    ASSERT_NE(addr, 0);
+
+    // protected without any segment, the fault has no callback to call but must not retry the access forever
+    protect_inner(mem, addr, mem.page_size, MemPerm::ReadOnly);
+    ASSERT_TRUE(is_protecting(mem, addr));
+    *Ptr<uint32_t>(addr).get(mem) = 1;
+    ASSERT_EQ(*Ptr<uint32_t>(addr).get(mem), 1);
+    ASSERT_FALSE(is_protecting(mem, addr));
+
+#ifndef WIN32
+    // protected behind the back of the page states
+    ASSERT_EQ(mprotect(Ptr<uint8_t>(addr + mem.page_size).get(mem), mem.page_size, PROT_READ), 0);
+    ASSERT_FALSE(is_protecting(mem, addr + mem.page_size));
+    *Ptr<uint32_t>(addr + mem.page_size).get(mem) = 2;
+    ASSERT_EQ(*Ptr<uint32_t>(addr + mem.page_size).get(mem), 2);
+#endif
+
+    free(mem, addr);
+}
+
+TEST(mem_protect, concurrent_writes_and_reprotect) {
+    constexpr uint32_t PAGE_COUNT = 16;
+    constexpr int WRITER_COUNT = 4;
+    constexpr int WRITES_PER_THREAD = 100000;
+
+    MemState &mem = get_test_mem();
+    const Address addr = alloc(mem, mem.page_size * PAGE_COUNT, "protect stress test");
+    ASSERT_NE(addr, 0);
+
+    std::atomic<bool> dirty[PAGE_COUNT];
+    for (auto &page_dirty : dirty)
+        page_dirty = false;
+
+    const auto protect_page = [&](uint32_t page) {
+        add_protect(mem, addr + page * mem.page_size, mem.page_size, MemPerm::ReadOnly, [&dirty, page](Address, bool) {
+            dirty[page] = true;
+            return true;
+        });
+    };
+
+    for (uint32_t page = 0; page < PAGE_COUNT; page++)
+        protect_page(page);
+
+    std::atomic<bool> writers_done = false;
+    std::vector<std::thread> writers;
+    for (int i = 0; i < WRITER_COUNT; i++) {
+        writers.emplace_back([&, i] {
+            std::mt19937 rng(i);
+            for (int write = 0; write < WRITES_PER_THREAD; write++) {
+                const uint32_t page = rng() % PAGE_COUNT;
+                std::atomic_ref<uint32_t>(*Ptr<uint32_t>(addr + page * mem.page_size + i * 4).get(mem))++;
+            }
+        });
+    }
+
+    std::thread protector([&] {
+        while (!writers_done) {
+            for (uint32_t page = 0; page < PAGE_COUNT; page++) {
+                if (dirty[page].exchange(false))
+                    protect_page(page);
+            }
+        }
+    });
+
+    for (auto &writer : writers)
+        writer.join();
+    writers_done = true;
+    protector.join();
+
+    // every write landed
+    uint32_t total = 0;
+    for (uint32_t page = 0; page < PAGE_COUNT; page++)
+        for (int i = 0; i < WRITER_COUNT; i++)
+            total += *Ptr<uint32_t>(addr + page * mem.page_size + i * 4).get(mem);
+    ASSERT_EQ(total, WRITER_COUNT * WRITES_PER_THREAD);
+
+    // and no page was left writable without being reported
+    for (uint32_t page = 0; page < PAGE_COUNT; page++)
+        ASSERT_TRUE(dirty[page] || is_protecting(mem, addr + page * mem.page_size));
+
+    handle_access_range(mem, addr, mem.page_size * PAGE_COUNT, true);
+    free(mem, addr);
+}
@@ -0,0 +1,30 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#pragma once
+
+#include <mem/functions.h>
+#include <mem/state.h>
+
+#include <gtest/gtest.h>
+
+inline MemState &get_test_mem() {
+    // the access violation handler is process wide, keep a single memory state for all the tests
+    static MemState mem;
+    static const bool initialized = init(mem, false);
+    EXPECT_TRUE(initialized);
+    return mem;
+}
@@ -22,6 +22,7 @@
 #include <kernel/state.h>
 #include <packages/functions.h>
 #include <renderer/state.h>
+#include <replay/functions.h>
 #include <util/lock_and_find.h>
 #include <util/types.h>
 
@@ -128,10 +129,12 @@ EXPORT(SceInt32, _sceDisplaySetFrameBuf, const SceDisplayFrameBuf *pFrameBuf, Sc
     info.pixelformat = pFrameBuf->pixelformat;
     info.image_size.x = pFrameBuf->width;
     info.image_size.y = pFrameBuf->height;
+    info.frame_index = emuenv.frame_count + 1;
     update_prediction(emuenv, info);
 
     emuenv.display.last_setframe_vblank_count = emuenv.display.vblank_count.load();
     emuenv.frame_count++;
+    add_replay_frame(emuenv.replay, emuenv.frame_count);
 
 #ifdef TRACY_ENABLE
     FrameMarkNamed("SCE frame buffer"); // Tracy - Secondary frame end mark for the emulated frame buffer
@@ -20,6 +20,7 @@
 #include <ctrl/state.h>
 #include <motion/functions.h>
 #include <motion/motion.h>
+#include <rtc/clock.h>
 
 #include <util/tracy.h>
 TRACY_MODULE_NAME(SceMotion);
@@ -103,8 +104,7 @@ EXPORT(int, sceMotionGetSensorState, SceMotionSensorState *sensorState, int numR
             sensorState->accelerometer.y = 0;
             sensorState->gyro = {0,0,0};
             
-            std::chrono::time_point<std::chrono::steady_clock> ts = std::chrono::steady_clock::now();
-            uint64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(ts.time_since_epoch()).count();
+            uint64_t timestamp = get_guest_clock().now();
             sensorState->timestamp = timestamp;
             sensorState->hostTimestamp = timestamp;
     
@@ -150,8 +150,7 @@ EXPORT(int, sceMotionGetState, SceMotionState *motionState) {
             // put some default values
             memset(motionState, 0, sizeof(SceMotionState));
     
-            std::chrono::time_point<std::chrono::steady_clock> ts = std::chrono::steady_clock::now();
-            uint64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(ts.time_since_epoch()).count();
+            uint64_t timestamp = get_guest_clock().now();
             motionState->timestamp = timestamp;
             motionState->hostTimestamp = timestamp;
     
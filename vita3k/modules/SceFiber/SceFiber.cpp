@@ -21,7 +21,10 @@
 #include <cpu/functions.h>
 #include <kernel/state.h>
 
+#include <algorithm>
+#include <atomic>
 #include <sstream>
+#include <unordered_map>
 #include <util/lock_and_find.h>
 #include <util/log.h>
 
@@ -64,62 +67,96 @@ typedef struct SceFiber {
     SceUInt32 argOnInitialize;
     Ptr<uint32_t> argOnRun;
     FiberStatus status;
+    bool context_size_check;
 } SceFiber;
 
 static_assert(sizeof(SceFiber) <= 128, "SceFiber struct size is more than 128");
 
+// Fiber bookkeeping of one guest thread, only ever touched by that thread and erased once it exits
+struct FiberThread {
+    CPUState *cpu = nullptr;
+    SceFiber *current_fiber = nullptr;
+    CPUContext thread_context;
+};
+
 struct FiberState {
     std::mutex mutex;
-    std::map<SceUID, SceFiber *> thread_fibers;
-    std::map<SceUID, CPUContext> thread_contexts;
+    std::unordered_map<SceUID, FiberThread> threads;
+    // read by fiber initializations without taking the mutex
+    std::atomic<bool> context_size_check = false;
 };
 
 LIBRARY_INIT(SceFiber) {
     emuenv.kernel.obj_store.create<FiberState>();
+    emuenv.kernel.add_thread_exit_handler([&emuenv](SceUID thread_id) {
+        const auto state = emuenv.kernel.obj_store.get<FiberState>();
+        const std::lock_guard<std::mutex> lock(state->mutex);
+        state->threads.erase(thread_id);
+    });
 }
 
 constexpr bool LOG_FIBER = false;
+constexpr uint8_t CONTEXT_FILL_PATTERN = 0xCC;
+
+// The returned entry keeps its address as unordered_map never moves its elements,
+// so switches only take the lock for this lookup and never touch the kernel thread list again
+static FiberThread *get_fiber_thread(EmuEnvState &emuenv, FiberState &state, SceUID thread_id) {
+    const std::lock_guard<std::mutex> lock(state.mutex);
+    auto it = state.threads.find(thread_id);
+    if (it != state.threads.end()) {
+        return &it->second;
+    }
 
-void set_thread_fiber(FiberState &state, const SceUID &tid, SceFiber *fiber) {
-    state.thread_fibers[tid] = fiber;
-}
-
-SceFiber *get_thread_fiber(FiberState &state, const SceUID &tid) {
-    auto fiber = state.thread_fibers.find(tid);
-    if (fiber == state.thread_fibers.end()) {
+    const ThreadStatePtr thread = lock_and_find(thread_id, emuenv.kernel.threads, emuenv.kernel.mutex);
+    if (!thread) {
         return nullptr;
     }
-    return fiber->second;
+
+    FiberThread &fiber_thread = state.threads[thread_id];
+    fiber_thread.cpu = thread->cpu.get();
+    return &fiber_thread;
 }
 
-void set_thread_context(FiberState &state, const SceUID &tid, const CPUContext &ctx) {
-    state.thread_contexts[tid] = ctx;
+static SceUInt32 get_context_margin(const MemState &mem, const SceFiber *fiber) {
+    const uint8_t *context = Ptr<uint8_t>(fiber->addrContext).get(mem);
+    const uint8_t *used = std::find_if(context, context + fiber->sizeContext, [](uint8_t value) { return value != CONTEXT_FILL_PATTERN; });
+    return static_cast<SceUInt32>(used - context);
 }
 
-CPUContext get_thread_context(FiberState &state, const SceUID &tid) {
-    return state.thread_contexts[tid];
+// Called when a fiber is switched out, the stack pointer must be inside its context
+// and the bottom of the context must still hold the fill pattern
+static void check_fiber_context(const MemState &mem, const SceFiber *fiber) {
+    if (!fiber->context_size_check || !fiber->addrContext) {
+        return;
+    }
+
+    const Address sp = fiber->cpu->get_sp();
+    if ((sp < fiber->addrContext) || (sp > fiber->addrContext + fiber->sizeContext)) {
+        LOG_ERROR("Fiber {} stack pointer {} is outside of its context ({}, size {})", fiber->name, log_hex(sp), log_hex(fiber->addrContext), fiber->sizeContext);
+    } else if (*Ptr<uint32_t>(fiber->addrContext).get(mem) != 0xCCCCCCCC) {
+        LOG_ERROR("Fiber {} overflowed its context ({}, size {})", fiber->name, log_hex(fiber->addrContext), fiber->sizeContext);
+    }
 }
 
-std::string describe_fiber(FiberState &state, const ThreadStatePtr &thread, SceFiber *fiber) {
+std::string describe_fiber(FiberThread &fiber_thread, SceUID thread_id, SceFiber *fiber) {
     std::stringstream ss;
     ss << fmt::format("Fiber (name: {})\n", fiber->name);
     ss << fmt::format("entry: {}\n", log_hex(fiber->cpu->get_pc()), log_hex(fiber->entry.address()));
     ss << "CPU Context:\n";
     ss << fiber->cpu->description();
-    ss << "Referenced from " << thread->id << "\n";
+    ss << "Referenced from " << thread_id << "\n";
     ss << "CPU Context:\n";
-    auto ctx = get_thread_context(state, thread->id);
-    ss << ctx.description();
+    ss << fiber_thread.thread_context.description();
     return ss.str();
 }
 
-void log_fiber(FiberState &state, const ThreadStatePtr &thread, SceFiber *fiber, const std::string &function_name) {
+void log_fiber(FiberThread &fiber_thread, SceUID thread_id, SceFiber *fiber, const std::string &function_name) {
     std::string log_msg = function_name + "\n";
-    log_msg += describe_fiber(state, thread, fiber);
+    log_msg += describe_fiber(fiber_thread, thread_id, fiber);
     LOG_INFO("{}", log_msg);
 }
 
-void setup_fiber_to_run(EmuEnvState &emuenv, const ThreadStatePtr &thread, SceFiber *fiber, uint32_t thread_sp, const uint32_t &argOnRunTo) {
+void setup_fiber_to_run(EmuEnvState &emuenv, SceFiber *fiber, uint32_t thread_sp, const uint32_t &argOnRunTo) {
     assert(fiber->status != FiberStatus::RUN);
     if (!fiber->addrContext) {
         fiber->cpu->set_sp(thread_sp);
@@ -138,7 +175,16 @@ void setup_fiber_to_run(EmuEnvState &emuenv, const ThreadStatePtr &thread, SceFi
     fiber->status = FiberStatus::RUN;
 }
 
-void initialize_fiber(EmuEnvState &emuenv, const ThreadStatePtr &thread, SceFiber *fiber, const char *name, Ptr<SceFiberEntry> entry, SceUInt32 argOnInitialize, Ptr<void> addrContext, SceSize sizeContext, SceFiberOptParam *params) {
+// Save the running fiber registers in place, they are restored by the next switch to it
+void suspend_fiber(EmuEnvState &emuenv, FiberThread &fiber_thread, SceFiber *fiber, Ptr<SceUInt32> argOnRun) {
+    *fiber->cpu = save_context(*fiber_thread.cpu);
+    fiber->cpu->cpu_registers[0] = SCE_FIBER_OK;
+    fiber->status = FiberStatus::SUSPEND;
+    fiber->argOnRun = argOnRun;
+    check_fiber_context(emuenv.mem, fiber);
+}
+
+void initialize_fiber(EmuEnvState &emuenv, FiberState &state, CPUState &cpu, SceFiber *fiber, const char *name, Ptr<SceFiberEntry> entry, SceUInt32 argOnInitialize, Ptr<void> addrContext, SceSize sizeContext, SceFiberOptParam *params) {
     fiber->entry = entry;
     strncpy(fiber->name, name, 32);
     fiber->argOnInitialize = argOnInitialize;
@@ -147,10 +193,11 @@ void initialize_fiber(EmuEnvState &emuenv, const ThreadStatePtr &thread, SceFibe
     fiber->sizeContext = sizeContext;
     fiber->cpu = new CPUContext;
     fiber->status = FiberStatus::INIT;
-    *fiber->cpu = save_context(*thread->cpu);
+    fiber->context_size_check = state.context_size_check && addrContext && (sizeContext > 0);
+    *fiber->cpu = save_context(cpu);
 
     if (addrContext && sizeContext > 0) {
-        memset(addrContext.get(emuenv.mem), 0xCC, sizeContext);
+        memset(addrContext.get(emuenv.mem), CONTEXT_FILL_PATTERN, sizeContext);
         fiber->cpu->set_sp(addrContext.address() + sizeContext);
     }
     fiber->cpu->set_lr(0xDEADBEAF);
@@ -161,12 +208,15 @@ EXPORT(int, _sceFiberAttachContextAndRun, SceFiber *fiber, Address addrContext,
     // Maybe Need more check on real hw
     STUBBED("Todo: not sure for now");
     const auto state = emuenv.kernel.obj_store.get<FiberState>();
-    const std::lock_guard<std::mutex> lock(state->mutex);
-    const auto thread = lock_and_find(thread_id, emuenv.kernel.threads, emuenv.kernel.mutex);
-    assert(!get_thread_fiber(*state, thread->id));
+    FiberThread *fiber_thread = get_fiber_thread(emuenv, *state, thread_id);
+    if (!fiber_thread) {
+        return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_THREAD_ID);
+    }
+
+    assert(!fiber_thread->current_fiber);
     assert(!fiber->addrContext);
     if (LOG_FIBER) {
-        log_fiber(*state, thread, fiber, "Attach context and run");
+        log_fiber(*fiber_thread, thread_id, fiber, "Attach context and run");
     }
 
     fiber->addrContext = addrContext;
@@ -175,11 +225,11 @@ EXPORT(int, _sceFiberAttachContextAndRun, SceFiber *fiber, Address addrContext,
         fiber->cpu->set_sp(addrContext + sizeContext);
     }
 
-    setup_fiber_to_run(emuenv, thread, fiber, read_sp(*thread->cpu), argOnRunTo);
-    set_thread_context(*state, thread->id, save_context(*thread->cpu));
-    set_thread_fiber(*state, thread->id, fiber);
+    setup_fiber_to_run(emuenv, fiber, read_sp(*fiber_thread->cpu), argOnRunTo);
+    fiber_thread->thread_context = save_context(*fiber_thread->cpu);
+    fiber_thread->current_fiber = fiber;
 
-    load_context(*thread->cpu, *fiber->cpu);
+    load_context(*fiber_thread->cpu, *fiber->cpu);
     return fiber->cpu->cpu_registers[0];
 }
 
@@ -188,12 +238,14 @@ EXPORT(int, _sceFiberAttachContextAndSwitch, SceFiber *fiber, Address addrContex
     // Maybe Need more check on real hw
     STUBBED("Todo: not sure for now");
     const auto state = emuenv.kernel.obj_store.get<FiberState>();
-    const std::lock_guard<std::mutex> lock(state->mutex);
-    const auto thread = lock_and_find(thread_id, emuenv.kernel.threads, emuenv.kernel.mutex);
-    auto ctx = get_thread_context(*state, thread->id);
-    SceFiber *thread_fiber = get_thread_fiber(*state, thread->id);
+    FiberThread *fiber_thread = get_fiber_thread(emuenv, *state, thread_id);
+    if (!fiber_thread) {
+        return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_THREAD_ID);
+    }
+
+    SceFiber *thread_fiber = fiber_thread->current_fiber;
     if (LOG_FIBER) {
-        log_fiber(*state, thread, fiber, "Attach context and switch");
+        log_fiber(*fiber_thread, thread_id, fiber, "Attach context and switch");
     }
 
     assert(thread_fiber);
@@ -204,13 +256,10 @@ EXPORT(int, _sceFiberAttachContextAndSwitch, SceFiber *fiber, Address addrContex
         fiber->cpu->set_sp(addrContext + sizeContext);
     }
 
-    *thread_fiber->cpu = save_context(*thread->cpu);
-    setup_fiber_to_run(emuenv, thread, fiber, ctx.get_sp(), argOnRunTo);
-    thread_fiber->status = FiberStatus::SUSPEND;
-    thread_fiber->argOnRun = argOnRun;
-    thread_fiber->cpu->cpu_registers[0] = SCE_FIBER_OK;
-    set_thread_fiber(*state, thread->id, fiber);
-    load_context(*thread->cpu, *fiber->cpu);
+    suspend_fiber(emuenv, *fiber_thread, thread_fiber, argOnRun);
+    setup_fiber_to_run(emuenv, fiber, fiber_thread->thread_context.get_sp(), argOnRunTo);
+    fiber_thread->current_fiber = fiber;
+    load_context(*fiber_thread->cpu, *fiber->cpu);
 
     return fiber->cpu->cpu_registers[0];
 }
@@ -229,12 +278,13 @@ EXPORT(SceInt32, _sceFiberInitializeImpl, SceFiber *fiber, const char *name, Ptr
         return RET_ERROR(SCE_FIBER_ERROR_INVALID);
     }
 
-    const ThreadStatePtr thread = lock_and_find(thread_id, emuenv.kernel.threads, emuenv.kernel.mutex);
-    if (!thread) {
+    const auto state = emuenv.kernel.obj_store.get<FiberState>();
+    FiberThread *fiber_thread = get_fiber_thread(emuenv, *state, thread_id);
+    if (!fiber_thread) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_THREAD_ID);
     }
 
-    initialize_fiber(emuenv, thread, fiber, name, entry, argOnInitialize, addrContext, sizeContext, params);
+    initialize_fiber(emuenv, *state, *fiber_thread->cpu, fiber, name, entry, argOnInitialize, addrContext, sizeContext, params);
 
     return SCE_FIBER_OK;
 }
@@ -253,12 +303,13 @@ EXPORT(int, _sceFiberInitializeWithInternalOptionImpl, SceFiber *fiber, const ch
         return RET_ERROR(SCE_FIBER_ERROR_INVALID);
     }
 
-    const ThreadStatePtr thread = lock_and_find(thread_id, emuenv.kernel.threads, emuenv.kernel.mutex);
-    if (!thread) {
+    const auto state = emuenv.kernel.obj_store.get<FiberState>();
+    FiberThread *fiber_thread = get_fiber_thread(emuenv, *state, thread_id);
+    if (!fiber_thread) {
         return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_THREAD_ID);
     }
 
-    initialize_fiber(emuenv, thread, fiber, name, entry, argOnInitialize, addrContext, sizeContext, nullptr);
+    initialize_fiber(emuenv, *state, *fiber_thread->cpu, fiber, name, entry, argOnInitialize, addrContext, sizeContext, nullptr);
 
     return SCE_FIBER_OK;
 }
@@ -297,8 +348,8 @@ EXPORT(int, sceFiberGetInfo, SceFiber *fiber, SceFiberInfo *fiberInfo) {
     fiberInfo->addrContext = fiber->addrContext;
     fiberInfo->sizeContext = fiber->sizeContext;
     memcpy(fiberInfo->name, fiber->name, sizeof(fiberInfo->name));
-    STUBBED("sizeContextMargin is stubbed");
-    fiberInfo->sizeContextMargin = -1;
+    // The margin is only tracked for fibers created while the context size check was enabled
+    fiberInfo->sizeContextMargin = fiber->context_size_check ? get_context_margin(emuenv.mem, fiber) : static_cast<SceUInt32>(-1);
     return 0;
 }
 
@@ -309,19 +360,23 @@ EXPORT(SceUInt32, sceFiberGetSelf, Ptr<SceFiber> *fiber) {
         return RET_ERROR(SCE_FIBER_ERROR_NULL);
     }
 
-    const ThreadStatePtr thread = lock_and_find(thread_id, emuenv.kernel.threads, emuenv.kernel.mutex);
-    SceFiber *thread_fiber = get_thread_fiber(*state, thread->id);
-    if (thread_fiber)
-        *fiber = Ptr<SceFiber>(thread_fiber, emuenv.mem);
+    const FiberThread *fiber_thread = get_fiber_thread(emuenv, *state, thread_id);
+    if (fiber_thread && fiber_thread->current_fiber)
+        *fiber = Ptr<SceFiber>(fiber_thread->current_fiber, emuenv.mem);
     else
         *fiber = Ptr<SceFiber>(0);
 
     return SCE_FIBER_OK;
 }
 
-EXPORT(int, sceFiberOptParamInitialize) {
-    TRACY_FUNC(sceFiberOptParamInitialize);
-    return UNIMPLEMENTED();
+EXPORT(SceInt32, sceFiberOptParamInitialize, SceFiberOptParam *optParam) {
+    TRACY_FUNC(sceFiberOptParamInitialize, optParam);
+    if (!optParam) {
+        return RET_ERROR(SCE_FIBER_ERROR_NULL);
+    }
+
+    memset(optParam, 0, sizeof(SceFiberOptParam));
+    return SCE_FIBER_OK;
 }
 
 EXPORT(int, sceFiberPopUserMarkerWithHud) {
@@ -334,35 +389,41 @@ EXPORT(int, sceFiberPushUserMarkerWithHud) {
     return UNIMPLEMENTED();
 }
 
-EXPORT(int, sceFiberRenameSelf) {
-    TRACY_FUNC(sceFiberRenameSelf);
-    return UNIMPLEMENTED();
+EXPORT(SceInt32, sceFiberRenameSelf, const char *name) {
+    TRACY_FUNC(sceFiberRenameSelf, name);
+    if (!name) {
+        return RET_ERROR(SCE_FIBER_ERROR_NULL);
+    }
+
+    const auto state = emuenv.kernel.obj_store.get<FiberState>();
+    FiberThread *fiber_thread = get_fiber_thread(emuenv, *state, thread_id);
+    if (!fiber_thread || !fiber_thread->current_fiber) {
+        return RET_ERROR(SCE_FIBER_ERROR_PERMISSION);
+    }
+
+    strncpy(fiber_thread->current_fiber->name, name, sizeof(fiber_thread->current_fiber->name));
+    return SCE_FIBER_OK;
 }
 
 EXPORT(SceInt32, sceFiberReturnToThread, uint32_t argOnReturnTo, Ptr<uint32_t> argOnRun) {
     TRACY_FUNC(sceFiberReturnToThread, argOnReturnTo, argOnRun);
     const auto state = emuenv.kernel.obj_store.get<FiberState>();
-    const std::lock_guard<std::mutex> lock(state->mutex);
-    const ThreadStatePtr thread = lock_and_find(thread_id, emuenv.kernel.threads, emuenv.kernel.mutex);
-    SceFiber *fiber = get_thread_fiber(*state, thread->id);
-    if (!fiber) {
+    FiberThread *fiber_thread = get_fiber_thread(emuenv, *state, thread_id);
+    if (!fiber_thread || !fiber_thread->current_fiber) {
         return RET_ERROR(SCE_FIBER_ERROR_PERMISSION);
     }
 
-    CPUContext thread_context = get_thread_context(*state, thread->id);
+    SceFiber *fiber = fiber_thread->current_fiber;
     assert(fiber->status == FiberStatus::RUN);
     if (LOG_FIBER) {
-        log_fiber(*state, thread, fiber, "Return to thread");
+        log_fiber(*fiber_thread, thread_id, fiber, "Return to thread");
     }
 
-    *fiber->cpu = save_context(*thread->cpu);
-    fiber->cpu->cpu_registers[0] = SCE_FIBER_OK;
-    fiber->status = FiberStatus::SUSPEND;
-    fiber->argOnRun = argOnRun;
-    set_thread_fiber(*state, thread->id, nullptr);
+    suspend_fiber(emuenv, *fiber_thread, fiber, argOnRun);
+    fiber_thread->current_fiber = nullptr;
 
-    load_context(*thread->cpu, thread_context);
-    Address argOnReturn = thread_context.cpu_registers[2];
+    load_context(*fiber_thread->cpu, fiber_thread->thread_context);
+    Address argOnReturn = fiber_thread->thread_context.cpu_registers[2];
     if (argOnReturn) {
         *(Ptr<uint32_t>(argOnReturn).get(emuenv.mem)) = argOnReturnTo;
     }
@@ -373,8 +434,6 @@ EXPORT(SceInt32, sceFiberReturnToThread, uint32_t argOnReturnTo, Ptr<uint32_t> a
 EXPORT(SceUInt32, sceFiberRun, SceFiber *fiber, SceUInt32 argOnRunTo, Ptr<SceUInt32> argOnReturn) {
     TRACY_FUNC(sceFiberRun, fiber, argOnRunTo, argOnReturn);
     const auto state = emuenv.kernel.obj_store.get<FiberState>();
-    const std::lock_guard<std::mutex> lock(state->mutex);
-    const ThreadStatePtr thread = lock_and_find(thread_id, emuenv.kernel.threads, emuenv.kernel.mutex);
     if (!fiber) {
         return RET_ERROR(SCE_FIBER_ERROR_NULL);
     }
@@ -383,38 +442,56 @@ EXPORT(SceUInt32, sceFiberRun, SceFiber *fiber, SceUInt32 argOnRunTo, Ptr<SceUIn
         return RET_ERROR(SCE_FIBER_ERROR_STATE);
     }
 
-    if (get_thread_fiber(*state, thread->id)) {
+    FiberThread *fiber_thread = get_fiber_thread(emuenv, *state, thread_id);
+    if (!fiber_thread) {
+        return RET_ERROR(SCE_KERNEL_ERROR_UNKNOWN_THREAD_ID);
+    }
+
+    if (fiber_thread->current_fiber) {
         return RET_ERROR(SCE_FIBER_ERROR_PERMISSION);
     }
 
     if (LOG_FIBER) {
-        log_fiber(*state, thread, fiber, "Run");
+        log_fiber(*fiber_thread, thread_id, fiber, "Run");
     }
 
-    setup_fiber_to_run(emuenv, thread, fiber, read_sp(*thread->cpu), argOnRunTo);
-    set_thread_context(*state, thread->id, save_context(*thread->cpu));
-    set_thread_fiber(*state, thread->id, fiber);
+    setup_fiber_to_run(emuenv, fiber, read_sp(*fiber_thread->cpu), argOnRunTo);
+    fiber_thread->thread_context = save_context(*fiber_thread->cpu);
+    fiber_thread->current_fiber = fiber;
 
-    load_context(*thread->cpu, *fiber->cpu);
+    load_context(*fiber_thread->cpu, *fiber->cpu);
     return fiber->cpu->cpu_registers[0];
 }
 
-EXPORT(int, sceFiberStartContextSizeCheck) {
-    TRACY_FUNC(sceFiberStartContextSizeCheck);
-    return UNIMPLEMENTED();
+EXPORT(SceInt32, sceFiberStartContextSizeCheck, SceUInt32 flags) {
+    TRACY_FUNC(sceFiberStartContextSizeCheck, flags);
+    if (flags != 0) {
+        return RET_ERROR(SCE_FIBER_ERROR_INVALID);
+    }
+
+    const auto state = emuenv.kernel.obj_store.get<FiberState>();
+    bool expected = false;
+    if (!state->context_size_check.compare_exchange_strong(expected, true)) {
+        return RET_ERROR(SCE_FIBER_ERROR_STATE);
+    }
+
+    return SCE_FIBER_OK;
 }
 
-EXPORT(int, sceFiberStopContextSizeCheck) {
+EXPORT(SceInt32, sceFiberStopContextSizeCheck) {
     TRACY_FUNC(sceFiberStopContextSizeCheck);
-    return UNIMPLEMENTED();
+    const auto state = emuenv.kernel.obj_store.get<FiberState>();
+    bool expected = true;
+    if (!state->context_size_check.compare_exchange_strong(expected, false)) {
+        return RET_ERROR(SCE_FIBER_ERROR_STATE);
+    }
+
+    return SCE_FIBER_OK;
 }
 
 EXPORT(SceUInt32, sceFiberSwitch, SceFiber *fiber, SceUInt32 argOnRunTo, Ptr<SceUInt32> argOnRun) {
     TRACY_FUNC(sceFiberSwitch, fiber, argOnRunTo, argOnRun);
     const auto state = emuenv.kernel.obj_store.get<FiberState>();
-    const std::lock_guard<std::mutex> lock(state->mutex);
-    const ThreadStatePtr thread = lock_and_find(thread_id, emuenv.kernel.threads, emuenv.kernel.mutex);
-    auto ctx = get_thread_context(*state, thread->id);
     if (!fiber) {
         return RET_ERROR(SCE_FIBER_ERROR_NULL);
     }
@@ -423,22 +500,19 @@ EXPORT(SceUInt32, sceFiberSwitch, SceFiber *fiber, SceUInt32 argOnRunTo, Ptr<Sce
         return RET_ERROR(SCE_FIBER_ERROR_STATE);
     }
 
-    SceFiber *thread_fiber = get_thread_fiber(*state, thread->id);
-    if (!thread_fiber) {
+    FiberThread *fiber_thread = get_fiber_thread(emuenv, *state, thread_id);
+    if (!fiber_thread || !fiber_thread->current_fiber) {
         return RET_ERROR(SCE_FIBER_ERROR_PERMISSION);
     }
 
     if (LOG_FIBER) {
-        log_fiber(*state, thread, fiber, "Switch");
+        log_fiber(*fiber_thread, thread_id, fiber, "Switch");
     }
 
-    *thread_fiber->cpu = save_context(*thread->cpu);
-    thread_fiber->status = FiberStatus::SUSPEND;
-    thread_fiber->argOnRun = argOnRun;
-    thread_fiber->cpu->cpu_registers[0] = SCE_FIBER_OK;
-    set_thread_fiber(*state, thread->id, fiber);
-    setup_fiber_to_run(emuenv, thread, fiber, ctx.get_sp(), argOnRunTo);
-    load_context(*thread->cpu, *fiber->cpu);
+    suspend_fiber(emuenv, *fiber_thread, fiber_thread->current_fiber, argOnRun);
+    fiber_thread->current_fiber = fiber;
+    setup_fiber_to_run(emuenv, fiber, fiber_thread->thread_context.get_sp(), argOnRunTo);
+    load_context(*fiber_thread->cpu, *fiber->cpu);
 
     return fiber->cpu->cpu_registers[0];
 }
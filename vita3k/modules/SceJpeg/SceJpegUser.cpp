@@ -21,14 +21,72 @@
 #include <codec/types.h>
 #include <kernel/state.h>
 
+#include <algorithm>
+#include <mutex>
+
 #include <util/tracy.h>
 TRACY_MODULE_NAME(SceJpegUser);
 
 typedef std::shared_ptr<MjpegDecoderState> DecoderPtr;
 
+// a decoder along with the buffer used for its yuv output, both are reused between decodes
+struct MJpegDecoderContext {
+    DecoderPtr decoder = std::make_shared<MjpegDecoderState>();
+    std::vector<uint8_t> yuv_buffer;
+    // frame size (width << 16 | height) of the last decode, so that streams of the same resolution get the same decoder back
+    uint32_t frame_size = 0;
+};
+
 struct MJpegState {
     bool initialized = false;
-    DecoderPtr decoder;
+
+    // decoders which are not currently in use, so that guest threads can decode in parallel
+    std::mutex mutex;
+    std::vector<std::unique_ptr<MJpegDecoderContext>> free_decoders;
+};
+
+// Take a decoder from the pool for the duration of a call and give it back afterwards
+class MJpegDecoderLease {
+    MJpegState *state;
+    std::unique_ptr<MJpegDecoderContext> context;
+
+public:
+    // frame_size is 0 when the call doesn't decode or the size is unknown, any free decoder is then taken
+    MJpegDecoderLease(MJpegState *state, uint32_t frame_size)
+        : state(state) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        auto &free_decoders = state->free_decoders;
+        if (free_decoders.empty()) {
+            context = std::make_unique<MJpegDecoderContext>();
+        } else {
+            // prefer the decoder which last decoded to the same size, its buffer is already allocated
+            auto it = std::find_if(free_decoders.rbegin(), free_decoders.rend(), [frame_size](const auto &decoder) {
+                return decoder->frame_size == frame_size;
+            });
+            if (it == free_decoders.rend())
+                it = free_decoders.rbegin();
+            context = std::move(*it);
+            free_decoders.erase(std::next(it).base());
+        }
+        if (frame_size)
+            context->frame_size = frame_size;
+    }
+
+    ~MJpegDecoderLease() {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->free_decoders.push_back(std::move(context));
+    }
+
+    MJpegDecoderLease(const MJpegDecoderLease &) = delete;
+    MJpegDecoderLease &operator=(const MJpegDecoderLease &) = delete;
+
+    MjpegDecoderState *operator->() const {
+        return context->decoder.get();
+    }
+
+    std::vector<uint8_t> &yuv_buffer() {
+        return context->yuv_buffer;
+    }
 };
 
 struct SceJpegMJpegInitInfo {
@@ -155,8 +213,50 @@ static bool is_unsupported_image_size(uint32_t width, uint32_t height) {
     return width < 64 || height < 64 || width > 2032 || height > 1088;
 }
 
+// Return the frame size (width << 16 | height) read from the SOF marker of the jpeg, 0 if it is not found
+static uint32_t get_jpeg_frame_size(const uint8_t *jpeg, SceSize size) {
+    if (size < 4 || jpeg[0] != 0xFF || jpeg[1] != 0xD8)
+        return 0;
+
+    SceSize offset = 2;
+    while (offset + 4 <= size) {
+        if (jpeg[offset] != 0xFF)
+            return 0;
+
+        const uint8_t marker = jpeg[offset + 1];
+        if (marker == 0xFF) {
+            // fill byte
+            offset++;
+            continue;
+        }
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8)) {
+            // markers without a segment
+            offset += 2;
+            continue;
+        }
+
+        // SOF0 to SOF15, DHT, JPG and DAC share the range
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            if (offset + 9 > size)
+                return 0;
+            const uint32_t height = (jpeg[offset + 5] << 8) | jpeg[offset + 6];
+            const uint32_t width = (jpeg[offset + 7] << 8) | jpeg[offset + 8];
+            return (width << 16) | height;
+        }
+
+        // the image data starts, there was no frame header
+        if (marker == 0xDA)
+            return 0;
+
+        const uint32_t length = (jpeg[offset + 2] << 8) | jpeg[offset + 3];
+        offset += 2 + length;
+    }
+
+    return 0;
+}
+
 // Common decoder configuration
-void configure_decoder(MJpegState *state, int decodeMode) {
+void configure_decoder(MJpegDecoderLease &decoder, int decodeMode) {
     SceJpegDHTMode dhtMode = get_DHT_mode(decodeMode);
     SceJpegDownscaleMode downscaleMode = get_downscale_mode(decodeMode);
 
@@ -164,7 +264,7 @@ void configure_decoder(MJpegState *state, int decodeMode) {
     options.use_standard_decoder = is_standard_decoding(dhtMode);
     options.downscale_ratio = get_downscale_ratio(downscaleMode);
 
-    state->decoder->configure(&options);
+    decoder->configure(&options);
 }
 
 EXPORT(int, sceJpegCreateSplitDecoder) {
@@ -207,24 +307,27 @@ EXPORT(int, sceJpegDecodeMJpeg, const unsigned char *pJpeg, SceSize isize, uint8
     int decodeMode, void *pTempBuffer, SceSize tempBufferSize, void *pCoefBuffer, SceSize coefBufferSize) {
     TRACY_FUNC(sceJpegDecodeMJpeg, pJpeg, isize, pRGBA, osize, decodeMode, pTempBuffer, tempBufferSize, pCoefBuffer, coefBufferSize);
 
-    const auto state = emuenv.kernel.obj_store.get<MJpegState>();
-    configure_decoder(state, decodeMode);
+    MJpegDecoderLease decoder(emuenv.kernel.obj_store.get<MJpegState>(), get_jpeg_frame_size(pJpeg, isize));
+    configure_decoder(decoder, decodeMode);
 
     // the yuv data will always be smaller than the rgba data, so osize is an upper bound
-    std::vector<uint8_t> temporary(osize);
+    // the buffer belongs to the decoder so it is only allocated again if a bigger image is decoded
+    std::vector<uint8_t> &yuv_buffer = decoder.yuv_buffer();
+    if (yuv_buffer.size() < osize)
+        yuv_buffer.resize(osize);
     DecoderSize size = {};
 
-    state->decoder->send(pJpeg, isize);
-    state->decoder->receive(temporary.data(), &size);
+    decoder->send(pJpeg, isize);
+    decoder->receive(yuv_buffer.data(), &size);
 
     SceJpegPitch yuv_pitch[4];
-    state->decoder->get_pitch_info(yuv_pitch);
+    decoder->get_pitch_info(yuv_pitch);
 
     if (is_unsupported_image_size(yuv_pitch[0].x, yuv_pitch[0].y)) {
         return RET_ERROR(SCE_JPEG_ERROR_UNSUPPORT_IMAGE_SIZE);
     }
 
-    convert_yuv_to_rgb(temporary.data(), pRGBA, yuv_pitch[0].x, state->decoder->get_color_space(), false, yuv_pitch);
+    convert_yuv_to_rgb(yuv_buffer.data(), pRGBA, yuv_pitch[0].x, decoder->get_color_space(), false, yuv_pitch);
 
     // Top 16 bits = pitch_width, bottom 16 bits = pitch_height.
     return (yuv_pitch[0].x << 16u) | yuv_pitch[0].y;
@@ -234,16 +337,16 @@ EXPORT(int, sceJpegDecodeMJpegYCbCr, const uint8_t *pJpeg, SceSize isize,
     uint8_t *pYCbCr, SceSize osize, int decodeMode, void *pCoefBuffer, SceSize coefBufferSize) {
     TRACY_FUNC(sceJpegDecodeMJpegYCbCr, pJpeg, isize, pYCbCr, osize, decodeMode, pCoefBuffer, coefBufferSize);
 
-    const auto state = emuenv.kernel.obj_store.get<MJpegState>();
-    configure_decoder(state, decodeMode);
+    MJpegDecoderLease decoder(emuenv.kernel.obj_store.get<MJpegState>(), get_jpeg_frame_size(pJpeg, isize));
+    configure_decoder(decoder, decodeMode);
 
     DecoderSize size = {};
 
-    state->decoder->send(pJpeg, isize);
-    state->decoder->receive(pYCbCr, &size);
+    decoder->send(pJpeg, isize);
+    decoder->receive(pYCbCr, &size);
 
     SceJpegPitch yuv_pitch[4];
-    state->decoder->get_pitch_info(yuv_pitch);
+    decoder->get_pitch_info(yuv_pitch);
 
     // Top 16 bits = pitch_width, bottom 16 bits = pitch_height.
     return (yuv_pitch[0].x << 16u) | yuv_pitch[0].y;
@@ -279,16 +382,16 @@ EXPORT(int, sceJpegGetOutputInfo, const uint8_t *pJpeg, SceSize isize,
     if (format != SCE_JPEG_NO_CSC_OUTPUT && format != SCE_JPEG_PIXEL_RGBA8888 && format != SCE_JPEG_PIXEL_BGRA8888)
         return RET_ERROR(SCE_JPEG_ERROR_INVALID_COLOR_FORMAT);
 
-    const auto state = emuenv.kernel.obj_store.get<MJpegState>();
-    configure_decoder(state, decodeMode);
+    MJpegDecoderLease decoder(emuenv.kernel.obj_store.get<MJpegState>(), 0);
+    configure_decoder(decoder, decodeMode);
 
     DecoderSize size = {};
 
-    state->decoder->send(pJpeg, isize);
-    state->decoder->receive(nullptr, &size);
+    decoder->send(pJpeg, isize);
+    decoder->receive(nullptr, &size);
 
     memset(output, 0, sizeof(SceJpegOutputInfo));
-    output->color_space = convert_color_space_decoder_to_jpeg(state->decoder->get_color_space());
+    output->color_space = convert_color_space_decoder_to_jpeg(decoder->get_color_space());
 
     SceJpegDHTMode dhtMode = get_DHT_mode(decodeMode);
     bool isStandardDecodingMode = is_standard_decoding(dhtMode);
@@ -314,7 +417,7 @@ EXPORT(int, sceJpegGetOutputInfo, const uint8_t *pJpeg, SceSize isize,
     // for it to be 0 when it shouldn't than the opposite
     output->coef_buffer_size = 0x100;
 
-    state->decoder->get_pitch_info(output->pitch);
+    decoder->get_pitch_info(output->pitch);
 
     int totalYuvSize = 0;
 
@@ -346,7 +449,8 @@ EXPORT(int, sceJpegInitMJpeg, int maxSplitDecoder) {
 
     emuenv.kernel.obj_store.create<MJpegState>();
     const auto state = emuenv.kernel.obj_store.get<MJpegState>();
-    state->decoder = std::make_shared<MjpegDecoderState>();
+    // other decoders are created on demand, one per guest thread decoding at the same time
+    state->free_decoders.push_back(std::make_unique<MJpegDecoderContext>());
 
     return 0;
 }
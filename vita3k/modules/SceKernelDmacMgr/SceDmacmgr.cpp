@@ -17,10 +17,25 @@
 
 #include <module/module.h>
 
-EXPORT(int, sceDmacMemcpy) {
-    return UNIMPLEMENTED();
+#include <mem/dmac.h>
+
+#include <util/tracy.h>
+TRACY_MODULE_NAME(SceDmacmgr);
+
+EXPORT(Ptr<void>, sceDmacMemcpy, Ptr<void> dst, Ptr<const void> src, SceSize size) {
+    TRACY_FUNC(sceDmacMemcpy, dst, src, size);
+    if (!dst || !src)
+        return dst;
+
+    dmac_memcpy(emuenv.mem, dst.address(), src.address(), size);
+    return dst;
 }
 
-EXPORT(int, sceDmacMemset) {
-    return UNIMPLEMENTED();
+EXPORT(Ptr<void>, sceDmacMemset, Ptr<void> dst, int c, SceSize size) {
+    TRACY_FUNC(sceDmacMemset, dst, c, size);
+    if (!dst)
+        return dst;
+
+    dmac_memset(emuenv.mem, dst.address(), c, size);
+    return dst;
 }
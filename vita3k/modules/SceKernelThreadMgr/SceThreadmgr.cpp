@@ -21,8 +21,10 @@
 #include <kernel/callback.h>
 #include <kernel/state.h>
 #include <kernel/sync_primitives.h>
+#include <kernel/timer_service.h>
 #include <kernel/types.h>
 #include <packages/functions.h>
+#include <rtc/clock.h>
 
 #include <util/lock_and_find.h>
 
@@ -33,9 +35,7 @@
 TRACY_MODULE_NAME(SceThreadmgr);
 
 inline uint64_t get_current_time() {
-    return std::chrono::duration_cast<std::chrono::microseconds>(
-        std::chrono::high_resolution_clock::now().time_since_epoch())
-        .count();
+    return get_guest_clock().now();
 }
 
 EXPORT(int, __sceKernelCreateLwMutex, Ptr<SceKernelLwMutexWork> workarea, const char *name, unsigned int attr, Ptr<SceKernelCreateLwMutex_opt> opt) {
@@ -1040,19 +1040,18 @@ int delay_thread(SceUInt delay_us) {
     if (delay_us == 0)
         return SCE_KERNEL_ERROR_INVALID_ARGUMENT;
 
-    std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+    get_timer_service().sleep_until(TimerService::Clock::now() + get_guest_clock().to_host(delay_us));
 
     return SCE_KERNEL_OK;
 }
 
 int delay_thread_cb(EmuEnvState &emuenv, SceUID thread_id, SceUInt delay_us) {
-    auto start = std::chrono::high_resolution_clock::now(); // Meseaure the time taken to process callbacks
+    const uint64_t start = get_guest_clock().now(); // Meseaure the guest time taken to process callbacks
     process_callbacks(emuenv.kernel, thread_id);
-    auto end = std::chrono::high_resolution_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    const uint64_t elapsed = get_guest_clock().now() - start;
 
-    if (delay_us > elapsed.count()) // If we spent less time than requested processing callbacks, sleep the remaining time
-        return delay_thread(delay_us - elapsed.count());
+    if (delay_us > elapsed) // If we spent less time than requested processing callbacks, sleep the remaining time
+        return delay_thread(delay_us - elapsed);
     else // Else return directly
         return SCE_KERNEL_OK;
 }
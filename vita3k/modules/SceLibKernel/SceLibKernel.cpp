@@ -34,6 +34,7 @@
 #include <io/io.h>
 #include <io/types.h>
 #include <kernel/types.h>
+#include <rtc/clock.h>
 #include <rtc/rtc.h>
 #include <util/lock_and_find.h>
 #include <util/log.h>
@@ -56,9 +57,7 @@ enum class TimerFlags : uint32_t {
 TRACY_MODULE_NAME(SceLibKernel);
 
 inline uint64_t get_current_time() {
-    return std::chrono::duration_cast<std::chrono::microseconds>(
-        std::chrono::high_resolution_clock::now().time_since_epoch())
-        .count();
+    return get_guest_clock().now();
 }
 
 VAR_EXPORT(__sce_libcparam) {
@@ -360,7 +360,8 @@ EXPORT(int, sceKernelSyncVMDomain, SceUID block_uid, Address base, uint32_t size
     if (block->mappedBase.address() > base_end || base > block_base_end) {
         return RET_ERROR(SCE_KERNEL_ERROR_BLOCK_ERROR);
     }
-    invalidate_jit_cache(*emuenv.kernel.get_thread(thread_id)->cpu, base, size);
+    // the domain is shared, the other threads may run the same code
+    emuenv.kernel.invalidate_jit_cache(base, size);
 
     return 0;
 }
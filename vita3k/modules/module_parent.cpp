@@ -164,7 +164,8 @@ void call_import(EmuEnvState &emuenv, CPUState &cpu, uint32_t nid, SceUID thread
         log_import_call('L', nid, thread_id, lle_nid_blacklist, pc);
         write_pc(cpu, export_pc);
         // invalidate this small region (without it, this code will be called again)
-        invalidate_jit_cache(cpu, pc, 3 * sizeof(uint32_t));
+        // in every thread, the stub is shared by all of them
+        emuenv.kernel.invalidate_jit_cache(pc, 3 * sizeof(uint32_t));
     }
 }
 
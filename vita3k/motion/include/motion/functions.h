@@ -26,4 +26,5 @@ Util::Quaternion<SceFloat> get_orientation(const MotionState &state);
 SceBool get_gyro_bias_correction(const MotionState &state);
 void set_gyro_bias_correction(MotionState &state, SceBool setValue);
 
-void refresh_motion(MotionState &state, CtrlState &ctrl_state);
+// Called on each vblank, the motion comes from the recorded input when replaying
+void refresh_motion(MotionState &state, CtrlState &ctrl_state, ReplayState &replay, uint64_t vcount);
@@ -19,6 +19,7 @@
 #include <motion/state.h>
 
 #include <ctrl/state.h>
+#include <replay/functions.h>
 #include <util/log.h>
 
 #include <SDL.h>
@@ -128,22 +129,10 @@ void set_gyro_bias_correction(MotionState &state, SceBool setValue) {
     state.motion_data.EnableGyroBias(setValue);
 }
 
-void refresh_motion(MotionState &state, CtrlState &ctrl_state) {
-    if (!state.is_sampling){
-        // the check is done here so that everything sensor related is done on the same thread
-        if(state.device_accel){
-            SDL_SensorClose(state.device_accel);
-            state.device_accel = nullptr;
-        }
-        if(state.device_gyro){
-            SDL_SensorClose(state.device_gyro);
-            state.device_gyro = nullptr;
-        }
-        return;
-    }
-
+// Read the gyroscope and accelerometer of a controller or of the device
+static bool read_motion_sensors(MotionState &state, CtrlState &ctrl_state, replay::MotionSample &sample) {
     if (!ctrl_state.has_motion_support && !state.has_device_motion_support)
-        return;
+        return false;
 
     // make sure to use the data from only one accelerometer and gyroscope
     bool found_gyro = false;
@@ -202,7 +191,7 @@ void refresh_motion(MotionState &state, CtrlState &ctrl_state) {
     }
 
     if (!found_accel && !found_gyro)
-        return;
+        return false;
 
     // if timestamp is not available, use the current time instead
     if (gyro_timestamp == 0 || accel_timestamp == 0) {
@@ -226,15 +215,46 @@ void refresh_motion(MotionState &state, CtrlState &ctrl_state) {
         std::tie(accel.x, accel.y, accel.z) = std::make_tuple(accel.x, -accel.z, accel.y);
     }
 
+    sample.gyro = { gyro.x, gyro.y, gyro.z };
+    sample.accel = { accel.x, accel.y, accel.z };
+    sample.gyro_delta = gyro_timestamp - state.last_gyro_timestamp;
+    sample.accel_delta = accel_timestamp - state.last_accel_timestamp;
+    return true;
+}
+
+void refresh_motion(MotionState &state, CtrlState &ctrl_state, ReplayState &replay, uint64_t vcount) {
+    if (!state.is_sampling){
+        // the check is done here so that everything sensor related is done on the same thread
+        if(state.device_accel){
+            SDL_SensorClose(state.device_accel);
+            state.device_accel = nullptr;
+        }
+        if(state.device_gyro){
+            SDL_SensorClose(state.device_gyro);
+            state.device_gyro = nullptr;
+        }
+        return;
+    }
+
+    replay::MotionSample sample;
+    if (replay.mode == ReplayMode::Replay) {
+        if (!get_replay_motion(replay, vcount, sample))
+            return;
+    } else {
+        if (!read_motion_sensors(state, ctrl_state, sample))
+            return;
+        record_motion(replay, vcount, sample);
+    }
+
     std::lock_guard<std::mutex> guard(state.mutex);
 
-    state.motion_data.SetGyroscope(gyro);
-    state.motion_data.SetAcceleration(accel);
+    state.motion_data.SetGyroscope({ sample.gyro[0], sample.gyro[1], sample.gyro[2] });
+    state.motion_data.SetAcceleration({ sample.accel[0], sample.accel[1], sample.accel[2] });
 
-    state.motion_data.UpdateRotation(gyro_timestamp - state.last_gyro_timestamp);
-    state.motion_data.UpdateOrientation(accel_timestamp - state.last_accel_timestamp);
+    state.motion_data.UpdateRotation(sample.gyro_delta);
+    state.motion_data.UpdateOrientation(sample.accel_delta);
 
-    state.last_gyro_timestamp = gyro_timestamp;
-    state.last_accel_timestamp = accel_timestamp;
+    state.last_gyro_timestamp += sample.gyro_delta;
+    state.last_accel_timestamp += sample.accel_delta;
     state.last_counter++;
 }
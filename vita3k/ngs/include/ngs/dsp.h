@@ -0,0 +1,121 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <ngs/modules/compressor.h>
+#include <ngs/modules/delay.h>
+#include <ngs/modules/distortion.h>
+#include <ngs/modules/envelope.h>
+#include <ngs/modules/equalizer.h>
+#include <ngs/modules/filter.h>
+#include <ngs/modules/generator.h>
+#include <ngs/modules/pitchshift.h>
+#include <ngs/modules/reverb.h>
+
+#include <cstdint>
+
+// Block based implementation of the NGS effects.
+// Buffers hold interleaved stereo float frames, input and output can be the same buffer.
+// Effects with a tail use a memory block owned by the caller, its size is given by the *_memory_size functions.
+namespace ngs::dsp {
+
+float millibels_to_gain(const float millibels);
+float decibels_to_gain(const float decibels);
+
+// y[0] = b0 x[0] + b1 x[-1] + b2 x[-2] - a1 y[-1] - a2 y[-2]
+struct BiquadCoeffs {
+    float b0 = 1.0f;
+    float b1 = 0.0f;
+    float b2 = 0.0f;
+    float a1 = 0.0f;
+    float a2 = 0.0f;
+};
+
+struct BiquadState {
+    float s1[2];
+    float s2[2];
+};
+
+// fGain is a linear gain, used by the peak and shelf filters
+BiquadCoeffs make_biquad(const SceNgsParamFilter &filter, const float sample_rate);
+BiquadCoeffs make_biquad(const SceNgsParamCoEff &coeff);
+void biquad_process(const BiquadCoeffs &coeffs, BiquadState &state, const float *in, float *out, const uint32_t frames);
+
+struct EqualizerState {
+    BiquadState filters[SCE_NGS_MAX_EQ_FILTERS];
+};
+
+// Chain the filters that are not off, return false and leave out untouched when they all are
+bool equalizer_process(const SceNgsParamEqParams &params, EqualizerState &state, const float *in, float *out, const uint32_t frames, const float sample_rate);
+bool equalizer_process(const SceNgsParamEqParamsCoEff &params, EqualizerState &state, const float *in, float *out, const uint32_t frames);
+
+struct CompressorState {
+    float envelope[2];
+    float gain[2];
+};
+
+// fThreshold, fMakeupGain and fSoftKnee are in dB, fAttack and fRelease in milliseconds
+void compressor_process(const SceNgsCompressorParams &params, CompressorState &state, SceNgsCompressorStates &levels,
+    const float *in, float *out, const uint32_t frames, const float sample_rate);
+
+struct DelayState {
+    uint32_t position;
+    float mod_phase;
+    float filter_x1[SCE_NGS_DELAY_MAX_TAPS][2];
+    float filter_y1[SCE_NGS_DELAY_MAX_TAPS][2];
+};
+
+// in floats, always a power of two number of stereo frames
+uint32_t delay_memory_size(const SceNgsDelayParams &params, const float sample_rate);
+void delay_process(const SceNgsDelayParams &params, DelayState &state, float *memory, const float *in, float *out, const uint32_t frames, const float sample_rate);
+
+void distortion_process(const SceNgsDistortionParams &params, const float *in, float *out, const uint32_t frames);
+
+void envelope_reset(SceNgsEnvelopeStates &state);
+// Return true once the release is over
+bool envelope_process(const SceNgsEnvelopeParams &params, SceNgsEnvelopeStates &state, const bool releasing,
+    const float *in, float *out, const uint32_t frames, const float sample_rate);
+
+struct GeneratorState {
+    double phase;
+    uint32_t noise;
+    float noise_value;
+};
+
+void generator_reset(const SceNgsGeneratorParams &params, GeneratorState &state, const float sample_rate);
+// Add the generated signal to in, in can be null
+void generator_process(const SceNgsGeneratorParams &params, GeneratorState &state, const float *in, float *out, const uint32_t frames, const float sample_rate);
+
+struct PitchShiftState {
+    uint32_t position;
+    float phase;
+};
+
+uint32_t pitchshift_memory_size();
+void pitchshift_process(const SceNgsPitchShiftParams &params, PitchShiftState &state, float *memory, const float *in, float *out, const uint32_t frames);
+
+struct ReverbState {
+    uint32_t position;
+    float input_filter;
+    float damping[4];
+};
+
+uint32_t reverb_memory_size(const float sample_rate);
+void reverb_process(const SceNgsReverbParams &params, ReverbState &state, float *memory, const float *in, float *out, const uint32_t frames, const float sample_rate);
+
+} // namespace ngs::dsp
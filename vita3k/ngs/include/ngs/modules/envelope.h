@@ -56,6 +56,7 @@ namespace ngs {
 struct EnvelopeModule : public Module {
 public:
     bool process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) override;
+    void on_state_change(const MemState &mem, ModuleData &data, const VoiceState previous) override;
     uint32_t module_id() const override { return 0x5CE3; }
 
     static constexpr uint32_t get_max_parameter_size() {
@@ -101,6 +101,12 @@ struct ModuleData {
 
     void fill_to_fit_granularity();
 
+    // Buffer of granularity stereo frames the module writes its output to,
+    // followed by memory_size floats of module memory, zeroed when the size changes
+    float *get_output_buffer(const uint32_t memory_size = 0);
+    // Forget the voice state and the memory of the module, used on key on
+    void clear_state();
+
     void invoke_callback(KernelState &kern, const MemState &mem, const SceUID thread_id, const uint32_t reason1,
         const uint32_t reason2, Address reason_ptr);
 
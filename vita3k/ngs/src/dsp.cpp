@@ -0,0 +1,897 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <ngs/dsp.h>
+
+#include <algorithm>
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace ngs::dsp {
+
+static constexpr float PI = std::numbers::pi_v<float>;
+
+// 4 float lanes. A stereo frame uses the 2 lower lanes, 2 consecutive frames fill the vector
+struct Vec4 {
+#if defined(__aarch64__)
+    float32x4_t v;
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128 v;
+#else
+    float v[4];
+#endif
+};
+
+#if defined(__aarch64__)
+static Vec4 load4(const float *src) { return { vld1q_f32(src) }; }
+static void store4(float *dst, Vec4 a) { vst1q_f32(dst, a.v); }
+static Vec4 load2(const float *src) { return { vcombine_f32(vld1_f32(src), vdup_n_f32(0.0f)) }; }
+static void store2(float *dst, Vec4 a) { vst1_f32(dst, vget_low_f32(a.v)); }
+static Vec4 splat(float f) { return { vdupq_n_f32(f) }; }
+static Vec4 set4(float a, float b, float c, float d) {
+    const float values[4] = { a, b, c, d };
+    return { vld1q_f32(values) };
+}
+static Vec4 add(Vec4 a, Vec4 b) { return { vaddq_f32(a.v, b.v) }; }
+static Vec4 sub(Vec4 a, Vec4 b) { return { vsubq_f32(a.v, b.v) }; }
+static Vec4 mul(Vec4 a, Vec4 b) { return { vmulq_f32(a.v, b.v) }; }
+static Vec4 div(Vec4 a, Vec4 b) { return { vdivq_f32(a.v, b.v) }; }
+static Vec4 min(Vec4 a, Vec4 b) { return { vminq_f32(a.v, b.v) }; }
+static Vec4 max(Vec4 a, Vec4 b) { return { vmaxq_f32(a.v, b.v) }; }
+static Vec4 abs(Vec4 a) { return { vabsq_f32(a.v) }; }
+// a > b ? x : y
+static Vec4 select_greater(Vec4 a, Vec4 b, Vec4 x, Vec4 y) { return { vbslq_f32(vcgtq_f32(a.v, b.v), x.v, y.v) }; }
+// (v1, v0, v3, v2)
+static Vec4 swap_pairs(Vec4 a) { return { vrev64q_f32(a.v) }; }
+// (v2, v3, v0, v1)
+static Vec4 swap_halves(Vec4 a) { return { vextq_f32(a.v, a.v, 2) }; }
+#elif defined(__SSE2__) || defined(_M_X64)
+static Vec4 load4(const float *src) { return { _mm_loadu_ps(src) }; }
+static void store4(float *dst, Vec4 a) { _mm_storeu_ps(dst, a.v); }
+static Vec4 load2(const float *src) { return { _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(src))) }; }
+static void store2(float *dst, Vec4 a) { _mm_store_sd(reinterpret_cast<double *>(dst), _mm_castps_pd(a.v)); }
+static Vec4 splat(float f) { return { _mm_set1_ps(f) }; }
+static Vec4 set4(float a, float b, float c, float d) { return { _mm_setr_ps(a, b, c, d) }; }
+static Vec4 add(Vec4 a, Vec4 b) { return { _mm_add_ps(a.v, b.v) }; }
+static Vec4 sub(Vec4 a, Vec4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+static Vec4 mul(Vec4 a, Vec4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+static Vec4 div(Vec4 a, Vec4 b) { return { _mm_div_ps(a.v, b.v) }; }
+static Vec4 min(Vec4 a, Vec4 b) { return { _mm_min_ps(a.v, b.v) }; }
+static Vec4 max(Vec4 a, Vec4 b) { return { _mm_max_ps(a.v, b.v) }; }
+static Vec4 abs(Vec4 a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+static Vec4 select_greater(Vec4 a, Vec4 b, Vec4 x, Vec4 y) {
+    const __m128 mask = _mm_cmpgt_ps(a.v, b.v);
+    return { _mm_or_ps(_mm_and_ps(mask, x.v), _mm_andnot_ps(mask, y.v)) };
+}
+static Vec4 swap_pairs(Vec4 a) { return { _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(2, 3, 0, 1)) }; }
+static Vec4 swap_halves(Vec4 a) { return { _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(1, 0, 3, 2)) }; }
+#else
+template <typename F>
+static Vec4 map(F f) {
+    Vec4 result;
+    for (int i = 0; i < 4; i++)
+        result.v[i] = f(i);
+    return result;
+}
+static Vec4 load4(const float *src) { return map([&](int i) { return src[i]; }); }
+static void store4(float *dst, Vec4 a) { memcpy(dst, a.v, sizeof(a.v)); }
+static Vec4 load2(const float *src) { return map([&](int i) { return i < 2 ? src[i] : 0.0f; }); }
+static void store2(float *dst, Vec4 a) { memcpy(dst, a.v, 2 * sizeof(float)); }
+static Vec4 splat(float f) { return map([&](int) { return f; }); }
+static Vec4 set4(float a, float b, float c, float d) { return { { a, b, c, d } }; }
+static Vec4 add(Vec4 a, Vec4 b) { return map([&](int i) { return a.v[i] + b.v[i]; }); }
+static Vec4 sub(Vec4 a, Vec4 b) { return map([&](int i) { return a.v[i] - b.v[i]; }); }
+static Vec4 mul(Vec4 a, Vec4 b) { return map([&](int i) { return a.v[i] * b.v[i]; }); }
+static Vec4 div(Vec4 a, Vec4 b) { return map([&](int i) { return a.v[i] / b.v[i]; }); }
+static Vec4 min(Vec4 a, Vec4 b) { return map([&](int i) { return std::min(a.v[i], b.v[i]); }); }
+static Vec4 max(Vec4 a, Vec4 b) { return map([&](int i) { return std::max(a.v[i], b.v[i]); }); }
+static Vec4 abs(Vec4 a) { return map([&](int i) { return std::fabs(a.v[i]); }); }
+static Vec4 select_greater(Vec4 a, Vec4 b, Vec4 x, Vec4 y) { return map([&](int i) { return a.v[i] > b.v[i] ? x.v[i] : y.v[i]; }); }
+static Vec4 swap_pairs(Vec4 a) { return map([&](int i) { return a.v[i ^ 1]; }); }
+static Vec4 swap_halves(Vec4 a) { return map([&](int i) { return a.v[i ^ 2]; }); }
+#endif
+
+// lerp between two stereo frames
+static Vec4 mix(Vec4 a, Vec4 b, float t) {
+    return add(a, mul(sub(b, a), splat(t)));
+}
+
+// Orthogonal 4x4 mixing matrix (Hadamard matrix / 2)
+static Vec4 hadamard(Vec4 a) {
+    const Vec4 pairs = add(mul(a, set4(1.0f, -1.0f, 1.0f, -1.0f)), swap_pairs(a));
+    const Vec4 halves = add(mul(pairs, set4(1.0f, 1.0f, -1.0f, -1.0f)), swap_halves(pairs));
+    return mul(halves, splat(0.5f));
+}
+
+// keep very small values out of the feedback paths, denormals are very slow on x86
+static void flush_denormals(float *values, const uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (std::fabs(values[i]) < 1e-15f)
+            values[i] = 0.0f;
+    }
+}
+
+static void copy_frames(const float *in, float *out, const uint32_t frames) {
+    if (in != out)
+        memmove(out, in, frames * 2 * sizeof(float));
+}
+
+// Coefficient of the one pole lowpass y = x + a (y[-1] - x) with the given gain at the reference frequency
+static float lowpass_coeff(float gain, const float cos_w) {
+    if (gain >= 0.9999f)
+        return 0.0f;
+
+    gain = std::max(gain, 0.001f);
+    const float discriminant = std::max(2.0f * gain * (1.0f - cos_w) - gain * gain * (1.0f - cos_w * cos_w), 0.0f);
+    return (1.0f - gain * cos_w - std::sqrt(discriminant)) / (1.0f - gain);
+}
+
+float millibels_to_gain(const float millibels) {
+    return std::pow(10.0f, millibels / 2000.0f);
+}
+
+float decibels_to_gain(const float decibels) {
+    return std::pow(10.0f, decibels / 20.0f);
+}
+
+// Filters from the Audio EQ Cookbook by Robert Bristow-Johnson
+BiquadCoeffs make_biquad(const SceNgsParamFilter &filter, const float sample_rate) {
+    const float frequency = std::clamp(filter.fFrequency, 10.0f, sample_rate * 0.49f);
+    const float q = std::max(filter.fResonance, 0.01f);
+    const float w0 = 2.0f * PI * frequency / sample_rate;
+    const float cos_w = std::cos(w0);
+    const float alpha = std::sin(w0) / (2.0f * q);
+    const float a = std::sqrt(std::max(filter.fGain, 1e-6f));
+    const float sqrt_a_alpha = 2.0f * std::sqrt(a) * alpha;
+
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f;
+    float a0 = 1.0f, a1 = 0.0f, a2 = 0.0f;
+    switch (filter.eFilterMode) {
+    case SCE_NGS_FILTER_LOWPASS_RESONANT:
+    case SCE_NGS_FILTER_LOWPASS_RESONANT_NORMALIZED:
+        b0 = (1.0f - cos_w) / 2.0f;
+        b1 = 1.0f - cos_w;
+        b2 = b0;
+        a0 = 1.0f + alpha;
+        a1 = -2.0f * cos_w;
+        a2 = 1.0f - alpha;
+        if (filter.eFilterMode == SCE_NGS_FILTER_LOWPASS_RESONANT_NORMALIZED && q > 1.0f) {
+            // the resonance peak is roughly q, keep it at unity gain
+            b0 /= q;
+            b1 /= q;
+            b2 /= q;
+        }
+        break;
+    case SCE_NGS_FILTER_HIGHPASS_RESONANT:
+        b0 = (1.0f + cos_w) / 2.0f;
+        b1 = -(1.0f + cos_w);
+        b2 = b0;
+        a0 = 1.0f + alpha;
+        a1 = -2.0f * cos_w;
+        a2 = 1.0f - alpha;
+        break;
+    case SCE_NGS_FILTER_BANDPASS_PEAK:
+        b0 = q * alpha;
+        b2 = -q * alpha;
+        a0 = 1.0f + alpha;
+        a1 = -2.0f * cos_w;
+        a2 = 1.0f - alpha;
+        break;
+    case SCE_NGS_FILTER_BANDPASS_ZERO:
+        b0 = alpha;
+        b2 = -alpha;
+        a0 = 1.0f + alpha;
+        a1 = -2.0f * cos_w;
+        a2 = 1.0f - alpha;
+        break;
+    case SCE_NGS_FILTER_NOTCH:
+        b1 = -2.0f * cos_w;
+        b2 = 1.0f;
+        a0 = 1.0f + alpha;
+        a1 = -2.0f * cos_w;
+        a2 = 1.0f - alpha;
+        break;
+    case SCE_NGS_FILTER_PEAK:
+        b0 = 1.0f + alpha * a;
+        b1 = -2.0f * cos_w;
+        b2 = 1.0f - alpha * a;
+        a0 = 1.0f + alpha / a;
+        a1 = -2.0f * cos_w;
+        a2 = 1.0f - alpha / a;
+        break;
+    case SCE_NGS_FILTER_HIGHSHELF:
+        b0 = a * ((a + 1.0f) + (a - 1.0f) * cos_w + sqrt_a_alpha);
+        b1 = -2.0f * a * ((a - 1.0f) + (a + 1.0f) * cos_w);
+        b2 = a * ((a + 1.0f) + (a - 1.0f) * cos_w - sqrt_a_alpha);
+        a0 = (a + 1.0f) - (a - 1.0f) * cos_w + sqrt_a_alpha;
+        a1 = 2.0f * ((a - 1.0f) - (a + 1.0f) * cos_w);
+        a2 = (a + 1.0f) - (a - 1.0f) * cos_w - sqrt_a_alpha;
+        break;
+    case SCE_NGS_FILTER_LOWSHELF:
+        b0 = a * ((a + 1.0f) - (a - 1.0f) * cos_w + sqrt_a_alpha);
+        b1 = 2.0f * a * ((a - 1.0f) - (a + 1.0f) * cos_w);
+        b2 = a * ((a + 1.0f) - (a - 1.0f) * cos_w - sqrt_a_alpha);
+        a0 = (a + 1.0f) + (a - 1.0f) * cos_w + sqrt_a_alpha;
+        a1 = -2.0f * ((a - 1.0f) + (a + 1.0f) * cos_w);
+        a2 = (a + 1.0f) + (a - 1.0f) * cos_w - sqrt_a_alpha;
+        break;
+    case SCE_NGS_FILTER_LOWPASS_ONEPOLE: {
+        const float x = std::exp(-w0);
+        b0 = 1.0f - x;
+        a1 = -x;
+        break;
+    }
+    case SCE_NGS_FILTER_HIGHPASS_ONEPOLE: {
+        const float x = std::exp(-w0);
+        b0 = (1.0f + x) / 2.0f;
+        b1 = -b0;
+        a1 = -x;
+        break;
+    }
+    case SCE_NGS_FILTER_ALLPASS:
+        b0 = 1.0f - alpha;
+        b1 = -2.0f * cos_w;
+        b2 = 1.0f + alpha;
+        a0 = 1.0f + alpha;
+        a1 = -2.0f * cos_w;
+        a2 = 1.0f - alpha;
+        break;
+    case SCE_NGS_FILTER_MODE_OFF:
+    default:
+        return {};
+    }
+
+    return { b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0 };
+}
+
+BiquadCoeffs make_biquad(const SceNgsParamCoEff &coeff) {
+    return { coeff.fB0, coeff.fB1, coeff.fB2, coeff.fA1, coeff.fA2 };
+}
+
+// Transposed direct form II, both channels are processed at once
+void biquad_process(const BiquadCoeffs &coeffs, BiquadState &state, const float *in, float *out, const uint32_t frames) {
+    const Vec4 b0 = splat(coeffs.b0);
+    const Vec4 b1 = splat(coeffs.b1);
+    const Vec4 b2 = splat(coeffs.b2);
+    const Vec4 a1 = splat(coeffs.a1);
+    const Vec4 a2 = splat(coeffs.a2);
+
+    Vec4 s1 = load2(state.s1);
+    Vec4 s2 = load2(state.s2);
+    for (uint32_t i = 0; i < frames; i++) {
+        const Vec4 x = load2(in + i * 2);
+        const Vec4 y = add(mul(b0, x), s1);
+        s1 = sub(add(mul(b1, x), s2), mul(a1, y));
+        s2 = sub(mul(b2, x), mul(a2, y));
+        store2(out + i * 2, y);
+    }
+    store2(state.s1, s1);
+    store2(state.s2, s2);
+
+    flush_denormals(state.s1, 2);
+    flush_denormals(state.s2, 2);
+}
+
+// the filters are chained, the first one reads the input and the others work in place
+static bool equalizer_chain(const BiquadCoeffs *coeffs, const uint32_t filter_count, EqualizerState &state, const float *in, float *out, const uint32_t frames) {
+    if (filter_count == 0)
+        return false;
+
+    biquad_process(coeffs[0], state.filters[0], in, out, frames);
+    for (uint32_t i = 1; i < filter_count; i++)
+        biquad_process(coeffs[i], state.filters[i], out, out, frames);
+    return true;
+}
+
+bool equalizer_process(const SceNgsParamEqParams &params, EqualizerState &state, const float *in, float *out, const uint32_t frames, const float sample_rate) {
+    BiquadCoeffs coeffs[SCE_NGS_MAX_EQ_FILTERS];
+    uint32_t filter_count = 0;
+    for (const SceNgsParamFilter &filter : params.filter) {
+        if (filter.eFilterMode != SCE_NGS_FILTER_MODE_OFF)
+            coeffs[filter_count++] = make_biquad(filter, sample_rate);
+    }
+    return equalizer_chain(coeffs, filter_count, state, in, out, frames);
+}
+
+bool equalizer_process(const SceNgsParamEqParamsCoEff &params, EqualizerState &state, const float *in, float *out, const uint32_t frames) {
+    BiquadCoeffs coeffs[SCE_NGS_MAX_EQ_FILTERS];
+    for (uint32_t i = 0; i < SCE_NGS_MAX_EQ_FILTERS; i++)
+        coeffs[i] = make_biquad(params.filterCoEff[i]);
+    return equalizer_chain(coeffs, SCE_NGS_MAX_EQ_FILTERS, state, in, out, frames);
+}
+
+// the gain is computed once every COMPRESSOR_CONTROL_FRAMES frames and linearly interpolated in between
+static constexpr uint32_t COMPRESSOR_CONTROL_FRAMES = 16;
+
+static float compressor_gain(const SceNgsCompressorParams &params, const float level_db) {
+    const float over = level_db - params.fThreshold;
+    const float slope = 1.0f / std::max(params.fRatio, 1.0f) - 1.0f;
+    const float knee = std::max(params.fSoftKnee, 0.0f);
+
+    float reduction = 0.0f;
+    if (knee > 0.0f && 2.0f * std::fabs(over) <= knee)
+        reduction = slope * (over + knee / 2.0f) * (over + knee / 2.0f) / (2.0f * knee);
+    else if (over > 0.0f)
+        reduction = slope * over;
+
+    return decibels_to_gain(reduction + params.fMakeupGain);
+}
+
+void compressor_process(const SceNgsCompressorParams &params, CompressorState &state, SceNgsCompressorStates &levels,
+    const float *in, float *out, const uint32_t frames, const float sample_rate) {
+    const bool rms = params.nPeakMode == SCE_NGS_COMPRESSOR_RMS_MODE;
+    const Vec4 attack = splat(std::exp(-1.0f / (std::max(params.fAttack, 0.01f) * 0.001f * sample_rate)));
+    const Vec4 release = splat(std::exp(-1.0f / (std::max(params.fRelease, 0.01f) * 0.001f * sample_rate)));
+
+    Vec4 envelope = load2(state.envelope);
+    for (uint32_t start = 0; start < frames; start += COMPRESSOR_CONTROL_FRAMES) {
+        const uint32_t count = std::min(COMPRESSOR_CONTROL_FRAMES, frames - start);
+        const float *block_in = in + start * 2;
+        float *block_out = out + start * 2;
+
+        // level detection
+        for (uint32_t i = 0; i < count; i++) {
+            const Vec4 x = load2(block_in + i * 2);
+            const Vec4 level = rms ? mul(x, x) : abs(x);
+            const Vec4 coeff = select_greater(level, envelope, attack, release);
+            envelope = add(level, mul(coeff, sub(envelope, level)));
+        }
+        store2(state.envelope, envelope);
+        flush_denormals(state.envelope, 2);
+
+        float level[2];
+        float level_db[2];
+        for (int c = 0; c < 2; c++) {
+            level[c] = rms ? std::sqrt(state.envelope[c]) : state.envelope[c];
+            level_db[c] = 20.0f * std::log10(std::max(level[c], 1e-6f));
+        }
+        if (params.nStereoLink == SCE_NGS_COMPRESSOR_STEREO_LINK_ON)
+            level_db[0] = level_db[1] = std::max(level_db[0], level_db[1]);
+
+        float target[2];
+        for (int c = 0; c < 2; c++) {
+            target[c] = compressor_gain(params, level_db[c]);
+            levels.fInputLevel[c] = level[c];
+            levels.fOutputLevel[c] = level[c] * target[c];
+        }
+
+        // apply the gain
+        const Vec4 gain = set4(state.gain[0], state.gain[1], 0.0f, 0.0f);
+        const Vec4 step = div(sub(set4(target[0], target[1], 0.0f, 0.0f), gain), splat(static_cast<float>(count)));
+        for (uint32_t i = 0; i < count; i++) {
+            const Vec4 frame_gain = add(gain, mul(step, splat(static_cast<float>(i + 1))));
+            store2(block_out + i * 2, mul(load2(block_in + i * 2), frame_gain));
+        }
+        state.gain[0] = target[0];
+        state.gain[1] = target[1];
+    }
+}
+
+static constexpr float DELAY_MAX_MILLISECS = 4000.0f;
+
+static float get_tap_max_delay(const SceNgsDelayTap &tap) {
+    return std::clamp(tap.fDelayMillisecs + std::fabs(tap.fModWidthMillisecs), 0.0f, DELAY_MAX_MILLISECS);
+}
+
+uint32_t delay_memory_size(const SceNgsDelayParams &params, const float sample_rate) {
+    float max_delay = 0.0f;
+    for (const SceNgsDelayTap &tap : params.taps)
+        max_delay = std::max(max_delay, get_tap_max_delay(tap));
+
+    const uint32_t frames = static_cast<uint32_t>(std::ceil(max_delay * sample_rate / 1000.0f)) + 2;
+    return std::bit_ceil(frames) * 2;
+}
+
+void delay_process(const SceNgsDelayParams &params, DelayState &state, float *memory, const float *in, float *out, const uint32_t frames, const float sample_rate) {
+    const uint32_t memory_frames = delay_memory_size(params, sample_rate) / 2;
+    const uint32_t mask = memory_frames - 1;
+    const float frames_per_ms = sample_rate / 1000.0f;
+    const float max_delay = static_cast<float>(memory_frames - 2);
+
+    struct Tap {
+        float delay;
+        float width;
+        float phase;
+        float filter;
+        Vec4 volume;
+        Vec4 feedback;
+        Vec4 x1;
+        Vec4 y1;
+        SceNgsDelayFilterMode mode;
+    };
+    // keep the loop stable whatever the game gives us, all the taps feed the same line
+    float total_feedback = 0.0f;
+    for (const SceNgsDelayTap &tap : params.taps) {
+        if (tap.fDelayMillisecs > 0.0f)
+            total_feedback += std::fabs(tap.fFeedback);
+    }
+    const float feedback_scale = (total_feedback > 0.99f) ? 0.99f / total_feedback : 1.0f;
+
+    Tap taps[SCE_NGS_DELAY_MAX_TAPS];
+    uint32_t tap_count = 0;
+    for (uint32_t t = 0; t < SCE_NGS_DELAY_MAX_TAPS; t++) {
+        const SceNgsDelayTap &tap = params.taps[t];
+        if (tap.fDelayMillisecs <= 0.0f || (tap.fVolume == 0.0f && tap.fFeedback == 0.0f))
+            continue;
+
+        Tap &active = taps[tap_count++];
+        active.delay = tap.fDelayMillisecs * frames_per_ms;
+        active.width = tap.fModWidthMillisecs * frames_per_ms;
+        active.phase = tap.fPhaseOffsetDeg * PI / 180.0f;
+        active.volume = splat(tap.fVolume);
+        active.feedback = splat(tap.fFeedback * feedback_scale);
+        active.x1 = load2(state.filter_x1[t]);
+        active.y1 = load2(state.filter_y1[t]);
+        active.mode = tap.eFilterMode;
+
+        const float w = 2.0f * PI * std::clamp(tap.fCutoff, 10.0f, sample_rate * 0.49f) / sample_rate;
+        if (tap.eFilterMode == SCE_NGS_DELAY_FILTER_MODE_ALLPASS) {
+            const float t = std::tan(w / 2.0f);
+            active.filter = (t - 1.0f) / (t + 1.0f);
+        } else {
+            active.filter = 1.0f - std::exp(-w);
+        }
+    }
+
+    const Vec4 dry = splat(params.fDryVol);
+    const float mod_step = 2.0f * PI * params.fModRate / sample_rate;
+    uint32_t position = state.position & mask;
+    float mod_phase = state.mod_phase;
+
+    for (uint32_t i = 0; i < frames; i++) {
+        const Vec4 x = load2(in + i * 2);
+        Vec4 result = mul(x, dry);
+        Vec4 feedback = splat(0.0f);
+
+        for (uint32_t t = 0; t < tap_count; t++) {
+            Tap &tap = taps[t];
+            float delay = tap.delay;
+            if (tap.width != 0.0f)
+                delay += tap.width * std::sin(mod_phase + tap.phase);
+            delay = std::clamp(delay, 1.0f, max_delay);
+
+            // linear interpolation between the 2 closest frames
+            const float read_position = static_cast<float>(position + memory_frames) - delay;
+            const uint32_t index = static_cast<uint32_t>(read_position);
+            const float frac = read_position - static_cast<float>(index);
+            const Vec4 a = load2(memory + (index & mask) * 2);
+            const Vec4 b = load2(memory + ((index + 1) & mask) * 2);
+            Vec4 value = mix(a, b, frac);
+
+            switch (tap.mode) {
+            case SCE_NGS_DELAY_FILTER_MODE_LOWPASS_ONEPOLE:
+                tap.y1 = add(tap.y1, mul(splat(tap.filter), sub(value, tap.y1)));
+                value = tap.y1;
+                break;
+            case SCE_NGS_DELAY_FILTER_MODE_HIGHPASS_ONEPOLE:
+                tap.y1 = add(tap.y1, mul(splat(tap.filter), sub(value, tap.y1)));
+                value = sub(value, tap.y1);
+                break;
+            case SCE_NGS_DELAY_FILTER_MODE_ALLPASS: {
+                const Vec4 y = sub(add(mul(splat(tap.filter), value), tap.x1), mul(splat(tap.filter), tap.y1));
+                tap.x1 = value;
+                tap.y1 = y;
+                value = y;
+                break;
+            }
+            default:
+                break;
+            }
+
+            result = add(result, mul(value, tap.volume));
+            feedback = add(feedback, mul(value, tap.feedback));
+        }
+
+        store2(memory + position * 2, add(x, feedback));
+        store2(out + i * 2, result);
+
+        position = (position + 1) & mask;
+        mod_phase += mod_step;
+        if (mod_phase >= 2.0f * PI)
+            mod_phase -= 2.0f * PI;
+    }
+
+    state.position = position;
+    state.mod_phase = mod_phase;
+
+    tap_count = 0;
+    for (uint32_t t = 0; t < SCE_NGS_DELAY_MAX_TAPS; t++) {
+        const SceNgsDelayTap &tap = params.taps[t];
+        if (tap.fDelayMillisecs <= 0.0f || (tap.fVolume == 0.0f && tap.fFeedback == 0.0f))
+            continue;
+
+        store2(state.filter_x1[t], taps[tap_count].x1);
+        store2(state.filter_y1[t], taps[tap_count].y1);
+        flush_denormals(state.filter_x1[t], 2);
+        flush_denormals(state.filter_y1[t], 2);
+        tap_count++;
+    }
+}
+
+// wet = clip(a x / (1 + b |a x|)), silenced below the gate
+void distortion_process(const SceNgsDistortionParams &params, const float *in, float *out, const uint32_t frames) {
+    const Vec4 a = splat(params.fA);
+    const Vec4 b = splat(std::max(params.fB, 0.0f));
+    const Vec4 clip = splat(params.fClip > 0.0f ? params.fClip : FLT_MAX);
+    const Vec4 negative_clip = splat(params.fClip > 0.0f ? -params.fClip : -FLT_MAX);
+    const Vec4 gate = splat(params.fGate);
+    const Vec4 wet = splat(params.fWetGain);
+    const Vec4 dry = splat(params.fDryGain);
+    const Vec4 one = splat(1.0f);
+    const Vec4 zero = splat(0.0f);
+
+    const auto process = [&](Vec4 x) {
+        const Vec4 driven = mul(x, a);
+        Vec4 shaped = div(driven, add(one, mul(b, abs(driven))));
+        shaped = min(max(shaped, negative_clip), clip);
+        shaped = select_greater(gate, abs(x), zero, shaped);
+        return add(mul(shaped, wet), mul(x, dry));
+    };
+
+    const uint32_t count = frames * 2;
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        store4(out + i, process(load4(in + i)));
+    if (i < count)
+        store2(out + i, process(load2(in + i)));
+}
+
+void envelope_reset(SceNgsEnvelopeStates &state) {
+    state = {};
+}
+
+static float envelope_interpolate(const float from, const float to, const float t, const SceNgsEnvelopeCurveType curve) {
+    const float shaped = (curve == SCE_NGS_ENVELOPE_CURVED) ? t * t : t;
+    return from + (to - from) * shaped;
+}
+
+// envelope gains are computed for this many frames at once
+static constexpr uint32_t ENVELOPE_BLOCK_FRAMES = 64;
+
+bool envelope_process(const SceNgsEnvelopeParams &params, SceNgsEnvelopeStates &state, const bool releasing,
+    const float *in, float *out, const uint32_t frames, const float sample_rate) {
+    const float ms_per_frame = 1000.0f / sample_rate;
+    const int32_t point_count = static_cast<int32_t>(std::min<uint32_t>(params.uNumPoints, SCE_NGS_ENVELOPE_MAX_POINTS));
+    const float release_time = static_cast<float>(params.uReleaseMsecs);
+    const bool loop = params.nLoopEnd >= 0 && params.nLoopEnd < point_count && static_cast<int32_t>(params.uLoopStart) < params.nLoopEnd;
+
+    if (point_count == 0 && !releasing) {
+        state.fCurrentHeight = 1.0f;
+        copy_frames(in, out, frames);
+        return false;
+    }
+
+    float gains[ENVELOPE_BLOCK_FRAMES];
+    for (uint32_t start = 0; start < frames; start += ENVELOPE_BLOCK_FRAMES) {
+        const uint32_t count = std::min(ENVELOPE_BLOCK_FRAMES, frames - start);
+
+        for (uint32_t i = 0; i < count; i++) {
+            if (releasing) {
+                if (!state.nReleasing) {
+                    state.nReleasing = 1;
+                    state.fReleaseScale = state.fCurrentHeight;
+                    state.fPosition = 0.0f;
+                }
+
+                if (state.fPosition < release_time)
+                    state.fCurrentHeight = state.fReleaseScale * (1.0f - state.fPosition / release_time);
+                else
+                    state.fCurrentHeight = 0.0f;
+            } else {
+                // move to the segment containing the current position, zero length segments are skipped
+                for (int32_t step = 0; step <= point_count && state.nCurrentPoint < point_count - 1; step++) {
+                    const float duration = static_cast<float>(params.envelopePoints[state.nCurrentPoint].uMsecsToNextPoint);
+                    if (state.fPosition < duration)
+                        break;
+
+                    state.fPosition -= duration;
+                    state.nCurrentPoint++;
+                    if (loop && state.nCurrentPoint >= params.nLoopEnd)
+                        state.nCurrentPoint = params.uLoopStart;
+                }
+
+                if (state.nCurrentPoint >= point_count - 1) {
+                    // sustain on the last point
+                    state.nCurrentPoint = point_count - 1;
+                    state.fCurrentHeight = params.envelopePoints[point_count - 1].fAmplitude;
+                } else {
+                    const SceNgsEnvelopePoint &point = params.envelopePoints[state.nCurrentPoint];
+                    const SceNgsEnvelopePoint &next = params.envelopePoints[state.nCurrentPoint + 1];
+                    const float t = state.fPosition / static_cast<float>(point.uMsecsToNextPoint);
+                    state.fCurrentHeight = envelope_interpolate(point.fAmplitude, next.fAmplitude, t, point.eCurveType);
+                }
+            }
+
+            gains[i] = state.fCurrentHeight;
+            state.fPosition += ms_per_frame;
+        }
+
+        // apply the gains, 2 frames at once
+        const float *block_in = in + start * 2;
+        float *block_out = out + start * 2;
+        uint32_t i = 0;
+        for (; i + 2 <= count; i += 2)
+            store4(block_out + i * 2, mul(load4(block_in + i * 2), set4(gains[i], gains[i], gains[i + 1], gains[i + 1])));
+        if (i < count)
+            store2(block_out + i * 2, mul(load2(block_in + i * 2), splat(gains[i])));
+    }
+
+    return releasing && state.fPosition >= release_time;
+}
+
+void generator_reset(const SceNgsGeneratorParams &params, GeneratorState &state, const float sample_rate) {
+    const double start = params.uPhaseAngle / 360.0 + static_cast<double>(params.uSampleOffset) * params.nFrequency / sample_rate;
+    state.phase = start - std::floor(start);
+    state.noise = 0x2545F491;
+    state.noise_value = 0.0f;
+}
+
+static float next_noise(GeneratorState &state) {
+    // xorshift32
+    if (state.noise == 0)
+        state.noise = 0x2545F491;
+    state.noise ^= state.noise << 13;
+    state.noise ^= state.noise >> 17;
+    state.noise ^= state.noise << 5;
+    return static_cast<float>(static_cast<int32_t>(state.noise)) / 2147483648.0f;
+}
+
+// samples are generated for this many frames at once
+static constexpr uint32_t GENERATOR_BLOCK_FRAMES = 64;
+
+void generator_process(const SceNgsGeneratorParams &params, GeneratorState &state, const float *in, float *out, const uint32_t frames, const float sample_rate) {
+    const double step = static_cast<double>(params.nFrequency) / sample_rate;
+    const float pulse_width = std::clamp(params.fPulseWidth, 0.0f, 1.0f);
+
+    float samples[GENERATOR_BLOCK_FRAMES];
+    for (uint32_t start = 0; start < frames; start += GENERATOR_BLOCK_FRAMES) {
+        const uint32_t count = std::min(GENERATOR_BLOCK_FRAMES, frames - start);
+
+        for (uint32_t i = 0; i < count; i++) {
+            const float phase = static_cast<float>(state.phase);
+            switch (params.eGeneratorMode) {
+            case SCE_NGS_GENERATOR_SINE:
+                samples[i] = std::sin(2.0f * PI * phase);
+                break;
+            case SCE_NGS_GENERATOR_TRIANGLE:
+                samples[i] = 1.0f - 4.0f * std::fabs(phase - 0.5f);
+                break;
+            case SCE_NGS_GENERATOR_SAW:
+                samples[i] = 2.0f * phase - 1.0f;
+                break;
+            case SCE_NGS_GENERATOR_NOISE:
+                samples[i] = next_noise(state);
+                break;
+            case SCE_NGS_GENERATOR_NOISE_PSP:
+                // sample and hold noise, a new value every period
+                samples[i] = state.noise_value;
+                break;
+            case SCE_NGS_GENERATOR_PULSE:
+                samples[i] = phase < pulse_width ? 1.0f : -1.0f;
+                break;
+            default:
+                samples[i] = 0.0f;
+                break;
+            }
+
+            state.phase += step;
+            if (state.phase >= 1.0 || state.phase < 0.0) {
+                state.phase -= std::floor(state.phase);
+                if (params.eGeneratorMode == SCE_NGS_GENERATOR_NOISE_PSP)
+                    state.noise_value = next_noise(state);
+            }
+        }
+
+        const Vec4 amplitude = splat(params.fAmplitude);
+        const float *block_in = in ? in + start * 2 : nullptr;
+        float *block_out = out + start * 2;
+        uint32_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            Vec4 value = mul(set4(samples[i], samples[i], samples[i + 1], samples[i + 1]), amplitude);
+            if (block_in)
+                value = add(value, load4(block_in + i * 2));
+            store4(block_out + i * 2, value);
+        }
+        if (i < count) {
+            Vec4 value = mul(splat(samples[i]), amplitude);
+            if (block_in)
+                value = add(value, load2(block_in + i * 2));
+            store2(block_out + i * 2, value);
+        }
+    }
+}
+
+// Delay line pitch shifter: 2 read heads move through the window at the pitch ratio and are crossfaded
+static constexpr uint32_t PITCHSHIFT_MEMORY_FRAMES = 2048;
+static constexpr float PITCHSHIFT_WINDOW_FRAMES = 1024.0f;
+
+uint32_t pitchshift_memory_size() {
+    return PITCHSHIFT_MEMORY_FRAMES * 2;
+}
+
+void pitchshift_process(const SceNgsPitchShiftParams &params, PitchShiftState &state, float *memory, const float *in, float *out, const uint32_t frames) {
+    constexpr uint32_t mask = PITCHSHIFT_MEMORY_FRAMES - 1;
+    const float cents = std::clamp(params.fPitchOffsetInCents, -2400.0f, 2400.0f);
+    const float ratio = std::exp2(cents / 1200.0f);
+    const float phase_step = (1.0f - ratio) / PITCHSHIFT_WINDOW_FRAMES;
+
+    const auto read = [&](const uint32_t position, const float delay) {
+        const float read_position = static_cast<float>(position + PITCHSHIFT_MEMORY_FRAMES) - delay;
+        const uint32_t index = static_cast<uint32_t>(read_position);
+        const float frac = read_position - static_cast<float>(index);
+        return mix(load2(memory + (index & mask) * 2), load2(memory + ((index + 1) & mask) * 2), frac);
+    };
+
+    uint32_t position = state.position & mask;
+    float phase = state.phase;
+    for (uint32_t i = 0; i < frames; i++) {
+        store2(memory + position * 2, load2(in + i * 2));
+
+        const float phase2 = (phase >= 0.5f) ? phase - 0.5f : phase + 0.5f;
+        const float gain = 1.0f - std::fabs(2.0f * phase - 1.0f);
+        const Vec4 value = mix(read(position, phase2 * PITCHSHIFT_WINDOW_FRAMES), read(position, phase * PITCHSHIFT_WINDOW_FRAMES), gain);
+        store2(out + i * 2, value);
+
+        position = (position + 1) & mask;
+        phase += phase_step;
+        phase -= std::floor(phase);
+    }
+
+    state.position = position;
+    state.phase = phase;
+}
+
+// Feedback delay network reverb: 4 delay lines mixed by a Hadamard matrix, processed as a single vector
+static constexpr float REVERB_REFERENCE_RATE = 44100.0f;
+static constexpr float REVERB_LINE_LENGTHS[4] = { 1557.0f, 1617.0f, 1491.0f, 1422.0f };
+static constexpr float REVERB_ALLPASS_LENGTHS[2] = { 225.0f, 556.0f };
+static constexpr float REVERB_EARLY_TAPS[4] = { 1.0f, 1.37f, 1.71f, 2.13f };
+static constexpr float REVERB_MAX_REFLECTIONS_DELAY = 0.3f;
+static constexpr float REVERB_MAX_REVERB_DELAY = 0.1f;
+
+struct ReverbLayout {
+    uint32_t predelay_size;
+    uint32_t line_size;
+    uint32_t allpass_size[2];
+};
+
+static ReverbLayout get_reverb_layout(const float sample_rate) {
+    const float scale = sample_rate / REVERB_REFERENCE_RATE;
+    const float max_predelay = (REVERB_MAX_REFLECTIONS_DELAY * REVERB_EARLY_TAPS[3] + REVERB_MAX_REVERB_DELAY) * sample_rate;
+
+    ReverbLayout layout;
+    layout.predelay_size = std::bit_ceil(static_cast<uint32_t>(max_predelay) + 2);
+    layout.line_size = std::bit_ceil(static_cast<uint32_t>(*std::max_element(std::begin(REVERB_LINE_LENGTHS), std::end(REVERB_LINE_LENGTHS)) * scale) + 2);
+    for (int i = 0; i < 2; i++)
+        layout.allpass_size[i] = std::bit_ceil(static_cast<uint32_t>(REVERB_ALLPASS_LENGTHS[i] * scale) + 2);
+
+    return layout;
+}
+
+uint32_t reverb_memory_size(const float sample_rate) {
+    const ReverbLayout layout = get_reverb_layout(sample_rate);
+    return layout.predelay_size + layout.line_size * 4 + layout.allpass_size[0] + layout.allpass_size[1];
+}
+
+// Level parameters are in millibels, times in seconds, like I3DL2
+void reverb_process(const SceNgsReverbParams &params, ReverbState &state, float *memory, const float *in, float *out, const uint32_t frames, const float sample_rate) {
+    const ReverbLayout layout = get_reverb_layout(sample_rate);
+    float *predelay = memory;
+    float *lines = predelay + layout.predelay_size;
+    float *allpass[2] = { lines + layout.line_size * 4, lines + layout.line_size * 4 + layout.allpass_size[0] };
+    const uint32_t predelay_mask = layout.predelay_size - 1;
+    const uint32_t line_mask = layout.line_size - 1;
+    const uint32_t allpass_mask[2] = { layout.allpass_size[0] - 1, layout.allpass_size[1] - 1 };
+
+    const float scale = sample_rate / REVERB_REFERENCE_RATE;
+    const float room = millibels_to_gain(std::min(params.fRoom, 0.0f)) * 0.5f;
+    const float reflections = millibels_to_gain(std::min(params.fReflections, 1000.0f)) * 0.5f;
+    const Vec4 reverb = splat(millibels_to_gain(std::min(params.fReverb, 2000.0f)) * 0.5f);
+    const Vec4 dry = splat(millibels_to_gain(std::min(params.fDryMB, 0.0f)));
+
+    const float hf_reference = std::clamp(params.fHFReference, 20.0f, sample_rate * 0.45f);
+    const float cos_w = std::cos(2.0f * PI * hf_reference / sample_rate);
+    const float input_coeff = lowpass_coeff(millibels_to_gain(std::min(params.fRoomHF, 0.0f)), cos_w);
+
+    const float decay_time = std::clamp(params.fDecayTime, 0.1f, 20.0f);
+    const float decay_hf_ratio = std::clamp(params.fDecayHFRatio, 0.1f, 2.0f);
+    const float density = std::clamp(params.fDensity, 0.0f, 100.0f) / 100.0f;
+    const float diffusion = 0.7f * std::clamp(params.fDiffusion, 0.0f, 100.0f) / 100.0f;
+
+    uint32_t line_lengths[4];
+    float line_gains[4];
+    float line_damping[4];
+    for (int i = 0; i < 4; i++) {
+        line_lengths[i] = std::max(1u, static_cast<uint32_t>(REVERB_LINE_LENGTHS[i] * scale * (0.5f + 0.5f * density)));
+        // -60 dB after decay_time seconds
+        line_gains[i] = std::pow(10.0f, -3.0f * line_lengths[i] / (sample_rate * decay_time));
+        const float hf_gain = std::pow(10.0f, -3.0f * line_lengths[i] / (sample_rate * decay_time * decay_hf_ratio));
+        line_damping[i] = (decay_hf_ratio < 1.0f) ? lowpass_coeff(hf_gain / line_gains[i], cos_w) : 0.0f;
+    }
+    uint32_t allpass_lengths[2];
+    for (int i = 0; i < 2; i++)
+        allpass_lengths[i] = static_cast<uint32_t>(REVERB_ALLPASS_LENGTHS[i] * scale);
+
+    const float reflections_delay = std::clamp(params.fReflectionsDelay, 0.0f, REVERB_MAX_REFLECTIONS_DELAY) * sample_rate;
+    const uint32_t reverb_delay = static_cast<uint32_t>(reflections_delay + std::clamp(params.fReverbDelay, 0.0f, REVERB_MAX_REVERB_DELAY) * sample_rate);
+    uint32_t early_delays[4];
+    for (int i = 0; i < 4; i++)
+        early_delays[i] = static_cast<uint32_t>(reflections_delay * REVERB_EARLY_TAPS[i]);
+
+    const Vec4 gains = set4(line_gains[0], line_gains[1], line_gains[2], line_gains[3]);
+    const Vec4 damping = set4(line_damping[0], line_damping[1], line_damping[2], line_damping[3]);
+    Vec4 damping_state = load4(state.damping);
+    float input_filter = state.input_filter;
+    uint32_t position = state.position;
+
+    for (uint32_t i = 0; i < frames; i++) {
+        const float *frame = in + i * 2;
+
+        // mono input, filtered by the room HF attenuation
+        const float x = (frame[0] + frame[1]) * room;
+        input_filter = x + input_coeff * (input_filter - x);
+        predelay[position & predelay_mask] = input_filter;
+
+        // early reflections, alternating between the left and right channels
+        float early[4];
+        for (int e = 0; e < 4; e++)
+            early[e] = predelay[(position - early_delays[e]) & predelay_mask];
+        const Vec4 early_frame = mul(set4(early[0] + early[2], early[1] + early[3], 0.0f, 0.0f), splat(reflections));
+
+        // input diffusion
+        float late = predelay[(position - reverb_delay) & predelay_mask];
+        for (int a = 0; a < 2; a++) {
+            const float delayed = allpass[a][(position - allpass_lengths[a]) & allpass_mask[a]];
+            const float y = delayed - diffusion * late;
+            allpass[a][position & allpass_mask[a]] = late + diffusion * y;
+            late = y;
+        }
+
+        // feedback delay network
+        const Vec4 delayed = set4(lines[((position - line_lengths[0]) & line_mask) * 4 + 0],
+            lines[((position - line_lengths[1]) & line_mask) * 4 + 1],
+            lines[((position - line_lengths[2]) & line_mask) * 4 + 2],
+            lines[((position - line_lengths[3]) & line_mask) * 4 + 3]);
+        const Vec4 attenuated = mul(delayed, gains);
+        damping_state = add(attenuated, mul(damping, sub(damping_state, attenuated)));
+        // the tiny offset keeps denormals out of the network
+        store4(lines + (position & line_mask) * 4, add(hadamard(damping_state), splat(late + 1e-18f)));
+
+        // lines 0 and 2 go to the left channel, 1 and 3 to the right one
+        const Vec4 wet = add(mul(add(damping_state, swap_halves(damping_state)), reverb), early_frame);
+        store2(out + i * 2, add(wet, mul(load2(frame), dry)));
+
+        position++;
+    }
+
+    store4(state.damping, damping_state);
+    flush_denormals(state.damping, 4);
+    flush_denormals(&input_filter, 1);
+    state.input_filter = input_filter;
+    state.position = position;
+}
+
+} // namespace ngs::dsp
@@ -15,19 +15,38 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
+#include <ngs/dsp.h>
 #include <ngs/modules/compressor.h>
-#include <util/log.h>
 
 namespace ngs {
 
+struct CompressorVoiceState {
+    // returned by sceNgsVoiceGetStateData
+    SceNgsCompressorStates levels{};
+    dsp::CompressorState compressor = { {}, { 1.0f, 1.0f } };
+};
+
 bool CompressorModule::process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
-    if (!data.is_bypassed) {
-        const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
-        if (desc->id == SCE_NGS_COMPRESSOR_PARAMS_STRUCT_ID || desc->id == SCE_NGS_COMPRESSOR_PARAMS_STRUCT_ID_V2) {
-            LOG_WARN_ONCE("Game is using unimplemented compressor audio module");
-        }
-    }
+    const float *input = reinterpret_cast<const float *>(data.parent->products[0].data);
+    if (data.is_bypassed || !input)
+        return false;
+
+    const SceNgsCompressorParams *params = data.get_parameters<SceNgsCompressorParams>(mem);
+    if (params->desc.id != SCE_NGS_COMPRESSOR_PARAMS_STRUCT_ID && params->desc.id != SCE_NGS_COMPRESSOR_PARAMS_STRUCT_ID_V2)
+        return false;
+
+    // the side chain compressor uses its own input as the side chain
+    CompressorVoiceState *state = data.get_state<CompressorVoiceState>();
+    const System *system = data.parent->rack->system;
+    float *output = data.get_output_buffer();
+    dsp::compressor_process(*params, state->compressor, state->levels, input, output, system->granularity, static_cast<float>(system->sample_rate));
+    data.parent->products[0].data = reinterpret_cast<uint8_t *>(output);
 
     return false;
 }
+
+void CompressorModule::on_state_change(const MemState &mem, ModuleData &data, const VoiceState previous) {
+    if (data.parent->state == VOICE_STATE_ACTIVE && previous == VOICE_STATE_AVAILABLE)
+        data.clear_state();
+}
 } // namespace ngs
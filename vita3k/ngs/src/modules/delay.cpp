@@ -15,19 +15,35 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
+#include <ngs/dsp.h>
 #include <ngs/modules/delay.h>
-#include <util/log.h>
 
 namespace ngs {
 
 bool DelayModule::process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
-    if (!data.is_bypassed) {
-        const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
-        if (desc->id == SCE_NGS_DELAY_PARAMS_STRUCT_ID) {
-            LOG_WARN_ONCE("Game is using unimplemented delay audio module");
-        }
-    }
+    const float *input = reinterpret_cast<const float *>(data.parent->products[0].data);
+    if (data.is_bypassed || !input)
+        return false;
+
+    const SceNgsDelayParams *params = data.get_parameters<SceNgsDelayParams>(mem);
+    if (params->desc.id != SCE_NGS_DELAY_PARAMS_STRUCT_ID)
+        return false;
+
+    dsp::DelayState *state = data.get_state<dsp::DelayState>();
+    const System *system = data.parent->rack->system;
+    const float sample_rate = static_cast<float>(system->sample_rate);
+
+    // the delay line is after the output block
+    float *output = data.get_output_buffer(dsp::delay_memory_size(*params, sample_rate));
+    float *memory = output + system->granularity * 2;
+    dsp::delay_process(*params, *state, memory, input, output, system->granularity, sample_rate);
+    data.parent->products[0].data = reinterpret_cast<uint8_t *>(output);
 
     return false;
 }
+
+void DelayModule::on_state_change(const MemState &mem, ModuleData &data, const VoiceState previous) {
+    if (data.parent->state == VOICE_STATE_ACTIVE && previous == VOICE_STATE_AVAILABLE)
+        data.clear_state();
+}
 } // namespace ngs
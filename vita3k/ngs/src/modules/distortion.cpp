@@ -15,18 +15,23 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
+#include <ngs/dsp.h>
 #include <ngs/modules/distortion.h>
-#include <util/log.h>
 
 namespace ngs {
 
 bool DistortionModule::process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
-    if (!data.is_bypassed) {
-        const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
-        if (desc->id == SCE_NGS_DISTORTION_PARAMS_STRUCT_ID) {
-            LOG_WARN_ONCE("Game is using unimplemented distortion audio module");
-        }
-    }
+    const float *input = reinterpret_cast<const float *>(data.parent->products[0].data);
+    if (data.is_bypassed || !input)
+        return false;
+
+    const SceNgsDistortionParams *params = data.get_parameters<SceNgsDistortionParams>(mem);
+    if (params->desc.id != SCE_NGS_DISTORTION_PARAMS_STRUCT_ID)
+        return false;
+
+    float *output = data.get_output_buffer();
+    dsp::distortion_process(*params, input, output, data.parent->rack->system->granularity);
+    data.parent->products[0].data = reinterpret_cast<uint8_t *>(output);
 
     return false;
 }
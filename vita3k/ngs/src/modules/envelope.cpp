@@ -15,19 +15,34 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
+#include <ngs/dsp.h>
 #include <ngs/modules/envelope.h>
-#include <util/log.h>
 
 namespace ngs {
 
 bool EnvelopeModule::process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
-    if (!data.is_bypassed) {
-        const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
-        if (desc->id == SCE_NGS_ENVELOPE_PARAMS_STRUCT_ID) {
-            LOG_WARN_ONCE("Game is using unimplemented envelope audio module");
-        }
-    }
-
-    return false;
+    const float *input = reinterpret_cast<const float *>(data.parent->products[0].data);
+    if (data.is_bypassed || !input)
+        return false;
+
+    const SceNgsEnvelopeParams *params = data.get_parameters<SceNgsEnvelopeParams>(mem);
+    if (params->desc.id != SCE_NGS_ENVELOPE_PARAMS_STRUCT_ID)
+        return false;
+
+    SceNgsEnvelopeStates *state = data.get_state<SceNgsEnvelopeStates>();
+    const System *system = data.parent->rack->system;
+    const bool releasing = data.parent->state == VOICE_STATE_FINALIZING;
+
+    float *output = data.get_output_buffer();
+    const bool finished = dsp::envelope_process(*params, *state, releasing, input, output, system->granularity, static_cast<float>(system->sample_rate));
+    data.parent->products[0].data = reinterpret_cast<uint8_t *>(output);
+
+    // the voice ends with the release
+    return finished;
+}
+
+void EnvelopeModule::on_state_change(const MemState &mem, ModuleData &data, const VoiceState previous) {
+    if (data.parent->state == VOICE_STATE_ACTIVE && previous == VOICE_STATE_AVAILABLE)
+        dsp::envelope_reset(*data.get_state<SceNgsEnvelopeStates>());
 }
 } // namespace ngs
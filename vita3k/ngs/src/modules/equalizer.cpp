@@ -15,24 +15,59 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
+#include <ngs/dsp.h>
 #include <ngs/modules/equalizer.h>
-#include <util/log.h>
+
+#include <algorithm>
 
 namespace ngs {
 
+static void equalize(const MemState &mem, ModuleData &data, VoiceProduct &product) {
+    const float *input = reinterpret_cast<const float *>(product.data);
+    if (data.is_bypassed || !input)
+        return;
+
+    const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
+    dsp::EqualizerState *state = data.get_state<dsp::EqualizerState>();
+    const uint32_t granularity = data.parent->rack->system->granularity;
+    float *output = data.get_output_buffer();
+
+    bool filtered = false;
+    if (desc->id == SCE_NGS_PARAM_EQ_STRUCT_ID) {
+        const float sample_rate = static_cast<float>(data.parent->rack->system->sample_rate);
+        filtered = dsp::equalizer_process(*data.get_parameters<SceNgsParamEqParams>(mem), *state, input, output, granularity, sample_rate);
+    } else if (desc->id == SCE_NGS_PARAM_EQ_COEFF_STRUCT_ID) {
+        filtered = dsp::equalizer_process(*data.get_parameters<SceNgsParamEqParamsCoEff>(mem), *state, input, output, granularity);
+    }
+
+    if (filtered)
+        product.data = reinterpret_cast<uint8_t *>(output);
+}
+
 bool EqualizerModule::process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
-    if (!data.is_bypassed) {
-        const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
-        if (desc->id == SCE_NGS_PARAM_EQ_COEFF_STRUCT_ID || desc->id == SCE_NGS_PARAM_EQ_STRUCT_ID) {
-            LOG_WARN_ONCE("Game is using unimplemented equalizer audio module");
-        }
+    // Definitions with equalizers can have up to 4 outputs. The first equalizer works on the main signal,
+    // the next ones (if any) are each applied to one of the outputs
+    uint32_t position = 0;
+    for (uint32_t i = 0; i < data.index; i++) {
+        if (data.parent->rack->modules[i]->module_id() == module_id())
+            position++;
     }
 
-    // Definitions with equalizers can have up to 4 outputs
-    data.parent->products[1] = data.parent->products[0];
-    data.parent->products[2] = data.parent->products[0];
-    data.parent->products[3] = data.parent->products[0];
+    if (position == 0) {
+        equalize(mem, data, data.parent->products[0]);
+        std::fill_n(&data.parent->products[1], 3, data.parent->products[0]);
+    } else if (position <= MAX_VOICE_OUTPUT) {
+        // the output equalizers get the signal after the modules in between
+        if (position == 1)
+            std::fill_n(&data.parent->products[1], 3, data.parent->products[0]);
+        equalize(mem, data, data.parent->products[position - 1]);
+    }
 
     return false;
 }
+
+void EqualizerModule::on_state_change(const MemState &mem, ModuleData &data, const VoiceState previous) {
+    if (data.parent->state == VOICE_STATE_ACTIVE && previous == VOICE_STATE_AVAILABLE)
+        data.clear_state();
+}
 } // namespace ngs
@@ -15,22 +15,45 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
+#include <ngs/dsp.h>
 #include <ngs/modules/filter.h>
-#include <util/log.h>
 
 namespace ngs {
 
 bool FilterModule::process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
-    if (!data.is_bypassed) {
-        const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
-        if (desc->id == SCE_NGS_FILTER_PARAMS_COEFF_STRUCT_ID || desc->id == SCE_NGS_FILTER_PARAMS_STRUCT_ID) {
-            LOG_WARN_ONCE("Game is using unimplemented filter audio module");
-        }
+    // Definitions with filters have 2 outputs, the first filter is for the first send and the second one for the other
+    const bool first_filter = data.index == 0 || data.parent->rack->modules[data.index - 1]->module_id() != module_id();
+    if (first_filter)
+        data.parent->products[1] = data.parent->products[0];
+
+    VoiceProduct &product = data.parent->products[first_filter ? 0 : 1];
+    const float *input = reinterpret_cast<const float *>(product.data);
+    if (data.is_bypassed || !input)
+        return false;
+
+    const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
+    dsp::BiquadCoeffs coeffs;
+    if (desc->id == SCE_NGS_FILTER_PARAMS_STRUCT_ID) {
+        const SceNgsFilterParams *params = data.get_parameters<SceNgsFilterParams>(mem);
+        if (params->params.eFilterMode == SCE_NGS_FILTER_MODE_OFF)
+            return false;
+        coeffs = dsp::make_biquad(params->params, static_cast<float>(data.parent->rack->system->sample_rate));
+    } else if (desc->id == SCE_NGS_FILTER_PARAMS_COEFF_STRUCT_ID) {
+        coeffs = dsp::make_biquad(data.get_parameters<SceNgsFilterParamsCoEff>(mem)->params);
+    } else {
+        return false;
     }
 
-    // Definitions with filters have 2 outputs
-    data.parent->products[1] = data.parent->products[0];
+    dsp::BiquadState *state = data.get_state<dsp::BiquadState>();
+    float *output = data.get_output_buffer();
+    dsp::biquad_process(coeffs, *state, input, output, data.parent->rack->system->granularity);
+    product.data = reinterpret_cast<uint8_t *>(output);
 
     return false;
 }
+
+void FilterModule::on_state_change(const MemState &mem, ModuleData &data, const VoiceState previous) {
+    if (data.parent->state == VOICE_STATE_ACTIVE && previous == VOICE_STATE_AVAILABLE)
+        data.clear_state();
+}
 } // namespace ngs
@@ -15,19 +15,43 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
+#include <ngs/dsp.h>
 #include <ngs/modules/generator.h>
-#include <util/log.h>
 
 namespace ngs {
 
+struct GeneratorVoiceState {
+    bool initialized = false;
+    dsp::GeneratorState generator{};
+};
+
 bool GeneratorModule::process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
-    if (!data.is_bypassed) {
-        const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
-        if (desc->id == SCE_NGS_GENERATOR_PARAMS_STRUCT_ID) {
-            LOG_WARN_ONCE("Game is using unimplemented generator audio module");
-        }
+    if (data.is_bypassed)
+        return false;
+
+    const SceNgsGeneratorParams *params = data.get_parameters<SceNgsGeneratorParams>(mem);
+    if (params->desc.id != SCE_NGS_GENERATOR_PARAMS_STRUCT_ID || params->fAmplitude == 0.0f)
+        return false;
+
+    GeneratorVoiceState *state = data.get_state<GeneratorVoiceState>();
+    const System *system = data.parent->rack->system;
+    const float sample_rate = static_cast<float>(system->sample_rate);
+    if (!state->initialized) {
+        dsp::generator_reset(*params, state->generator, sample_rate);
+        state->initialized = true;
     }
 
+    // the generated signal is added to the one of the player
+    const float *input = reinterpret_cast<const float *>(data.parent->products[0].data);
+    float *output = data.get_output_buffer();
+    dsp::generator_process(*params, state->generator, input, output, system->granularity, sample_rate);
+    data.parent->products[0].data = reinterpret_cast<uint8_t *>(output);
+
     return false;
 }
+
+void GeneratorModule::on_state_change(const MemState &mem, ModuleData &data, const VoiceState previous) {
+    if (data.parent->state == VOICE_STATE_ACTIVE && previous == VOICE_STATE_AVAILABLE)
+        data.clear_state();
+}
 } // namespace ngs
@@ -15,19 +15,33 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
+#include <ngs/dsp.h>
 #include <ngs/modules/pitchshift.h>
-#include <util/log.h>
 
 namespace ngs {
 
 bool PitchShiftModule::process(KernelState &kern, const MemState &mem, const SceUID thread_id, ModuleData &data, std::unique_lock<std::recursive_mutex> &scheduler_lock, std::unique_lock<std::mutex> &voice_lock) {
-    if (!data.is_bypassed) {
-        const SceNgsParamsDescriptor *desc = data.get_parameters<SceNgsParamsDescriptor>(mem);
-        if (desc->id == SCE_NGS_PITCHSHIFT_PARAMS_STRUCT_ID) {
-            LOG_WARN_ONCE("Game is using unimplemented pitchshift audio module");
-        }
-    }
+    const float *input = reinterpret_cast<const float *>(data.parent->products[0].data);
+    if (data.is_bypassed || !input)
+        return false;
+
+    const SceNgsPitchShiftParams *params = data.get_parameters<SceNgsPitchShiftParams>(mem);
+    if (params->desc.id != SCE_NGS_PITCHSHIFT_PARAMS_STRUCT_ID)
+        return false;
+
+    dsp::PitchShiftState *state = data.get_state<dsp::PitchShiftState>();
+    const uint32_t granularity = data.parent->rack->system->granularity;
+
+    float *output = data.get_output_buffer(dsp::pitchshift_memory_size());
+    float *memory = output + granularity * 2;
+    dsp::pitchshift_process(*params, *state, memory, input, output, granularity);
+    data.parent->products[0].data = reinterpret_cast<uint8_t *>(output);
 
     return false;
 }
+
+void PitchShiftModule::on_state_change(const MemState &mem, ModuleData &data, const VoiceState previous) {
+    if (data.parent->state == VOICE_STATE_ACTIVE && previous == VOICE_STATE_AVAILABLE)
+        data.clear_state();
+}
 } // namespace ngs
@@ -149,6 +149,19 @@ void ModuleData::fill_to_fit_granularity() {
     }
 }
 
+float *ModuleData::get_output_buffer(const uint32_t memory_size) {
+    const size_t size = (parent->rack->system->granularity * 2 + memory_size) * sizeof(float);
+    if (extra_storage.size() != size)
+        extra_storage.assign(size, 0);
+
+    return reinterpret_cast<float *>(extra_storage.data());
+}
+
+void ModuleData::clear_state() {
+    voice_state_data.clear();
+    extra_storage.clear();
+}
+
 void Voice::init(Rack *mama) {
     rack = mama;
     state = VoiceState::VOICE_STATE_AVAILABLE;
@@ -0,0 +1,424 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <ngs/dsp.h>
+#include <testutil/benchmark.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numbers>
+#include <string>
+#include <vector>
+
+using namespace ngs;
+
+static constexpr float SAMPLE_RATE = 48000.0f;
+static constexpr uint32_t GRANULARITY = 512;
+
+static std::vector<float> make_sine(const float frequency, const uint32_t frames) {
+    std::vector<float> buffer(frames * 2);
+    for (uint32_t i = 0; i < frames; i++)
+        buffer[i * 2] = buffer[i * 2 + 1] = std::sin(2.0f * std::numbers::pi_v<float> * frequency * i / SAMPLE_RATE);
+    return buffer;
+}
+
+static std::vector<float> make_impulse(const uint32_t frames) {
+    std::vector<float> buffer(frames * 2, 0.0f);
+    buffer[0] = buffer[1] = 1.0f;
+    return buffer;
+}
+
+static float peak(const float *buffer, const uint32_t frames) {
+    float result = 0.0f;
+    for (uint32_t i = 0; i < frames * 2; i++)
+        result = std::max(result, std::fabs(buffer[i]));
+    return result;
+}
+
+TEST(ngs_dsp, biquad_matches_direct_form) {
+    const SceNgsParamFilter filter = { SCE_NGS_FILTER_LOWPASS_RESONANT, 1000.0f, 2.0f, 1.0f };
+    const dsp::BiquadCoeffs coeffs = dsp::make_biquad(filter, SAMPLE_RATE);
+
+    const std::vector<float> input = make_sine(440.0f, GRANULARITY);
+    std::vector<float> output(input.size());
+    dsp::BiquadState state{};
+    // split in 2 blocks to check the state is kept
+    dsp::biquad_process(coeffs, state, input.data(), output.data(), 100);
+    dsp::biquad_process(coeffs, state, input.data() + 200, output.data() + 200, GRANULARITY - 100);
+
+    for (int c = 0; c < 2; c++) {
+        double x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+        for (uint32_t i = 0; i < GRANULARITY; i++) {
+            const double x = input[i * 2 + c];
+            const double y = coeffs.b0 * x + coeffs.b1 * x1 + coeffs.b2 * x2 - coeffs.a1 * y1 - coeffs.a2 * y2;
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = y;
+            ASSERT_NEAR(output[i * 2 + c], y, 1e-4);
+        }
+    }
+}
+
+TEST(ngs_dsp, lowpass_attenuates_high_frequencies) {
+    const SceNgsParamFilter filter = { SCE_NGS_FILTER_LOWPASS_RESONANT, 500.0f, 0.707f, 1.0f };
+    const dsp::BiquadCoeffs coeffs = dsp::make_biquad(filter, SAMPLE_RATE);
+
+    std::vector<float> low = make_sine(100.0f, 4800);
+    std::vector<float> high = make_sine(8000.0f, 4800);
+    dsp::BiquadState low_state{};
+    dsp::BiquadState high_state{};
+    dsp::biquad_process(coeffs, low_state, low.data(), low.data(), 4800);
+    dsp::biquad_process(coeffs, high_state, high.data(), high.data(), 4800);
+
+    // skip the transient
+    EXPECT_NEAR(peak(low.data() + 4800, 2400), 1.0f, 0.05f);
+    EXPECT_LT(peak(high.data() + 4800, 2400), 0.01f);
+}
+
+TEST(ngs_dsp, distortion_matches_formula) {
+    SceNgsDistortionParams params{};
+    params.fA = 4.0f;
+    params.fB = 1.0f;
+    params.fClip = 0.6f;
+    params.fGate = 0.05f;
+    params.fWetGain = 0.75f;
+    params.fDryGain = 0.25f;
+
+    // odd frame count to go through the tail
+    constexpr uint32_t frames = 101;
+    const std::vector<float> input = make_sine(300.0f, frames);
+    std::vector<float> output(input.size());
+    dsp::distortion_process(params, input.data(), output.data(), frames);
+
+    for (uint32_t i = 0; i < frames * 2; i++) {
+        const float x = input[i];
+        float wet = std::clamp(params.fA * x / (1.0f + params.fB * std::fabs(params.fA * x)), -params.fClip, params.fClip);
+        if (std::fabs(x) < params.fGate)
+            wet = 0.0f;
+        ASSERT_NEAR(output[i], wet * params.fWetGain + x * params.fDryGain, 1e-5f);
+    }
+}
+
+TEST(ngs_dsp, generator_sine) {
+    SceNgsGeneratorParams params{};
+    params.eGeneratorMode = SCE_NGS_GENERATOR_SINE;
+    params.nFrequency = 1000;
+    params.fAmplitude = 0.5f;
+
+    dsp::GeneratorState state{};
+    dsp::generator_reset(params, state, SAMPLE_RATE);
+    std::vector<float> output(GRANULARITY * 4);
+    dsp::generator_process(params, state, nullptr, output.data(), GRANULARITY, SAMPLE_RATE);
+    dsp::generator_process(params, state, nullptr, output.data() + GRANULARITY * 2, GRANULARITY, SAMPLE_RATE);
+
+    for (uint32_t i = 0; i < GRANULARITY * 2; i++) {
+        const float expected = 0.5f * static_cast<float>(std::sin(2.0 * std::numbers::pi * 1000.0 * i / SAMPLE_RATE));
+        ASSERT_NEAR(output[i * 2], expected, 1e-4f);
+        ASSERT_EQ(output[i * 2], output[i * 2 + 1]);
+    }
+}
+
+TEST(ngs_dsp, envelope_points_and_release) {
+    SceNgsEnvelopeParams params{};
+    params.uNumPoints = 3;
+    // 0 -> 1 in 10 ms, 1 -> 0.5 in 10 ms, then sustain
+    params.envelopePoints[0] = { 10, 0.0f, SCE_NGS_ENVELOPE_LINEAR };
+    params.envelopePoints[1] = { 10, 1.0f, SCE_NGS_ENVELOPE_LINEAR };
+    params.envelopePoints[2] = { 0, 0.5f, SCE_NGS_ENVELOPE_LINEAR };
+    params.uReleaseMsecs = 10;
+    params.nLoopEnd = -1;
+
+    constexpr uint32_t frames = 2400; // 50 ms
+    const std::vector<float> input(frames * 2, 1.0f);
+    std::vector<float> output(frames * 2);
+
+    SceNgsEnvelopeStates state;
+    dsp::envelope_reset(state);
+    ASSERT_FALSE(dsp::envelope_process(params, state, false, input.data(), output.data(), frames, SAMPLE_RATE));
+
+    EXPECT_NEAR(output[0], 0.0f, 1e-3f);
+    EXPECT_NEAR(output[240 * 2], 0.5f, 1e-2f); // 5 ms
+    EXPECT_NEAR(output[480 * 2], 1.0f, 1e-2f); // 10 ms
+    EXPECT_NEAR(output[720 * 2], 0.75f, 1e-2f); // 15 ms
+    EXPECT_NEAR(output[(frames - 1) * 2], 0.5f, 1e-3f);
+
+    // 10 ms release, linear from the current height
+    ASSERT_FALSE(dsp::envelope_process(params, state, true, input.data(), output.data(), 240, SAMPLE_RATE));
+    EXPECT_NEAR(output[0], 0.5f, 1e-2f);
+    EXPECT_NEAR(output[239 * 2], 0.25f, 1e-2f);
+    ASSERT_TRUE(dsp::envelope_process(params, state, true, input.data(), output.data(), 250, SAMPLE_RATE));
+    EXPECT_NEAR(output[249 * 2], 0.0f, 1e-2f);
+}
+
+TEST(ngs_dsp, delay_echoes) {
+    SceNgsDelayParams params{};
+    params.fDryVol = 1.0f;
+    params.taps[0].fDelayMillisecs = 5.0f; // 240 frames
+    params.taps[0].fVolume = 0.5f;
+    params.taps[0].fFeedback = 0.5f;
+
+    const uint32_t memory_size = dsp::delay_memory_size(params, SAMPLE_RATE);
+    ASSERT_GE(memory_size, 242u * 2);
+    std::vector<float> memory(memory_size, 0.0f);
+    dsp::DelayState state{};
+
+    constexpr uint32_t frames = 1024;
+    const std::vector<float> input = make_impulse(frames);
+    std::vector<float> output(frames * 2);
+    dsp::delay_process(params, state, memory.data(), input.data(), output.data(), frames, SAMPLE_RATE);
+
+    for (uint32_t i = 0; i < frames; i++) {
+        float expected = 0.0f;
+        if (i == 0)
+            expected = 1.0f;
+        else if (i % 240 == 0)
+            expected = 0.5f * std::pow(0.5f, static_cast<float>(i / 240 - 1));
+        ASSERT_NEAR(output[i * 2], expected, 1e-5f) << "frame " << i;
+        ASSERT_EQ(output[i * 2], output[i * 2 + 1]);
+    }
+}
+
+TEST(ngs_dsp, compressor_steady_state) {
+    SceNgsCompressorParams params{};
+    params.fRatio = 4.0f;
+    params.fThreshold = -20.0f;
+    params.fAttack = 1.0f;
+    params.fRelease = 50.0f;
+    params.nPeakMode = SCE_NGS_COMPRESSOR_PEAK_MODE;
+
+    // constant -6 dB signal, 14 dB over the threshold
+    constexpr uint32_t frames = 4800;
+    const float level = dsp::decibels_to_gain(-6.0f);
+    const std::vector<float> input(frames * 2, level);
+    std::vector<float> output(frames * 2);
+
+    dsp::CompressorState state = { {}, { 1.0f, 1.0f } };
+    SceNgsCompressorStates levels{};
+    dsp::compressor_process(params, state, levels, input.data(), output.data(), frames, SAMPLE_RATE);
+
+    const float expected = dsp::decibels_to_gain(-20.0f + 14.0f / 4.0f);
+    EXPECT_NEAR(output[(frames - 1) * 2], expected, 1e-3f);
+    EXPECT_NEAR(levels.fInputLevel[0], level, 1e-3f);
+    EXPECT_NEAR(levels.fOutputLevel[1], expected, 1e-3f);
+}
+
+static SceNgsReverbParams get_reverb_params() {
+    SceNgsReverbParams params{};
+    params.fRoom = 0.0f;
+    params.fRoomHF = -100.0f;
+    params.fDecayTime = 1.0f;
+    params.fDecayHFRatio = 0.8f;
+    params.fReflections = -1000.0f;
+    params.fReflectionsDelay = 0.01f;
+    params.fReverb = 0.0f;
+    params.fReverbDelay = 0.02f;
+    params.fDiffusion = 100.0f;
+    params.fDensity = 100.0f;
+    params.fHFReference = 5000.0f;
+    params.fDryMB = -10000.0f;
+    return params;
+}
+
+TEST(ngs_dsp, reverb_decays) {
+    const SceNgsReverbParams params = get_reverb_params();
+    std::vector<float> memory(dsp::reverb_memory_size(SAMPLE_RATE), 0.0f);
+    dsp::ReverbState state{};
+
+    // 3 seconds, the tail must be 60 dB under its peak after a second and keep going down
+    constexpr uint32_t seconds = 3;
+    std::vector<float> output(GRANULARITY * 2);
+    std::vector<float> input = make_impulse(GRANULARITY);
+    float peaks[seconds] = {};
+    for (uint32_t frame = 0; frame < SAMPLE_RATE * seconds; frame += GRANULARITY) {
+        dsp::reverb_process(params, state, memory.data(), input.data(), output.data(), GRANULARITY, SAMPLE_RATE);
+        input.assign(input.size(), 0.0f);
+
+        for (float value : output)
+            ASSERT_TRUE(std::isfinite(value));
+        float &second_peak = peaks[static_cast<uint32_t>(frame / SAMPLE_RATE)];
+        second_peak = std::max(second_peak, peak(output.data(), GRANULARITY));
+    }
+
+    EXPECT_GT(peaks[0], 0.01f);
+    EXPECT_LT(peaks[1], peaks[0] * 0.01f);
+    EXPECT_LT(peaks[2], peaks[1]);
+}
+
+TEST(ngs_dsp, reverb_silence) {
+    const SceNgsReverbParams params = get_reverb_params();
+    std::vector<float> memory(dsp::reverb_memory_size(SAMPLE_RATE), 0.0f);
+    dsp::ReverbState state{};
+
+    const std::vector<float> input(GRANULARITY * 2, 0.0f);
+    std::vector<float> output(GRANULARITY * 2);
+    dsp::reverb_process(params, state, memory.data(), input.data(), output.data(), GRANULARITY, SAMPLE_RATE);
+    EXPECT_LT(peak(output.data(), GRANULARITY), 1e-12f);
+}
+
+static uint32_t count_zero_crossings(const float *buffer, const uint32_t frames) {
+    uint32_t crossings = 0;
+    for (uint32_t i = 1; i < frames; i++) {
+        if ((buffer[(i - 1) * 2] < 0.0f) != (buffer[i * 2] < 0.0f))
+            crossings++;
+    }
+    return crossings;
+}
+
+TEST(ngs_dsp, pitchshift_octave_up) {
+    SceNgsPitchShiftParams params{};
+    params.fPitchOffsetInCents = 1200.0f;
+
+    constexpr uint32_t frames = 48000;
+    const std::vector<float> input = make_sine(200.0f, frames);
+    std::vector<float> output(frames * 2);
+    std::vector<float> memory(dsp::pitchshift_memory_size(), 0.0f);
+    dsp::PitchShiftState state{};
+    for (uint32_t frame = 0; frame < frames; frame += GRANULARITY) {
+        const uint32_t count = std::min(GRANULARITY, frames - frame);
+        dsp::pitchshift_process(params, state, memory.data(), input.data() + frame * 2, output.data() + frame * 2, count);
+    }
+
+    // a 400 Hz sine crosses zero 800 times per second, the crossfades add a few more
+    const uint32_t crossings = count_zero_crossings(output.data() + 4800 * 2, 43200);
+    EXPECT_NEAR(crossings, 720, 40);
+}
+
+TEST(ngs_dsp, equalizer_chains_enabled_filters) {
+    SceNgsParamEqParams params{};
+    params.filter[0] = { SCE_NGS_FILTER_LOWSHELF, 200.0f, 0.707f, 2.0f };
+    params.filter[2] = { SCE_NGS_FILTER_PEAK, 3000.0f, 1.5f, 0.5f };
+
+    const std::vector<float> input = make_sine(440.0f, GRANULARITY);
+    std::vector<float> output(input.size());
+    dsp::EqualizerState state{};
+    // split in 2 blocks to check the state of each filter is kept
+    ASSERT_TRUE(dsp::equalizer_process(params, state, input.data(), output.data(), 100, SAMPLE_RATE));
+    ASSERT_TRUE(dsp::equalizer_process(params, state, input.data() + 200, output.data() + 200, GRANULARITY - 100, SAMPLE_RATE));
+
+    // the filter turned off is skipped
+    std::vector<float> expected(input.size());
+    dsp::BiquadState shelf{};
+    dsp::BiquadState peak{};
+    dsp::biquad_process(dsp::make_biquad(params.filter[0], SAMPLE_RATE), shelf, input.data(), expected.data(), GRANULARITY);
+    dsp::biquad_process(dsp::make_biquad(params.filter[2], SAMPLE_RATE), peak, expected.data(), expected.data(), GRANULARITY);
+
+    for (size_t i = 0; i < expected.size(); i++)
+        ASSERT_NEAR(output[i], expected[i], 1e-5);
+}
+
+TEST(ngs_dsp, equalizer_without_filters) {
+    const SceNgsParamEqParams params{};
+    const std::vector<float> input = make_sine(440.0f, GRANULARITY);
+    std::vector<float> output(input.size(), 2.0f);
+    dsp::EqualizerState state{};
+
+    ASSERT_FALSE(dsp::equalizer_process(params, state, input.data(), output.data(), GRANULARITY, SAMPLE_RATE));
+    for (float value : output)
+        ASSERT_EQ(value, 2.0f);
+}
+
+TEST(ngs_dsp, equalizer_coefficients) {
+    // 3 pass-through filters and a gain of 0.5
+    SceNgsParamEqParamsCoEff params{};
+    for (SceNgsParamCoEff &coeff : params.filterCoEff)
+        coeff.fB0 = 1.0f;
+    params.filterCoEff[1].fB0 = 0.5f;
+
+    const std::vector<float> input = make_sine(440.0f, GRANULARITY);
+    std::vector<float> output(input.size());
+    dsp::EqualizerState state{};
+    ASSERT_TRUE(dsp::equalizer_process(params, state, input.data(), output.data(), GRANULARITY));
+
+    for (size_t i = 0; i < input.size(); i++)
+        ASSERT_FLOAT_EQ(output[i], input[i] * 0.5f);
+}
+
+// Time taken by a voice going through every effect
+BENCHMARK_TEST(ngs_dsp, voice) {
+    constexpr uint32_t iterations = 10000;
+
+    SceNgsParamEqParams equalizer{};
+    for (SceNgsParamFilter &filter : equalizer.filter)
+        filter = { SCE_NGS_FILTER_PEAK, 2000.0f, 1.0f, 2.0f };
+    dsp::EqualizerState equalizer_state{};
+
+    SceNgsCompressorParams compressor{};
+    compressor.fRatio = 4.0f;
+    compressor.fThreshold = -20.0f;
+    compressor.fAttack = 1.0f;
+    compressor.fRelease = 50.0f;
+    dsp::CompressorState compressor_state = { {}, { 1.0f, 1.0f } };
+    SceNgsCompressorStates levels{};
+
+    SceNgsDelayParams delay{};
+    delay.fDryVol = 1.0f;
+    delay.fModRate = 1.0f;
+    for (uint32_t t = 0; t < SCE_NGS_DELAY_MAX_TAPS; t++)
+        delay.taps[t] = { 50.0f * (t + 1), 0.3f, 0.3f, SCE_NGS_DELAY_FILTER_MODE_LOWPASS_ONEPOLE, 3000.0f, 90.0f * t, 2.0f };
+    std::vector<float> delay_memory(dsp::delay_memory_size(delay, SAMPLE_RATE), 0.0f);
+    dsp::DelayState delay_state{};
+
+    SceNgsDistortionParams distortion = { {}, 2.0f, 1.0f, 0.8f, 0.0f, 0.5f, 0.5f };
+
+    SceNgsEnvelopeParams envelope{};
+    envelope.uNumPoints = 2;
+    envelope.envelopePoints[0] = { 1000, 0.0f, SCE_NGS_ENVELOPE_CURVED };
+    envelope.envelopePoints[1] = { 0, 1.0f, SCE_NGS_ENVELOPE_LINEAR };
+    envelope.nLoopEnd = -1;
+    SceNgsEnvelopeStates envelope_state;
+    dsp::envelope_reset(envelope_state);
+
+    SceNgsGeneratorParams generator{};
+    generator.eGeneratorMode = SCE_NGS_GENERATOR_SINE;
+    generator.nFrequency = 440;
+    generator.fAmplitude = 0.1f;
+    dsp::GeneratorState generator_state{};
+    dsp::generator_reset(generator, generator_state, SAMPLE_RATE);
+
+    SceNgsPitchShiftParams pitchshift = { {}, 700.0f };
+    std::vector<float> pitchshift_memory(dsp::pitchshift_memory_size(), 0.0f);
+    dsp::PitchShiftState pitchshift_state{};
+
+    const SceNgsReverbParams reverb = get_reverb_params();
+    std::vector<float> reverb_memory(dsp::reverb_memory_size(SAMPLE_RATE), 0.0f);
+    dsp::ReverbState reverb_state{};
+
+    const std::vector<float> input = make_sine(440.0f, GRANULARITY);
+    std::vector<float> buffer(GRANULARITY * 2);
+
+    const auto elapsed = testutil::elapsed([&] {
+        for (uint32_t i = 0; i < iterations; i++) {
+            dsp::generator_process(generator, generator_state, input.data(), buffer.data(), GRANULARITY, SAMPLE_RATE);
+            dsp::equalizer_process(equalizer, equalizer_state, buffer.data(), buffer.data(), GRANULARITY, SAMPLE_RATE);
+            dsp::envelope_process(envelope, envelope_state, false, buffer.data(), buffer.data(), GRANULARITY, SAMPLE_RATE);
+            dsp::distortion_process(distortion, buffer.data(), buffer.data(), GRANULARITY);
+            dsp::compressor_process(compressor, compressor_state, levels, buffer.data(), buffer.data(), GRANULARITY, SAMPLE_RATE);
+            dsp::delay_process(delay, delay_state, delay_memory.data(), buffer.data(), buffer.data(), GRANULARITY, SAMPLE_RATE);
+            dsp::pitchshift_process(pitchshift, pitchshift_state, pitchshift_memory.data(), buffer.data(), buffer.data(), GRANULARITY);
+            dsp::reverb_process(reverb, reverb_state, reverb_memory.data(), buffer.data(), buffer.data(), GRANULARITY, SAMPLE_RATE);
+        }
+    });
+
+    const auto block_time = elapsed / iterations;
+    const auto budget = std::chrono::duration<double>(GRANULARITY / SAMPLE_RATE);
+    testutil::record_time("block", block_time);
+    testutil::record("real_time_percent", 100.0 * block_time / budget);
+    for (float value : buffer)
+        ASSERT_TRUE(std::isfinite(value));
+}
@@ -0,0 +1,85 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <util/fs.h>
+
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief Size and metadata of a content directory (app, addcont, save data, theme)
+ */
+struct ContentInfo {
+    fs::path path;
+    uint64_t size = 0;
+    // Last write time of the directory itself
+    std::time_t updated = 0;
+    // From sce_sys/param.sfo in the system language, empty when the directory has none
+    std::string title;
+    std::string title_id;
+};
+
+/**
+ * @brief Computes the size and param.sfo metadata of content directories on worker threads
+ *
+ * Each request walks the whole tree once. Results are not cached: telling that a tree is unchanged
+ * needs the size and write time of all its files, which costs as much as the walk itself.
+ */
+class ContentIndexer {
+public:
+    explicit ContentIndexer(int sys_lang);
+    ~ContentIndexer();
+
+    /**
+     * @brief Queue the indexing of a directory, requesting a path already queued does nothing
+     */
+    void request(const fs::path &path);
+
+    /**
+     * @brief Take the results done since the last call, in completion order
+     */
+    std::vector<ContentInfo> poll();
+
+    // True when every requested directory is done
+    bool is_idle();
+
+    // Block until every requested directory is done
+    void wait();
+
+private:
+    void index(const fs::path &path);
+    void worker_loop();
+
+    const int sys_lang;
+    std::mutex mutex;
+    std::condition_variable job_cond;
+    std::condition_variable done_cond;
+    std::deque<fs::path> jobs;
+    std::unordered_set<std::string> queued;
+    std::vector<ContentInfo> results;
+    size_t pending = 0;
+    bool exiting = false;
+    std::vector<std::thread> workers;
+};
@@ -29,7 +29,9 @@
 #include <functional>
 #include <string>
 
-void install_pup(const fs::path &pref_path, const fs::path &pup_path, const std::function<void(uint32_t)> &progress_callback = nullptr);
+// Return false if the PUP is invalid or one of its partitions could not be installed
+// firmware_version is left empty if the PUP has no version.txt
+bool install_pup(const fs::path &pref_path, const fs::path &pup_path, std::string &firmware_version, const std::function<void(uint32_t)> &progress_callback = nullptr);
 
 bool create_license(EmuEnvState &emuenv, const std::string &zRIF);
 bool copy_license(EmuEnvState &emuenv, const fs::path &license_path);
@@ -24,6 +24,8 @@
 
 #include <util/log.h>
 
+#include <istream>
+
 // Credits to TeamMolecule for their original work on this https://github.com/TeamMolecule/sceutils
 
 #define SCE_MAGIC 0x00454353
@@ -651,9 +653,10 @@ public:
 };
 
 void register_keys(KeyStore &SCE_KEYS, int type);
-void extract_fat(const fs::path &partition_path, const std::string &partition, const fs::path &pref_path);
-std::string decompress_segments(const std::vector<uint8_t> &decrypted_data, const uint64_t &size);
-std::tuple<uint64_t, SelfType> get_key_type(std::ifstream &file, const SceHeader &sce_hdr);
-std::vector<SceSegment> get_segments(std::ifstream &file, const SceHeader &sce_hdr, KeyStore &SCE_KEYS, uint64_t sysver = -1, SelfType self_type = static_cast<SelfType>(0), int keytype = 0, unsigned char *klictxt = 0);
+// Extract the files of a FAT16 partition image held in memory to pref_path/partition
+void extract_fat(const std::vector<uint8_t> &partition_image, const std::string &partition, const fs::path &pref_path);
+std::vector<uint8_t> decompress_segments(const uint8_t *compressed_data, const uint64_t size);
+std::tuple<uint64_t, SelfType> get_key_type(std::istream &file, const SceHeader &sce_hdr);
+std::vector<SceSegment> get_segments(std::istream &file, const SceHeader &sce_hdr, KeyStore &SCE_KEYS, uint64_t sysver = -1, SelfType self_type = static_cast<SelfType>(0), int keytype = 0, unsigned char *klictxt = 0);
 void decrypt_fself(const fs::path &file_path, KeyStore &SCE_KEYS, unsigned char *klictxt);
 bool is_self(const fs::path &file_path);
@@ -0,0 +1,144 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <packages/content_index.h>
+#include <packages/sfo.h>
+
+#include <boost/algorithm/string/trim.hpp>
+
+#include <algorithm>
+
+// Total size of the files of the tree, false if the directory does not exist
+static bool get_directory_size(const fs::path &path, uint64_t &size) {
+    boost::system::error_code ec;
+    if (!fs::is_directory(path, ec))
+        return false;
+
+    // entries removed while the tree is walked are skipped
+    for (fs::recursive_directory_iterator it(path, ec), end; !ec && (it != end); it.increment(ec)) {
+        const auto type = it->status(ec).type();
+        if (!ec && (type == fs::regular_file)) {
+            const auto file_size = fs::file_size(it->path(), ec);
+            if (!ec)
+                size += file_size;
+        }
+        ec.clear();
+    }
+    return true;
+}
+
+static void read_param_sfo(ContentInfo &info, int sys_lang) {
+    const auto sfo_path = info.path / "sce_sys/param.sfo";
+    fs::ifstream file(sfo_path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return;
+
+    std::vector<uint8_t> content(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if ((content.size() < sizeof(SfoHeader)) || !file.read(reinterpret_cast<char *>(content.data()), content.size()))
+        return;
+
+    SfoFile sfo_handle;
+    if (!sfo::load(sfo_handle, content))
+        return;
+    if (!sfo::get_data_by_key(info.title, sfo_handle, fmt::format("TITLE_{:0>2d}", sys_lang)))
+        sfo::get_data_by_key(info.title, sfo_handle, "TITLE");
+    std::replace(info.title.begin(), info.title.end(), '\n', ' ');
+    boost::trim(info.title);
+    sfo::get_data_by_key(info.title_id, sfo_handle, "TITLE_ID");
+}
+
+ContentIndexer::ContentIndexer(int sys_lang)
+    : sys_lang(sys_lang) {
+    // the walks mostly wait on the file system, one more worker than cores keeps the disk busy
+    const unsigned int worker_count = std::max(std::thread::hardware_concurrency(), 1u) + 1;
+    for (unsigned int i = 0; i < worker_count; i++)
+        workers.emplace_back(&ContentIndexer::worker_loop, this);
+}
+
+ContentIndexer::~ContentIndexer() {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        exiting = true;
+    }
+    job_cond.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void ContentIndexer::request(const fs::path &path) {
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        if (!queued.insert(path.string()).second)
+            return;
+        jobs.push_back(path);
+        pending++;
+    }
+    job_cond.notify_one();
+}
+
+std::vector<ContentInfo> ContentIndexer::poll() {
+    std::vector<ContentInfo> done;
+    const std::lock_guard<std::mutex> lock(mutex);
+    std::swap(done, results);
+    return done;
+}
+
+bool ContentIndexer::is_idle() {
+    const std::lock_guard<std::mutex> lock(mutex);
+    return pending == 0;
+}
+
+void ContentIndexer::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    done_cond.wait(lock, [&] { return pending == 0; });
+}
+
+void ContentIndexer::index(const fs::path &path) {
+    // a directory that is gone is reported as empty
+    ContentInfo info{ path };
+    if (get_directory_size(path, info.size)) {
+        boost::system::error_code ec;
+        info.updated = fs::last_write_time(path, ec);
+        read_param_sfo(info, sys_lang);
+    }
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    results.push_back(std::move(info));
+}
+
+void ContentIndexer::worker_loop() {
+    while (true) {
+        fs::path path;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job_cond.wait(lock, [&] { return exiting || !jobs.empty(); });
+            if (exiting)
+                return;
+            path = std::move(jobs.front());
+            jobs.pop_front();
+            // requested again from now on, the directory may change while it is walked
+            queued.erase(path.string());
+        }
+        index(path);
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            pending--;
+        }
+        done_cond.notify_all();
+    }
+}
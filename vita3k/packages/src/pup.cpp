@@ -29,8 +29,15 @@
 #include <util/fs.h>
 
 #include <algorithm>
-#include <fstream>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 // Credits to TeamMolecule for their original work on this https://github.com/TeamMolecule/sceutils
 
@@ -76,46 +83,47 @@ static const char *FSTYPE[] = {
     "psp_emulist",
 };
 
-static std::string make_filename(unsigned char *hdr, int64_t filetype) {
+static constexpr int SCEUF_HEADER_SIZE = 0x80;
+static constexpr int SCEUF_FILEREC_SIZE = 0x20;
+
+// Partitions installed from the PUP, in installation order
+static const char *PARTITIONS[] = { "os0", "sa0", "vs0" };
+
+struct PupEntry {
+    uint64_t filetype;
+    uint64_t offset;
+    uint64_t length;
+    std::string name;
+};
+
+// Name of the partition the package belongs to, the packages of a partition are joined in file order
+static std::string get_package_fstype(const unsigned char *hdr) {
     uint32_t magic = 0;
     uint32_t version = 0;
     uint32_t flags = 0;
-    uint32_t moffs = 0;
     uint64_t metaoffs = 0;
     memcpy(&magic, &hdr[0], 4);
     memcpy(&version, &hdr[4], 4);
     memcpy(&flags, &hdr[8], 4);
-    memcpy(&moffs, &hdr[12], 4);
     memcpy(&metaoffs, &hdr[16], 8);
 
-    if (magic == SCE_MAGIC && version == 3 && flags == 0x30040) {
-        std::vector meta = std::vector<unsigned char>(&hdr[0] + metaoffs, &hdr[0] + (HEADER_LENGTH - metaoffs));
-        unsigned char t = 0;
-        memcpy(&t, &meta[4], 1);
-
-        static int typecount = 0;
-
-        if (t < 0x1C) { // 0x1C is the file separator
-            std::string name = fmt::format("{}-{:0>2}.pkg", FSTYPE[t], typecount);
-            typecount++;
-            return name;
-        }
+    if (magic == SCE_MAGIC && version == 3 && flags == 0x30040 && metaoffs + 4 < HEADER_LENGTH) {
+        const unsigned char t = hdr[metaoffs + 4];
+        if (t < 0x1C) // 0x1C is the file separator
+            return FSTYPE[t];
     }
-    return fmt::format("unknown-0x{:X}.pkg", filetype);
+    return "";
 }
 
-static void extract_pup_files(const fs::path &pup, const fs::path &output) {
-    constexpr int SCEUF_HEADER_SIZE = 0x80;
-    constexpr int SCEUF_FILEREC_SIZE = 0x20;
+static bool read_pup_entries(FILE *infile, std::vector<PupEntry> &entries) {
+    fseek(infile, 0, SEEK_END);
+    const uint64_t pup_size = ftell(infile);
+    fseek(infile, 0, SEEK_SET);
 
-    FILE *infile = host::dialog::filesystem::resolve_host_handle(pup);
     char header[SCEUF_HEADER_SIZE];
-    fread(header, SCEUF_HEADER_SIZE, 1, infile);
-
-    if (strncmp(header, "SCEUF", 5) != 0) {
+    if ((fread(header, SCEUF_HEADER_SIZE, 1, infile) != 1) || (strncmp(header, "SCEUF", 5) != 0)) {
         LOG_ERROR("Invalid PUP");
-        fclose(infile);
-        return;
+        return false;
     }
 
     uint32_t cnt = 0;
@@ -132,170 +140,366 @@ static void extract_pup_files(const fs::path &pup, const fs::path &output) {
     LOG_INFO("Build Number: {:0}", build_number);
     LOG_INFO("Number Of Files: {}", cnt);
 
+    // checked before allocating the records, the count comes from the file
+    if (static_cast<uint64_t>(cnt) * SCEUF_FILEREC_SIZE > pup_size - SCEUF_HEADER_SIZE) {
+        LOG_ERROR("Invalid number of files in the PUP: {}", cnt);
+        return false;
+    }
+
+    std::vector<char> records(static_cast<size_t>(cnt) * SCEUF_FILEREC_SIZE);
+    if (cnt && (fread(records.data(), records.size(), 1, infile) != 1)) {
+        LOG_ERROR("Truncated PUP file records");
+        return false;
+    }
+
     for (uint32_t x = 0; x < cnt; x++) {
-        fseek(infile, SCEUF_HEADER_SIZE + x * SCEUF_FILEREC_SIZE, SEEK_SET);
-        char rec[SCEUF_FILEREC_SIZE];
-        fread(rec, SCEUF_FILEREC_SIZE, 1, infile);
-
-        uint64_t filetype = 0;
-        uint64_t offset = 0;
-        uint64_t length = 0;
-        uint64_t flags = 0;
-
-        memcpy(&filetype, &rec[0], 8);
-        memcpy(&offset, &rec[8], 8);
-        memcpy(&length, &rec[16], 8);
-        memcpy(&flags, &rec[24], 8);
-
-        std::string filename = "";
-        if (PUP_TYPES.contains(filetype)) {
-            filename = PUP_TYPES.at(filetype);
-        } else {
-            fseek(infile, offset, SEEK_SET);
-            char hdr[HEADER_LENGTH];
-            fread(hdr, HEADER_LENGTH, 1, infile);
-            filename = make_filename((unsigned char *)hdr, filetype);
+        const char *rec = &records[x * SCEUF_FILEREC_SIZE];
+        PupEntry entry{};
+        memcpy(&entry.filetype, &rec[0], 8);
+        memcpy(&entry.offset, &rec[8], 8);
+        memcpy(&entry.length, &rec[16], 8);
+
+        if ((entry.offset > pup_size) || (entry.length > pup_size - entry.offset)) {
+            LOG_ERROR("PUP entry at offset 0x{:X} of size 0x{:X} is out of the file bounds", entry.offset, entry.length);
+            return false;
         }
 
-        fs::ofstream outfile(output / filename, std::ios::binary);
-        fseek(infile, offset, SEEK_SET);
-        std::vector<char> buffer(length);
-        fread(buffer.data(), length, 1, infile);
-        outfile.write(&buffer[0], length);
-
-        outfile.close();
+        if (PUP_TYPES.contains(entry.filetype)) {
+            entry.name = PUP_TYPES.at(entry.filetype);
+        } else {
+            unsigned char hdr[HEADER_LENGTH] = {};
+            const size_t hdr_size = std::min<uint64_t>(entry.length, HEADER_LENGTH);
+            fseek(infile, entry.offset, SEEK_SET);
+            if (fread(hdr, 1, hdr_size, infile) > 0)
+                entry.name = get_package_fstype(hdr);
+        }
+        entries.push_back(std::move(entry));
     }
-    fclose(infile);
+    return true;
 }
 
-static void decrypt_segments(std::ifstream &infile, const fs::path &outdir, const fs::path &filename, KeyStore &SCE_KEYS) {
-    char sceheaderbuffer[SceHeader::Size];
-    infile.read(sceheaderbuffer, SceHeader::Size);
-    const SceHeader sce_hdr = SceHeader(sceheaderbuffer);
+// Decrypt and inflate the content of a SPKG package held in memory
+static std::vector<uint8_t> decrypt_package(std::vector<uint8_t> &package, KeyStore &SCE_KEYS) {
+    if (package.size() < SceHeader::Size)
+        return {};
 
-    const auto sysver = std::get<0>(get_key_type(infile, sce_hdr));
-    const SelfType selftype = std::get<1>(get_key_type(infile, sce_hdr));
+    const SceHeader sce_hdr = SceHeader(reinterpret_cast<const char *>(package.data()));
+    // only the headers are parsed through a stream, the segments are used in place
+    const size_t header_size = std::min<size_t>(package.size(), sce_hdr.header_length + SpkgHeader::Size);
+    std::istringstream header(std::string(reinterpret_cast<const char *>(package.data()), header_size));
+
+    const auto [sysver, selftype] = get_key_type(header, sce_hdr);
+    const auto scesegs = get_segments(header, sce_hdr, SCE_KEYS, sysver, selftype);
 
     EVP_CIPHER_CTX *cipher_ctx = EVP_CIPHER_CTX_new();
     EVP_CIPHER *cipher = EVP_CIPHER_fetch(nullptr, "AES-128-CTR", nullptr);
     int dec_len = 0;
 
-    const auto scesegs = get_segments(infile, sce_hdr, SCE_KEYS, sysver, selftype);
+    // the package content is the last segment
+    std::vector<uint8_t> content;
     for (const auto &sceseg : scesegs) {
-        fs::ofstream outfile(outdir / fs_utils::path_concat(filename, ".seg02"), std::ios::binary);
-        infile.seekg(sceseg.offset);
-        std::vector<unsigned char> encrypted_data(sceseg.size);
-        infile.read((char *)&encrypted_data[0], sceseg.size);
+        if (sceseg.offset + sceseg.size > package.size()) {
+            LOG_ERROR("Segment {} is out of the package bounds", sceseg.idx);
+            continue;
+        }
 
-        std::vector<unsigned char> decrypted_data(sceseg.size);
+        // CTR mode can decrypt in place
+        uint8_t *data = package.data() + sceseg.offset;
         EVP_DecryptInit_ex(cipher_ctx, cipher, nullptr, reinterpret_cast<const unsigned char *>(sceseg.key.c_str()), reinterpret_cast<const unsigned char *>(sceseg.iv.c_str()));
         EVP_CIPHER_CTX_set_padding(cipher_ctx, 0);
-        EVP_DecryptUpdate(cipher_ctx, decrypted_data.data(), &dec_len, encrypted_data.data(), sceseg.size);
-        EVP_DecryptFinal_ex(cipher_ctx, decrypted_data.data() + dec_len, &dec_len);
+        EVP_DecryptUpdate(cipher_ctx, data, &dec_len, data, static_cast<int>(sceseg.size));
+        EVP_DecryptFinal_ex(cipher_ctx, data + dec_len, &dec_len);
 
-        if (sceseg.compressed) {
-            const std::string decompressed_data = decompress_segments(decrypted_data, sceseg.size);
-            outfile.write(decompressed_data.c_str(), decompressed_data.size());
-        } else {
-            outfile.write((char *)&decrypted_data[0], sceseg.size);
-        }
-        outfile.close();
+        if (sceseg.compressed)
+            content = decompress_segments(data, sceseg.size);
+        else
+            content.assign(data, data + sceseg.size);
     }
 
     EVP_CIPHER_CTX_free(cipher_ctx);
     EVP_CIPHER_free(cipher);
+
+    return content;
 }
 
-static void join_files(const fs::path &path, const std::string &filename, const fs::path &output) {
-    std::vector<fs::path> files;
+// Pool of host threads decrypting the packages while the calling thread keeps reading the PUP.
+// The calling thread helps with the remaining jobs once everything is read
+class PupWorkers {
+public:
+    PupWorkers() {
+        // no worker on a single core host, the calling thread does everything
+        const unsigned int hardware_threads = std::thread::hardware_concurrency();
+        const unsigned int worker_count = hardware_threads > 1 ? hardware_threads - 1 : 0;
+        for (unsigned int i = 0; i < worker_count; i++)
+            workers.emplace_back(&PupWorkers::worker_loop, this);
+    }
 
-    for (auto &p : fs::directory_iterator(path)) {
-        if (p.path().filename().string().substr(0, 4) == filename) {
-            files.push_back(p.path());
+    ~PupWorkers() {
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            exiting = true;
         }
+        job_cond.notify_all();
+        for (auto &worker : workers)
+            worker.join();
     }
 
-    std::sort(files.begin(), files.end());
+    size_t get_worker_count() const {
+        return workers.size();
+    }
 
-    fs::ofstream fileout(output, std::ios::binary);
-    for (const auto &file : files) {
-        fs::ifstream filein(file, std::ios::binary);
-        std::vector<char> buffer(fs::file_size(file));
-        filein.read(&buffer[0], fs::file_size(file));
-        fileout.write(&buffer[0], fs::file_size(file));
-        filein.close();
-        fs::remove(file);
+    void submit(std::function<void()> &&job) {
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+            pending++;
+        }
+        job_cond.notify_one();
     }
-    fileout.close();
-}
 
-static void decrypt_pup_packages(const fs::path &src, const fs::path &dest, KeyStore &SCE_KEYS) {
-    std::vector<fs::path> pkgfiles;
+    // Wait until at most max_pending submitted jobs are left, on_progress is called from the calling thread each time a job is done
+    void wait(const std::function<void()> &on_progress, size_t max_pending = 0) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (pending > max_pending) {
+            if (!jobs.empty()) {
+                const auto job = std::move(jobs.front());
+                jobs.pop_front();
+                lock.unlock();
+                job();
+                lock.lock();
+                pending--;
+            } else {
+                done_cond.wait(lock);
+            }
+
+            lock.unlock();
+            on_progress();
+            lock.lock();
+        }
+    }
+
+private:
+    void worker_loop() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                job_cond.wait(lock, [&] { return exiting || !jobs.empty(); });
+                if (exiting)
+                    return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+            {
+                const std::lock_guard<std::mutex> lock(mutex);
+                pending--;
+            }
+            done_cond.notify_all();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable job_cond;
+    std::condition_variable done_cond;
+    std::deque<std::function<void()>> jobs;
+    std::vector<std::thread> workers;
+    size_t pending = 0;
+    bool exiting = false;
+};
+
+// Only report the progress when the percentage changes, the callback may log or redraw each time
+class PupProgress {
+public:
+    PupProgress(const std::function<void(uint32_t)> &callback, uint64_t total)
+        : callback(callback)
+        , total(std::max<uint64_t>(total, 1)) {}
+
+    void add(uint64_t amount) {
+        done = std::min(done + amount, total);
+        const uint32_t percent = static_cast<uint32_t>(done * 100 / total);
+        if (callback && (percent != last_percent)) {
+            last_percent = percent;
+            callback(percent);
+        }
+    }
 
-    for (const auto &p : fs::directory_iterator(src)) {
-        if (p.path().filename().extension().string() == ".pkg")
-            pkgfiles.push_back(p.path().filename());
+    void finish() {
+        add(total);
     }
 
-    for (const auto &filename : pkgfiles) {
-        const fs::path &filepath = src / filename;
-        fs::ifstream infile(filepath, std::ios::binary);
-        decrypt_segments(infile, dest, filename, SCE_KEYS);
-        infile.close();
+private:
+    const std::function<void(uint32_t)> &callback;
+    uint64_t total;
+    uint64_t done = 0;
+    uint32_t last_percent = 0;
+};
+
+// Decrypt the packages of a partition on the workers and join them into the partition image, in file order
+// The packages are read as the workers need them, only one per worker and one ahead are held encrypted in memory
+static std::vector<uint8_t> decrypt_partition(FILE *infile, const std::vector<PupEntry> &entries, KeyStore &SCE_KEYS, PupWorkers &workers, PupProgress &progress) {
+    std::vector<std::vector<uint8_t>> pieces(entries.size());
+    std::atomic<uint64_t> decrypted_bytes = 0;
+    uint64_t reported_bytes = 0;
+    const auto report = [&] {
+        const uint64_t bytes = decrypted_bytes;
+        progress.add(bytes - reported_bytes);
+        reported_bytes = bytes;
+    };
+
+    bool failed = false;
+    for (size_t i = 0; i < entries.size(); i++) {
+        workers.wait(report, workers.get_worker_count());
+
+        std::vector<uint8_t> package(entries[i].length);
+        fseek(infile, entries[i].offset, SEEK_SET);
+        if (fread(package.data(), package.size(), 1, infile) != 1) {
+            LOG_ERROR("Failed to read package at offset 0x{:X}", entries[i].offset);
+            failed = true;
+            break;
+        }
+
+        workers.submit([&, i, package = std::move(package)]() mutable {
+            pieces[i] = decrypt_package(package, SCE_KEYS);
+            decrypted_bytes += entries[i].length;
+        });
     }
+    // the submitted jobs write to pieces, they must be done even when giving up
+    workers.wait(report);
 
-    join_files(dest, "os0-", dest / "os0.img");
-    join_files(dest, "vs0-", dest / "vs0.img");
-    join_files(dest, "sa0-", dest / "sa0.img");
+    for (size_t i = 0; !failed && (i < entries.size()); i++) {
+        if (pieces[i].empty()) {
+            LOG_ERROR("Failed to decrypt package at offset 0x{:X}", entries[i].offset);
+            failed = true;
+        }
+    }
+    // a missing piece would shift the rest of the image, the partition is not installed
+    if (failed) {
+        uint64_t partition_bytes = 0;
+        for (const auto &entry : entries)
+            partition_bytes += entry.length;
+        progress.add(partition_bytes - reported_bytes);
+        return {};
+    }
+
+    size_t image_size = 0;
+    for (const auto &piece : pieces)
+        image_size += piece.size();
+
+    std::vector<uint8_t> image;
+    image.reserve(image_size);
+    for (auto &piece : pieces) {
+        image.insert(image.end(), piece.begin(), piece.end());
+        std::vector<uint8_t>().swap(piece);
+    }
+    return image;
 }
 
-void install_pup(const fs::path &pref_path, const fs::path &pup_path, const std::function<void(uint32_t)> &progress_callback) {
-    fs::path pup_dec_root = pref_path / "PUP_DEC";
-    if (fs::exists(pup_dec_root)) {
-        LOG_WARN("Path already exists, deleting it and reinstalling");
-        fs::remove_all(pup_dec_root);
+static void decrypt_fselfs(const fs::path &partition_path, KeyStore &SCE_KEYS, PupWorkers &workers, PupProgress &progress, uint64_t budget) {
+    std::vector<fs::path> selfs;
+    for (const auto &file : fs::recursive_directory_iterator(partition_path)) {
+        if (fs::is_regular_file(file.path()) && is_self(file.path()))
+            selfs.push_back(file.path());
     }
 
-    LOG_INFO("Extracting {} to {}", pup_path, pup_dec_root);
+    if (selfs.empty()) {
+        progress.add(budget);
+        return;
+    }
 
-    fs::create_directory(pup_dec_root);
-    const auto pup_dest = pup_dec_root / "PUP";
-    fs::create_directory(pup_dest);
-    progress_callback(10);
+    std::atomic<size_t> decrypted_count = 0;
+    size_t reported_count = 0;
+    const auto report = [&] {
+        const size_t count = decrypted_count;
+        progress.add(budget * count / selfs.size() - budget * reported_count / selfs.size());
+        reported_count = count;
+    };
+
+    for (const auto &self : selfs) {
+        workers.submit([&] {
+            decrypt_fself(self, SCE_KEYS, nullptr);
+            decrypted_count++;
+        });
+    }
+    workers.wait(report);
+}
+
+bool install_pup(const fs::path &pref_path, const fs::path &pup_path, std::string &firmware_version, const std::function<void(uint32_t)> &progress_callback) {
+    firmware_version.clear();
+
+    // left behind by the previous versions of the installer
+    const fs::path pup_dec_root = pref_path / "PUP_DEC";
+    if (fs::exists(pup_dec_root))
+        fs::remove_all(pup_dec_root);
+
+    LOG_INFO("Installing {} to {}", pup_path, pref_path);
 
-    extract_pup_files(pup_path, pup_dest);
+    FILE *infile = host::dialog::filesystem::resolve_host_handle(pup_path);
+    if (!infile) {
+        LOG_ERROR("Failed to open {}", pup_path);
+        return false;
+    }
+
+    std::vector<PupEntry> entries;
+    if (!read_pup_entries(infile, entries)) {
+        fclose(infile);
+        return false;
+    }
 
-    const auto pup_dec = pup_dec_root / "PUP_dec";
-    fs::create_directory(pup_dec);
+    uint64_t total_bytes = 0;
+    for (const auto &entry : entries) {
+        if (entry.name == "version.txt") {
+            firmware_version.resize(entry.length);
+            fseek(infile, entry.offset, SEEK_SET);
+            if (fread(firmware_version.data(), entry.length, 1, infile) != 1)
+                firmware_version.clear();
+            // only keep the first line
+            firmware_version = firmware_version.substr(0, firmware_version.find_first_of("\r\n"));
+        } else if (std::find(std::begin(PARTITIONS), std::end(PARTITIONS), entry.name) != std::end(PARTITIONS)) {
+            total_bytes += entry.length;
+        }
+    }
 
     KeyStore SCE_KEYS;
     register_keys(SCE_KEYS, 0);
 
-    progress_callback(30);
-    decrypt_pup_packages(pup_dest, pup_dec, SCE_KEYS);
-
-    progress_callback(70);
-    if (fs::file_size(pup_dec / "os0.img") > 0) {
-        extract_fat(pup_dec, "os0.img", pref_path);
-        for (const auto &file : fs::recursive_directory_iterator(pref_path / "os0")) {
-            if (fs::is_regular_file(file.path())) {
-                if (is_self(file.path())) {
-                    decrypt_fself(file.path(), SCE_KEYS, 0);
-                }
+    PupWorkers workers;
+    // decrypting the packages of a partition weights its size, extracting its files and decrypting its modules the same
+    PupProgress progress(progress_callback, total_bytes * 2);
+
+    // the partitions are done one after the other, only the image being installed is held in memory
+    for (const std::string partition : PARTITIONS) {
+        std::vector<PupEntry> partition_entries;
+        uint64_t partition_bytes = 0;
+        for (const auto &entry : entries) {
+            if (entry.name == partition) {
+                partition_entries.push_back(entry);
+                partition_bytes += entry.length;
             }
         }
-    }
-    if (fs::file_size(pup_dec / "sa0.img") > 0)
-        extract_fat(pup_dec, "sa0.img", pref_path);
-    if (fs::file_size(pup_dec / "vs0.img") > 0) {
-        extract_fat(pup_dec, "vs0.img", pref_path);
-        for (const auto &file : fs::recursive_directory_iterator(pref_path / "vs0")) {
-            if (fs::is_regular_file(file.path())) {
-                if (is_self(file.path())) {
-                    decrypt_fself(file.path(), SCE_KEYS, nullptr);
-                }
-            }
+        if (partition_entries.empty())
+            continue;
+
+        std::vector<uint8_t> image = decrypt_partition(infile, partition_entries, SCE_KEYS, workers, progress);
+        if (image.empty()) {
+            LOG_ERROR("Failed to decrypt the {} partition", partition);
+            fclose(infile);
+            return false;
         }
+
+        extract_fat(image, partition, pref_path);
+        std::vector<uint8_t>().swap(image);
+        progress.add(partition_bytes / 4);
+
+        const uint64_t remaining_bytes = partition_bytes - partition_bytes / 4;
+        if (partition == "sa0")
+            progress.add(remaining_bytes);
+        else
+            decrypt_fselfs(pref_path / partition, SCE_KEYS, workers, progress, remaining_bytes);
     }
-    progress_callback(100);
+    fclose(infile);
+
+    progress.finish();
+
+    return true;
 }
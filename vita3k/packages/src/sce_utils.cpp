@@ -652,64 +652,69 @@ static void traverse_directory(Fat16::Image &img, Fat16::Entry mee, const fs::pa
     }
 }
 
-void extract_fat(const fs::path &partition_path, const std::string &partition, const fs::path &pref_path) {
-    FILE *f = FOPEN((partition_path / partition).native().c_str(), "rb");
+struct MemoryImage {
+    const std::vector<uint8_t> &data;
+    size_t position;
+};
+
+void extract_fat(const std::vector<uint8_t> &partition_image, const std::string &partition, const fs::path &pref_path) {
+    MemoryImage image{ partition_image, 0 };
     Fat16::Image img(
-        f,
+        &image,
         // Read hook
         [](void *userdata, void *buffer, std::uint32_t size) -> std::uint32_t {
-            return static_cast<std::uint32_t>(fread(buffer, 1, size, (FILE *)userdata));
+            MemoryImage &image = *static_cast<MemoryImage *>(userdata);
+            const size_t size_read = std::min<size_t>(size, image.data.size() - std::min(image.position, image.data.size()));
+            memcpy(buffer, image.data.data() + image.position, size_read);
+            image.position += size_read;
+            return static_cast<std::uint32_t>(size_read);
         },
         // Seek hook
         [](void *userdata, std::uint32_t offset, int mode) -> std::uint32_t {
-            fseek((FILE *)userdata, offset, (mode == Fat16::IMAGE_SEEK_MODE_BEG ? SEEK_SET : (mode == Fat16::IMAGE_SEEK_MODE_CUR ? SEEK_CUR : SEEK_END)));
-
-            return ftell((FILE *)userdata);
+            MemoryImage &image = *static_cast<MemoryImage *>(userdata);
+            if (mode == Fat16::IMAGE_SEEK_MODE_BEG)
+                image.position = offset;
+            else if (mode == Fat16::IMAGE_SEEK_MODE_CUR)
+                image.position += static_cast<std::int32_t>(offset);
+            else
+                image.position = image.data.size() + static_cast<std::int32_t>(offset);
+
+            return static_cast<std::uint32_t>(image.position);
         });
 
     Fat16::Entry first;
-    traverse_directory(img, first, pref_path / partition.substr(0, 3));
-
-    fclose(f);
+    traverse_directory(img, first, pref_path / partition);
 }
 
-std::string decompress_segments(const std::vector<uint8_t> &decrypted_data, const uint64_t &size) {
-    mz_stream stream;
-    stream.zalloc = Z_NULL;
-    stream.zfree = Z_NULL;
-    stream.opaque = Z_NULL;
-    stream.avail_in = 0;
-    stream.next_in = Z_NULL;
+std::vector<uint8_t> decompress_segments(const uint8_t *compressed_data, const uint64_t size) {
+    mz_stream stream = {};
     if (mz_inflateInit(&stream) != MZ_OK) {
         LOG_ERROR("inflateInit failed while decompressing");
-        return "";
+        return {};
     }
 
-    const std::string compressed_data((char *)&decrypted_data[0], size);
-    stream.next_in = (const Bytef *)compressed_data.data();
-    stream.avail_in = compressed_data.size();
+    stream.next_in = compressed_data;
+    stream.avail_in = static_cast<unsigned int>(size);
 
-    int ret = 0;
-    char outbuffer[4096];
-    std::string decompressed_data;
+    // inflate straight into the result, growing it when full instead of going through a small bounce buffer
+    std::vector<uint8_t> decompressed_data(std::max<uint64_t>(size * 2, 0x10000));
+    int ret = MZ_OK;
+    while (ret == MZ_OK) {
+        if (stream.total_out == decompressed_data.size())
+            decompressed_data.resize(decompressed_data.size() * 2);
 
-    do {
-        stream.next_out = reinterpret_cast<Bytef *>(outbuffer);
-        stream.avail_out = sizeof(outbuffer);
-
-        ret = mz_inflate(&stream, 0);
-
-        if (decompressed_data.size() < stream.total_out) {
-            decompressed_data.append(outbuffer, stream.total_out - decompressed_data.size());
-        }
-    } while (ret == MZ_OK);
+        stream.next_out = decompressed_data.data() + stream.total_out;
+        stream.avail_out = static_cast<unsigned int>(decompressed_data.size() - stream.total_out);
+        ret = mz_inflate(&stream, MZ_NO_FLUSH);
+    }
 
     mz_inflateEnd(&stream);
 
     if (ret != MZ_STREAM_END) {
-        LOG_ERROR("Exception during zlib decompression: ({}) {}", ret, stream.msg);
-        return "";
+        LOG_ERROR("Exception during zlib decompression: ({}) {}", ret, stream.msg ? stream.msg : "");
+        return {};
     }
+    decompressed_data.resize(stream.total_out);
     return decompressed_data;
 }
 
@@ -845,10 +850,10 @@ void self2elf(const fs::path &infile, const fs::path &outfile, KeyStore &SCE_KEY
         }
 
         if (segment_infos[idx].compressed == SecureBool::YES) {
-            const std::string decompressed_data = decompress_segments(decrypted_data, segment_infos[idx].size);
+            const std::vector<uint8_t> decompressed_data = decompress_segments(decrypted_data.data(), segment_infos[idx].size);
             segment_infos[idx].compressed = SecureBool::NO;
-            fileout.write(decompressed_data.c_str(), decompressed_data.length());
-            at += decompressed_data.length();
+            fileout.write(reinterpret_cast<const char *>(decompressed_data.data()), decompressed_data.size());
+            at += decompressed_data.size();
         } else {
             fileout.write((char *)&decrypted_data[0], segment_infos[idx].size);
             at += segment_infos[idx].size;
@@ -980,7 +985,7 @@ void make_fself(const fs::path &input_file, const fs::path &output_file, uint64_
     fileout.close();
 }
 
-std::vector<SceSegment> get_segments(std::ifstream &file, const SceHeader &sce_hdr, KeyStore &SCE_KEYS, const uint64_t sysver, const SelfType self_type, int keytype, unsigned char *klictxt) {
+std::vector<SceSegment> get_segments(std::istream &file, const SceHeader &sce_hdr, KeyStore &SCE_KEYS, const uint64_t sysver, const SelfType self_type, int keytype, unsigned char *klictxt) {
     file.seekg(sce_hdr.metadata_offset + 48);
     std::vector<char> dat(sce_hdr.header_length - sce_hdr.metadata_offset - 48);
     file.read(&dat[0], sce_hdr.header_length - sce_hdr.metadata_offset - 48);
@@ -1069,7 +1074,7 @@ std::vector<SceSegment> get_segments(std::ifstream &file, const SceHeader &sce_h
     return segs;
 }
 
-std::tuple<uint64_t, SelfType> get_key_type(std::ifstream &file, const SceHeader &sce_hdr) {
+std::tuple<uint64_t, SelfType> get_key_type(std::istream &file, const SceHeader &sce_hdr) {
     if (sce_hdr.sce_type == SceType::SELF) {
         file.seekg(32);
         char selfheaderbuffer[SelfHeader::Size];
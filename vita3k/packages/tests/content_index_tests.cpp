@@ -0,0 +1,186 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <packages/content_index.h>
+#include <packages/sfo.h>
+#include <testutil/benchmark.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+namespace {
+
+// param.sfo holding string entries only
+std::vector<uint8_t> make_param_sfo(const std::vector<std::pair<std::string, std::string>> &entries) {
+    std::string keys;
+    std::string data;
+    std::vector<SfoIndexTableEntry> index;
+    for (const auto &[key, value] : entries) {
+        const uint32_t data_len = static_cast<uint32_t>(value.size() + 1);
+        index.push_back({ static_cast<uint16_t>(keys.size()), 0x0204, data_len, data_len, static_cast<uint32_t>(data.size()) });
+        keys += key + '\0';
+        data += value + '\0';
+    }
+
+    SfoHeader header{ 0x46535000, 0x101 };
+    header.key_table_start = static_cast<uint32_t>(sizeof(SfoHeader) + index.size() * sizeof(SfoIndexTableEntry));
+    header.data_table_start = static_cast<uint32_t>(header.key_table_start + keys.size());
+    header.tables_entries = static_cast<uint32_t>(index.size());
+
+    std::vector<uint8_t> sfo(header.data_table_start + data.size());
+    memcpy(sfo.data(), &header, sizeof(header));
+    memcpy(sfo.data() + sizeof(header), index.data(), index.size() * sizeof(SfoIndexTableEntry));
+    memcpy(sfo.data() + header.key_table_start, keys.data(), keys.size());
+    memcpy(sfo.data() + header.data_table_start, data.data(), data.size());
+    return sfo;
+}
+
+void write_file(const fs::path &path, size_t size) {
+    fs::create_directories(path.parent_path());
+    std::ofstream(path.string(), std::ios::binary) << std::string(size, 'x');
+}
+
+void write_file(const fs::path &path, const std::vector<uint8_t> &content) {
+    fs::create_directories(path.parent_path());
+    std::ofstream(path.string(), std::ios::binary).write(reinterpret_cast<const char *>(content.data()), content.size());
+}
+
+std::map<std::string, ContentInfo> index_all(ContentIndexer &indexer, const std::vector<fs::path> &paths) {
+    for (const auto &path : paths)
+        indexer.request(path);
+    indexer.wait();
+
+    std::map<std::string, ContentInfo> infos;
+    for (auto &info : indexer.poll())
+        infos[info.path.filename().string()] = std::move(info);
+    return infos;
+}
+
+} // namespace
+
+class ContentIndexTest : public testing::Test {
+protected:
+    void SetUp() override {
+        root = fs::temp_directory_path() / fmt::format("vita3k-content-test-{}", testing::UnitTest::GetInstance()->random_seed());
+        fs::remove_all(root);
+        fs::create_directories(root);
+    }
+
+    void TearDown() override {
+        fs::remove_all(root);
+    }
+
+    fs::path root;
+};
+
+TEST_F(ContentIndexTest, indexes_size_and_param_sfo) {
+    write_file(root / "PCSE00001/eboot.bin", 1000);
+    write_file(root / "PCSE00001/data/level/1.dat", 234);
+    write_file(root / "PCSE00001/sce_sys/param.sfo", make_param_sfo({ { "TITLE", "Default\nTitle " }, { "TITLE_01", "Localized" }, { "TITLE_ID", "PCSE00001" } }));
+    write_file(root / "PCSE00002/sce_sys/param.sfo", make_param_sfo({ { "TITLE", "Other" }, { "TITLE_ID", "PCSE00002" } }));
+    fs::create_directories(root / "EMPTY");
+
+    ContentIndexer indexer(1);
+    const auto infos = index_all(indexer, { root / "PCSE00001", root / "PCSE00002", root / "EMPTY", root / "MISSING" });
+    ASSERT_EQ(infos.size(), 4);
+    ASSERT_TRUE(indexer.poll().empty());
+
+    const auto &app = infos.at("PCSE00001");
+    ASSERT_EQ(app.size, 1000 + 234 + fs::file_size(root / "PCSE00001/sce_sys/param.sfo"));
+    ASSERT_EQ(app.title, "Localized");
+    ASSERT_EQ(app.title_id, "PCSE00001");
+    ASSERT_EQ(app.updated, fs::last_write_time(root / "PCSE00001"));
+
+    // no title in the system language
+    ASSERT_EQ(infos.at("PCSE00002").title, "Other");
+
+    ASSERT_EQ(infos.at("EMPTY").size, 0);
+    ASSERT_TRUE(infos.at("EMPTY").title.empty());
+    ASSERT_EQ(infos.at("MISSING").size, 0);
+}
+
+TEST_F(ContentIndexTest, result_follows_directory_changes) {
+    const auto save = root / "PCSE00001";
+    write_file(save / "sce_sys/param.sfo", make_param_sfo({ { "TITLE", "Save" } }));
+    write_file(save / "sdslot.dat", 100);
+    const auto sfo_size = fs::file_size(save / "sce_sys/param.sfo");
+
+    ContentIndexer indexer(0);
+    ASSERT_EQ(index_all(indexer, { save }).at("PCSE00001").size, sfo_size + 100);
+
+    // a file added in a sub directory changes its write time
+    write_file(save / "slot0/data.bin", 50);
+    ASSERT_EQ(index_all(indexer, { save }).at("PCSE00001").size, sfo_size + 150);
+
+    // a file grown in place leaves the directories as they were
+    write_file(save / "sdslot.dat", 300);
+    fs::last_write_time(save, fs::last_write_time(save));
+    ASSERT_EQ(index_all(indexer, { save }).at("PCSE00001").size, sfo_size + 350);
+
+    // a file rewritten in place with the same size is seen from its write time
+    write_file(save / "sce_sys/param.sfo", make_param_sfo({ { "TITLE", "Evas" } }));
+    fs::last_write_time(save / "sce_sys/param.sfo", fs::last_write_time(save / "sce_sys/param.sfo") + 10);
+    ASSERT_EQ(index_all(indexer, { save }).at("PCSE00001").title, "Evas");
+
+    fs::remove_all(save);
+    ASSERT_EQ(index_all(indexer, { save }).at("PCSE00001").size, 0);
+}
+
+BENCHMARK_TEST_F(ContentIndexTest, savedata) {
+    // save data directories like a heavily used ux0/user/00/savedata
+    constexpr int SAVE_COUNT = 4000;
+    std::vector<fs::path> saves;
+    for (int i = 0; i < SAVE_COUNT; i++) {
+        const auto save = root / fmt::format("PCSE{:05}", i);
+        write_file(save / "sce_sys/param.sfo", make_param_sfo({ { "TITLE", fmt::format("Save {}", i) } }));
+        write_file(save / "sce_sys/sdslot.dat", 1024);
+        write_file(save / "sce_pfs/files.db", 512);
+        for (int slot = 0; slot < 4; slot++)
+            write_file(save / fmt::format("slot{}/data.bin", slot), 4096 + i);
+        saves.push_back(save);
+    }
+
+    // what the content manager did on the GUI thread
+    uint64_t serial_size = 0;
+    testutil::measure<std::chrono::milliseconds>("serial_walk", [&] {
+        for (const auto &save : saves) {
+            for (const auto &entry : fs::recursive_directory_iterator(save)) {
+                if (fs::is_regular_file(entry.path()))
+                    serial_size += fs::file_size(entry.path());
+            }
+        }
+    });
+
+    ContentIndexer indexer(0);
+    uint64_t cold_size = 0;
+    testutil::measure<std::chrono::milliseconds>("cold_index", [&] {
+        for (const auto &[name, info] : index_all(indexer, saves))
+            cold_size += info.size;
+    });
+    uint64_t reindex_size = 0;
+    testutil::measure<std::chrono::milliseconds>("reindex", [&] {
+        for (const auto &[name, info] : index_all(indexer, saves))
+            reindex_size += info.size;
+    });
+
+    ASSERT_EQ(cold_size, serial_size);
+    ASSERT_EQ(reindex_size, serial_size);
+}
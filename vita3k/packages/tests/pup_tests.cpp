@@ -0,0 +1,429 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <packages/functions.h>
+#include <packages/sce_types.h>
+#include <testutil/benchmark.h>
+#include <util/string_utils.h>
+
+#include <gtest/gtest.h>
+#include <miniz.h>
+#include <openssl/evp.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+
+namespace {
+
+constexpr uint32_t SECTOR_SIZE = 512;
+constexpr uint32_t ROOT_ENTRY_COUNT = 512;
+constexpr uint32_t ROOT_SECTORS = ROOT_ENTRY_COUNT * 32 / SECTOR_SIZE;
+
+constexpr uint8_t SPKG_TYPE_SA0 = 0x17;
+constexpr uint64_t SPKG_HEADER_LENGTH = 0x400;
+constexpr uint32_t SPKG_METADATA_OFFSET = 0xD0;
+constexpr uint64_t SPKG_SEGMENT_OFFSET = SPKG_HEADER_LENGTH + 0x80;
+
+template <typename T>
+void put(std::vector<uint8_t> &data, size_t offset, T value) {
+    memcpy(&data[offset], &value, sizeof(T));
+}
+
+std::vector<uint8_t> make_file_data(std::mt19937 &rng, size_t size) {
+    // half random, half repeated, so that deflate has some work
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++)
+        data[i] = (i / 64) % 2 ? static_cast<uint8_t>(rng()) : static_cast<uint8_t>(i / 64);
+    return data;
+}
+
+// Minimal FAT16 image with 1 sector clusters, sub directories are in the root directory and fit in a cluster
+class FatBuilder {
+public:
+    explicit FatBuilder(uint32_t cluster_count)
+        : cluster_count(cluster_count)
+        , fat_sectors(((cluster_count + 2) * 2 + SECTOR_SIZE - 1) / SECTOR_SIZE)
+        , data_start((1 + 2 * fat_sectors + ROOT_SECTORS) * SECTOR_SIZE)
+        , image(data_start + cluster_count * SECTOR_SIZE) {
+        const uint32_t total_sectors = static_cast<uint32_t>(image.size() / SECTOR_SIZE);
+        const uint8_t jump[] = { 0xEB, 0x3C, 0x90 };
+        memcpy(&image[0], jump, sizeof(jump));
+        memcpy(&image[3], "VITA3K  ", 8);
+        put<uint16_t>(image, 11, SECTOR_SIZE);
+        put<uint8_t>(image, 13, 1);
+        put<uint16_t>(image, 14, 1);
+        put<uint8_t>(image, 16, 2);
+        put<uint16_t>(image, 17, ROOT_ENTRY_COUNT);
+        put<uint16_t>(image, 19, total_sectors < 0x10000 ? total_sectors : 0);
+        put<uint8_t>(image, 21, 0xF8);
+        put<uint16_t>(image, 22, fat_sectors);
+        put<uint32_t>(image, 32, total_sectors < 0x10000 ? 0 : total_sectors);
+        put<uint8_t>(image, 36, 0x80);
+        put<uint8_t>(image, 38, 0x29);
+        memcpy(&image[43], "NO NAME    ", 11);
+        memcpy(&image[54], "FAT16   ", 8);
+        put<uint16_t>(image, 510, 0xAA55);
+
+        set_fat(0, 0xFFF8);
+        set_fat(1, 0xFFFF);
+    }
+
+    // Return the first cluster of the new directory
+    uint16_t add_dir(const std::string &name) {
+        const uint16_t cluster = allocate(SECTOR_SIZE);
+        const size_t dir = cluster_offset(cluster);
+        write_entry(dir, ".", 0x10, cluster, 0);
+        write_entry(dir + 32, "..", 0x10, 0, 0);
+        next_dir_slot[cluster] = 2;
+        add_entry(0, name, 0x10, cluster, 0);
+        return cluster;
+    }
+
+    // parent 0 is the root directory
+    void add_file(uint16_t parent, const std::string &name, const std::vector<uint8_t> &content) {
+        const uint16_t cluster = content.empty() ? 0 : allocate(content.size());
+        if (!content.empty())
+            memcpy(&image[cluster_offset(cluster)], content.data(), content.size());
+        add_entry(parent, name, 0x20, cluster, static_cast<uint32_t>(content.size()));
+    }
+
+    const std::vector<uint8_t> &get_image() const {
+        return image;
+    }
+
+private:
+    size_t cluster_offset(uint16_t cluster) const {
+        return data_start + (cluster - 2) * SECTOR_SIZE;
+    }
+
+    void set_fat(uint32_t cluster, uint16_t value) {
+        for (uint32_t fat = 0; fat < 2; fat++)
+            put<uint16_t>(image, (1 + fat * fat_sectors) * SECTOR_SIZE + cluster * 2, value);
+    }
+
+    uint16_t allocate(size_t size) {
+        const uint32_t count = static_cast<uint32_t>(std::max<size_t>((size + SECTOR_SIZE - 1) / SECTOR_SIZE, 1));
+        EXPECT_LE(next_cluster + count, cluster_count + 2);
+        const uint16_t first = static_cast<uint16_t>(next_cluster);
+        for (uint32_t i = 0; i < count; i++)
+            set_fat(first + i, i + 1 == count ? 0xFFFF : first + i + 1);
+        next_cluster += count;
+        return first;
+    }
+
+    void add_entry(uint16_t parent, const std::string &name, uint8_t attributes, uint16_t cluster, uint32_t size) {
+        const uint32_t slot = next_dir_slot[parent]++;
+        const size_t offset = parent == 0 ? (1 + 2 * fat_sectors) * SECTOR_SIZE + slot * 32 : cluster_offset(parent) + slot * 32;
+        ASSERT_LT(slot, parent == 0 ? ROOT_ENTRY_COUNT : SECTOR_SIZE / 32);
+        write_entry(offset, name, attributes, cluster, size);
+    }
+
+    void write_entry(size_t offset, const std::string &name, uint8_t attributes, uint16_t cluster, uint32_t size) {
+        // 8.3 name padded with spaces
+        char short_name[11];
+        memset(short_name, ' ', sizeof(short_name));
+        const size_t dot = (name == "." || name == "..") ? std::string::npos : name.find('.');
+        memcpy(short_name, name.data(), std::min<size_t>(dot == std::string::npos ? name.size() : dot, 8));
+        if (dot != std::string::npos)
+            memcpy(&short_name[8], &name[dot + 1], std::min<size_t>(name.size() - dot - 1, 3));
+
+        memcpy(&image[offset], short_name, sizeof(short_name));
+        put<uint8_t>(image, offset + 11, attributes);
+        put<uint16_t>(image, offset + 26, cluster);
+        put<uint32_t>(image, offset + 28, size);
+    }
+
+    uint32_t cluster_count;
+    uint32_t fat_sectors;
+    size_t data_start;
+    std::vector<uint8_t> image;
+    uint32_t next_cluster = 2;
+    std::map<uint16_t, uint32_t> next_dir_slot;
+};
+
+void aes_encrypt(const char *cipher_name, const uint8_t *key, const uint8_t *iv, uint8_t *data, size_t size) {
+    EVP_CIPHER_CTX *cipher_ctx = EVP_CIPHER_CTX_new();
+    EVP_CIPHER *cipher = EVP_CIPHER_fetch(nullptr, cipher_name, nullptr);
+    int len = 0;
+    EVP_EncryptInit_ex(cipher_ctx, cipher, nullptr, key, iv);
+    EVP_CIPHER_CTX_set_padding(cipher_ctx, 0);
+    EVP_EncryptUpdate(cipher_ctx, data, &len, data, static_cast<int>(size));
+    EVP_EncryptFinal_ex(cipher_ctx, data + len, &len);
+    EVP_CIPHER_CTX_free(cipher_ctx);
+    EVP_CIPHER_free(cipher);
+}
+
+// SPKG package holding a deflated and encrypted piece of a partition image, like the ones of the retail PUPs
+std::vector<uint8_t> make_package(const uint8_t *piece, size_t piece_size, uint8_t spkg_type, std::mt19937 &rng) {
+    mz_ulong compressed_size = mz_compressBound(static_cast<mz_ulong>(piece_size));
+    std::vector<uint8_t> compressed(compressed_size);
+    EXPECT_EQ(mz_compress2(compressed.data(), &compressed_size, piece, static_cast<mz_ulong>(piece_size), MZ_BEST_SPEED), MZ_OK);
+
+    std::vector<uint8_t> package(SPKG_SEGMENT_OFFSET + compressed_size);
+    put<uint32_t>(package, 0, SCE_MAGIC);
+    put<uint32_t>(package, 4, 3);
+    put<uint8_t>(package, 8, static_cast<uint8_t>(SelfPlatform::VITA));
+    put<uint8_t>(package, 9, 0);
+    put<uint16_t>(package, 10, static_cast<uint16_t>(SceType::SPKG));
+    put<uint32_t>(package, 12, SPKG_METADATA_OFFSET);
+    put<uint64_t>(package, 16, SPKG_HEADER_LENGTH);
+    put<uint64_t>(package, 24, package.size());
+
+    // SPKG header
+    put<uint32_t>(package, SPKG_HEADER_LENGTH + 4, spkg_type);
+    put<uint64_t>(package, SPKG_HEADER_LENGTH + 16, 0x03600000);
+
+    uint8_t segment_key[16];
+    uint8_t segment_iv[16];
+    uint8_t metadata_key[16];
+    uint8_t metadata_iv[16];
+    for (auto *bytes : { segment_key, segment_iv, metadata_key, metadata_iv })
+        for (size_t i = 0; i < 16; i++)
+            bytes[i] = static_cast<uint8_t>(rng());
+
+    // metadata info, decrypted with the SPKG key
+    const size_t info_offset = SPKG_METADATA_OFFSET + 48;
+    memcpy(&package[info_offset], metadata_key, 16);
+    memcpy(&package[info_offset + 32], metadata_iv, 16);
+    const auto spkg_key = string_utils::string_to_byte_array("2E6F4751D15B06C51F572A9306E52DD7007EA56A31D459EC6D3681AB08625501");
+    const auto spkg_iv = string_utils::string_to_byte_array("B3D541A568751DF8F4833BAB4EFE0537");
+    aes_encrypt("AES-256-CBC", spkg_key.data(), spkg_iv.data(), &package[info_offset], MetadataInfo::Size);
+
+    // metadata header, a single section and its key and iv
+    const size_t header_offset = info_offset + MetadataInfo::Size;
+    put<uint32_t>(package, header_offset + 12, 1);
+    put<uint32_t>(package, header_offset + 16, 2);
+    const size_t section_offset = header_offset + MetadataHeader::Size;
+    put<uint64_t>(package, section_offset, SPKG_SEGMENT_OFFSET);
+    put<uint64_t>(package, section_offset + 8, compressed_size);
+    put<uint32_t>(package, section_offset + 20, 2);
+    put<uint32_t>(package, section_offset + 32, static_cast<uint32_t>(EncryptionType::AES128CTR));
+    put<uint32_t>(package, section_offset + 36, 0);
+    put<uint32_t>(package, section_offset + 40, 1);
+    put<uint32_t>(package, section_offset + 44, static_cast<uint32_t>(CompressionType::DEFLATE));
+    const size_t vault_offset = section_offset + MetadataSection::Size;
+    memcpy(&package[vault_offset], segment_key, 16);
+    memcpy(&package[vault_offset + 16], segment_iv, 16);
+    aes_encrypt("AES-128-CBC", metadata_key, metadata_iv, &package[header_offset], SPKG_HEADER_LENGTH - header_offset);
+
+    memcpy(&package[SPKG_SEGMENT_OFFSET], compressed.data(), compressed_size);
+    aes_encrypt("AES-128-CTR", segment_key, segment_iv, &package[SPKG_SEGMENT_OFFSET], compressed_size);
+
+    return package;
+}
+
+class PupInstallTest : public testing::Test {
+protected:
+    void SetUp() override {
+        pref_path = fs::temp_directory_path() / fmt::format("vita3k-pup-test-{}", testing::UnitTest::GetInstance()->random_seed());
+        fs::remove_all(pref_path);
+        fs::create_directories(pref_path);
+    }
+
+    void TearDown() override {
+        fs::remove_all(pref_path);
+    }
+
+    // Build a sa0 partition holding file_count files of about file_size bytes, spread in the root and in sub directories
+    void make_partition(uint32_t file_count, size_t file_size) {
+        std::mt19937 rng(1234);
+        const uint32_t clusters_per_file = static_cast<uint32_t>(file_size / SECTOR_SIZE + 1);
+        // at least 4085 clusters, or it would be a FAT12 image
+        FatBuilder builder(std::max<uint32_t>(file_count * clusters_per_file + file_count / 8 + 8, 4200));
+
+        // a directory cluster holds 14 entries besides . and ..
+        constexpr uint32_t FILES_PER_DIR = 14;
+        uint16_t dir = 0;
+        std::string dir_name;
+        for (uint32_t i = 0; i < file_count; i++) {
+            const std::string name = fmt::format("F{:05}.BIN", i);
+            auto content = make_file_data(rng, file_size + i % 7);
+            if (i < 4) {
+                builder.add_file(0, name, content);
+                files[string_utils::tolower(name)] = std::move(content);
+                continue;
+            }
+
+            if ((i - 4) % FILES_PER_DIR == 0) {
+                dir_name = fmt::format("D{:03}", (i - 4) / FILES_PER_DIR);
+                dir = builder.add_dir(dir_name);
+            }
+            builder.add_file(dir, name, content);
+            files[string_utils::tolower(dir_name + "/" + name)] = std::move(content);
+        }
+        image = builder.get_image();
+    }
+
+    // Split the partition image in package_count SPKG packages and write the PUP, without version.txt if version is empty
+    void make_pup(uint32_t package_count, const std::string &version) {
+        std::mt19937 rng(5678);
+        std::vector<std::pair<uint64_t, std::vector<uint8_t>>> entries;
+        if (!version.empty())
+            entries.push_back({ 0x100, std::vector<uint8_t>(version.begin(), version.end()) });
+        const size_t piece_size = (image.size() + package_count - 1) / package_count;
+        for (size_t offset = 0; offset < image.size(); offset += piece_size) {
+            const size_t size = std::min(piece_size, image.size() - offset);
+            entries.push_back({ 0x300 + entries.size(), make_package(&image[offset], size, SPKG_TYPE_SA0, rng) });
+        }
+
+        std::vector<uint8_t> pup(0x80 + entries.size() * 0x20);
+        memcpy(&pup[0], "SCEUF", 5);
+        put<uint32_t>(pup, 0x18, static_cast<uint32_t>(entries.size()));
+        for (size_t i = 0; i < entries.size(); i++) {
+            const size_t record = 0x80 + i * 0x20;
+            put<uint64_t>(pup, record, entries[i].first);
+            put<uint64_t>(pup, record + 8, pup.size());
+            put<uint64_t>(pup, record + 16, entries[i].second.size());
+            pup.insert(pup.end(), entries[i].second.begin(), entries[i].second.end());
+        }
+
+        pup_path = pref_path / "test.PUP";
+        std::ofstream pup_file(pup_path.string(), std::ios::binary);
+        pup_file.write(reinterpret_cast<const char *>(pup.data()), pup.size());
+    }
+
+    void check_installed_files() {
+        const fs::path sa0 = pref_path / "sa0";
+        size_t found = 0;
+        for (const auto &file : fs::recursive_directory_iterator(sa0)) {
+            if (!fs::is_regular_file(file.path()))
+                continue;
+            const std::string relative = string_utils::tolower(fs::relative(file.path(), sa0).generic_string());
+            ASSERT_TRUE(files.contains(relative)) << relative;
+
+            std::ifstream installed(file.path().string(), std::ios::binary);
+            const std::vector<uint8_t> content((std::istreambuf_iterator<char>(installed)), std::istreambuf_iterator<char>());
+            ASSERT_EQ(content, files[relative]) << relative;
+            found++;
+        }
+        ASSERT_EQ(found, files.size());
+    }
+
+    fs::path pref_path;
+    fs::path pup_path;
+    std::vector<uint8_t> image;
+    std::map<std::string, std::vector<uint8_t>> files;
+};
+
+} // namespace
+
+TEST(pup, decompress_segments_inflates_in_one_pass) {
+    std::mt19937 rng(42);
+    const auto data = make_file_data(rng, 1024 * 1024 + 3);
+    mz_ulong compressed_size = mz_compressBound(static_cast<mz_ulong>(data.size()));
+    std::vector<uint8_t> compressed(compressed_size);
+    ASSERT_EQ(mz_compress(compressed.data(), &compressed_size, data.data(), static_cast<mz_ulong>(data.size())), MZ_OK);
+
+    ASSERT_EQ(decompress_segments(compressed.data(), compressed_size), data);
+    // truncated stream
+    ASSERT_TRUE(decompress_segments(compressed.data(), compressed_size / 2).empty());
+}
+
+TEST_F(PupInstallTest, installs_partition_without_intermediate_files) {
+    make_partition(64, 3000);
+    make_pup(5, "3.600.011\n");
+
+    std::vector<uint32_t> progress;
+    std::string version;
+    ASSERT_TRUE(install_pup(pref_path, pup_path, version, [&](uint32_t percent) {
+        progress.push_back(percent);
+    }));
+
+    ASSERT_EQ(version, "3.600.011");
+    check_installed_files();
+    ASSERT_FALSE(fs::exists(pref_path / "PUP_DEC"));
+
+    // reported once per percentage change, in order, ending at 100
+    ASSERT_FALSE(progress.empty());
+    ASSERT_TRUE(std::is_sorted(progress.begin(), progress.end()));
+    ASSERT_EQ(std::adjacent_find(progress.begin(), progress.end()), progress.end());
+    ASSERT_EQ(progress.back(), 100);
+}
+
+TEST_F(PupInstallTest, rejects_invalid_pup) {
+    pup_path = pref_path / "invalid.PUP";
+    std::ofstream(pup_path.string(), std::ios::binary) << std::string(0x100, 'x');
+
+    std::string version;
+    ASSERT_FALSE(install_pup(pref_path, pup_path, version));
+    ASSERT_FALSE(fs::exists(pref_path / "sa0"));
+}
+
+TEST_F(PupInstallTest, installs_pup_without_version) {
+    make_partition(16, 3000);
+    make_pup(2, "");
+
+    std::string version;
+    ASSERT_TRUE(install_pup(pref_path, pup_path, version));
+    ASSERT_TRUE(version.empty());
+    check_installed_files();
+}
+
+TEST_F(PupInstallTest, rejects_file_count_overflow) {
+    // 0x08000000 records of 0x20 bytes wrap around to 0 in 32 bits
+    std::vector<uint8_t> pup(0x100);
+    memcpy(&pup[0], "SCEUF", 5);
+    put<uint32_t>(pup, 0x18, 0x08000000);
+    pup_path = pref_path / "overflow.PUP";
+    std::ofstream(pup_path.string(), std::ios::binary).write(reinterpret_cast<const char *>(pup.data()), pup.size());
+
+    std::string version;
+    ASSERT_FALSE(install_pup(pref_path, pup_path, version));
+}
+
+TEST_F(PupInstallTest, rejects_truncated_pup) {
+    make_partition(64, 3000);
+    make_pup(5, "3.600.011\n");
+    // the last package ends after the end of the file
+    fs::resize_file(pup_path, fs::file_size(pup_path) - 16);
+
+    std::string version;
+    ASSERT_FALSE(install_pup(pref_path, pup_path, version));
+    ASSERT_FALSE(fs::exists(pref_path / "sa0"));
+}
+
+TEST_F(PupInstallTest, fails_on_corrupted_package) {
+    make_partition(64, 3000);
+    make_pup(5, "3.600.011\n");
+    // the end of the last package is its encrypted segment, it no longer inflates
+    {
+        std::fstream pup_file(pup_path.string(), std::ios::binary | std::ios::in | std::ios::out);
+        pup_file.seekp(-16, std::ios::end);
+        pup_file.write(std::string(16, '\0').data(), 16);
+    }
+
+    std::string version;
+    ASSERT_FALSE(install_pup(pref_path, pup_path, version));
+    ASSERT_FALSE(fs::exists(pref_path / "sa0"));
+}
+
+BENCHMARK_TEST_F(PupInstallTest, install) {
+    // about 24 MB of partition split in 32 packages
+    make_partition(768, 32 * 1024);
+    make_pup(32, "3.600.011\n");
+
+    std::string version;
+    bool installed = false;
+    testutil::measure<std::chrono::milliseconds>("install", [&] { installed = install_pup(pref_path, pup_path, version); });
+    ASSERT_TRUE(installed);
+
+    check_installed_files();
+}
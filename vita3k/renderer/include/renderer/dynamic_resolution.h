@@ -0,0 +1,66 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace renderer {
+
+/**
+ * @brief Picks the render scale of the next frames from the GPU time of the last ones
+ *
+ * The GPU time is considered proportional to the number of pixels rendered, so to the square of the scale.
+ * The scale drops as soon as the smoothed GPU time goes over the frame budget and only rises back
+ * once the higher scale has fitted in the budget for a while, so it does not oscillate between two steps.
+ */
+class DynamicResolution {
+public:
+    // Scales are multiplied with the resolution multiplier, max_scale is usually 1
+    void set_bounds(float min_scale, float max_scale);
+    void set_target(std::chrono::microseconds frame_time);
+
+    /**
+     * @brief Feed the GPU time of a finished frame
+     *
+     * @return The scale to render the next frames at
+     */
+    float add_frame(std::chrono::microseconds gpu_time);
+
+    float get_scale() const {
+        return scale;
+    }
+
+    // Forget the previous frames and go back to the maximum scale
+    void reset();
+
+private:
+    float min_scale = 0.5f;
+    float max_scale = 1.0f;
+    float scale = 1.0f;
+    std::chrono::microseconds target = std::chrono::microseconds(16667);
+
+    // exponential moving average of the GPU time, in microseconds
+    double average_time = 0.0;
+    // frames ignored after a change, they were already in flight at the previous scale
+    uint32_t frames_to_skip = 0;
+    uint32_t frames_under_budget = 0;
+};
+
+} // namespace renderer
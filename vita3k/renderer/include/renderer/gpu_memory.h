@@ -0,0 +1,79 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace renderer {
+
+struct GpuMemoryStats {
+    // bytes allocated by each part of the renderer
+    uint64_t texture_cache = 0;
+    uint64_t surface_cache = 0;
+    uint64_t ring_buffers = 0;
+    uint64_t other = 0;
+
+    // device local memory used by the whole process and what the driver lets it use, 0 if unknown
+    uint64_t usage = 0;
+    uint64_t budget = 0;
+
+    uint64_t evicted_bytes = 0;
+    uint32_t defragmentations = 0;
+};
+
+// Memory blocks of a memory type holding textures
+struct TextureMemoryUsage {
+    // size of all the blocks of the memory type and the bytes allocated in them, by textures or anything else
+    uint64_t block_bytes = 0;
+    uint64_t allocation_bytes = 0;
+    // number of these blocks holding at least one texture
+    uint32_t texture_blocks = 0;
+};
+
+// Return true if moving the textures can release memory blocks, only the memory types holding textures must be given
+bool should_defragment_textures(const std::vector<TextureMemoryUsage> &memory_types);
+
+/**
+ * @brief Keeps the GPU memory usage under the budget given by the driver
+ *
+ * Once the usage goes over a high watermark, the caches are asked in order to free memory until
+ * the usage is back under a low watermark, the gap avoids evicting a bit every frame.
+ */
+class GpuMemoryBudget {
+public:
+    // Free up to the given number of bytes, return how many were freed
+    using Evictor = std::function<uint64_t(uint64_t)>;
+
+    // Evictors are called in the order they are added, the cheapest to refill first
+    void add_evictor(Evictor &&evictor);
+
+    /**
+     * @brief Evict from the caches if usage is too close to budget
+     *
+     * @return The number of bytes evicted
+     */
+    uint64_t enforce(uint64_t usage, uint64_t budget);
+
+private:
+    std::vector<Evictor> evictors;
+};
+
+} // namespace renderer
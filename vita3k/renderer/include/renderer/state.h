@@ -19,6 +19,7 @@
 
 #include <features/state.h>
 #include <renderer/commands.h>
+#include <renderer/gpu_memory.h>
 #include <renderer/types.h>
 #include <threads/queue.h>
 
@@ -28,6 +29,7 @@
 
 struct SDL_Window;
 struct DisplayState;
+struct DisplayFrameInfo;
 struct GxmState;
 struct Config;
 #ifdef ANDROID
@@ -108,8 +110,8 @@ struct State {
         const GxmState &gxm, MemState &mem)
         = 0;
     virtual void swap_window(SDL_Window *window) = 0;
-    // perform a screenshot of the (upscaled) frame to be rendered and return it in a vector in its rgba8 format
-    virtual std::vector<uint32_t> dump_frame(DisplayState &display, uint32_t &width, uint32_t &height) = 0;
+    // perform a screenshot of the (upscaled) frame and return it in a vector in its rgba8 format
+    virtual std::vector<uint32_t> dump_frame(const DisplayFrameInfo &frame, uint32_t &width, uint32_t &height) = 0;
     // return a mask of the features which can influence the compiled shaders
     virtual uint32_t get_features_mask() {
         return 0;
@@ -137,6 +139,11 @@ struct State {
         return false;
     }
     virtual void set_turbo_mode(bool set) {}
+    virtual void set_dynamic_resolution(bool enable, float min_scale, int target_fps) {}
+    // return false if the backend does not track its GPU memory
+    virtual bool get_gpu_memory_stats(GpuMemoryStats &stats) {
+        return false;
+    }
     virtual uint32_t get_gpu_version() {
         return 0;
     }
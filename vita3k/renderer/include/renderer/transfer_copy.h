@@ -0,0 +1,39 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <renderer/gxm_types.h>
+
+#include <cstdint>
+
+namespace renderer {
+
+/**
+ * @brief Copy the area of src starting at (src.x, src.y) to dst at (dst.x, dst.y) on the CPU
+ *
+ * The address field of the images is not used, src_data and dst_data point to the first texel of each image.
+ * The color key is only applied to 32-bit formats.
+ */
+void copy_transfer_image(const void *src_data, void *dst_data, const SceGxmTransferImage &src, const SceGxmTransferImage &dst,
+    SceGxmTransferType src_type, SceGxmTransferType dst_type, SceGxmTransferColorKeyMode key_mode, uint32_t key_value, uint32_t key_mask);
+
+// Same as copy_transfer_image, but computes the address of each texel on its own, used as a reference for the faster kernels
+void copy_transfer_image_texels(const void *src_data, void *dst_data, const SceGxmTransferImage &src, const SceGxmTransferImage &dst,
+    SceGxmTransferType src_type, SceGxmTransferType dst_type, SceGxmTransferColorKeyMode key_mode, uint32_t key_value, uint32_t key_mask);
+
+} // namespace renderer
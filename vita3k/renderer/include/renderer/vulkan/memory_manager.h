@@ -0,0 +1,60 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#pragma once
+
+#include <renderer/gpu_memory.h>
+
+#include <mutex>
+
+namespace renderer::vulkan {
+
+struct VKState;
+
+/**
+ * @brief Watches the device local memory used by the renderer
+ *
+ * Every few frames, the usage is compared with the budget reported by the driver (VK_EXT_memory_budget)
+ * and the texture cache then the surface cache are trimmed if it gets too close.
+ * The texture allocations are also defragmented from time to time, the texture cache creates and
+ * destroys images of all sizes and ends up spreading them over many memory blocks.
+ */
+class MemoryManager {
+public:
+    explicit MemoryManager(VKState &state);
+
+    // Must be called at the beginning of a frame, outside of any command buffer recording
+    void new_frame(uint64_t frame_timestamp);
+
+    // Can be called from any thread
+    GpuMemoryStats get_stats();
+
+private:
+    VKState &state;
+    GpuMemoryBudget budget;
+
+    // usage and budget of the device local heaps
+    void get_device_usage(uint64_t &usage, uint64_t &total_budget);
+    // return true if textures were moved
+    bool defragment_textures();
+
+    std::mutex stats_mutex;
+    GpuMemoryStats stats;
+};
+
+} // namespace renderer::vulkan
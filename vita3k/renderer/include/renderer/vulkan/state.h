@@ -17,9 +17,11 @@
 
 #pragma once
 
+#include <renderer/dynamic_resolution.h>
 #include <renderer/state.h>
 #include <renderer/types.h>
 
+#include <renderer/vulkan/memory_manager.h>
 #include <renderer/vulkan/pipeline_cache.h>
 #include <renderer/vulkan/screen_renderer.h>
 #include <renderer/vulkan/surface_cache.h>
@@ -50,6 +52,7 @@ struct VKState : public renderer::State {
     VKSurfaceCache surface_cache;
     PipelineCache pipeline_cache;
     VKTextureCache texture_cache;
+    MemoryManager memory_manager;
 
     vk::Instance instance;
     vk::Device device;
@@ -103,6 +106,13 @@ struct VKState : public renderer::State {
     vkutil::Buffer default_buffer;
 
     bool support_fsr = false;
+    // valid bits of the timestamps written on the general queue, 0 if timestamp queries are not supported
+    uint32_t timestamp_valid_bits = 0;
+
+    bool enable_dynamic_resolution = false;
+    DynamicResolution dynamic_resolution;
+    // scale applied on top of res_multiplier to the surfaces being presented, updated at the beginning of each frame
+    float render_scale = 1.0f;
     // support for the VK_KHR_uniform_buffer_standard_layout extension, needed for memory mapping and texture viewport
     bool support_standard_layout = false;
     bool support_rasterized_order_access = false;
@@ -130,7 +140,7 @@ struct VKState : public renderer::State {
     void render_frame(const SceFVector2 &viewport_pos, const SceFVector2 &viewport_size, DisplayState &display,
         const GxmState &gxm, MemState &mem) override;
     void swap_window(SDL_Window *window) override;
-    std::vector<uint32_t> dump_frame(DisplayState &display, uint32_t &width, uint32_t &height) override;
+    std::vector<uint32_t> dump_frame(const DisplayFrameInfo &frame, uint32_t &width, uint32_t &height) override;
 
     uint32_t get_features_mask() override;
     int get_supported_filters() override;
@@ -153,6 +163,8 @@ struct VKState : public renderer::State {
     void preclose_action() override;
     bool support_custom_drivers() override;
     void set_turbo_mode(bool set) override;
+    void set_dynamic_resolution(bool enable, float min_scale, int target_fps) override;
+    bool get_gpu_memory_stats(GpuMemoryStats &stats) override;
 
     inline FrameObject &frame() {
         return frames[current_frame_idx];
@@ -110,6 +110,12 @@ struct ColorSurfaceCacheInfo : public SurfaceCacheInfo {
     // only for double buffer, do we need to sync the two views?
     bool need_buffer_sync = false;
 
+    // dynamic resolution: part of the surface (in each dimension) rendered to the last time it was used as a framebuffer
+    float render_scale = 1.0f;
+    // only surfaces displayed on the screen and never read back are rendered at a lower scale
+    bool is_presented = false;
+    bool is_sampled = false;
+
     ColorSurfaceCacheInfo() = default;
     ~ColorSurfaceCacheInfo();
 };
@@ -132,6 +138,8 @@ struct DepthStencilSurfaceCacheInfo : public SurfaceCacheInfo {
     // stride in samples
     uint32_t stride_samples;
     SceGxmMultisampleMode multisample_mode;
+    // dynamic resolution: scale of the render pass which last used this depth stencil
+    float render_scale = 1.0f;
 
     // used when reading from this depth stencil in a shader with texture viewport enabled
     vk::ImageView depth_view = nullptr;
@@ -181,12 +189,29 @@ private:
     VKRenderTarget *target = nullptr;
     ColorSurfaceCacheInfo *last_written_surface = nullptr;
 
+    // surfaces written by a GPU transfer and copied back to memory in the command buffer being recorded
+    std::vector<ColorSurfaceCacheInfo *> transfer_synced_surfaces;
+
     // destroy all framebuffers using view as their color or depth-stencil
     void destroy_framebuffers(vk::ImageView view);
 
     void destroy_surface(ColorSurfaceCacheInfo &info);
     void destroy_surface(DepthStencilSurfaceCacheInfo &info);
 
+    // return the color surface the transfer image is exactly located in, if any
+    ColorSurfaceCacheInfo *find_transfer_surface(const SceGxmTransferImage &image, SceGxmTransferType type);
+    // return the command buffer transfer operations can be recorded into, null if it is not possible right now
+    vk::CommandBuffer get_transfer_cmd_buffer();
+    // the transfer only wrote the destination surface on the GPU, copy it back to memory too if surface sync is enabled
+    void sync_transfer_destination(vk::CommandBuffer cmd_buffer, ColorSurfaceCacheInfo &surface);
+    // copy the content of the surface, which is in image_layout, to its memory
+    void copy_surface_to_memory(vk::CommandBuffer cmd_buffer, ColorSurfaceCacheInfo &surface, vk::ImageLayout image_layout);
+    // copy height rows of row_size bytes, data_stride bytes apart, to the area of the surface
+    // the data is read when this function is called
+    void copy_data_to_surface(vk::CommandBuffer cmd_buffer, ColorSurfaceCacheInfo &surface, const uint8_t *data, uint32_t data_stride, vk::Offset3D offset, vk::Extent3D extent);
+    // stretch the part of the surface rendered at its current scale so that it covers the area of new_scale
+    void rescale_surface(vk::CommandBuffer cmd_buffer, ColorSurfaceCacheInfo &info, float new_scale);
+
 public:
     // when creating a mutable image, can we pass as an argument
     // the possible format used for an image view to improve performance ?
@@ -215,8 +240,21 @@ public:
     // so that subsequent calls to check_for_surface with the target destination also get delayed
     bool check_for_surface(MemState &mem, Address source_address, CallbackRequestFunction &callback, Address target_address);
 
+    // Perform the transfer operation on the GPU if both the source and destination are cached color surfaces
+    // or if the destination surface can simply be filled
+    // Return true if the operation was handled, in this case the CPU implementation must not be called
+    bool gpu_transfer_copy(const SceGxmTransferImage &src, const SceGxmTransferImage &dst, SceGxmTransferType src_type, SceGxmTransferType dst_type, SceGxmTransferColorKeyMode key_mode);
+    bool gpu_transfer_downscale(const SceGxmTransferImage &src, const SceGxmTransferImage &dst);
+    bool gpu_transfer_fill(const SceGxmTransferImage &dst, uint32_t fill_color);
+
+    // Called after the CPU performed a transfer operation to dst
+    // if dst is a cached color surface, upload the modified area so the GPU content stays coherent
+    void upload_transfer_to_surface(MemState &mem, const SceGxmTransferImage &dst, SceGxmTransferType dst_type);
+
     // If non-null, the return value must be sent as a PostSurfaceSyncRequest
     ColorSurfaceCacheInfo *perform_surface_sync();
+    // Surfaces copied back to memory by GPU transfers since the last call, to be handled as the return value of perform_surface_sync
+    std::vector<ColorSurfaceCacheInfo *> take_transfer_synced_surfaces();
 
     // Called after the render has been done
     void perform_post_surface_sync(const MemState &mem, ColorSurfaceCacheInfo *surface);
@@ -231,7 +269,16 @@ public:
 
     // Dump an rgba8 frame with the given properties to the returned vector
     // if this function fails, the vector will be empty
-    std::vector<uint32_t> dump_frame(Ptr<const void> address, uint32_t width, uint32_t height, uint32_t pitch);
+    // width and height are scaled if the surface was rendered at a lower scale
+    std::vector<uint32_t> dump_frame(Ptr<const void> address, uint32_t &width, uint32_t &height, uint32_t pitch);
+
+    // Return the scale at which the color surface is going to be rendered with dynamic resolution, color can be null
+    float get_render_scale(const SceGxmColorSurface *color);
+
+    // destroy the copies made from the least recently rendered color surfaces (casted textures, downscaled images, ...)
+    // until bytes are freed, return the number of bytes freed
+    // the surfaces themselves are kept, their content may not have been written back to the guest memory
+    uint64_t evict_surfaces(uint64_t bytes);
 
     void set_render_target(VKRenderTarget *new_target) {
         target = new_target;
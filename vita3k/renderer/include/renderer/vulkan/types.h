@@ -31,6 +31,8 @@ struct VKRenderTarget;
 
 constexpr uint8_t MAX_FRAMES_RENDERING = 3;
 constexpr uint8_t NB_TEXTURE_STAGING_BUFFERS = 16;
+// two timestamps are written for each submitted scene, used to measure the GPU time of a frame
+constexpr uint32_t MAX_TIMESTAMPS_PER_FRAME = 512;
 
 struct TextureStagingBuffer {
     vkutil::Buffer buffer;
@@ -45,6 +47,10 @@ struct TextureCacheEntry {
     bool is_cube;
     uint16_t mip_count;
     uint32_t memory_needed;
+    // needed to create the view again when the texture is moved by the defragmentation
+    vk::ComponentMapping swizzle;
+    // frame timestamp of the last time this texture was bound
+    uint64_t last_used_frame = 0;
 };
 
 struct VKTextureCache : public TextureCache {
@@ -75,6 +81,9 @@ struct VKTextureCache : public TextureCache {
 
     void configure_sampler(size_t index, const SceGxmTexture &texture, bool no_linear) override;
 
+    // destroy the least recently used textures until bytes are freed, return the number of bytes freed
+    uint64_t evict_textures(uint64_t bytes);
+
     void import_configure_impl(SceGxmTextureBaseFormat base_format, uint32_t width, uint32_t height, bool is_srgb, uint16_t nb_components, uint16_t mipcount, bool swap_rb) override;
 
     vk::Sampler get_retrieved_sampler() const {
@@ -107,6 +116,10 @@ struct FrameObject {
 
     // destroy gpu objects MAX_FRAMES_RENDERING frames later to make sure they are no longer being used
     vkutil::DestroyQueue destroy_queue;
+
+    // only created if timestamps are supported, the beginning and end of each recording are written in it
+    vk::QueryPool timestamp_pool;
+    uint32_t timestamps_used = 0;
 };
 
 struct MappedMemoryBuffer {
@@ -280,6 +293,8 @@ struct VKContext : public renderer::Context {
     VKRenderTarget *render_target = nullptr;
     vk::Viewport viewport;
     vk::Rect2D scissor;
+    // part of the color surface rendered to with dynamic resolution, viewport and scissor are already scaled by it
+    float render_scale = 1.0f;
     SceGxmPrimitiveType last_primitive;
 
     vk::RenderPass current_render_pass;
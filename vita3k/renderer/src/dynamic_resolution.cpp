@@ -0,0 +1,101 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#include <renderer/dynamic_resolution.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace renderer {
+
+// Weight of the last frame in the average, a single slow frame does not change the scale
+constexpr double FRAME_WEIGHT = 0.2;
+// The scale drops when the average goes over this part of the budget
+constexpr double DOWNSCALE_THRESHOLD = 0.95;
+// Part of the budget a new scale is chosen to use, leaving headroom for heavier scenes
+constexpr double BUDGET_USAGE = 0.85;
+// Frames the next step up must be predicted to fit in before the scale rises
+constexpr uint32_t UPSCALE_DELAY = 30;
+// Granularity of the scale, so that surfaces are not rendered at a slightly different size each frame
+constexpr float SCALE_STEP = 0.05f;
+// Frames rendered at the previous scale still being measured after a change
+constexpr uint32_t SETTLE_FRAMES = 4;
+
+void DynamicResolution::set_bounds(float min_scale, float max_scale) {
+    this->max_scale = max_scale;
+    this->min_scale = std::min(min_scale, max_scale);
+    scale = std::clamp(scale, this->min_scale, this->max_scale);
+}
+
+void DynamicResolution::set_target(std::chrono::microseconds frame_time) {
+    target = frame_time;
+}
+
+void DynamicResolution::reset() {
+    scale = max_scale;
+    average_time = 0.0;
+    frames_to_skip = 0;
+    frames_under_budget = 0;
+}
+
+float DynamicResolution::add_frame(std::chrono::microseconds gpu_time) {
+    if (gpu_time.count() <= 0)
+        return scale;
+
+    if (frames_to_skip > 0) {
+        frames_to_skip--;
+        return scale;
+    }
+
+    if (average_time == 0.0)
+        average_time = static_cast<double>(gpu_time.count());
+    else
+        average_time += (static_cast<double>(gpu_time.count()) - average_time) * FRAME_WEIGHT;
+
+    const double budget = static_cast<double>(target.count());
+    float new_scale = scale;
+    if (average_time > budget * DOWNSCALE_THRESHOLD) {
+        frames_under_budget = 0;
+        const float ideal_scale = scale * static_cast<float>(std::sqrt(budget * BUDGET_USAGE / average_time));
+        new_scale = std::max(std::floor(ideal_scale / SCALE_STEP) * SCALE_STEP, min_scale);
+    } else if (scale < max_scale) {
+        const float next_scale = std::min(scale + SCALE_STEP, max_scale);
+        const double ratio = static_cast<double>(next_scale) / scale;
+        if (average_time * ratio * ratio < budget * BUDGET_USAGE)
+            frames_under_budget++;
+        else
+            frames_under_budget = 0;
+
+        if (frames_under_budget >= UPSCALE_DELAY) {
+            frames_under_budget = 0;
+            new_scale = next_scale;
+        }
+    }
+
+    if (new_scale != scale) {
+        // the next frames are expected to take the time predicted for the new scale
+        const double ratio = static_cast<double>(new_scale) / scale;
+        average_time *= ratio * ratio;
+        scale = new_scale;
+        frames_to_skip = SETTLE_FRAMES;
+    }
+
+    return scale;
+}
+
+} // namespace renderer
@@ -677,6 +677,8 @@ void GLState::render_frame(const SceFVector2 &viewport_pos, const SceFVector2 &v
     if (!frame.base)
         return;
 
+    display.presented_frame = frame;
+
     // Check if the surface exists
     float uvs[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
     bool need_uv = true;
@@ -731,13 +733,7 @@ void GLState::swap_window(SDL_Window *window) {
     SDL_GL_SwapWindow(window);
 }
 
-std::vector<uint32_t> GLState::dump_frame(DisplayState &display, uint32_t &width, uint32_t &height) {
-    DisplayFrameInfo frame;
-    {
-        std::lock_guard<std::mutex> guard(display.display_info_mutex);
-        frame = display.next_rendered_frame;
-    }
-
+std::vector<uint32_t> GLState::dump_frame(const DisplayFrameInfo &frame, uint32_t &width, uint32_t &height) {
     width = static_cast<uint32_t>(frame.image_size.x * res_multiplier);
     height = static_cast<uint32_t>(frame.image_size.y * res_multiplier);
     return surface_cache.dump_frame(frame.base, width, height, frame.pitch, res_multiplier, features.support_get_texture_sub_image);
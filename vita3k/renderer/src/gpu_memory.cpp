@@ -0,0 +1,66 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#include <renderer/gpu_memory.h>
+
+namespace renderer {
+
+// Part of the budget over which the caches start being evicted
+constexpr double HIGH_WATERMARK = 0.90;
+// Part of the budget the eviction brings the usage back to
+constexpr double LOW_WATERMARK = 0.75;
+// Part of the memory blocks left unused above which the textures are defragmented
+constexpr double FRAGMENTATION_THRESHOLD = 0.25;
+
+bool should_defragment_textures(const std::vector<TextureMemoryUsage> &memory_types) {
+    for (const auto &memory_type : memory_types) {
+        // the textures are packed into fewer blocks, with all of them in a single one nothing can be released
+        if (memory_type.texture_blocks < 2 || memory_type.block_bytes == 0)
+            continue;
+
+        const uint64_t unused_bytes = memory_type.block_bytes - memory_type.allocation_bytes;
+        if (unused_bytes >= memory_type.block_bytes * FRAGMENTATION_THRESHOLD)
+            return true;
+    }
+
+    return false;
+}
+
+void GpuMemoryBudget::add_evictor(Evictor &&evictor) {
+    evictors.push_back(std::move(evictor));
+}
+
+uint64_t GpuMemoryBudget::enforce(uint64_t usage, uint64_t budget) {
+    if (budget == 0 || usage <= static_cast<uint64_t>(budget * HIGH_WATERMARK))
+        return 0;
+
+    const uint64_t target = static_cast<uint64_t>(budget * LOW_WATERMARK);
+    uint64_t evicted = 0;
+    for (auto &evictor : evictors) {
+        if (usage - evicted <= target)
+            break;
+
+        evicted += evictor(usage - evicted - target);
+        if (evicted >= usage)
+            break;
+    }
+
+    return evicted;
+}
+
+} // namespace renderer
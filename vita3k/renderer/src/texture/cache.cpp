@@ -752,11 +752,7 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
         if (export_textures && !importing_texture)
             export_select(gxm_texture);
 
-        if (importing_texture)
-            import_upload_texture();
-        else
-            upload_texture(gxm_texture, mem);
-
+        // protect the texture before reading it, a guest write done during the upload then marks it dirty again
         if (!info->use_hash) {
             info->dirty = false;
             add_protect(mem, range_protect_begin, range_protect_end - range_protect_begin, MemPerm::ReadOnly, [info, texture_repr](Address, bool) {
@@ -768,6 +764,11 @@ void TextureCache::cache_and_bind_texture(const SceGxmTexture &gxm_texture, MemS
             });
         }
 
+        if (importing_texture)
+            import_upload_texture();
+        else
+            upload_texture(gxm_texture, mem);
+
         upload_done();
         if (export_textures && !importing_texture)
             export_done();
@@ -17,40 +17,17 @@
 
 #include <renderer/functions.h>
 
+#include <codec/state.h>
+
 extern "C" {
 #include <libswscale/swscale.h>
 }
 
 namespace renderer::texture {
 
-static SwsContext *s_render_sws_context{};
-static size_t res[2] = { 0, 0 };
-static bool is_yuv_p3 = false;
-static SwsContext *get_sws_context(size_t width, size_t height, bool is_p3) {
-    bool recreate = false;
-    if (res[0] != width || res[1] != height || is_yuv_p3 != is_p3) {
-        recreate = true;
-        res[0] = width;
-        res[1] = height;
-        is_yuv_p3 = is_p3;
-    } else if (s_render_sws_context == nullptr) {
-        recreate = true;
-    }
-
-    if (recreate) {
-        if (s_render_sws_context != nullptr) {
-            sws_freeContext(s_render_sws_context);
-            s_render_sws_context = nullptr;
-        }
-        const AVPixelFormat format = is_p3 ? AV_PIX_FMT_YUV420P : AV_PIX_FMT_NV12;
-        s_render_sws_context = sws_getContext(width, height, format, width, height, AV_PIX_FMT_RGB0,
-            0, nullptr, nullptr, nullptr);
-    }
-    return s_render_sws_context;
-}
-
 void yuv420_texture_to_rgb(uint8_t *dst, const uint8_t *src, uint32_t width, uint32_t height, uint32_t layout_width, uint32_t layout_height, bool is_p3) {
-    SwsContext *context = get_sws_context(width, height, is_p3);
+    const AVPixelFormat format = is_p3 ? AV_PIX_FMT_YUV420P : AV_PIX_FMT_NV12;
+    SwsContext *context = get_sws_context(width, height, format, width, height, AV_PIX_FMT_RGB0, 0);
     assert(context);
 
     const uint8_t *slices[] = {
@@ -15,12 +15,14 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
+#include <codec/state.h>
 #include <gxm/functions.h>
 #include <gxm/types.h>
 #include <renderer/commands.h>
 #include <renderer/driver_functions.h>
 #include <renderer/functions.h>
 #include <renderer/state.h>
+#include <renderer/transfer_copy.h>
 #include <renderer/types.h>
 #include <util/log.h>
 #include <util/tracy.h>
@@ -30,105 +32,22 @@
 // keywords.h must be after tracy.h for msvc compiler
 #include <util/keywords.h>
 
+#include <algorithm>
+#include <vector>
+
 extern "C" {
 #include <libswscale/swscale.h>
 }
 
 namespace renderer {
 
-template <typename T, SceGxmTransferColorKeyMode mode, SceGxmTransferType src_type, SceGxmTransferType dst_type>
-static void perform_transfer_copy_impl(MemState &mem, const SceGxmTransferImage &src, const SceGxmTransferImage &dst, uint32_t key_value, uint32_t key_mask) {
-    T *__restrict__ src_ptr = src.address.cast<T>().get(mem);
-    T *__restrict__ dst_ptr = dst.address.cast<T>().get(mem);
-
-    auto compute_offset = [&](uint32_t dx, uint32_t dy, const SceGxmTransferImage &img, SceGxmTransferType type) -> int32_t {
-        const int32_t stride_pixel = img.stride / sizeof(T);
-        if (type == SCE_GXM_TRANSFER_LINEAR) {
-            return dy * stride_pixel + dx;
-        } else if (type == SCE_GXM_TRANSFER_TILED) {
-            // tiles are 32x32, you have the offset within the tile then the offset of the tile
-            const uint32_t texel_offset_in_tile = ((dy % 32) * 32) + (dx % 32);
-            const int32_t tile_address = (stride_pixel / 32) * (dy / 32) + (dx / 32);
-
-            return tile_address * 1024 + texel_offset_in_tile;
-        } else {
-            return texture::encode_morton(dx, dy, img.width, img.height);
-        }
-    };
-
-    for (uint32_t dx = 0; dx < src.width; dx++) {
-        for (uint32_t dy = 0; dy < src.height; dy++) {
-            // compute offset depending on the texture type used
-            // the function compute_offset gets inlined
-            uint32_t src_offset = compute_offset(src.x + dx, src.y + dy, src, src_type);
-            uint32_t dst_offset = compute_offset(dst.x + dx, dst.y + dy, dst, dst_type);
-
-            T value = src_ptr[src_offset];
-            if constexpr (mode == SCE_GXM_TRANSFER_COLORKEY_PASS) {
-                if ((value & key_mask) != key_value)
-                    continue;
-            } else if constexpr (mode == SCE_GXM_TRANSFER_COLORKEY_REJECT) {
-                if ((value & key_mask) == key_value)
-                    continue;
-            }
-
-            dst_ptr[dst_offset] = value;
-        }
-    }
-}
+// return the vulkan surface cache if transfers can interact with it
+static vulkan::VKSurfaceCache *get_transfer_surface_cache(State &renderer) {
+    // check_for_surface needs surface sync, the transfers done on the GPU work in any configuration
+    if (renderer.current_backend == Backend::Vulkan)
+        return &dynamic_cast<vulkan::VKState &>(renderer).surface_cache;
 
-template <typename T, SceGxmTransferColorKeyMode mode, SceGxmTransferType src_type>
-static void perform_transfer_copy_dst_type(MemState &mem, const SceGxmTransferImage &src, const SceGxmTransferImage &dst, SceGxmTransferType dst_type, uint32_t key_value, uint32_t key_mask) {
-    switch (dst_type) {
-    case SCE_GXM_TRANSFER_LINEAR:
-        perform_transfer_copy_impl<T, mode, src_type, SCE_GXM_TRANSFER_LINEAR>(mem, src, dst, key_value, key_mask);
-        break;
-    case SCE_GXM_TRANSFER_SWIZZLED:
-        perform_transfer_copy_impl<T, mode, src_type, SCE_GXM_TRANSFER_SWIZZLED>(mem, src, dst, key_value, key_mask);
-        break;
-    case SCE_GXM_TRANSFER_TILED:
-        perform_transfer_copy_impl<T, mode, src_type, SCE_GXM_TRANSFER_TILED>(mem, src, dst, key_value, key_mask);
-        break;
-    default:
-        LOG_ERROR("Unknown transfer key mode {}", fmt::underlying(mode));
-        break;
-    }
-}
-
-template <typename T, SceGxmTransferColorKeyMode mode>
-static void perform_transfer_copy_src_type(MemState &mem, const SceGxmTransferImage &src, const SceGxmTransferImage &dst, SceGxmTransferType src_type, SceGxmTransferType dst_type, uint32_t key_value, uint32_t key_mask) {
-    switch (src_type) {
-    case SCE_GXM_TRANSFER_LINEAR:
-        perform_transfer_copy_dst_type<T, mode, SCE_GXM_TRANSFER_LINEAR>(mem, src, dst, dst_type, key_value, key_mask);
-        break;
-    case SCE_GXM_TRANSFER_SWIZZLED:
-        perform_transfer_copy_dst_type<T, mode, SCE_GXM_TRANSFER_SWIZZLED>(mem, src, dst, dst_type, key_value, key_mask);
-        break;
-    case SCE_GXM_TRANSFER_TILED:
-        perform_transfer_copy_dst_type<T, mode, SCE_GXM_TRANSFER_TILED>(mem, src, dst, dst_type, key_value, key_mask);
-        break;
-    default:
-        LOG_ERROR("Unknown transfer key mode {}", fmt::underlying(mode));
-        break;
-    }
-}
-
-template <typename T>
-static void perform_transfer_copy_mode(MemState &mem, const SceGxmTransferImage &src, const SceGxmTransferImage &dst, SceGxmTransferType src_type, SceGxmTransferType dst_type, uint32_t key_value, uint32_t key_mask, SceGxmTransferColorKeyMode mode) {
-    switch (mode) {
-    case SCE_GXM_TRANSFER_COLORKEY_NONE:
-        perform_transfer_copy_src_type<T, SCE_GXM_TRANSFER_COLORKEY_NONE>(mem, src, dst, src_type, dst_type, key_value, key_mask);
-        break;
-    case SCE_GXM_TRANSFER_COLORKEY_PASS:
-        perform_transfer_copy_src_type<T, SCE_GXM_TRANSFER_COLORKEY_PASS>(mem, src, dst, src_type, dst_type, key_value, key_mask);
-        break;
-    case SCE_GXM_TRANSFER_COLORKEY_REJECT:
-        perform_transfer_copy_src_type<T, SCE_GXM_TRANSFER_COLORKEY_REJECT>(mem, src, dst, src_type, dst_type, key_value, key_mask);
-        break;
-    default:
-        LOG_ERROR("Unknown transfer key mode {}", fmt::underlying(mode));
-        break;
-    }
+    return nullptr;
 }
 
 COMMAND(handle_transfer_copy) {
@@ -156,50 +75,30 @@ COMMAND(handle_transfer_copy) {
         const SceGxmTransferImage &src = images[0];
         const SceGxmTransferImage &dst = images[1];
 
-        // Get bits per pixel of the image
-        const uint32_t bpp = gxm::get_bits_per_pixel(src.format);
-
-        // use a specialized function for each type (more optimized)
-        switch (bpp) {
-        case 1:
-            LOG_TRACE("Perform transfer copy with 1 color");
-            perform_transfer_copy_src_type<bool, SCE_GXM_TRANSFER_COLORKEY_NONE>(mem, src, dst, src_type, dst_type, colorKeyValue, colorKeyMask);
-            break;
-        case 2:
-        case 4:
-        case 8:
-            perform_transfer_copy_src_type<uint8_t, SCE_GXM_TRANSFER_COLORKEY_NONE>(mem, src, dst, src_type, dst_type, colorKeyValue, colorKeyMask);
-            break;
-        case 16:
-            perform_transfer_copy_src_type<uint16_t, SCE_GXM_TRANSFER_COLORKEY_NONE>(mem, src, dst, src_type, dst_type, colorKeyValue, colorKeyMask);
-            break;
-        case 24:
-            perform_transfer_copy_src_type<std::array<uint8_t, 3>, SCE_GXM_TRANSFER_COLORKEY_NONE>(mem, src, dst, src_type, dst_type, colorKeyValue, colorKeyMask);
-            break;
-        case 32:
-            perform_transfer_copy_mode<uint32_t>(mem, src, dst, src_type, dst_type, colorKeyValue, colorKeyMask, colorKeyMode);
-            break;
-        case 48:
-            perform_transfer_copy_src_type<std::array<uint16_t, 3>, SCE_GXM_TRANSFER_COLORKEY_NONE>(mem, src, dst, src_type, dst_type, colorKeyValue, colorKeyMask);
-            break;
-        case 64:
-            perform_transfer_copy_src_type<uint64_t, SCE_GXM_TRANSFER_COLORKEY_NONE>(mem, src, dst, src_type, dst_type, colorKeyValue, colorKeyMask);
-            break;
-        case 128:
-            perform_transfer_copy_src_type<std::array<uint64_t, 2>, SCE_GXM_TRANSFER_COLORKEY_NONE>(mem, src, dst, src_type, dst_type, colorKeyValue, colorKeyMask);
-            break;
-        }
+        copy_transfer_image(src.address.get(mem), dst.address.get(mem), src, dst, src_type, dst_type, colorKeyMode, colorKeyValue, colorKeyMask);
 
         delete[] images;
     };
 
-    if (renderer.current_backend == Backend::Vulkan && renderer.features.enable_memory_mapping && !renderer.disable_surface_sync) {
-        if (dynamic_cast<vulkan::VKState &>(renderer).surface_cache.check_for_surface(mem, images[0].address.address(), copy_operation, images[1].address.address()))
+    vulkan::VKSurfaceCache *surface_cache = get_transfer_surface_cache(renderer);
+    if (surface_cache) {
+        if (surface_cache->gpu_transfer_copy(images[0], images[1], src_type, dst_type, colorKeyMode)) {
+            // both images are surfaces, the copy was done on the GPU
+            delete[] images;
+            return;
+        }
+
+        if (surface_cache->check_for_surface(mem, images[0].address.address(), copy_operation, images[1].address.address()))
             // let the vulkan surface cache handle it
             return;
     }
 
+    // copy_operation frees images
+    const SceGxmTransferImage dst_image = images[1];
     copy_operation();
+
+    if (surface_cache)
+        surface_cache->upload_transfer_to_surface(mem, dst_image, dst_type);
 }
 
 COMMAND(handle_transfer_downscale) {
@@ -212,6 +111,14 @@ COMMAND(handle_transfer_downscale) {
         return;
     }
 
+    vulkan::VKSurfaceCache *surface_cache = get_transfer_surface_cache(renderer);
+    if (surface_cache && surface_cache->gpu_transfer_downscale(*src, *dst)) {
+        delete src;
+        delete dst;
+        return;
+    }
+    const SceGxmTransferImage dst_image = *dst;
+
     // adjust the x/y value
     const uint32_t pixel_bytes = gxm::get_bits_per_pixel(src->format) / 8;
     src->address = (src->address.cast<uint8_t>() + src->y * src->stride + src->x * pixel_bytes).cast<void>();
@@ -243,12 +150,11 @@ COMMAND(handle_transfer_downscale) {
 
         if (pixel_fmt != AV_PIX_FMT_NONE && src->stride > 0 && dst->stride > 0) {
             // use ffmpeg with the avg filter
-            SwsContext *ctx = sws_getContext(src->width, src->height, pixel_fmt, dst->width, dst->height, pixel_fmt, SWS_AREA, nullptr, nullptr, nullptr);
+            SwsContext *ctx = get_sws_context(src->width, src->height, pixel_fmt, dst->width, dst->height, pixel_fmt, SWS_AREA);
             if (ctx == nullptr) {
                 LOG_ERROR("Failed to get ffmpeg context for format {}", log_hex(fmt::underlying(src->format)));
             } else {
                 sws_scale(ctx, &src_ptr, &src->stride, 0, src->height, &dst_ptr, &dst->stride);
-                sws_freeContext(ctx);
             }
 
         } else {
@@ -259,9 +165,9 @@ COMMAND(handle_transfer_downscale) {
                 for (int y = 0; y < dst->height; y++) {
                     // stride is in bytes
                     T *src_line = reinterpret_cast<T *>(src_ptr + src->stride * y * 2);
-                    T *dst_line = reinterpret_cast<T *>(dst_ptr + dst->stride);
+                    T *dst_line = reinterpret_cast<T *>(dst_ptr + dst->stride * y);
                     for (int x = 0; x < dst->width; x++) {
-                        dst_ptr[x] = src_ptr[2 * x];
+                        dst_line[x] = src_line[2 * x];
                     }
                 }
             };
@@ -290,6 +196,7 @@ COMMAND(handle_transfer_downscale) {
             case 64:
                 LOG_TRACE("SW downscaling type is 64, slow!");
                 perform_downscale(uint64_t());
+                break;
             default:
                 // should not happen
                 LOG_ERROR("Unhandled format {}", log_hex(fmt::underlying(src->format)));
@@ -301,13 +208,14 @@ COMMAND(handle_transfer_downscale) {
         delete dst;
     };
 
-    if (renderer.current_backend == Backend::Vulkan && renderer.features.enable_memory_mapping && !renderer.disable_surface_sync) {
-        if (dynamic_cast<vulkan::VKState &>(renderer).surface_cache.check_for_surface(mem, src->address.address(), downscale_operation, dst->address.address()))
-            // let the vulkan surface cache handle it
-            return;
-    }
+    if (surface_cache && surface_cache->check_for_surface(mem, src->address.address(), downscale_operation, dst->address.address()))
+        // let the vulkan surface cache handle it
+        return;
 
     downscale_operation();
+
+    if (surface_cache)
+        surface_cache->upload_transfer_to_surface(mem, dst_image, SCE_GXM_TRANSFER_LINEAR);
 }
 
 COMMAND(handle_transfer_fill) {
@@ -318,20 +226,32 @@ COMMAND(handle_transfer_fill) {
     const auto bpp = gxm::get_bits_per_pixel(dest->format);
 
     const uint32_t bytes_per_pixel = (bpp + 7) >> 3;
-    for (uint32_t y = 0; y < dest->height; y++) {
-        for (uint32_t x = 0; x < dest->width; x++) {
-            // Set offset of destination
-            const auto dest_offset = ((x + dest->x) * bytes_per_pixel) + ((y + dest->y) * dest->stride);
-
-            // Set pointer of destination
-            auto dest_ptr = (uint8_t *)dest->address.get(mem) + dest_offset;
-
-            // Fill color in destination
-            memcpy(dest_ptr, &fill_color, bytes_per_pixel);
+    const uint32_t row_size = dest->width * bytes_per_pixel;
+    uint8_t *dest_ptr = dest->address.cast<uint8_t>().get(mem) + dest->x * bytes_per_pixel + dest->y * dest->stride;
+
+    if (bytes_per_pixel == 1) {
+        for (uint32_t y = 0; y < dest->height; y++)
+            memset(dest_ptr + y * dest->stride, static_cast<uint8_t>(fill_color), row_size);
+    } else if (row_size > 0) {
+        // build a single filled row by doubling the pattern, then copy it to each row
+        std::vector<uint8_t> row(row_size);
+        memcpy(row.data(), &fill_color, bytes_per_pixel);
+        uint32_t filled = bytes_per_pixel;
+        while (filled < row_size) {
+            const uint32_t to_copy = std::min(filled, row_size - filled);
+            memcpy(row.data() + filled, row.data(), to_copy);
+            filled += to_copy;
         }
+
+        for (uint32_t y = 0; y < dest->height; y++)
+            memcpy(dest_ptr + y * dest->stride, row.data(), row_size);
     }
 
-    // TODO: handle case where dest is a cached surface
+    // also fill the surface if the destination is a cached one
+    // the memory is still written so that it stays coherent with the GPU content
+    vulkan::VKSurfaceCache *surface_cache = get_transfer_surface_cache(renderer);
+    if (surface_cache && !surface_cache->gpu_transfer_fill(*dest, fill_color))
+        surface_cache->upload_transfer_to_surface(mem, *dest, SCE_GXM_TRANSFER_LINEAR);
 
     delete dest;
 }
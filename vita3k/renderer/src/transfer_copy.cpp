@@ -0,0 +1,400 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <gxm/functions.h>
+#include <renderer/functions.h>
+#include <renderer/transfer_copy.h>
+#include <util/keywords.h>
+#include <util/log.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace renderer {
+
+// The offset of a texel in a transfer image is separable for all 3 layouts:
+// offset(x, y) = column_offset(x) + row_offset(y)
+// This lets the copy walk the image row by row instead of recomputing the full address of each texel
+template <typename T, SceGxmTransferType type>
+static uint32_t column_offset(const SceGxmTransferImage &img, uint32_t x) {
+    if constexpr (type == SCE_GXM_TRANSFER_LINEAR) {
+        return x;
+    } else if constexpr (type == SCE_GXM_TRANSFER_TILED) {
+        // tiles are 32x32, you have the offset within the tile then the offset of the tile
+        return (x / 32) * 1024 + (x % 32);
+    } else {
+        // x and y bits are interleaved, so the morton code of (x, y) is the one of (x, 0) plus the one of (0, y)
+        return texture::encode_morton(x, 0, img.width, img.height);
+    }
+}
+
+template <typename T, SceGxmTransferType type>
+static int32_t row_offset(const SceGxmTransferImage &img, uint32_t y) {
+    const int32_t stride_pixel = img.stride / static_cast<int32_t>(sizeof(T));
+    if constexpr (type == SCE_GXM_TRANSFER_LINEAR) {
+        return static_cast<int32_t>(y) * stride_pixel;
+    } else if constexpr (type == SCE_GXM_TRANSFER_TILED) {
+        return (stride_pixel / 32) * static_cast<int32_t>(y / 32) * 1024 + static_cast<int32_t>((y % 32) * 32);
+    } else {
+        return texture::encode_morton(0, y, img.width, img.height);
+    }
+}
+
+// number of texels starting at column x that are contiguous in memory
+template <SceGxmTransferType type>
+static uint32_t contiguous_texels(uint32_t x) {
+    if constexpr (type == SCE_GXM_TRANSFER_LINEAR)
+        return std::numeric_limits<uint32_t>::max();
+    else if constexpr (type == SCE_GXM_TRANSFER_TILED)
+        return 32 - (x % 32);
+    else
+        return 1;
+}
+
+template <SceGxmTransferColorKeyMode mode>
+static void copy_span_color_key_u32(const uint32_t *__restrict__ src, uint32_t *__restrict__ dst, uint32_t count, uint32_t key_value, uint32_t key_mask) {
+    uint32_t i = 0;
+#if defined(__aarch64__)
+    const uint32x4_t key = vdupq_n_u32(key_value);
+    const uint32x4_t mask = vdupq_n_u32(key_mask);
+    for (; i + 4 <= count; i += 4) {
+        const uint32x4_t value = vld1q_u32(src + i);
+        uint32x4_t select = vceqq_u32(vandq_u32(value, mask), key);
+        if constexpr (mode == SCE_GXM_TRANSFER_COLORKEY_REJECT)
+            select = vmvnq_u32(select);
+        vst1q_u32(dst + i, vbslq_u32(select, value, vld1q_u32(dst + i)));
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    const __m128i key = _mm_set1_epi32(static_cast<int>(key_value));
+    const __m128i mask = _mm_set1_epi32(static_cast<int>(key_mask));
+    for (; i + 4 <= count; i += 4) {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i old_value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        const __m128i equal = _mm_cmpeq_epi32(_mm_and_si128(value, mask), key);
+        __m128i result;
+        if constexpr (mode == SCE_GXM_TRANSFER_COLORKEY_PASS)
+            result = _mm_or_si128(_mm_and_si128(equal, value), _mm_andnot_si128(equal, old_value));
+        else
+            result = _mm_or_si128(_mm_andnot_si128(equal, value), _mm_and_si128(equal, old_value));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), result);
+    }
+#endif
+    for (; i < count; i++) {
+        const uint32_t value = src[i];
+        if constexpr (mode == SCE_GXM_TRANSFER_COLORKEY_PASS) {
+            if ((value & key_mask) != key_value)
+                continue;
+        } else {
+            if ((value & key_mask) == key_value)
+                continue;
+        }
+        dst[i] = value;
+    }
+}
+
+// copy count contiguous texels
+template <typename T, SceGxmTransferColorKeyMode mode>
+static void copy_span(const T *src, T *dst, uint32_t count, uint32_t key_value, uint32_t key_mask) {
+    if constexpr (mode == SCE_GXM_TRANSFER_COLORKEY_NONE) {
+        // source and destination may be the same image
+        memmove(dst, src, count * sizeof(T));
+    } else if constexpr (std::is_same_v<T, uint32_t>) {
+        copy_span_color_key_u32<mode>(src, dst, count, key_value, key_mask);
+    } else {
+        for (uint32_t i = 0; i < count; i++) {
+            const T value = src[i];
+            if constexpr (mode == SCE_GXM_TRANSFER_COLORKEY_PASS) {
+                if ((value & key_mask) != key_value)
+                    continue;
+            } else {
+                if ((value & key_mask) == key_value)
+                    continue;
+            }
+            dst[i] = value;
+        }
+    }
+}
+
+// copy the width x height area starting at (dx, dy) of the transfer one texel at a time
+template <typename T, SceGxmTransferColorKeyMode mode, SceGxmTransferType src_type, SceGxmTransferType dst_type>
+static void copy_texels(const T *src_ptr, T *dst_ptr, const SceGxmTransferImage &src, const SceGxmTransferImage &dst, uint32_t dx, uint32_t dy, uint32_t width, uint32_t height, uint32_t key_value, uint32_t key_mask) {
+    for (uint32_t y = dy; y < dy + height; y++) {
+        const T *src_row = src_ptr + row_offset<T, src_type>(src, src.y + y);
+        T *dst_row = dst_ptr + row_offset<T, dst_type>(dst, dst.y + y);
+        for (uint32_t x = dx; x < dx + width; x++)
+            copy_span<T, mode>(src_row + column_offset<T, src_type>(src, src.x + x), dst_row + column_offset<T, dst_type>(dst, dst.x + x), 1, key_value, key_mask);
+    }
+}
+
+// Swizzled images are copied by aligned 8x8 tiles: as the morton code of (x, y) ends with the bits of x % 8 and y % 8,
+// the 64 texels of such a tile are contiguous in memory and always stored in the same order
+constexpr uint32_t SWIZZLE_TILE_SIZE = 8;
+
+struct SwizzleTileOrder {
+    // position in the tile of the i-th texel stored in memory
+    std::array<uint8_t, SWIZZLE_TILE_SIZE * SWIZZLE_TILE_SIZE> x{};
+    std::array<uint8_t, SWIZZLE_TILE_SIZE * SWIZZLE_TILE_SIZE> y{};
+};
+
+static constexpr SwizzleTileOrder make_swizzle_tile_order() {
+    // the bits of y are the even bits of the morton code and the bits of x the odd ones
+    SwizzleTileOrder order;
+    for (uint32_t i = 0; i < SWIZZLE_TILE_SIZE * SWIZZLE_TILE_SIZE; i++) {
+        order.x[i] = static_cast<uint8_t>(((i >> 1) & 1) | ((i >> 2) & 2) | ((i >> 3) & 4));
+        order.y[i] = static_cast<uint8_t>((i & 1) | ((i >> 1) & 2) | ((i >> 2) & 4));
+    }
+    return order;
+}
+
+static constexpr SwizzleTileOrder SWIZZLE_TILE_ORDER = make_swizzle_tile_order();
+
+// load count texels of the row y starting at column x of a linear or tiled image
+template <typename T, SceGxmTransferType type>
+static void load_row(const T *ptr, const SceGxmTransferImage &img, uint32_t x, uint32_t y, uint32_t count, T *out) {
+    const T *row = ptr + row_offset<T, type>(img, y);
+    uint32_t i = 0;
+    while (i < count) {
+        const uint32_t run = std::min(count - i, contiguous_texels<type>(x + i));
+        memcpy(out + i, row + column_offset<T, type>(img, x + i), run * sizeof(T));
+        i += run;
+    }
+}
+
+// store count texels to the row y starting at column x of a linear or tiled image
+template <typename T, SceGxmTransferColorKeyMode mode, SceGxmTransferType type>
+static void store_row(const T *in, T *ptr, const SceGxmTransferImage &img, uint32_t x, uint32_t y, uint32_t count, uint32_t key_value, uint32_t key_mask) {
+    T *row = ptr + row_offset<T, type>(img, y);
+    uint32_t i = 0;
+    while (i < count) {
+        const uint32_t run = std::min(count - i, contiguous_texels<type>(x + i));
+        copy_span<T, mode>(in + i, row + column_offset<T, type>(img, x + i), run, key_value, key_mask);
+        i += run;
+    }
+}
+
+// copy the tile starting at (dx, dy) of the transfer, it is aligned in the swizzled images
+template <typename T, SceGxmTransferColorKeyMode mode, SceGxmTransferType src_type, SceGxmTransferType dst_type>
+static void copy_swizzle_tile(const T *src_ptr, T *dst_ptr, const SceGxmTransferImage &src, const SceGxmTransferImage &dst, uint32_t dx, uint32_t dy, uint32_t key_value, uint32_t key_mask) {
+    constexpr uint32_t tile_texels = SWIZZLE_TILE_SIZE * SWIZZLE_TILE_SIZE;
+
+    if constexpr (src_type == SCE_GXM_TRANSFER_SWIZZLED && dst_type == SCE_GXM_TRANSFER_SWIZZLED) {
+        // both tiles are stored the same way
+        const T *src_tile = src_ptr + column_offset<T, src_type>(src, src.x + dx) + row_offset<T, src_type>(src, src.y + dy);
+        T *dst_tile = dst_ptr + column_offset<T, dst_type>(dst, dst.x + dx) + row_offset<T, dst_type>(dst, dst.y + dy);
+        copy_span<T, mode>(src_tile, dst_tile, tile_texels, key_value, key_mask);
+    } else if constexpr (dst_type == SCE_GXM_TRANSFER_SWIZZLED) {
+        // read the source rows, reorder them then write the whole tile at once
+        T rows[SWIZZLE_TILE_SIZE][SWIZZLE_TILE_SIZE];
+        for (uint32_t y = 0; y < SWIZZLE_TILE_SIZE; y++)
+            load_row<T, src_type>(src_ptr, src, src.x + dx, src.y + dy + y, SWIZZLE_TILE_SIZE, rows[y]);
+
+        T tile[tile_texels];
+        for (uint32_t i = 0; i < tile_texels; i++)
+            tile[i] = rows[SWIZZLE_TILE_ORDER.y[i]][SWIZZLE_TILE_ORDER.x[i]];
+
+        T *dst_tile = dst_ptr + column_offset<T, dst_type>(dst, dst.x + dx) + row_offset<T, dst_type>(dst, dst.y + dy);
+        copy_span<T, mode>(tile, dst_tile, tile_texels, key_value, key_mask);
+    } else {
+        // read the whole tile at once, reorder it then write the destination rows
+        const T *src_tile = src_ptr + column_offset<T, src_type>(src, src.x + dx) + row_offset<T, src_type>(src, src.y + dy);
+        T rows[SWIZZLE_TILE_SIZE][SWIZZLE_TILE_SIZE];
+        for (uint32_t i = 0; i < tile_texels; i++)
+            rows[SWIZZLE_TILE_ORDER.y[i]][SWIZZLE_TILE_ORDER.x[i]] = src_tile[i];
+
+        for (uint32_t y = 0; y < SWIZZLE_TILE_SIZE; y++)
+            store_row<T, mode, dst_type>(rows[y], dst_ptr, dst, dst.x + dx, dst.y + dy + y, SWIZZLE_TILE_SIZE, key_value, key_mask);
+    }
+}
+
+template <typename T, SceGxmTransferColorKeyMode mode, SceGxmTransferType src_type, SceGxmTransferType dst_type>
+static void copy_swizzled(const T *src_ptr, T *dst_ptr, const SceGxmTransferImage &src, const SceGxmTransferImage &dst, uint32_t key_value, uint32_t key_mask) {
+    const uint32_t width = src.width;
+    const uint32_t height = src.height;
+
+    // the tiles are aligned in the swizzled destination if there is one, writing whole tiles matters more than reading them
+    const SceGxmTransferImage &swizzled = (dst_type == SCE_GXM_TRANSFER_SWIZZLED) ? dst : src;
+
+    // the tiles must fit in the square blocks of the morton order and be aligned in both images when both are swizzled
+    bool use_tiles = std::min(swizzled.width, swizzled.height) >= SWIZZLE_TILE_SIZE;
+    if constexpr (src_type == SCE_GXM_TRANSFER_SWIZZLED && dst_type == SCE_GXM_TRANSFER_SWIZZLED) {
+        use_tiles &= std::min(src.width, src.height) >= SWIZZLE_TILE_SIZE;
+        use_tiles &= (src.x % SWIZZLE_TILE_SIZE) == (dst.x % SWIZZLE_TILE_SIZE) && (src.y % SWIZZLE_TILE_SIZE) == (dst.y % SWIZZLE_TILE_SIZE);
+    }
+
+    // area of the transfer covered by whole tiles
+    const uint32_t tiles_x_start = std::min(width, (SWIZZLE_TILE_SIZE - swizzled.x % SWIZZLE_TILE_SIZE) % SWIZZLE_TILE_SIZE);
+    const uint32_t tiles_y_start = std::min(height, (SWIZZLE_TILE_SIZE - swizzled.y % SWIZZLE_TILE_SIZE) % SWIZZLE_TILE_SIZE);
+    const uint32_t tiles_x_end = tiles_x_start + (width - tiles_x_start) / SWIZZLE_TILE_SIZE * SWIZZLE_TILE_SIZE;
+    const uint32_t tiles_y_end = tiles_y_start + (height - tiles_y_start) / SWIZZLE_TILE_SIZE * SWIZZLE_TILE_SIZE;
+
+    if (!use_tiles || tiles_x_start == tiles_x_end || tiles_y_start == tiles_y_end) {
+        copy_texels<T, mode, src_type, dst_type>(src_ptr, dst_ptr, src, dst, 0, 0, width, height, key_value, key_mask);
+        return;
+    }
+
+    for (uint32_t dy = tiles_y_start; dy < tiles_y_end; dy += SWIZZLE_TILE_SIZE) {
+        for (uint32_t dx = tiles_x_start; dx < tiles_x_end; dx += SWIZZLE_TILE_SIZE)
+            copy_swizzle_tile<T, mode, src_type, dst_type>(src_ptr, dst_ptr, src, dst, dx, dy, key_value, key_mask);
+    }
+
+    // the borders that are not made of whole tiles
+    copy_texels<T, mode, src_type, dst_type>(src_ptr, dst_ptr, src, dst, 0, 0, width, tiles_y_start, key_value, key_mask);
+    copy_texels<T, mode, src_type, dst_type>(src_ptr, dst_ptr, src, dst, 0, tiles_y_end, width, height - tiles_y_end, key_value, key_mask);
+    copy_texels<T, mode, src_type, dst_type>(src_ptr, dst_ptr, src, dst, 0, tiles_y_start, tiles_x_start, tiles_y_end - tiles_y_start, key_value, key_mask);
+    copy_texels<T, mode, src_type, dst_type>(src_ptr, dst_ptr, src, dst, tiles_x_end, tiles_y_start, width - tiles_x_end, tiles_y_end - tiles_y_start, key_value, key_mask);
+}
+
+template <typename T, SceGxmTransferColorKeyMode mode, SceGxmTransferType src_type, SceGxmTransferType dst_type>
+static void perform_transfer_copy_impl(const void *src_data, void *dst_data, const SceGxmTransferImage &src, const SceGxmTransferImage &dst, bool per_texel, uint32_t key_value, uint32_t key_mask) {
+    const T *src_ptr = static_cast<const T *>(src_data);
+    T *dst_ptr = static_cast<T *>(dst_data);
+
+    const uint32_t width = src.width;
+    const uint32_t height = src.height;
+
+    if (per_texel) {
+        copy_texels<T, mode, src_type, dst_type>(src_ptr, dst_ptr, src, dst, 0, 0, width, height, key_value, key_mask);
+    } else if constexpr (src_type == SCE_GXM_TRANSFER_SWIZZLED || dst_type == SCE_GXM_TRANSFER_SWIZZLED) {
+        copy_swizzled<T, mode, src_type, dst_type>(src_ptr, dst_ptr, src, dst, key_value, key_mask);
+    } else {
+        // linear rows are contiguous and tiled rows are made of 32-texel runs,
+        // copy the longest run that is contiguous on both sides at once
+        for (uint32_t dy = 0; dy < height; dy++) {
+            const T *src_row = src_ptr + row_offset<T, src_type>(src, src.y + dy);
+            T *dst_row = dst_ptr + row_offset<T, dst_type>(dst, dst.y + dy);
+
+            uint32_t dx = 0;
+            while (dx < width) {
+                const uint32_t src_x = src.x + dx;
+                const uint32_t dst_x = dst.x + dx;
+                const uint32_t run = std::min({ width - dx, contiguous_texels<src_type>(src_x), contiguous_texels<dst_type>(dst_x) });
+                copy_span<T, mode>(src_row + column_offset<T, src_type>(src, src_x), dst_row + column_offset<T, dst_type>(dst, dst_x), run, key_value, key_mask);
+                dx += run;
+            }
+        }
+    }
+}
+
+template <typename T, SceGxmTransferColorKeyMode mode, SceGxmTransferType src_type>
+static void perform_transfer_copy_dst_type(const void *src_data, void *dst_data, const SceGxmTransferImage &src, const SceGxmTransferImage &dst, SceGxmTransferType dst_type, bool per_texel, uint32_t key_value, uint32_t key_mask) {
+    switch (dst_type) {
+    case SCE_GXM_TRANSFER_LINEAR:
+        perform_transfer_copy_impl<T, mode, src_type, SCE_GXM_TRANSFER_LINEAR>(src_data, dst_data, src, dst, per_texel, key_value, key_mask);
+        break;
+    case SCE_GXM_TRANSFER_SWIZZLED:
+        perform_transfer_copy_impl<T, mode, src_type, SCE_GXM_TRANSFER_SWIZZLED>(src_data, dst_data, src, dst, per_texel, key_value, key_mask);
+        break;
+    case SCE_GXM_TRANSFER_TILED:
+        perform_transfer_copy_impl<T, mode, src_type, SCE_GXM_TRANSFER_TILED>(src_data, dst_data, src, dst, per_texel, key_value, key_mask);
+        break;
+    default:
+        LOG_ERROR("Unknown transfer key mode {}", fmt::underlying(mode));
+        break;
+    }
+}
+
+template <typename T, SceGxmTransferColorKeyMode mode>
+static void perform_transfer_copy_src_type(const void *src_data, void *dst_data, const SceGxmTransferImage &src, const SceGxmTransferImage &dst, SceGxmTransferType src_type, SceGxmTransferType dst_type, bool per_texel, uint32_t key_value, uint32_t key_mask) {
+    switch (src_type) {
+    case SCE_GXM_TRANSFER_LINEAR:
+        perform_transfer_copy_dst_type<T, mode, SCE_GXM_TRANSFER_LINEAR>(src_data, dst_data, src, dst, dst_type, per_texel, key_value, key_mask);
+        break;
+    case SCE_GXM_TRANSFER_SWIZZLED:
+        perform_transfer_copy_dst_type<T, mode, SCE_GXM_TRANSFER_SWIZZLED>(src_data, dst_data, src, dst, dst_type, per_texel, key_value, key_mask);
+        break;
+    case SCE_GXM_TRANSFER_TILED:
+        perform_transfer_copy_dst_type<T, mode, SCE_GXM_TRANSFER_TILED>(src_data, dst_data, src, dst, dst_type, per_texel, key_value, key_mask);
+        break;
+    default:
+        LOG_ERROR("Unknown transfer key mode {}", fmt::underlying(mode));
+        break;
+    }
+}
+
+template <typename T>
+static void perform_transfer_copy_mode(const void *src_data, void *dst_data, const SceGxmTransferImage &src, const SceGxmTransferImage &dst, SceGxmTransferType src_type, SceGxmTransferType dst_type, bool per_texel, uint32_t key_value, uint32_t key_mask, SceGxmTransferColorKeyMode mode) {
+    switch (mode) {
+    case SCE_GXM_TRANSFER_COLORKEY_NONE:
+        perform_transfer_copy_src_type<T, SCE_GXM_TRANSFER_COLORKEY_NONE>(src_data, dst_data, src, dst, src_type, dst_type, per_texel, key_value, key_mask);
+        break;
+    case SCE_GXM_TRANSFER_COLORKEY_PASS:
+        perform_transfer_copy_src_type<T, SCE_GXM_TRANSFER_COLORKEY_PASS>(src_data, dst_data, src, dst, src_type, dst_type, per_texel, key_value, key_mask);
+        break;
+    case SCE_GXM_TRANSFER_COLORKEY_REJECT:
+        perform_transfer_copy_src_type<T, SCE_GXM_TRANSFER_COLORKEY_REJECT>(src_data, dst_data, src, dst, src_type, dst_type, per_texel, key_value, key_mask);
+        break;
+    default:
+        LOG_ERROR("Unknown transfer key mode {}", fmt::underlying(mode));
+        break;
+    }
+}
+
+static void perform_transfer_copy(const void *src_data, void *dst_data, const SceGxmTransferImage &src, const SceGxmTransferImage &dst, SceGxmTransferType src_type, SceGxmTransferType dst_type, bool per_texel, SceGxmTransferColorKeyMode key_mode, uint32_t key_value, uint32_t key_mask) {
+    // Get bits per pixel of the image
+    const uint32_t bpp = gxm::get_bits_per_pixel(src.format);
+
+    // use a specialized function for each type (more optimized)
+    switch (bpp) {
+    case 1:
+        LOG_TRACE("Perform transfer copy with 1 color");
+        perform_transfer_copy_src_type<bool, SCE_GXM_TRANSFER_COLORKEY_NONE>(src_data, dst_data, src, dst, src_type, dst_type, per_texel, key_value, key_mask);
+        break;
+    case 2:
+    case 4:
+    case 8:
+        perform_transfer_copy_src_type<uint8_t, SCE_GXM_TRANSFER_COLORKEY_NONE>(src_data, dst_data, src, dst, src_type, dst_type, per_texel, key_value, key_mask);
+        break;
+    case 16:
+        perform_transfer_copy_src_type<uint16_t, SCE_GXM_TRANSFER_COLORKEY_NONE>(src_data, dst_data, src, dst, src_type, dst_type, per_texel, key_value, key_mask);
+        break;
+    case 24:
+        perform_transfer_copy_src_type<std::array<uint8_t, 3>, SCE_GXM_TRANSFER_COLORKEY_NONE>(src_data, dst_data, src, dst, src_type, dst_type, per_texel, key_value, key_mask);
+        break;
+    case 32:
+        perform_transfer_copy_mode<uint32_t>(src_data, dst_data, src, dst, src_type, dst_type, per_texel, key_value, key_mask, key_mode);
+        break;
+    case 48:
+        perform_transfer_copy_src_type<std::array<uint16_t, 3>, SCE_GXM_TRANSFER_COLORKEY_NONE>(src_data, dst_data, src, dst, src_type, dst_type, per_texel, key_value, key_mask);
+        break;
+    case 64:
+        perform_transfer_copy_src_type<uint64_t, SCE_GXM_TRANSFER_COLORKEY_NONE>(src_data, dst_data, src, dst, src_type, dst_type, per_texel, key_value, key_mask);
+        break;
+    case 128:
+        perform_transfer_copy_src_type<std::array<uint64_t, 2>, SCE_GXM_TRANSFER_COLORKEY_NONE>(src_data, dst_data, src, dst, src_type, dst_type, per_texel, key_value, key_mask);
+        break;
+    }
+}
+
+void copy_transfer_image(const void *src_data, void *dst_data, const SceGxmTransferImage &src, const SceGxmTransferImage &dst,
+    SceGxmTransferType src_type, SceGxmTransferType dst_type, SceGxmTransferColorKeyMode key_mode, uint32_t key_value, uint32_t key_mask) {
+    perform_transfer_copy(src_data, dst_data, src, dst, src_type, dst_type, false, key_mode, key_value, key_mask);
+}
+
+void copy_transfer_image_texels(const void *src_data, void *dst_data, const SceGxmTransferImage &src, const SceGxmTransferImage &dst,
+    SceGxmTransferType src_type, SceGxmTransferType dst_type, SceGxmTransferColorKeyMode key_mode, uint32_t key_value, uint32_t key_mask) {
+    perform_transfer_copy(src_data, dst_data, src, dst, src_type, dst_type, true, key_mode, key_value, key_mask);
+}
+
+} // namespace renderer
@@ -158,6 +158,18 @@ void set_context(VKContext &context, MemState &mem, VKRenderTarget *rt, const Fe
     VKState &state = context.state;
     state.surface_cache.set_render_target(rt);
 
+    // only the surfaces being presented are rendered at the dynamic resolution scale
+    const float render_scale = state.surface_cache.get_render_scale(color_surface_fin);
+    if (render_scale != context.render_scale) {
+        const float ratio = render_scale / context.render_scale;
+        context.viewport.x *= ratio;
+        context.viewport.y *= ratio;
+        context.viewport.width *= ratio;
+        context.viewport.height *= ratio;
+        context.render_scale = render_scale;
+        sync_clipping(context);
+    }
+
     context.start_recording(true);
 
     bool force_load = context.record.depth_stencil_surface.force_load;
@@ -251,6 +263,16 @@ void VKContext::start_recording(bool first_in_scene) {
     render_cmd.begin(begin_info);
     prerender_cmd.begin(begin_info);
 
+    // timestamps at the beginning and end of the recording, to measure the GPU time of the frame
+    FrameObject &frame = state.frame();
+    if (frame.timestamp_pool) {
+        if (frame.timestamps_used + 2 <= MAX_TIMESTAMPS_PER_FRAME) {
+            prerender_cmd.resetQueryPool(frame.timestamp_pool, frame.timestamps_used, 2);
+            prerender_cmd.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, frame.timestamp_pool, frame.timestamps_used);
+        }
+        frame.timestamps_used += 2;
+    }
+
     is_recording = true;
 
     // set all the dynamic state here
@@ -444,6 +466,10 @@ void VKContext::stop_recording(const SceGxmNotification &notif1, const SceGxmNot
     if (state.features.enable_memory_mapping && !state.disable_surface_sync && submit)
         surface_info = state.surface_cache.perform_surface_sync();
 
+    FrameObject &frame = state.frame();
+    if (frame.timestamp_pool && frame.timestamps_used <= MAX_TIMESTAMPS_PER_FRAME)
+        render_cmd.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, frame.timestamp_pool, frame.timestamps_used - 1);
+
     prerender_cmd.end();
     render_cmd.end();
 
@@ -493,6 +519,14 @@ void VKContext::stop_recording(const SceGxmNotification &notif1, const SceGxmNot
             state.request_queue.push(PostSurfaceSyncRequest{ surface_info });
         }
 
+        // the destinations of the transfers done on the GPU in this command buffer
+        for (ColorSurfaceCacheInfo *transfer_info : state.surface_cache.take_transfer_synced_surfaces()) {
+            if (state.mapping_method == MappingMethod::DoubleBuffer && transfer_info->need_buffer_sync)
+                state.request_queue.push(BufferSyncRequest{ transfer_info->data.address(), static_cast<uint32_t>(transfer_info->total_bytes) });
+            if (transfer_info->need_post_surface_sync)
+                state.request_queue.push(PostSurfaceSyncRequest{ transfer_info });
+        }
+
         if(notif1.address || notif2.address){
             // notifications last
             NotificationRequest request = {
@@ -539,6 +573,36 @@ void VKContext::check_for_macroblock_change(bool is_draw) {
     }
 }
 
+// feed the GPU time of the frame to the dynamic resolution and get the scale of the next frames
+static void update_render_scale(VKState &state, FrameObject &frame) {
+    const uint32_t timestamp_count = frame.timestamps_used;
+    frame.timestamps_used = 0;
+
+    // surfaces read back by surface sync are kept at full resolution by get_render_scale
+    if (!state.enable_dynamic_resolution) {
+        state.render_scale = 1.0f;
+        return;
+    }
+
+    // the frame used more scenes than it has queries for, its timing is incomplete
+    if (timestamp_count == 0 || timestamp_count > MAX_TIMESTAMPS_PER_FRAME)
+        return;
+
+    std::array<uint64_t, MAX_TIMESTAMPS_PER_FRAME> timestamps;
+    const vk::Result result = state.device.getQueryPoolResults(frame.timestamp_pool, 0, timestamp_count, timestamp_count * sizeof(uint64_t),
+        timestamps.data(), sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+    if (result != vk::Result::eSuccess)
+        return;
+
+    const uint64_t mask = state.timestamp_valid_bits >= 64 ? ~0ULL : (1ULL << state.timestamp_valid_bits) - 1;
+    uint64_t ticks = 0;
+    for (uint32_t i = 0; i < timestamp_count; i += 2)
+        ticks += (timestamps[i + 1] - timestamps[i]) & mask;
+
+    const double gpu_time_ns = static_cast<double>(ticks) * state.physical_device_properties.limits.timestampPeriod;
+    state.render_scale = state.dynamic_resolution.add_frame(std::chrono::microseconds(static_cast<int64_t>(gpu_time_ns / 1000.0)));
+}
+
 void new_frame(VKContext &context) {
     if (context.state.features.enable_memory_mapping) {
         FrameDoneRequest request = { context.frame_timestamp };
@@ -581,6 +645,9 @@ void new_frame(VKContext &context) {
         frame.rendered_fences.clear();
     }
 
+    if (frame.timestamp_pool)
+        update_render_scale(context.state, frame);
+
     device.resetCommandPool(frame.prerender_pool);
     device.resetCommandPool(frame.render_pool);
 
@@ -594,6 +661,8 @@ void new_frame(VKContext &context) {
     // deferred destruction of the objects
     frame.destroy_queue.destroy_objects();
 
+    context.state.memory_manager.new_frame(context.frame_timestamp);
+
     context.last_vert_texture_count = ~0;
     context.last_frag_texture_count = ~0;
 
@@ -0,0 +1,255 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#include <renderer/vulkan/memory_manager.h>
+
+#include <renderer/vulkan/state.h>
+
+#include <util/log.h>
+#include <vkutil/vkutil.h>
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace renderer::vulkan {
+
+// Frames between two checks of the budget
+constexpr uint64_t BUDGET_CHECK_INTERVAL = 30;
+// Frames between two attempts at defragmenting the textures, the GPU is stalled while it is done
+constexpr uint64_t DEFRAGMENTATION_INTERVAL = 1800;
+// Limits of one defragmentation pass, a pass is done with one copy command
+constexpr VkDeviceSize DEFRAGMENTATION_MAX_BYTES_PER_PASS = 64 * 1024 * 1024;
+constexpr uint32_t DEFRAGMENTATION_MAX_MOVES_PER_PASS = 128;
+constexpr int DEFRAGMENTATION_MAX_PASSES = 8;
+
+static constexpr uint64_t to_mib(uint64_t bytes) {
+    return bytes / (1024 * 1024);
+}
+
+MemoryManager::MemoryManager(VKState &state)
+    : state(state) {
+    // textures can be uploaded again from the guest memory, they go first
+    budget.add_evictor([this](uint64_t bytes) { return this->state.texture_cache.evict_textures(bytes); });
+    budget.add_evictor([this](uint64_t bytes) { return this->state.surface_cache.evict_surfaces(bytes); });
+}
+
+void MemoryManager::get_device_usage(uint64_t &usage, uint64_t &total_budget) {
+    usage = 0;
+    total_budget = 0;
+
+    // without VK_EXT_memory_budget, vma estimates them from its own allocations and the heap sizes
+    std::vector<vma::Budget> budgets(state.physical_device_memory.memoryHeapCount);
+    state.allocator.getHeapBudgets(budgets.data());
+    for (uint32_t heap = 0; heap < state.physical_device_memory.memoryHeapCount; heap++) {
+        if (!(state.physical_device_memory.memoryHeaps[heap].flags & vk::MemoryHeapFlagBits::eDeviceLocal))
+            continue;
+
+        usage += budgets[heap].usage;
+        total_budget += budgets[heap].budget;
+    }
+}
+
+void MemoryManager::new_frame(uint64_t frame_timestamp) {
+    if (frame_timestamp % BUDGET_CHECK_INTERVAL != 0)
+        return;
+
+    uint64_t usage, total_budget;
+    get_device_usage(usage, total_budget);
+
+    const uint64_t evicted = budget.enforce(usage, total_budget);
+    if (evicted > 0)
+        LOG_INFO("GPU memory usage ({} MiB) is close to the budget ({} MiB), evicted {} MiB from the caches", to_mib(usage), to_mib(total_budget), to_mib(evicted));
+
+    const bool defragmented = (frame_timestamp % DEFRAGMENTATION_INTERVAL == 0) && defragment_textures();
+
+    const std::lock_guard<std::mutex> lock(stats_mutex);
+    stats.texture_cache = vkutil::get_allocated_memory(vkutil::MemoryCategory::TextureCache);
+    stats.surface_cache = vkutil::get_allocated_memory(vkutil::MemoryCategory::SurfaceCache);
+    stats.ring_buffers = vkutil::get_allocated_memory(vkutil::MemoryCategory::RingBuffer);
+    stats.other = vkutil::get_allocated_memory(vkutil::MemoryCategory::Other);
+    stats.usage = usage;
+    stats.budget = total_budget;
+    stats.evicted_bytes += evicted;
+    if (defragmented)
+        stats.defragmentations++;
+}
+
+GpuMemoryStats MemoryManager::get_stats() {
+    const std::lock_guard<std::mutex> lock(stats_mutex);
+    return stats;
+}
+
+bool MemoryManager::defragment_textures() {
+    const VmaAllocator allocator = static_cast<VmaAllocator>(state.allocator);
+
+    // only the textures in the cache are moved, the other allocations may be used without going through their vkutil::Image
+    std::unordered_map<VmaAllocation, TextureCacheEntry *> texture_allocations;
+    // memory blocks holding these textures, for each memory type
+    std::map<uint32_t, std::unordered_set<VkDeviceMemory>> texture_blocks;
+    for (auto &entry : state.texture_cache.textures) {
+        if (entry.texture.image && entry.texture.layout == vkutil::ImageLayout::SampledImage) {
+            const VmaAllocation allocation = static_cast<VmaAllocation>(entry.texture.allocation);
+            texture_allocations[allocation] = &entry;
+
+            VmaAllocationInfo allocation_info;
+            vmaGetAllocationInfo(allocator, allocation, &allocation_info);
+            texture_blocks[allocation_info.memoryType].insert(allocation_info.deviceMemory);
+        }
+    }
+    if (texture_allocations.empty())
+        return false;
+
+    // the memory used by the other allocations is not looked at, nothing would be moved there
+    VmaTotalStatistics total_stats;
+    vmaCalculateStatistics(allocator, &total_stats);
+    std::vector<TextureMemoryUsage> memory_types;
+    for (const auto &[memory_type, blocks] : texture_blocks) {
+        const VmaStatistics &type_stats = total_stats.memoryType[memory_type].statistics;
+        memory_types.push_back({
+            .block_bytes = type_stats.blockBytes,
+            .allocation_bytes = type_stats.allocationBytes,
+            .texture_blocks = static_cast<uint32_t>(blocks.size()),
+        });
+    }
+    // the whole GPU is stalled below, only go on if some blocks can actually be released
+    if (!should_defragment_textures(memory_types))
+        return false;
+
+    // the textures being moved must not be in use
+    state.device.waitIdle();
+
+    const VmaDefragmentationInfo defrag_info{
+        .flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_FAST_BIT,
+        .maxBytesPerPass = DEFRAGMENTATION_MAX_BYTES_PER_PASS,
+        .maxAllocationsPerPass = DEFRAGMENTATION_MAX_MOVES_PER_PASS,
+    };
+    VmaDefragmentationContext defrag_context;
+    if (vmaBeginDefragmentation(allocator, &defrag_info, &defrag_context) != VK_SUCCESS)
+        return false;
+
+    for (int pass = 0; pass < DEFRAGMENTATION_MAX_PASSES; pass++) {
+        VmaDefragmentationPassMoveInfo pass_info;
+        if (vmaBeginDefragmentationPass(allocator, defrag_context, &pass_info) == VK_SUCCESS)
+            // nothing left to move
+            break;
+
+        vk::CommandBuffer cmd_buffer = vkutil::create_single_time_command(state.device, state.general_command_pool);
+        std::vector<std::pair<TextureCacheEntry *, vk::Image>> moved;
+        for (uint32_t i = 0; i < pass_info.moveCount; i++) {
+            VmaDefragmentationMove &move = pass_info.pMoves[i];
+            auto it = texture_allocations.find(move.srcAllocation);
+            if (it == texture_allocations.end()) {
+                move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+                continue;
+            }
+
+            TextureCacheEntry &entry = *it->second;
+            vkutil::Image &texture = entry.texture;
+            const uint32_t layer_count = entry.is_cube ? 6U : 1U;
+
+            vk::ImageCreateInfo image_info{
+                .flags = entry.is_cube ? vk::ImageCreateFlagBits::eCubeCompatible : vk::ImageCreateFlags(),
+                .imageType = vk::ImageType::e2D,
+                .format = texture.format,
+                .extent = vk::Extent3D{
+                    .width = texture.width,
+                    .height = texture.height,
+                    .depth = 1 },
+                .mipLevels = entry.mip_count,
+                .arrayLayers = layer_count,
+                .samples = vk::SampleCountFlagBits::e1,
+                .tiling = vk::ImageTiling::eOptimal,
+                .usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc,
+                .sharingMode = vk::SharingMode::eExclusive,
+                .initialLayout = vk::ImageLayout::eUndefined,
+            };
+            vk::Image new_image = state.device.createImage(image_info);
+            vmaBindImageMemory(allocator, move.dstTmpAllocation, static_cast<VkImage>(new_image));
+
+            const vk::ImageSubresourceRange range{
+                .aspectMask = vk::ImageAspectFlagBits::eColor,
+                .baseMipLevel = 0,
+                .levelCount = entry.mip_count,
+                .baseArrayLayer = 0,
+                .layerCount = layer_count
+            };
+            vkutil::transition_image_layout(cmd_buffer, texture.image, vkutil::ImageLayout::SampledImage, vkutil::ImageLayout::TransferSrc, range);
+            vkutil::transition_image_layout_discard(cmd_buffer, new_image, vkutil::ImageLayout::Undefined, vkutil::ImageLayout::TransferDst, range);
+
+            std::vector<vk::ImageCopy> regions(entry.mip_count);
+            for (uint32_t mip = 0; mip < entry.mip_count; mip++) {
+                const vk::ImageSubresourceLayers layers{
+                    .aspectMask = vk::ImageAspectFlagBits::eColor,
+                    .mipLevel = mip,
+                    .baseArrayLayer = 0,
+                    .layerCount = layer_count
+                };
+                regions[mip] = vk::ImageCopy{
+                    .srcSubresource = layers,
+                    .dstSubresource = layers,
+                    .extent = vk::Extent3D{
+                        .width = std::max(texture.width >> mip, 1U),
+                        .height = std::max(texture.height >> mip, 1U),
+                        .depth = 1 }
+                };
+            }
+            cmd_buffer.copyImage(texture.image, vk::ImageLayout::eTransferSrcOptimal, new_image, vk::ImageLayout::eTransferDstOptimal, regions);
+            vkutil::transition_image_layout(cmd_buffer, new_image, vkutil::ImageLayout::TransferDst, vkutil::ImageLayout::SampledImage, range);
+
+            moved.emplace_back(&entry, new_image);
+        }
+        vkutil::end_single_time_command(state.device, state.general_queue, state.general_command_pool, cmd_buffer);
+
+        // the allocations now point to the new memory, make the textures use the images bound to it
+        for (auto &[entry, new_image] : moved) {
+            vkutil::Image &texture = entry->texture;
+            state.device.destroy(texture.view);
+            state.device.destroy(texture.image);
+            texture.image = new_image;
+
+            vk::ImageViewCreateInfo view_info{
+                .image = new_image,
+                .viewType = entry->is_cube ? vk::ImageViewType::eCube : vk::ImageViewType::e2D,
+                .format = texture.format,
+                .components = entry->swizzle,
+                .subresourceRange = {
+                    .aspectMask = vk::ImageAspectFlagBits::eColor,
+                    .baseMipLevel = 0,
+                    .levelCount = entry->mip_count,
+                    .baseArrayLayer = 0,
+                    .layerCount = entry->is_cube ? 6U : 1U }
+            };
+            texture.view = state.device.createImageView(view_info);
+        }
+
+        if (vmaEndDefragmentationPass(allocator, defrag_context, &pass_info) == VK_SUCCESS)
+            break;
+    }
+
+    VmaDefragmentationStats defrag_stats;
+    vmaEndDefragmentation(allocator, defrag_context, &defrag_stats);
+    if (defrag_stats.allocationsMoved == 0)
+        return false;
+
+    LOG_INFO("Defragmented the texture memory: {} textures moved, {} MiB of memory released", defrag_stats.allocationsMoved, to_mib(defrag_stats.bytesFreed));
+    return true;
+}
+
+} // namespace renderer::vulkan
@@ -230,6 +230,7 @@ static bool select_queues(VKState &vk_state,
             queue_infos.emplace_back(std::move(queue_create_info));
             vk_state.general_family_index = i;
             vk_state.transfer_family_index = i;
+            vk_state.timestamp_valid_bits = queue_family.timestampValidBits;
             found_graphics = true;
             found_transfer = true;
         }
@@ -287,6 +288,7 @@ VKState::VKState(int gpu_idx)
     , surface_cache(*this)
     , pipeline_cache(*this)
     , texture_cache(*this)
+    , memory_manager(*this)
     , screen_renderer(*this)
     , buffer_trapping(*this) {
 }
@@ -518,6 +520,7 @@ bool VKState::create(SDL_Window *window, std::unique_ptr<renderer::State> &state
     }
 
     bool support_dedicated_allocations = false;
+    bool support_memory_budget = false;
     // Create Device
     {
         std::vector<vk::DeviceQueueCreateInfo> queue_infos;
@@ -555,6 +558,8 @@ bool VKState::create(SDL_Window *window, std::unique_ptr<renderer::State> &state
             { VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME, &temp_bool },
             // can be used by vma to improve performance
             { VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME, &support_dedicated_allocations },
+            // used by vma to get the memory the driver lets us use, to evict the caches before running out of it
+            { VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, &support_memory_budget },
             // used to tell the driver this application is high priority
             { VK_EXT_GLOBAL_PRIORITY_EXTENSION_NAME, &support_global_priority },
             // can be used to specify which format will be used by mutable images
@@ -777,6 +782,9 @@ bool VKState::create(SDL_Window *window, std::unique_ptr<renderer::State> &state
         if (support_dedicated_allocations)
             allocator_info.flags |= vma::AllocatorCreateFlagBits::eKhrDedicatedAllocation;
 
+        if (support_memory_budget)
+            allocator_info.flags |= vma::AllocatorCreateFlagBits::eExtMemoryBudget;
+
         // if memory mapping is supported
         if (supported_mapping_methods_mask > 1)
             allocator_info.flags |= vma::AllocatorCreateFlagBits::eBufferDeviceAddress;
@@ -831,6 +839,14 @@ bool VKState::create(SDL_Window *window, std::unique_ptr<renderer::State> &state
         frame.prerender_pool = device.createCommandPool(pool_info);
 
         frame.destroy_queue.init(device);
+
+        if (timestamp_valid_bits) {
+            vk::QueryPoolCreateInfo query_pool_info{
+                .queryType = vk::QueryType::eTimestamp,
+                .queryCount = MAX_TIMESTAMPS_PER_FRAME
+            };
+            frame.timestamp_pool = device.createQueryPool(query_pool_info);
+        }
     }
 
     auto &config_vk_mapping = config.vk_mapping;
@@ -948,6 +964,8 @@ void VKState::render_frame(const SceFVector2 &viewport_pos, const SceFVector2 &v
     if (!screen_renderer.acquire_swapchain_image())
         return;
 
+    display.presented_frame = frame;
+
     // Check if the surface exists
     Viewport viewport;
     viewport.width = static_cast<uint32_t>(frame.image_size.x * res_multiplier);
@@ -1012,13 +1030,7 @@ void VKState::swap_window(SDL_Window *window) {
     }
 }
 
-std::vector<uint32_t> VKState::dump_frame(DisplayState &display, uint32_t &width, uint32_t &height) {
-    DisplayFrameInfo frame;
-    {
-        std::lock_guard<std::mutex> guard(display.display_info_mutex);
-        frame = display.next_rendered_frame;
-    }
-
+std::vector<uint32_t> VKState::dump_frame(const DisplayFrameInfo &frame, uint32_t &width, uint32_t &height) {
     width = static_cast<uint32_t>(frame.image_size.x * res_multiplier);
     height = static_cast<uint32_t>(frame.image_size.y * res_multiplier);
     return surface_cache.dump_frame(frame.base, width, height, frame.pitch);
@@ -1067,7 +1079,7 @@ bool VKState::map_memory(MemState &mem, Ptr<void> address, uint32_t size) {
     assert(features.enable_memory_mapping);
     // the address should be 4K aligned
     assert((address.address() & 4095) == 0);
-    constexpr vk::BufferUsageFlags mapped_memory_flags = vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress | vk::BufferUsageFlagBits::eTransferDst;
+    constexpr vk::BufferUsageFlags mapped_memory_flags = vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eTransferSrc;
 
     auto find_mem_type_with_flag = [&](const vk::MemoryPropertyFlags flags, uint32_t hardware_types) {
         while (hardware_types != 0) {
@@ -1455,6 +1467,25 @@ void VKState::set_turbo_mode(bool set) {
 #endif
 }
 
+void VKState::set_dynamic_resolution(bool enable, float min_scale, int target_fps) {
+    if (enable && !timestamp_valid_bits) {
+        LOG_WARN_ONCE("Dynamic resolution needs timestamp queries, which are not supported by this GPU");
+        enable = false;
+    }
+
+    if (enable && !enable_dynamic_resolution)
+        dynamic_resolution.reset();
+    enable_dynamic_resolution = enable;
+
+    dynamic_resolution.set_bounds(min_scale, 1.0f);
+    dynamic_resolution.set_target(std::chrono::microseconds(1'000'000 / std::max(target_fps, 1)));
+}
+
+bool VKState::get_gpu_memory_stats(GpuMemoryStats &stats) {
+    stats = memory_manager.get_stats();
+    return true;
+}
+
 BufferTrapping::BufferTrapping(VKState &state)
     : state(state) {}
 
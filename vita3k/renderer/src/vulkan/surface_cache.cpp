@@ -194,6 +194,8 @@ SurfaceRetrieveResult VKSurfaceCache::retrieve_color_surface_for_framebuffer(Mem
             constexpr uint64_t big_delay_between_frames = 60;
             state.pipeline_cache.can_use_deferred_compilation = context->frame_timestamp - info.last_frame_rendered < big_delay_between_frames;
             info.last_frame_rendered = context->frame_timestamp;
+            // the render pass may load the previous content, it must be at the scale of this pass
+            rescale_surface(context->prerender_cmd, info, context->render_scale);
 
             if (vk_format == info.texture.format) {
                 return { info.texture.view, &info.texture };
@@ -239,6 +241,9 @@ SurfaceRetrieveResult VKSurfaceCache::retrieve_color_surface_for_framebuffer(Mem
     info_added.tiling = tiling;
     // only remember the swizzle here, it will be useful if we get to present or sample from this image with a different swizzle
     info_added.swizzle = color::translate_swizzle(color->colorFormat);
+    info_added.render_scale = context->render_scale;
+    info_added.is_presented = false;
+    info_added.is_sampled = false;
 
     vkutil::Image &image = info_added.texture;
     image.width = width;
@@ -262,6 +267,7 @@ SurfaceRetrieveResult VKSurfaceCache::retrieve_color_surface_for_framebuffer(Mem
     vk::ImageUsageFlags surface_usages = vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eInputAttachment;
     if (state.features.support_shader_interlock)
         surface_usages |= vk::ImageUsageFlagBits::eStorage;
+    image.category = vkutil::MemoryCategory::SurfaceCache;
     image.init_image(surface_usages, vkutil::default_comp_mapping, image_create_flags, image_info_pNext);
 
     // do it in the prerender if we read from this texture in the same scene (although this would be useless)
@@ -409,6 +415,12 @@ std::optional<TextureLookupResult> VKSurfaceCache::retrieve_color_surface_as_tex
     const vk::ImageView color_handle_view = reinterpret_cast<VKContext *>(state.context)->current_color_view;
     const bool is_same_image = (color_handle_view == info.texture.view) || (color_handle_view == info.alternate_view);
 
+    // the whole surface is needed from now on, do not render it at a lower scale anymore
+    // the surface being rendered to is scaled back with its next render pass
+    info.is_sampled = true;
+    if (!is_same_image)
+        rescale_surface(reinterpret_cast<VKContext *>(state.context)->prerender_cmd, info, 1.0f);
+
     if (state.features.use_texture_viewport && base_format == info.format) {
         // use a texture viewport
         *texture_viewport = {
@@ -504,6 +516,7 @@ std::optional<TextureLookupResult> VKSurfaceCache::retrieve_color_surface_as_tex
             else
                 resulting_swizzle = swizzle;
 
+            casted->texture.category = vkutil::MemoryCategory::SurfaceCache;
             casted->texture.init_image(vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, resulting_swizzle);
             casted->texture.transition_to(cmd_buffer, vkutil::ImageLayout::TransferDst);
         } else {
@@ -535,6 +548,7 @@ std::optional<TextureLookupResult> VKSurfaceCache::retrieve_color_surface_as_tex
                 // create or re-create the buffer
                 state.frame().destroy_queue.add_buffer(casted->transition_buffer);
                 casted->transition_buffer = vkutil::Buffer(buffer_size);
+                casted->transition_buffer.category = vkutil::MemoryCategory::SurfaceCache;
                 casted->transition_buffer.init_buffer(vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eTransferSrc);
             }
 
@@ -625,6 +639,8 @@ SurfaceRetrieveResult VKSurfaceCache::retrieve_depth_stencil_for_framebuffer(Sce
             cached_info = it->second;
     }
 
+    VKContext *context = reinterpret_cast<VKContext *>(state.context);
+
     if (cached_info != nullptr) {
         // this the most recently used depth-stencil surface
         ds_surface_queue.set_as_mru(cached_info);
@@ -634,11 +650,27 @@ SurfaceRetrieveResult VKSurfaceCache::retrieve_depth_stencil_for_framebuffer(Sce
             || cached_info->stride_samples != depth_stencil->get_stride()
             || cached_info->tiling != tiling;
 
-        if (!need_remake)
+        if (!need_remake) {
+            if (cached_info->render_scale != context->render_scale) {
+                // the depth rendered at the previous scale does not match the new one, a linear blit is not possible on depth
+                // and the scale only changes between frames, which usually clear it anyway, so start from a cleared buffer
+                vkutil::Image &image = cached_info->texture;
+                const vkutil::ImageLayout layout = image.layout;
+                image.transition_to_discard(context->prerender_cmd, vkutil::ImageLayout::TransferDst, vkutil::ds_subresource_range);
+                vk::ClearDepthStencilValue clear_value{
+                    .depth = 1.0,
+                    .stencil = 0
+                };
+                context->prerender_cmd.clearDepthStencilImage(image.image, vk::ImageLayout::eTransferDstOptimal, clear_value, vkutil::ds_subresource_range);
+                image.transition_to(context->prerender_cmd, layout, vkutil::ds_subresource_range);
+                cached_info->render_scale = context->render_scale;
+            }
+
             return {
                 cached_info->texture.view,
                 &cached_info->texture
             };
+        }
     } else {
         // retrieve a new depth stencil
         cached_info = ds_surface_queue.get_lru();
@@ -665,6 +697,7 @@ SurfaceRetrieveResult VKSurfaceCache::retrieve_depth_stencil_for_framebuffer(Sce
     cached_info->multisample_mode = target->multisample_mode;
     cached_info->stride_samples = depth_stencil->get_stride();
     cached_info->tiling = tiling;
+    cached_info->render_scale = context->render_scale;
 
     uint32_t bytes_per_sample;
     switch (depth_stencil->get_format()) {
@@ -683,13 +716,13 @@ SurfaceRetrieveResult VKSurfaceCache::retrieve_depth_stencil_for_framebuffer(Sce
     vkutil::Image &image = cached_info->texture;
 
     // use prerender cmd in case we read from the depth buffer (although I really doubt this could happen)
-    VKContext *context = reinterpret_cast<VKContext *>(state.context);
     vk::CommandBuffer cmd_buffer = context->prerender_cmd;
 
     image.width = width;
     image.height = height;
     image.format = vk::Format::eD32SfloatS8Uint;
     image.layout = vkutil::ImageLayout::Undefined;
+    image.category = vkutil::MemoryCategory::SurfaceCache;
     image.init_image(vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eSampled);
 
     image.transition_to(cmd_buffer, vkutil::ImageLayout::TransferDst, vkutil::ds_subresource_range);
@@ -888,6 +921,7 @@ std::optional<TextureLookupResult> VKSurfaceCache::retrieve_depth_stencil_as_tex
             .delta_col = delta_col_samples,
             .delta_row = delta_row_samples,
         };
+        read_only.depth_view.category = vkutil::MemoryCategory::SurfaceCache;
         read_only.depth_view.init_image(vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst);
         // we want a texture view with only the depth or stencil aspect bit
         // TODO: not efficient
@@ -1109,6 +1143,321 @@ bool VKSurfaceCache::check_for_surface(MemState &mem, Address source_address, Ca
     return true;
 }
 
+ColorSurfaceCacheInfo *VKSurfaceCache::find_transfer_surface(const SceGxmTransferImage &image, SceGxmTransferType type) {
+    // only linear surfaces starting exactly at the image address are handled
+    if (type != SCE_GXM_TRANSFER_LINEAR)
+        return nullptr;
+
+    auto it = color_address_lookup.find(image.address.address());
+    if (it == color_address_lookup.end())
+        return nullptr;
+
+    ColorSurfaceCacheInfo &surface = *it->second;
+    const VKContext &context = *static_cast<VKContext *>(state.context);
+    // same as check_for_surface, do not trust surfaces that were not rendered to recently
+    if (surface.last_frame_rendered + MAX_FRAMES_RENDERING <= context.frame_timestamp)
+        return nullptr;
+
+    if (surface.tiling != SurfaceTiling::Linear || image.stride < 0 || static_cast<uint32_t>(image.stride) != surface.stride_bytes)
+        return nullptr;
+
+    if (gxm::get_bits_per_pixel(image.format) != gxm::bits_per_pixel(surface.format))
+        return nullptr;
+
+    if (image.x + image.width > surface.original_width || image.y + image.height > surface.original_height)
+        return nullptr;
+
+    // transfers work on the whole surface, do not render it at a lower scale anymore
+    surface.is_sampled = true;
+    if (surface.render_scale != 1.0f) {
+        vk::CommandBuffer cmd_buffer = get_transfer_cmd_buffer();
+        if (!cmd_buffer)
+            return nullptr;
+
+        rescale_surface(cmd_buffer, surface, 1.0f);
+    }
+
+    return &surface;
+}
+
+vk::CommandBuffer VKSurfaceCache::get_transfer_cmd_buffer() {
+    // record the operation in the current command buffer so that it is ordered
+    // with the scenes which have not been submitted yet
+    VKContext *context = reinterpret_cast<VKContext *>(state.context);
+    if (context == nullptr || !context->is_recording || context->in_renderpass)
+        return nullptr;
+
+    return context->render_cmd;
+}
+
+void VKSurfaceCache::rescale_surface(vk::CommandBuffer cmd_buffer, ColorSurfaceCacheInfo &info, float new_scale) {
+    if (info.render_scale == new_scale)
+        return;
+
+    const vk::Extent3D old_extent{ static_cast<uint32_t>(info.width * info.render_scale), static_cast<uint32_t>(info.height * info.render_scale), 1 };
+    const vk::Offset3D new_end{ static_cast<int32_t>(info.width * new_scale), static_cast<int32_t>(info.height * new_scale), 1 };
+    info.render_scale = new_scale;
+    if (old_extent.width == 0 || old_extent.height == 0 || new_end.x == 0 || new_end.y == 0)
+        return;
+
+    // a blit can't read and write the same image, go through a copy of the rendered part
+    vkutil::Image temp_image;
+    temp_image.format = info.texture.format;
+    temp_image.width = old_extent.width;
+    temp_image.height = old_extent.height;
+    temp_image.category = vkutil::MemoryCategory::SurfaceCache;
+    temp_image.init_image(vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst);
+    temp_image.transition_to(cmd_buffer, vkutil::ImageLayout::TransferDst);
+
+    const vkutil::ImageLayout layout = info.texture.layout;
+    info.texture.transition_to(cmd_buffer, vkutil::ImageLayout::TransferSrc);
+
+    vk::ImageCopy image_copy{
+        .srcSubresource = vkutil::color_subresource_layer,
+        .dstSubresource = vkutil::color_subresource_layer,
+        .extent = old_extent
+    };
+    cmd_buffer.copyImage(info.texture.image, vk::ImageLayout::eTransferSrcOptimal, temp_image.image, vk::ImageLayout::eTransferDstOptimal, image_copy);
+
+    temp_image.transition_to(cmd_buffer, vkutil::ImageLayout::TransferSrc);
+    info.texture.transition_to(cmd_buffer, vkutil::ImageLayout::TransferDst);
+
+    vk::ImageBlit blit{
+        .srcSubresource = vkutil::color_subresource_layer,
+        .srcOffsets = std::array<vk::Offset3D, 2>{ vk::Offset3D{ 0, 0, 0 }, vk::Offset3D{ static_cast<int32_t>(old_extent.width), static_cast<int32_t>(old_extent.height), 1 } },
+        .dstSubresource = vkutil::color_subresource_layer,
+        .dstOffsets = std::array<vk::Offset3D, 2>{ vk::Offset3D{ 0, 0, 0 }, new_end },
+    };
+    cmd_buffer.blitImage(temp_image.image, vk::ImageLayout::eTransferSrcOptimal, info.texture.image, vk::ImageLayout::eTransferDstOptimal, blit, vk::Filter::eLinear);
+
+    info.texture.transition_to(cmd_buffer, layout);
+    state.frame().destroy_queue.add_image(temp_image);
+}
+
+void VKSurfaceCache::sync_transfer_destination(vk::CommandBuffer cmd_buffer, ColorSurfaceCacheInfo &surface) {
+    // without surface sync, the memory of a surface is not updated after a scene either
+    if (!state.features.enable_memory_mapping || state.disable_surface_sync)
+        return;
+
+    const vkutil::ImageLayout layout = surface.texture.layout;
+    surface.texture.transition_to(cmd_buffer, vkutil::ImageLayout::TransferSrc);
+    copy_surface_to_memory(cmd_buffer, surface, vk::ImageLayout::eTransferSrcOptimal);
+    surface.texture.transition_to(cmd_buffer, layout);
+
+    transfer_synced_surfaces.push_back(&surface);
+}
+
+void VKSurfaceCache::copy_data_to_surface(vk::CommandBuffer cmd_buffer, ColorSurfaceCacheInfo &surface, const uint8_t *data, uint32_t data_stride, vk::Offset3D offset, vk::Extent3D extent) {
+    const uint32_t row_size = extent.width * (gxm::bits_per_pixel(surface.format) / 8);
+    if (row_size == 0 || extent.height == 0)
+        return;
+
+    // the guest can write the memory again before the command buffer is executed, copy it now
+    vkutil::Buffer staging_buffer(static_cast<vk::DeviceSize>(row_size) * extent.height);
+    staging_buffer.init_buffer(vk::BufferUsageFlagBits::eTransferSrc, vkutil::vma_mapped_alloc);
+    uint8_t *staging_data = static_cast<uint8_t *>(staging_buffer.mapped_data);
+    for (uint32_t y = 0; y < extent.height; y++)
+        memcpy(staging_data + y * row_size, data + y * data_stride, row_size);
+
+    const vkutil::ImageLayout layout = surface.texture.layout;
+    surface.texture.transition_to(cmd_buffer, vkutil::ImageLayout::TransferDst);
+
+    vk::BufferImageCopy copy{
+        .bufferOffset = 0,
+        .bufferRowLength = extent.width,
+        .bufferImageHeight = extent.height,
+        .imageSubresource = vkutil::color_subresource_layer,
+        .imageOffset = offset,
+        .imageExtent = extent
+    };
+    cmd_buffer.copyBufferToImage(staging_buffer.buffer, surface.texture.image, vk::ImageLayout::eTransferDstOptimal, copy);
+
+    surface.texture.transition_to(cmd_buffer, layout);
+    state.frame().destroy_queue.add_buffer(staging_buffer);
+}
+
+std::vector<ColorSurfaceCacheInfo *> VKSurfaceCache::take_transfer_synced_surfaces() {
+    return std::exchange(transfer_synced_surfaces, {});
+}
+
+// offset and extent of the transfer image area in a surface which may be upscaled
+static std::pair<vk::Offset3D, vk::Extent3D> get_scaled_area(const SceGxmTransferImage &image, const ColorSurfaceCacheInfo &surface, float res_multiplier) {
+    const int32_t x = static_cast<int32_t>(image.x * res_multiplier);
+    const int32_t y = static_cast<int32_t>(image.y * res_multiplier);
+    const uint32_t width = std::min(static_cast<uint32_t>(image.width * res_multiplier), surface.width - static_cast<uint32_t>(x));
+    const uint32_t height = std::min(static_cast<uint32_t>(image.height * res_multiplier), surface.height - static_cast<uint32_t>(y));
+    return { vk::Offset3D{ x, y, 0 }, vk::Extent3D{ width, height, 1 } };
+}
+
+bool VKSurfaceCache::gpu_transfer_copy(const SceGxmTransferImage &src, const SceGxmTransferImage &dst, SceGxmTransferType src_type, SceGxmTransferType dst_type, SceGxmTransferColorKeyMode key_mode) {
+    if (key_mode != SCE_GXM_TRANSFER_COLORKEY_NONE || src.format != dst.format)
+        return false;
+
+    // a CPU transfer involving one of these surfaces is pending, we must not get ahead of it
+    if (vector_utils::find_index(cpu_surfaces_changed, src.address.address()) != -1
+        || vector_utils::find_index(cpu_surfaces_changed, dst.address.address()) != -1)
+        return false;
+
+    ColorSurfaceCacheInfo *src_surface = find_transfer_surface(src, src_type);
+    if (!src_surface)
+        return false;
+
+    ColorSurfaceCacheInfo *dst_surface = find_transfer_surface(dst, dst_type);
+    // the CPU is reading the destination, keep using the CPU path so the memory stays up to date
+    if (!dst_surface || dst_surface == src_surface || *dst_surface->need_surface_sync)
+        return false;
+
+    if (src_surface->texture.format != dst_surface->texture.format || src_surface->swizzle != dst_surface->swizzle)
+        return false;
+
+    vk::CommandBuffer cmd_buffer = get_transfer_cmd_buffer();
+    if (!cmd_buffer)
+        return false;
+
+    const auto [src_offset, src_extent] = get_scaled_area(src, *src_surface, state.res_multiplier);
+    const auto [dst_offset, dst_extent] = get_scaled_area(dst, *dst_surface, state.res_multiplier);
+
+    const vkutil::ImageLayout src_layout = src_surface->texture.layout;
+    const vkutil::ImageLayout dst_layout = dst_surface->texture.layout;
+    src_surface->texture.transition_to(cmd_buffer, vkutil::ImageLayout::TransferSrc);
+    dst_surface->texture.transition_to(cmd_buffer, vkutil::ImageLayout::TransferDst);
+
+    vk::ImageCopy copy{
+        .srcSubresource = vkutil::color_subresource_layer,
+        .srcOffset = src_offset,
+        .dstSubresource = vkutil::color_subresource_layer,
+        .dstOffset = dst_offset,
+        .extent = vk::Extent3D{ std::min(src_extent.width, dst_extent.width), std::min(src_extent.height, dst_extent.height), 1 }
+    };
+    cmd_buffer.copyImage(src_surface->texture.image, vk::ImageLayout::eTransferSrcOptimal, dst_surface->texture.image, vk::ImageLayout::eTransferDstOptimal, copy);
+
+    src_surface->texture.transition_to(cmd_buffer, src_layout);
+    dst_surface->texture.transition_to(cmd_buffer, dst_layout);
+
+    sync_transfer_destination(cmd_buffer, *dst_surface);
+
+    return true;
+}
+
+bool VKSurfaceCache::gpu_transfer_downscale(const SceGxmTransferImage &src, const SceGxmTransferImage &dst) {
+    if (src.format != dst.format)
+        return false;
+
+    if (vector_utils::find_index(cpu_surfaces_changed, src.address.address()) != -1
+        || vector_utils::find_index(cpu_surfaces_changed, dst.address.address()) != -1)
+        return false;
+
+    ColorSurfaceCacheInfo *src_surface = find_transfer_surface(src, SCE_GXM_TRANSFER_LINEAR);
+    if (!src_surface)
+        return false;
+
+    ColorSurfaceCacheInfo *dst_surface = find_transfer_surface(dst, SCE_GXM_TRANSFER_LINEAR);
+    if (!dst_surface || dst_surface == src_surface || *dst_surface->need_surface_sync)
+        return false;
+
+    if (src_surface->texture.format != dst_surface->texture.format || src_surface->swizzle != dst_surface->swizzle)
+        return false;
+
+    vk::CommandBuffer cmd_buffer = get_transfer_cmd_buffer();
+    if (!cmd_buffer)
+        return false;
+
+    const auto [src_offset, src_extent] = get_scaled_area(src, *src_surface, state.res_multiplier);
+    const auto [dst_offset, dst_extent] = get_scaled_area(dst, *dst_surface, state.res_multiplier);
+
+    const vkutil::ImageLayout src_layout = src_surface->texture.layout;
+    const vkutil::ImageLayout dst_layout = dst_surface->texture.layout;
+    src_surface->texture.transition_to(cmd_buffer, vkutil::ImageLayout::TransferSrc);
+    dst_surface->texture.transition_to(cmd_buffer, vkutil::ImageLayout::TransferDst);
+
+    // the PS Vita averages 2x2 blocks, a linear filter on a 2x downscale gives the same result
+    vk::ImageBlit blit{
+        .srcSubresource = vkutil::color_subresource_layer,
+        .srcOffsets = std::array<vk::Offset3D, 2>{ src_offset, vk::Offset3D{ src_offset.x + static_cast<int32_t>(src_extent.width), src_offset.y + static_cast<int32_t>(src_extent.height), 1 } },
+        .dstSubresource = vkutil::color_subresource_layer,
+        .dstOffsets = std::array<vk::Offset3D, 2>{ dst_offset, vk::Offset3D{ dst_offset.x + static_cast<int32_t>(dst_extent.width), dst_offset.y + static_cast<int32_t>(dst_extent.height), 1 } },
+    };
+    cmd_buffer.blitImage(src_surface->texture.image, vk::ImageLayout::eTransferSrcOptimal, dst_surface->texture.image, vk::ImageLayout::eTransferDstOptimal, blit, vk::Filter::eLinear);
+
+    src_surface->texture.transition_to(cmd_buffer, src_layout);
+    dst_surface->texture.transition_to(cmd_buffer, dst_layout);
+
+    sync_transfer_destination(cmd_buffer, *dst_surface);
+
+    return true;
+}
+
+bool VKSurfaceCache::gpu_transfer_fill(const SceGxmTransferImage &dst, uint32_t fill_color) {
+    if (vector_utils::find_index(cpu_surfaces_changed, dst.address.address()) != -1)
+        return false;
+
+    ColorSurfaceCacheInfo *surface = find_transfer_surface(dst, SCE_GXM_TRANSFER_LINEAR);
+    if (!surface)
+        return false;
+
+    // the fill color is given in the memory layout, the texture must have the same one
+    const bool is_swizzle_identity = surface->swizzle.r == vk::ComponentSwizzle::eR;
+    if (!is_swizzle_identity || format_need_additional_memory(surface->format) || !format_support_surface_sync(surface->format))
+        return false;
+
+    const uint32_t bytes_per_pixel = gxm::bits_per_pixel(surface->format) / 8;
+    if (bytes_per_pixel == 0 || bytes_per_pixel > sizeof(fill_color))
+        return false;
+
+    vk::CommandBuffer cmd_buffer = get_transfer_cmd_buffer();
+    if (!cmd_buffer)
+        return false;
+
+    const bool whole_surface = dst.x == 0 && dst.y == 0 && dst.width == surface->original_width && dst.height == surface->original_height;
+    if (whole_surface && surface->texture.format == vk::Format::eR8G8B8A8Unorm) {
+        const vkutil::ImageLayout layout = surface->texture.layout;
+        surface->texture.transition_to_discard(cmd_buffer, vkutil::ImageLayout::TransferDst);
+
+        std::array<float, 4> color;
+        for (int i = 0; i < 4; i++)
+            color[i] = static_cast<float>((fill_color >> (8 * i)) & 0xFF) / 255.0f;
+        cmd_buffer.clearColorImage(surface->texture.image, vk::ImageLayout::eTransferDstOptimal, vk::ClearColorValue{ color }, vkutil::color_subresource_range);
+
+        surface->texture.transition_to(cmd_buffer, layout);
+    } else {
+        // vkCmdClearColorImage can only clear the whole image, copy a filled row to each row of the area instead
+        const auto [offset, extent] = get_scaled_area(dst, *surface, state.res_multiplier);
+        std::vector<uint8_t> row(extent.width * bytes_per_pixel);
+        for (uint32_t x = 0; x < extent.width; x++)
+            memcpy(row.data() + x * bytes_per_pixel, &fill_color, bytes_per_pixel);
+
+        copy_data_to_surface(cmd_buffer, *surface, row.data(), 0, offset, extent);
+    }
+
+    return true;
+}
+
+void VKSurfaceCache::upload_transfer_to_surface(MemState &mem, const SceGxmTransferImage &dst, SceGxmTransferType dst_type) {
+    // the memory content can only be copied as-is if the surface is not upscaled
+    if (state.res_multiplier != 1.0f)
+        return;
+
+    ColorSurfaceCacheInfo *surface = find_transfer_surface(dst, dst_type);
+    if (!surface)
+        return;
+
+    const bool is_swizzle_identity = surface->swizzle.r == vk::ComponentSwizzle::eR;
+    if (!is_swizzle_identity || format_need_additional_memory(surface->format) || !format_support_surface_sync(surface->format))
+        return;
+
+    const uint32_t bytes_per_pixel = gxm::bits_per_pixel(surface->format) / 8;
+    if (bytes_per_pixel == 0)
+        return;
+
+    vk::CommandBuffer cmd_buffer = get_transfer_cmd_buffer();
+    if (!cmd_buffer)
+        return;
+
+    const uint8_t *data = surface->data.cast<uint8_t>().get(mem) + dst.y * surface->stride_bytes + dst.x * bytes_per_pixel;
+    copy_data_to_surface(cmd_buffer, *surface, data, surface->stride_bytes,
+        vk::Offset3D{ static_cast<int32_t>(dst.x), static_cast<int32_t>(dst.y), 0 }, vk::Extent3D{ dst.width, dst.height, 1 });
+}
+
 ColorSurfaceCacheInfo *VKSurfaceCache::perform_surface_sync() {
     // surface sync is supported only if memory mapping is enabled
     if (!state.features.enable_memory_mapping)
@@ -1118,15 +1467,24 @@ ColorSurfaceCacheInfo *VKSurfaceCache::perform_surface_sync() {
         return nullptr;
 
     VKContext *context = reinterpret_cast<VKContext *>(state.context);
-    vk::CommandBuffer cmd_buffer = context->render_cmd;
+    copy_surface_to_memory(context->render_cmd, *last_written_surface, vk::ImageLayout::eGeneral);
+
+    ColorSurfaceCacheInfo *return_value = last_written_surface;
+    last_written_surface = nullptr;
 
-    vk::Image image_to_copy = last_written_surface->texture.image;
-    vk::ImageLayout image_layout = vk::ImageLayout::eGeneral;
+    return return_value;
+}
+
+void VKSurfaceCache::copy_surface_to_memory(vk::CommandBuffer cmd_buffer, ColorSurfaceCacheInfo &surface, vk::ImageLayout image_layout) {
+    // the CPU started reading the surface after it was rendered at a lower scale
+    rescale_surface(cmd_buffer, surface, 1.0f);
+
+    vk::Image image_to_copy = surface.texture.image;
 
     // this works for surface swizzles
-    bool is_swizzle_identity = last_written_surface->swizzle.r == vk::ComponentSwizzle::eR;
-    if (!is_swizzle_identity && !format_support_swizzle(last_written_surface->format)) {
-        LOG_WARN_ONCE("Surface sync with swizzle not support on {}", vk::to_string(last_written_surface->texture.format));
+    bool is_swizzle_identity = surface.swizzle.r == vk::ComponentSwizzle::eR;
+    if (!is_swizzle_identity && !format_support_swizzle(surface.format)) {
+        LOG_WARN_ONCE("Surface sync with swizzle not support on {}", vk::to_string(surface.texture.format));
 
         is_swizzle_identity = true;
     }
@@ -1134,16 +1492,17 @@ ColorSurfaceCacheInfo *VKSurfaceCache::perform_surface_sync() {
     if (state.res_multiplier != 1.0f) {
         // scale back the image using a blit command first
 
-        if (!last_written_surface->blit_image)
-            last_written_surface->blit_image = std::make_unique<vkutil::Image>();
+        if (!surface.blit_image)
+            surface.blit_image = std::make_unique<vkutil::Image>();
 
-        vkutil::Image &blit_image = *last_written_surface->blit_image;
+        vkutil::Image &blit_image = *surface.blit_image;
 
         if (!blit_image.image) {
-            blit_image.format = last_written_surface->texture.format;
-            blit_image.width = last_written_surface->original_width;
-            blit_image.height = last_written_surface->original_height;
+            blit_image.format = surface.texture.format;
+            blit_image.width = surface.original_width;
+            blit_image.height = surface.original_height;
 
+            blit_image.category = vkutil::MemoryCategory::SurfaceCache;
             blit_image.init_image(vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst);
             blit_image.transition_to(cmd_buffer, vkutil::ImageLayout::TransferDst);
         } else {
@@ -1152,9 +1511,9 @@ ColorSurfaceCacheInfo *VKSurfaceCache::perform_surface_sync() {
 
         vk::ImageBlit blit{
             .srcSubresource = vkutil::color_subresource_layer,
-            .srcOffsets = std::array<vk::Offset3D, 2>{ vk::Offset3D{ 0, 0, 0 }, vk::Offset3D{ last_written_surface->width, last_written_surface->height, 1 } },
+            .srcOffsets = std::array<vk::Offset3D, 2>{ vk::Offset3D{ 0, 0, 0 }, vk::Offset3D{ surface.width, surface.height, 1 } },
             .dstSubresource = vkutil::color_subresource_layer,
-            .dstOffsets = std::array<vk::Offset3D, 2>{ vk::Offset3D{ 0, 0, 0 }, vk::Offset3D{ last_written_surface->original_width, last_written_surface->original_height, 1 } },
+            .dstOffsets = std::array<vk::Offset3D, 2>{ vk::Offset3D{ 0, 0, 0 }, vk::Offset3D{ surface.original_width, surface.original_height, 1 } },
         };
         // Apply nearest filter for the time being, linear might be better if we have no data in the texture tho
         cmd_buffer.blitImage(image_to_copy, image_layout, blit_image.image, vk::ImageLayout::eTransferDstOptimal, blit, vk::Filter::eNearest);
@@ -1166,42 +1525,38 @@ ColorSurfaceCacheInfo *VKSurfaceCache::perform_surface_sync() {
 
     vk::Buffer buffer;
     uint32_t offset;
-    if (format_need_additional_memory(last_written_surface->format)) {
-        if (!last_written_surface->copy_buffer)
-            last_written_surface->copy_buffer = std::make_unique<vkutil::Buffer>();
+    if (format_need_additional_memory(surface.format)) {
+        if (!surface.copy_buffer)
+            surface.copy_buffer = std::make_unique<vkutil::Buffer>();
 
-        vkutil::Buffer &copy_buffer = *last_written_surface->copy_buffer;
+        vkutil::Buffer &copy_buffer = *surface.copy_buffer;
 
         if (!copy_buffer.buffer) {
-            copy_buffer.size = last_written_surface->stride_bytes * last_written_surface->original_height;
+            copy_buffer.size = surface.stride_bytes * surface.original_height;
+            copy_buffer.category = vkutil::MemoryCategory::SurfaceCache;
             copy_buffer.init_buffer(vk::BufferUsageFlagBits::eTransferDst, vkutil::vma_mapped_alloc);
         }
 
         buffer = copy_buffer.buffer;
         offset = 0;
 
-        last_written_surface->need_buffer_sync = false;
-        last_written_surface->need_post_surface_sync = true;
+        surface.need_buffer_sync = false;
+        surface.need_post_surface_sync = true;
     } else {
-        last_written_surface->need_buffer_sync = true;
-        last_written_surface->need_post_surface_sync = !is_swizzle_identity;
-        std::tie(buffer, offset) = state.get_matching_mapping(last_written_surface->data);
+        surface.need_buffer_sync = true;
+        surface.need_post_surface_sync = !is_swizzle_identity;
+        std::tie(buffer, offset) = state.get_matching_mapping(surface.data);
     }
-    const uint32_t pixel_stride = (last_written_surface->stride_bytes * 8) / gxm::bits_per_pixel(last_written_surface->format);
+    const uint32_t pixel_stride = (surface.stride_bytes * 8) / gxm::bits_per_pixel(surface.format);
     vk::BufferImageCopy copy{
         .bufferOffset = offset,
         .bufferRowLength = pixel_stride,
-        .bufferImageHeight = last_written_surface->original_height,
+        .bufferImageHeight = surface.original_height,
         .imageSubresource = vkutil::color_subresource_layer,
         .imageOffset = { 0, 0, 0 },
-        .imageExtent = { last_written_surface->original_width, last_written_surface->original_height, 1 }
+        .imageExtent = { surface.original_width, surface.original_height, 1 }
     };
     cmd_buffer.copyImageToBuffer(image_to_copy, image_layout, buffer, copy);
-
-    ColorSurfaceCacheInfo *return_value = last_written_surface;
-    last_written_surface = nullptr;
-
-    return return_value;
 }
 
 template <typename T>
@@ -1304,6 +1659,59 @@ void VKSurfaceCache::destroy_associated_framebuffers(const VKRenderTarget *rende
     destroy_framebuffers(render_target->depthstencil.view);
 }
 
+uint64_t VKSurfaceCache::evict_surfaces(uint64_t bytes) {
+    const uint64_t frame_timestamp = reinterpret_cast<VKContext *>(state.context)->frame_timestamp;
+    vkutil::DestroyQueue &destroy_queue = state.frame().destroy_queue;
+
+    uint64_t evicted = 0;
+    // start from the least recently used surface
+    lru::Item<ColorSurfaceCacheInfo> *item = color_surface_queue.head->prev;
+    for (size_t i = 0; i < color_surface_queue.items.size() && evicted < bytes; i++) {
+        ColorSurfaceCacheInfo &info = item->content;
+        item = item->prev;
+
+        if (!info.texture.image || &info == last_written_surface || frame_timestamp - info.last_frame_rendered <= MAX_FRAMES_RENDERING)
+            continue;
+
+        for (auto &casted : info.casted_textures) {
+            if (casted.texture.image)
+                evicted += vkutil::get_allocation_size(casted.texture.allocation);
+            if (casted.transition_buffer.buffer)
+                evicted += vkutil::get_allocation_size(casted.transition_buffer.allocation);
+            destroy_queue.add_buffer(casted.transition_buffer);
+            destroy_queue.add_image(casted.texture);
+        }
+        info.casted_textures.clear();
+
+        if (info.blit_image && info.blit_image->image) {
+            evicted += vkutil::get_allocation_size(info.blit_image->allocation);
+            destroy_queue.add_image(*info.blit_image);
+        }
+
+        if (info.copy_buffer && info.copy_buffer->buffer) {
+            evicted += vkutil::get_allocation_size(info.copy_buffer->allocation);
+            destroy_queue.add_buffer(*info.copy_buffer);
+        }
+    }
+
+    return evicted;
+}
+
+float VKSurfaceCache::get_render_scale(const SceGxmColorSurface *color) {
+    if (!color)
+        return 1.0f;
+
+    auto it = color_address_lookup.find(color->data.address());
+    if (it == color_address_lookup.end())
+        return 1.0f;
+
+    // the surface content is rescaled when the framebuffer is retrieved
+    // a surface read by the CPU is copied back to memory at full resolution
+    const ColorSurfaceCacheInfo &info = *it->second;
+    const bool is_synced = info.need_surface_sync && *info.need_surface_sync;
+    return (info.is_presented && !info.is_sampled && !is_synced) ? state.render_scale : 1.0f;
+}
+
 vk::ImageView VKSurfaceCache::sourcing_color_surface_for_presentation(Ptr<const void> address, uint32_t pitch, Viewport &viewport) {
     // get closest surface with an address below address
     auto ite = color_address_lookup.upper_bound(address.address());
@@ -1334,11 +1742,12 @@ vk::ImageView VKSurfaceCache::sourcing_color_surface_for_presentation(Ptr<const
                 }
             }
 
-            // Compute position in texture
+            // Compute position in texture, only the top-left part of the surface is used if it was rendered at a lower scale
+            info.is_presented = true;
             viewport.offset_x = 0;
-            viewport.offset_y = start_sourced_line;
-            viewport.width = std::min(viewport.width, static_cast<uint32_t>(info.width));
-            viewport.height = limited_height;
+            viewport.offset_y = static_cast<uint32_t>(start_sourced_line * info.render_scale);
+            viewport.width = static_cast<uint32_t>(std::min(viewport.width, static_cast<uint32_t>(info.width)) * info.render_scale);
+            viewport.height = static_cast<uint32_t>(limited_height * info.render_scale);
             viewport.texture_width = info.width;
             viewport.texture_height = info.height;
 
@@ -1364,7 +1773,7 @@ vk::ImageView VKSurfaceCache::sourcing_color_surface_for_presentation(Ptr<const
     return nullptr;
 }
 
-std::vector<uint32_t> VKSurfaceCache::dump_frame(Ptr<const void> address, uint32_t width, uint32_t height, uint32_t pitch) {
+std::vector<uint32_t> VKSurfaceCache::dump_frame(Ptr<const void> address, uint32_t &width, uint32_t &height, uint32_t pitch) {
     // get closest surface with an address below address
     auto ite = color_address_lookup.upper_bound(address.address());
     if (ite == color_address_lookup.begin()) {
@@ -1379,10 +1788,13 @@ std::vector<uint32_t> VKSurfaceCache::dump_frame(Ptr<const void> address, uint32
     if (info.stride_bytes != pitch_byte || data_delta % pitch_byte != 0)
         return {};
 
-    const uint32_t line_delta = static_cast<uint32_t>((data_delta / pitch_byte) * state.res_multiplier);
+    const uint32_t line_delta = static_cast<uint32_t>((data_delta / pitch_byte) * state.res_multiplier * info.render_scale);
     if (line_delta >= info.height)
         return {};
 
+    width = static_cast<uint32_t>(width * info.render_scale);
+    height = static_cast<uint32_t>(height * info.render_scale);
+
     const uint32_t real_height = std::min(height, info.height - line_delta);
 
     std::vector<uint32_t> frame(width * height, 0);
@@ -30,7 +30,12 @@ void sync_clipping(VKContext &context) {
     if (!context.render_target)
         return;
 
-    const float res_multiplier = context.state.res_multiplier;
+    const float res_multiplier = context.state.res_multiplier * context.render_scale;
+    // with dynamic resolution, only the scaled part of the render target is rendered to
+    const vk::Extent2D target_extent = {
+        static_cast<uint32_t>(context.render_target->width * context.render_scale),
+        static_cast<uint32_t>(context.render_target->height * context.render_scale)
+    };
 
     const int scissor_x = context.record.region_clip_min.x;
     const int scissor_y = context.record.region_clip_min.y;
@@ -41,7 +46,7 @@ void sync_clipping(VKContext &context) {
     switch (context.record.region_clip_mode) {
     case SCE_GXM_REGION_CLIP_NONE:
         // make the scissor the size of the framebuffer
-        context.scissor = vk::Rect2D{ { 0, 0 }, { context.render_target->width, context.render_target->height } };
+        context.scissor = vk::Rect2D{ { 0, 0 }, target_extent };
         break;
     case SCE_GXM_REGION_CLIP_ALL:
         context.scissor = vk::Rect2D{};
@@ -55,7 +60,7 @@ void sync_clipping(VKContext &context) {
     case SCE_GXM_REGION_CLIP_INSIDE:
         // TODO: Implement SCE_GXM_REGION_CLIP_INSIDE
         LOG_WARN("STUB SCE_GXM_REGION_CLIP_INSIDE");
-        context.scissor = vk::Rect2D{ { 0, 0 }, { context.render_target->width, context.render_target->height } };
+        context.scissor = vk::Rect2D{ { 0, 0 }, target_extent };
         break;
     }
 
@@ -153,15 +158,15 @@ void sync_point_line_width(VKContext &context, const bool is_front) {
         return;
 
     if (is_front && context.state.physical_device_features.wideLines)
-        context.render_cmd.setLineWidth(context.record.line_width * context.state.res_multiplier);
+        context.render_cmd.setLineWidth(context.record.line_width * context.state.res_multiplier * context.render_scale);
 }
 
 void sync_viewport_flat(VKContext &context) {
     context.viewport = vk::Viewport{
         .x = 0.0f,
         .y = 0.0f,
-        .width = static_cast<float>(context.render_target->width),
-        .height = static_cast<float>(context.render_target->height),
+        .width = context.render_target->width * context.render_scale,
+        .height = context.render_target->height * context.render_scale,
         .minDepth = 0.0f,
         .maxDepth = 1.0f
     };
@@ -181,7 +186,7 @@ void sync_viewport_real(VKContext &context, const float xOffset, const float yOf
     const float x = xOffset - std::abs(xScale);
     const float y = yOffset - yScale;
 
-    const float res_multiplier = context.state.res_multiplier;
+    const float res_multiplier = context.state.res_multiplier * context.render_scale;
 
     // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkViewport.html
     // https://registry.khronos.org/vulkan/specs/1.3-extensions/html/vkspec.html#vertexpostproc-viewport
@@ -222,6 +222,7 @@ void VKTextureCache::prepare_staging_buffer(bool is_configure) {
             staging_buffer->buffer.destroy();
 
             staging_buffer->buffer.size = current_texture->memory_needed;
+            staging_buffer->buffer.category = vkutil::MemoryCategory::TextureCache;
             staging_buffer->buffer.init_buffer(vk::BufferUsageFlagBits::eTransferSrc, vkutil::vma_mapped_alloc);
         }
     }
@@ -271,9 +272,44 @@ bool VKTextureCache::init(const bool hashless_texture_cache, const fs::path &tex
 
 void VKTextureCache::select(size_t index, const SceGxmTexture &texture) {
     current_texture = &textures[index];
+    current_texture->last_used_frame = reinterpret_cast<VKContext *>(state.context)->frame_timestamp;
     is_texture_transfer_ready = false;
 }
 
+uint64_t VKTextureCache::evict_textures(uint64_t bytes) {
+    const uint64_t frame_timestamp = reinterpret_cast<VKContext *>(state.context)->frame_timestamp;
+    vkutil::DestroyQueue &destroy_queue = state.frame().destroy_queue;
+
+    uint64_t evicted = 0;
+    // start from the least recently used texture
+    lru::Item<TextureCacheInfo> *item = texture_queue.head->prev;
+    for (size_t i = 0; i < TextureCacheSize && evicted < bytes; i++) {
+        lru::Item<TextureCacheInfo> *next = item->prev;
+        TextureCacheInfo &info = item->content;
+        TextureCacheEntry &entry = textures[info.index];
+
+        if (entry.texture.image) {
+            // the textures after this one were bound more recently, they may be used by the frames being rendered
+            if (frame_timestamp - entry.last_used_frame <= MAX_FRAMES_RENDERING)
+                break;
+
+            evicted += vkutil::get_allocation_size(entry.texture.allocation);
+            destroy_queue.add_image(entry.texture);
+
+            // the next lookup of this texture will be a miss and it will be uploaded again
+            if (info.texture_size > 0)
+                texture_lookup.erase(std::bit_cast<TextureGxmDataRepr>(info.texture));
+            info.texture_size = 0;
+            info.texture = {};
+            texture_queue.set_as_lru(&info);
+        }
+
+        item = next;
+    }
+
+    return evicted;
+}
+
 static vk::Format linear_to_srgb(const vk::Format format) {
     switch (format) {
     case vk::Format::eR8Unorm:
@@ -426,12 +462,15 @@ void VKTextureCache::configure_texture(const SceGxmTexture &gxm_texture) {
         .arrayLayers = is_cube ? 6U : 1U,
         .samples = vk::SampleCountFlagBits::e1,
         .tiling = vk::ImageTiling::eOptimal,
-        .usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,
+        // transfer src is needed to move the texture when defragmenting
+        .usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc,
         .sharingMode = vk::SharingMode::eExclusive,
         .initialLayout = vk::ImageLayout::eUndefined,
     };
 
     std::tie(image.image, image.allocation) = state.allocator.createImage(image_info, vkutil::vma_auto_alloc);
+    vkutil::track_allocation(image.allocation, vkutil::MemoryCategory::TextureCache);
+    current_texture->swizzle = swizzle;
 
     // create image view
     vk::ImageSubresourceRange range{
@@ -650,12 +689,13 @@ void VKTextureCache::import_configure_impl(SceGxmTextureBaseFormat base_format,
         .arrayLayers = is_cube ? 6U : 1U,
         .samples = vk::SampleCountFlagBits::e1,
         .tiling = vk::ImageTiling::eOptimal,
-        .usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,
+        .usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc,
         .sharingMode = vk::SharingMode::eExclusive,
         .initialLayout = vk::ImageLayout::eUndefined,
     };
 
     std::tie(image.image, image.allocation) = state.allocator.createImage(image_info, vkutil::vma_auto_alloc);
+    vkutil::track_allocation(image.allocation, vkutil::MemoryCategory::TextureCache);
 
     // create image view
     vk::ImageSubresourceRange range{
@@ -687,6 +727,7 @@ void VKTextureCache::import_configure_impl(SceGxmTextureBaseFormat base_format,
 
     if (swap_rb)
         std::swap(swizzle.r, swizzle.b);
+    current_texture->swizzle = swizzle;
 
     vk::ImageViewCreateInfo view_info{
         .image = image.image,
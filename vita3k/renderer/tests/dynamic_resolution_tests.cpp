@@ -0,0 +1,114 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#include <renderer/dynamic_resolution.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+
+using namespace std::chrono_literals;
+using renderer::DynamicResolution;
+
+namespace {
+
+// GPU time of a frame rendered at scale, for a scene taking full_time at the maximum scale
+std::chrono::microseconds frame_time(std::chrono::microseconds full_time, float scale) {
+    return std::chrono::microseconds(static_cast<int64_t>(full_time.count() * scale * scale));
+}
+
+// Run frames of a scene, return the number of scale changes
+int run_scene(DynamicResolution &controller, std::chrono::microseconds full_time, int frame_count, std::mt19937 *rng = nullptr) {
+    int changes = 0;
+    float scale = controller.get_scale();
+    std::normal_distribution<float> noise(1.0f, 0.05f);
+    for (int i = 0; i < frame_count; i++) {
+        auto time = frame_time(full_time, scale);
+        if (rng)
+            time = std::chrono::microseconds(static_cast<int64_t>(time.count() * noise(*rng)));
+        const float new_scale = controller.add_frame(time);
+        if (new_scale != scale)
+            changes++;
+        scale = new_scale;
+    }
+    return changes;
+}
+
+DynamicResolution make_controller(float min_scale) {
+    DynamicResolution controller;
+    controller.set_bounds(min_scale, 1.0f);
+    controller.set_target(16667us);
+    return controller;
+}
+
+} // namespace
+
+TEST(dynamic_resolution, light_scene_stays_at_max_scale) {
+    auto controller = make_controller(0.5f);
+    ASSERT_EQ(run_scene(controller, 8ms, 600), 0);
+    ASSERT_EQ(controller.get_scale(), 1.0f);
+}
+
+TEST(dynamic_resolution, heavy_scene_fits_in_budget) {
+    auto controller = make_controller(0.5f);
+    std::mt19937 rng(42);
+    run_scene(controller, 30ms, 300, &rng);
+
+    const float scale = controller.get_scale();
+    ASSERT_LT(scale, 1.0f);
+    ASSERT_GE(scale, 0.5f);
+    ASSERT_LE(frame_time(30ms, scale), 16667us);
+    // not much lower than needed either
+    ASSERT_GT(frame_time(30ms, scale + 0.1f), 16667us * 0.85);
+
+    // and it settles there
+    ASSERT_LE(run_scene(controller, 30ms, 600, &rng), 1);
+}
+
+TEST(dynamic_resolution, scale_is_bounded) {
+    auto controller = make_controller(0.6f);
+    run_scene(controller, 100ms, 300);
+    ASSERT_FLOAT_EQ(controller.get_scale(), 0.6f);
+
+    // the minimum can be raised while running
+    controller.set_bounds(0.75f, 1.0f);
+    ASSERT_FLOAT_EQ(controller.get_scale(), 0.75f);
+}
+
+TEST(dynamic_resolution, isolated_slow_frame_is_ignored) {
+    auto controller = make_controller(0.5f);
+    run_scene(controller, 10ms, 60);
+    controller.add_frame(25ms);
+    ASSERT_EQ(run_scene(controller, 10ms, 60), 0);
+    ASSERT_EQ(controller.get_scale(), 1.0f);
+}
+
+TEST(dynamic_resolution, rises_back_when_the_scene_gets_lighter) {
+    auto controller = make_controller(0.5f);
+    run_scene(controller, 40ms, 300);
+    ASSERT_LT(controller.get_scale(), 0.7f);
+
+    // each step up waits for the previous one to be measured
+    const int changes = run_scene(controller, 10ms, 2000);
+    ASSERT_EQ(controller.get_scale(), 1.0f);
+    ASSERT_GT(changes, 1);
+
+    controller.reset();
+    ASSERT_EQ(controller.get_scale(), 1.0f);
+}
@@ -0,0 +1,166 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#include <renderer/gpu_memory.h>
+
+#include <gtest/gtest.h>
+
+#include <deque>
+
+using renderer::GpuMemoryBudget;
+
+namespace {
+
+constexpr uint64_t MiB = 1024 * 1024;
+
+// Cache evicting its least recently used entries first, like the texture and surface caches
+struct FakeCache {
+    std::deque<uint64_t> entries;
+    uint64_t evicted = 0;
+
+    void fill(uint64_t count, uint64_t size) {
+        for (uint64_t i = 0; i < count; i++)
+            entries.push_back(size);
+    }
+
+    uint64_t size() const {
+        uint64_t total = 0;
+        for (uint64_t entry : entries)
+            total += entry;
+        return total;
+    }
+
+    uint64_t evict(uint64_t bytes) {
+        uint64_t freed = 0;
+        while (freed < bytes && !entries.empty()) {
+            freed += entries.front();
+            entries.pop_front();
+        }
+        evicted += freed;
+        return freed;
+    }
+};
+
+struct gpu_memory : public ::testing::Test {
+    FakeCache textures;
+    FakeCache surfaces;
+    // memory neither cache can give back
+    uint64_t fixed = 0;
+    GpuMemoryBudget budget;
+
+    void SetUp() override {
+        budget.add_evictor([this](uint64_t bytes) { return textures.evict(bytes); });
+        budget.add_evictor([this](uint64_t bytes) { return surfaces.evict(bytes); });
+    }
+
+    uint64_t usage() const {
+        return fixed + textures.size() + surfaces.size();
+    }
+};
+
+} // namespace
+
+TEST_F(gpu_memory, no_eviction_under_high_watermark) {
+    fixed = 100 * MiB;
+    textures.fill(100, 4 * MiB);
+    surfaces.fill(20, 8 * MiB);
+
+    // 660 MiB out of 1 GiB
+    ASSERT_EQ(budget.enforce(usage(), 1024 * MiB), 0);
+    ASSERT_EQ(textures.evicted, 0);
+    ASSERT_EQ(surfaces.evicted, 0);
+
+    // budget unknown
+    ASSERT_EQ(budget.enforce(usage(), 0), 0);
+}
+
+TEST_F(gpu_memory, textures_evicted_first) {
+    fixed = 100 * MiB;
+    textures.fill(200, 4 * MiB);
+    surfaces.fill(10, 8 * MiB);
+
+    const uint64_t total = 1024 * MiB;
+    const uint64_t before = usage();
+    ASSERT_GT(before, total * 9 / 10);
+
+    const uint64_t evicted = budget.enforce(before, total);
+    ASSERT_EQ(usage(), before - evicted);
+    ASSERT_LE(usage(), total * 3 / 4);
+    ASSERT_GT(textures.evicted, 0);
+    ASSERT_EQ(surfaces.evicted, 0);
+
+    // the usage went down enough, a second call has nothing to do
+    ASSERT_EQ(budget.enforce(usage(), total), 0);
+}
+
+TEST_F(gpu_memory, surfaces_evicted_when_textures_are_not_enough) {
+    fixed = 300 * MiB;
+    textures.fill(20, 4 * MiB);
+    surfaces.fill(80, 8 * MiB);
+
+    const uint64_t total = 1024 * MiB;
+    const uint64_t evicted = budget.enforce(usage(), total);
+    ASSERT_GT(evicted, 0);
+    ASSERT_TRUE(textures.entries.empty());
+    ASSERT_GT(surfaces.evicted, 0);
+    ASSERT_LE(usage(), total * 3 / 4);
+}
+
+TEST_F(gpu_memory, usage_stays_under_budget_while_allocating) {
+    // a game streaming textures into a 512 MiB budget, the renderer checks the budget every few allocations
+    const uint64_t total = 512 * MiB;
+    fixed = 64 * MiB;
+    surfaces.fill(16, 8 * MiB);
+
+    for (int i = 0; i < 1000; i++) {
+        textures.fill(1, (1 + i % 8) * MiB);
+        if (i % 4 == 0)
+            budget.enforce(usage(), total);
+        ASSERT_LE(usage(), total);
+    }
+    ASSERT_GT(textures.evicted, 0);
+    ASSERT_EQ(surfaces.evicted, 0);
+}
+
+TEST_F(gpu_memory, cannot_free_enough) {
+    fixed = 1000 * MiB;
+    textures.fill(4, 4 * MiB);
+
+    const uint64_t evicted = budget.enforce(usage(), 1024 * MiB);
+    ASSERT_EQ(evicted, 16 * MiB);
+    ASSERT_TRUE(textures.entries.empty());
+}
+
+TEST(gpu_memory_defragmentation, textures_in_a_single_block_are_not_moved) {
+    // the block is mostly empty, but moving its textures cannot release it
+    ASSERT_FALSE(renderer::should_defragment_textures({ { .block_bytes = 256 * MiB, .allocation_bytes = 16 * MiB, .texture_blocks = 1 } }));
+    ASSERT_FALSE(renderer::should_defragment_textures({}));
+}
+
+TEST(gpu_memory_defragmentation, spread_textures_are_moved) {
+    ASSERT_TRUE(renderer::should_defragment_textures({ { .block_bytes = 512 * MiB, .allocation_bytes = 300 * MiB, .texture_blocks = 2 } }));
+    // the blocks are almost full, there is nowhere to move the textures to
+    ASSERT_FALSE(renderer::should_defragment_textures({ { .block_bytes = 512 * MiB, .allocation_bytes = 480 * MiB, .texture_blocks = 4 } }));
+}
+
+TEST(gpu_memory_defragmentation, any_fragmented_memory_type_is_enough) {
+    ASSERT_TRUE(renderer::should_defragment_textures({
+        { .block_bytes = 256 * MiB, .allocation_bytes = 250 * MiB, .texture_blocks = 2 },
+        { .block_bytes = 768 * MiB, .allocation_bytes = 256 * MiB, .texture_blocks = 3 },
+    }));
+}
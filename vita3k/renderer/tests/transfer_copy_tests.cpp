@@ -0,0 +1,143 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <gxm/functions.h>
+#include <renderer/transfer_copy.h>
+#include <testutil/benchmark.h>
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// large enough for every image used below in any layout
+constexpr size_t IMAGE_TEXELS = 256 * 256;
+constexpr uint32_t STRIDE_TEXELS = 128;
+
+struct TransferArea {
+    uint32_t width;
+    uint32_t height;
+    uint32_t src_x;
+    uint32_t src_y;
+    uint32_t dst_x;
+    uint32_t dst_y;
+};
+
+// swizzled images need power of two sizes, the offsets cover tile aligned, unaligned and mismatched cases
+const TransferArea AREAS[] = {
+    { 64, 64, 0, 0, 0, 0 },
+    { 64, 64, 8, 16, 24, 8 },
+    { 64, 32, 3, 5, 3, 5 },
+    { 32, 64, 3, 5, 11, 2 },
+    { 16, 16, 7, 1, 2, 9 },
+    { 128, 8, 1, 0, 33, 4 },
+    { 4, 4, 2, 2, 1, 3 },
+};
+
+const SceGxmTransferType TYPES[] = { SCE_GXM_TRANSFER_LINEAR, SCE_GXM_TRANSFER_TILED, SCE_GXM_TRANSFER_SWIZZLED };
+
+std::vector<uint8_t> make_image(uint32_t bytes_per_pixel, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> image(IMAGE_TEXELS * bytes_per_pixel);
+    for (uint8_t &value : image)
+        value = static_cast<uint8_t>(rng());
+    return image;
+}
+
+// copy with the optimized kernels and one texel at a time, both must give the same destination
+void expect_same_as_texels(SceGxmTransferFormat format, SceGxmTransferColorKeyMode key_mode) {
+    const uint32_t bytes_per_pixel = gxm::get_bits_per_pixel(format) / 8;
+    const std::vector<uint8_t> src_data = make_image(bytes_per_pixel, 1);
+    const std::vector<uint8_t> dst_data = make_image(bytes_per_pixel, 2);
+
+    for (const TransferArea &area : AREAS) {
+        for (SceGxmTransferType src_type : TYPES) {
+            for (SceGxmTransferType dst_type : TYPES) {
+                SCOPED_TRACE(::testing::Message() << "area " << area.width << "x" << area.height << " from (" << area.src_x << ", " << area.src_y
+                                                  << ") to (" << area.dst_x << ", " << area.dst_y << "), types " << src_type << " to " << dst_type);
+
+                const int32_t stride = static_cast<int32_t>(STRIDE_TEXELS * bytes_per_pixel);
+                const SceGxmTransferImage src = { format, Ptr<void>(), area.src_x, area.src_y, area.width, area.height, stride };
+                const SceGxmTransferImage dst = { format, Ptr<void>(), area.dst_x, area.dst_y, area.width, area.height, stride };
+
+                std::vector<uint8_t> expected = dst_data;
+                renderer::copy_transfer_image_texels(src_data.data(), expected.data(), src, dst, src_type, dst_type, key_mode, 0, 1);
+
+                std::vector<uint8_t> result = dst_data;
+                renderer::copy_transfer_image(src_data.data(), result.data(), src, dst, src_type, dst_type, key_mode, 0, 1);
+
+                ASSERT_NE(expected, dst_data);
+                ASSERT_EQ(result, expected);
+            }
+        }
+    }
+}
+
+} // namespace
+
+TEST(transfer_copy, matches_texel_copy_8bpp) {
+    expect_same_as_texels(SCE_GXM_TRANSFER_FORMAT_U8_R, SCE_GXM_TRANSFER_COLORKEY_NONE);
+}
+
+TEST(transfer_copy, matches_texel_copy_16bpp) {
+    expect_same_as_texels(SCE_GXM_TRANSFER_FORMAT_U5U6U5_BGR, SCE_GXM_TRANSFER_COLORKEY_NONE);
+}
+
+TEST(transfer_copy, matches_texel_copy_24bpp) {
+    expect_same_as_texels(SCE_GXM_TRANSFER_FORMAT_U8U8U8_BGR, SCE_GXM_TRANSFER_COLORKEY_NONE);
+}
+
+TEST(transfer_copy, matches_texel_copy_32bpp) {
+    expect_same_as_texels(SCE_GXM_TRANSFER_FORMAT_U8U8U8U8_ABGR, SCE_GXM_TRANSFER_COLORKEY_NONE);
+}
+
+TEST(transfer_copy, matches_texel_copy_128bpp) {
+    expect_same_as_texels(SCE_GXM_TRANSFER_FORMAT_RAW128, SCE_GXM_TRANSFER_COLORKEY_NONE);
+}
+
+TEST(transfer_copy, matches_texel_copy_color_key_pass) {
+    expect_same_as_texels(SCE_GXM_TRANSFER_FORMAT_U8U8U8U8_ABGR, SCE_GXM_TRANSFER_COLORKEY_PASS);
+}
+
+TEST(transfer_copy, matches_texel_copy_color_key_reject) {
+    expect_same_as_texels(SCE_GXM_TRANSFER_FORMAT_U8U8U8U8_ABGR, SCE_GXM_TRANSFER_COLORKEY_REJECT);
+}
+
+// Time taken to copy a 256x256 RGBA8 image between the linear and swizzled layouts with the optimized kernels and one texel at a time
+BENCHMARK_TEST(transfer_copy, swizzle) {
+    constexpr uint32_t iterations = 200;
+
+    const std::vector<uint8_t> src_data = make_image(4, 1);
+    std::vector<uint8_t> dst_data(src_data.size());
+    const SceGxmTransferImage image = { SCE_GXM_TRANSFER_FORMAT_U8U8U8U8_ABGR, Ptr<void>(), 0, 0, 256, 256, 256 * 4 };
+
+    const auto record_copy = [&](const std::string &name, auto copy, SceGxmTransferType src_type, SceGxmTransferType dst_type) {
+        const auto time = testutil::elapsed([&] {
+            for (uint32_t i = 0; i < iterations; i++)
+                copy(src_data.data(), dst_data.data(), image, image, src_type, dst_type, SCE_GXM_TRANSFER_COLORKEY_NONE, 0, 0);
+        });
+        testutil::record_time(name, time / iterations);
+    };
+
+    record_copy("swizzle", renderer::copy_transfer_image, SCE_GXM_TRANSFER_LINEAR, SCE_GXM_TRANSFER_SWIZZLED);
+    record_copy("swizzle_texels", renderer::copy_transfer_image_texels, SCE_GXM_TRANSFER_LINEAR, SCE_GXM_TRANSFER_SWIZZLED);
+    record_copy("unswizzle", renderer::copy_transfer_image, SCE_GXM_TRANSFER_SWIZZLED, SCE_GXM_TRANSFER_LINEAR);
+    record_copy("unswizzle_texels", renderer::copy_transfer_image_texels, SCE_GXM_TRANSFER_SWIZZLED, SCE_GXM_TRANSFER_LINEAR);
+}
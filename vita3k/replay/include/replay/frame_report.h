@@ -0,0 +1,65 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <util/fs.h>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace replay {
+
+struct FrameStats {
+    uint64_t frame_count = 0;
+    // host time between two guest frames, in ms
+    double average = 0;
+    double p50 = 0;
+    double p95 = 0;
+    double p99 = 0;
+    double max = 0;
+    // frames that took more than twice the median
+    uint64_t stutter_count = 0;
+    // combination of all the frame hashes, two runs showing the same frames have the same one
+    uint64_t run_hash = 0;
+};
+
+/**
+ * @brief Frame times and hashes of a run, compared between two runs of the same input recording
+ */
+class FrameReport {
+public:
+    // Called on each guest frame, time is the host time in us
+    void add_frame(uint64_t time);
+    // Hash of the output of guest frame number frame
+    void add_frame_hash(uint64_t frame, uint64_t hash);
+
+    uint64_t get_frame_count() const { return frame_count; }
+    FrameStats get_stats() const;
+    // Text report with the stats followed by the hash of each hashed frame
+    bool save(const fs::path &path) const;
+    void clear();
+
+private:
+    std::optional<uint64_t> last_frame_time;
+    uint64_t frame_count = 0;
+    std::vector<uint32_t> frame_times;
+    std::vector<std::pair<uint64_t, uint64_t>> frame_hashes;
+};
+
+} // namespace replay
@@ -0,0 +1,54 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <replay/state.h>
+
+#include <atomic>
+#include <string>
+
+struct Config;
+
+// Load the input to replay or start recording, from the command line options
+bool init_replay(ReplayState &state, const Config &cfg, const std::string &title_id);
+// Save the input recording and the frame report
+void finish_replay(ReplayState &state);
+
+// Pad state of a port, sampled on each vblank while recording
+void record_pad(ReplayState &state, uint64_t vcount, int port, const replay::PadInput &pad);
+// Pad state the guest sees at vcount while recording or replaying
+replay::PadInput get_replay_pad(ReplayState &state, uint64_t vcount, int port);
+
+// Store the touch data of the vblank while recording, replace it with the recorded one while replaying
+void replay_touch(ReplayState &state, uint64_t vcount, int port, SceTouchData &touch);
+
+void record_motion(ReplayState &state, uint64_t vcount, const replay::MotionSample &motion);
+// false if motion was not sampled on this vblank when recording
+bool get_replay_motion(ReplayState &state, uint64_t vcount, replay::MotionSample &motion);
+
+// Called before vcount is sent, and before its input is sampled. Store the number of guest flips
+// while recording, wait for the guest to have flipped as many frames while replaying
+void sync_replay_vblank(ReplayState &state, uint64_t vcount, bool guest_paused, const std::atomic<bool> &abort);
+// True once, on the first vblank after the end of the replayed input
+bool is_replay_over(ReplayState &state, uint64_t vcount);
+
+// Called on each guest flip, flip_count counts this one
+void add_replay_frame(ReplayState &state, uint64_t flip_count);
+// True if the frame of this guest flip is to be hashed, once per flip
+bool should_hash_frame(ReplayState &state, uint64_t flip);
+void add_replay_frame_hash(ReplayState &state, uint64_t frame, uint64_t hash);
@@ -0,0 +1,100 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <touch/touch.h>
+#include <util/fs.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace replay {
+
+constexpr int PAD_PORT_COUNT = 4;
+constexpr int TOUCH_PORT_COUNT = 2;
+
+// Pad state of a port before the input mode and the negative logic are applied, like CtrlSample
+struct PadInput {
+    uint32_t buttons = 0;
+    uint32_t buttons_ext = 0;
+    uint8_t lx = 0x80;
+    uint8_t ly = 0x80;
+    uint8_t rx = 0x80;
+    uint8_t ry = 0x80;
+};
+
+// Motion sample as given to MotionInput, with the time since the previous sample instead of host timestamps
+struct MotionSample {
+    std::array<float, 3> gyro = {};
+    std::array<float, 3> accel = {};
+    uint64_t gyro_delta = 0;
+    uint64_t accel_delta = 0;
+};
+
+/**
+ * @brief Guest visible input of a run, indexed by the vblank it was sampled on
+ *
+ * Pads and touch panels are only stored when their state changes, the state at a vblank is the last
+ * one stored at or before it. Motion is stored on each vblank it is sampled on, the orientation is
+ * integrated from every sample. The number of frames the guest had flipped on each vblank is kept
+ * the same way, a replay only sends a vblank once the guest has caught up with it.
+ */
+class InputRecording {
+public:
+    void add_pad(uint64_t vcount, int port, const PadInput &pad);
+    // The timestamp is not stored, replayed touch data keeps the timestamp of the replay
+    void add_touch(uint64_t vcount, int port, const SceTouchData &touch);
+    void add_motion(uint64_t vcount, const MotionSample &motion);
+    void add_flip_count(uint64_t vcount, uint64_t flip_count);
+
+    // nullptr before the first input of the port
+    const PadInput *get_pad(uint64_t vcount, int port) const;
+    const SceTouchData *get_touch(uint64_t vcount, int port) const;
+    // nullptr if motion was not sampled on this vblank
+    const MotionSample *get_motion(uint64_t vcount) const;
+    // 0 before the first guest flip
+    uint64_t get_flip_count(uint64_t vcount) const;
+
+    // Last vblank seen while recording, the replay is over after it
+    uint64_t get_end_vcount() const { return end_vcount; }
+    bool empty() const;
+    void clear();
+
+    bool load(const fs::path &path);
+    bool save(const fs::path &path) const;
+
+    // App the input was recorded on, only used to warn about replaying it on another one
+    std::string title_id;
+
+private:
+    template <typename T>
+    struct Event {
+        uint64_t vcount;
+        T input;
+    };
+
+    std::array<std::vector<Event<PadInput>>, PAD_PORT_COUNT> pads;
+    std::array<std::vector<Event<SceTouchData>>, TOUCH_PORT_COUNT> touch;
+    std::vector<Event<MotionSample>> motion;
+    std::vector<Event<uint64_t>> flip_counts;
+    uint64_t end_vcount = 0;
+};
+
+} // namespace replay
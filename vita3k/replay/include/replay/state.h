@@ -0,0 +1,51 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <replay/frame_report.h>
+#include <replay/input_recording.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+enum class ReplayMode {
+    Off,
+    // guest input is recorded to input_path, the guest sees the recorded input
+    Record,
+    // guest input is read from input_path instead of the host devices
+    Replay,
+};
+
+struct ReplayState {
+    std::mutex mutex;
+    std::atomic<ReplayMode> mode = ReplayMode::Off;
+    replay::InputRecording input;
+    fs::path input_path;
+    // guest flips so far, a replayed vblank waits on it
+    uint64_t flip_count = 0;
+    std::condition_variable flip_cond;
+    // set once a vblank gave up waiting for the guest, the next ones do not wait anymore
+    bool lost_sync = false;
+    // the frame report is only kept when it is written somewhere
+    replay::FrameReport report;
+    fs::path report_path;
+    bool hash_frames = false;
+    uint64_t last_hashed_frame = 0;
+    bool finished = false;
+};
@@ -0,0 +1,109 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <replay/frame_report.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace replay {
+
+// value below which ratio of the sorted times are, nearest rank
+static double get_percentile(const std::vector<uint32_t> &sorted_times, double ratio) {
+    const size_t rank = static_cast<size_t>(std::ceil(ratio * sorted_times.size()));
+    return sorted_times[std::clamp<size_t>(rank, 1, sorted_times.size()) - 1] / 1000.0;
+}
+
+void FrameReport::add_frame(uint64_t time) {
+    frame_count++;
+    if (last_frame_time)
+        frame_times.push_back(static_cast<uint32_t>(std::min<uint64_t>(time - *last_frame_time, UINT32_MAX)));
+    last_frame_time = time;
+}
+
+void FrameReport::add_frame_hash(uint64_t frame, uint64_t hash) {
+    frame_hashes.emplace_back(frame, hash);
+}
+
+FrameStats FrameReport::get_stats() const {
+    FrameStats stats;
+    stats.frame_count = frame_count;
+
+    // FNV-1a over the hashes, in frame order
+    stats.run_hash = 0xcbf29ce484222325ULL;
+    for (const auto &[frame, hash] : frame_hashes) {
+        for (int i = 0; i < 8; i++) {
+            stats.run_hash ^= (hash >> (i * 8)) & 0xFF;
+            stats.run_hash *= 0x100000001b3ULL;
+        }
+    }
+
+    if (frame_times.empty())
+        return stats;
+
+    std::vector<uint32_t> sorted_times = frame_times;
+    std::sort(sorted_times.begin(), sorted_times.end());
+
+    uint64_t total = 0;
+    for (const uint32_t time : sorted_times)
+        total += time;
+    stats.average = static_cast<double>(total) / sorted_times.size() / 1000.0;
+    stats.p50 = get_percentile(sorted_times, 0.50);
+    stats.p95 = get_percentile(sorted_times, 0.95);
+    stats.p99 = get_percentile(sorted_times, 0.99);
+    stats.max = sorted_times.back() / 1000.0;
+
+    const uint64_t stutter_threshold = 2 * static_cast<uint64_t>(stats.p50 * 1000.0);
+    stats.stutter_count = std::count_if(frame_times.begin(), frame_times.end(), [&](uint32_t time) { return time > stutter_threshold; });
+
+    return stats;
+}
+
+bool FrameReport::save(const fs::path &path) const {
+    fs::ofstream file(path, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    const FrameStats stats = get_stats();
+    file << std::fixed << std::setprecision(3);
+    file << "frames: " << stats.frame_count << "\n";
+    file << "average: " << stats.average << " ms\n";
+    file << "p50: " << stats.p50 << " ms\n";
+    file << "p95: " << stats.p95 << " ms\n";
+    file << "p99: " << stats.p99 << " ms\n";
+    file << "max: " << stats.max << " ms\n";
+    file << "stutters: " << stats.stutter_count << "\n";
+
+    if (!frame_hashes.empty()) {
+        file << std::hex << std::setfill('0');
+        file << "run hash: " << std::setw(16) << stats.run_hash << "\n";
+        for (const auto &[frame, hash] : frame_hashes)
+            file << "frame " << std::dec << frame << ": " << std::hex << std::setw(16) << hash << "\n";
+    }
+
+    return file.good();
+}
+
+void FrameReport::clear() {
+    last_frame_time.reset();
+    frame_count = 0;
+    frame_times.clear();
+    frame_hashes.clear();
+}
+
+} // namespace replay
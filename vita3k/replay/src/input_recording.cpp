@@ -0,0 +1,218 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <replay/input_recording.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace replay {
+
+static constexpr uint32_t RECORDING_VERSION = 2;
+
+struct RecordingHeader {
+    char magic[4];
+    uint32_t version;
+    char title_id[16];
+    uint64_t end_vcount;
+    uint64_t pad_counts[PAD_PORT_COUNT];
+    uint64_t touch_counts[TOUCH_PORT_COUNT];
+    uint64_t motion_count;
+    uint64_t flip_count_count;
+};
+
+// The events are read and written as they are in memory
+static_assert(sizeof(PadInput) == 12);
+static_assert(sizeof(SceTouchData) == 144);
+static_assert(sizeof(MotionSample) == 40);
+
+template <typename T>
+static bool same_input(const T &a, const T &b) {
+    return memcmp(&a, &b, sizeof(T)) == 0;
+}
+
+// Last event at or before vcount
+template <typename Event>
+static const Event *find_event(const std::vector<Event> &events, uint64_t vcount) {
+    const auto next = std::upper_bound(events.begin(), events.end(), vcount, [](uint64_t vcount, const Event &event) {
+        return vcount < event.vcount;
+    });
+    if (next == events.begin())
+        return nullptr;
+    return &*std::prev(next);
+}
+
+template <typename Event>
+static bool read_events(fs::ifstream &file, std::vector<Event> &events, uint64_t count, uint64_t &bytes_left) {
+    // the counts come from the file, they must not ask for more than what it holds
+    if (count > bytes_left / sizeof(Event))
+        return false;
+    bytes_left -= count * sizeof(Event);
+
+    events.resize(count);
+    if (!file.read(reinterpret_cast<char *>(events.data()), count * sizeof(Event)))
+        return false;
+
+    // the lookups are binary searches
+    return std::is_sorted(events.begin(), events.end(), [](const Event &a, const Event &b) { return a.vcount < b.vcount; });
+}
+
+template <typename Event>
+static void write_events(fs::ofstream &file, const std::vector<Event> &events) {
+    file.write(reinterpret_cast<const char *>(events.data()), events.size() * sizeof(Event));
+}
+
+void InputRecording::add_pad(uint64_t vcount, int port, const PadInput &pad) {
+    end_vcount = std::max(end_vcount, vcount);
+    auto &events = pads[port];
+    if (!events.empty() && same_input(events.back().input, pad))
+        return;
+
+    Event<PadInput> event{};
+    event.vcount = vcount;
+    event.input = pad;
+    events.push_back(event);
+}
+
+void InputRecording::add_touch(uint64_t vcount, int port, const SceTouchData &data) {
+    end_vcount = std::max(end_vcount, vcount);
+    Event<SceTouchData> event{};
+    event.vcount = vcount;
+    event.input = data;
+    event.input.timeStamp = 0;
+
+    auto &events = touch[port];
+    if (!events.empty() && same_input(events.back().input, event.input))
+        return;
+    events.push_back(event);
+}
+
+void InputRecording::add_motion(uint64_t vcount, const MotionSample &sample) {
+    end_vcount = std::max(end_vcount, vcount);
+    Event<MotionSample> event{};
+    event.vcount = vcount;
+    event.input = sample;
+    motion.push_back(event);
+}
+
+void InputRecording::add_flip_count(uint64_t vcount, uint64_t flip_count) {
+    end_vcount = std::max(end_vcount, vcount);
+    if (!flip_counts.empty() && (flip_counts.back().input == flip_count))
+        return;
+
+    flip_counts.push_back({ vcount, flip_count });
+}
+
+const PadInput *InputRecording::get_pad(uint64_t vcount, int port) const {
+    const auto event = find_event(pads[port], vcount);
+    return event ? &event->input : nullptr;
+}
+
+const SceTouchData *InputRecording::get_touch(uint64_t vcount, int port) const {
+    const auto event = find_event(touch[port], vcount);
+    return event ? &event->input : nullptr;
+}
+
+const MotionSample *InputRecording::get_motion(uint64_t vcount) const {
+    const auto event = find_event(motion, vcount);
+    if (!event || (event->vcount != vcount))
+        return nullptr;
+    return &event->input;
+}
+
+uint64_t InputRecording::get_flip_count(uint64_t vcount) const {
+    const auto event = find_event(flip_counts, vcount);
+    return event ? event->input : 0;
+}
+
+bool InputRecording::empty() const {
+    const auto is_empty = [](const auto &events) { return events.empty(); };
+    return std::all_of(pads.begin(), pads.end(), is_empty) && std::all_of(touch.begin(), touch.end(), is_empty) && motion.empty() && flip_counts.empty();
+}
+
+void InputRecording::clear() {
+    for (auto &events : pads)
+        events.clear();
+    for (auto &events : touch)
+        events.clear();
+    motion.clear();
+    flip_counts.clear();
+    end_vcount = 0;
+    title_id.clear();
+}
+
+bool InputRecording::load(const fs::path &path) {
+    clear();
+
+    fs::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+    const uint64_t file_size = file.tellg();
+    file.seekg(0);
+
+    RecordingHeader header;
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        return false;
+    if ((memcmp(header.magic, "V3KI", sizeof(header.magic)) != 0) || (header.version != RECORDING_VERSION))
+        return false;
+
+    uint64_t bytes_left = file_size - sizeof(header);
+    bool ok = true;
+    for (int port = 0; ok && (port < PAD_PORT_COUNT); port++)
+        ok = read_events(file, pads[port], header.pad_counts[port], bytes_left);
+    for (int port = 0; ok && (port < TOUCH_PORT_COUNT); port++)
+        ok = read_events(file, touch[port], header.touch_counts[port], bytes_left);
+    ok = ok && read_events(file, motion, header.motion_count, bytes_left);
+    ok = ok && read_events(file, flip_counts, header.flip_count_count, bytes_left);
+    if (!ok) {
+        clear();
+        return false;
+    }
+
+    title_id.assign(header.title_id, strnlen(header.title_id, sizeof(header.title_id)));
+    end_vcount = header.end_vcount;
+    return true;
+}
+
+bool InputRecording::save(const fs::path &path) const {
+    fs::ofstream file(path, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    RecordingHeader header{};
+    memcpy(header.magic, "V3KI", sizeof(header.magic));
+    header.version = RECORDING_VERSION;
+    strncpy(header.title_id, title_id.c_str(), sizeof(header.title_id) - 1);
+    header.end_vcount = end_vcount;
+    for (int port = 0; port < PAD_PORT_COUNT; port++)
+        header.pad_counts[port] = pads[port].size();
+    for (int port = 0; port < TOUCH_PORT_COUNT; port++)
+        header.touch_counts[port] = touch[port].size();
+    header.motion_count = motion.size();
+    header.flip_count_count = flip_counts.size();
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (const auto &events : pads)
+        write_events(file, events);
+    for (const auto &events : touch)
+        write_events(file, events);
+    write_events(file, motion);
+    write_events(file, flip_counts);
+    return file.good();
+}
+
+} // namespace replay
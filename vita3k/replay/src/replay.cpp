@@ -0,0 +1,193 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <replay/functions.h>
+
+#include <config/state.h>
+#include <rtc/clock.h>
+#include <util/log.h>
+
+#include <chrono>
+
+// the guest may not follow the recording at all, a replayed vblank stops waiting for it after this
+static constexpr auto REPLAY_VBLANK_TIMEOUT = std::chrono::seconds(2);
+
+bool init_replay(ReplayState &state, const Config &cfg, const std::string &title_id) {
+    if (cfg.replay_input_path.has_value()) {
+        state.input_path = fs_utils::utf8_to_path(*cfg.replay_input_path);
+        if (!state.input.load(state.input_path)) {
+            LOG_ERROR("Input recording {} could not be loaded.", *cfg.replay_input_path);
+            return false;
+        }
+        LOG_WARN_IF(state.input.title_id != title_id, "Input recording {} was made on {}, replaying it on {}.", *cfg.replay_input_path, state.input.title_id, title_id);
+        LOG_INFO("Replaying input from {} until vblank {}", *cfg.replay_input_path, state.input.get_end_vcount());
+        state.mode = ReplayMode::Replay;
+    } else if (cfg.record_input_path.has_value()) {
+        state.input_path = fs_utils::utf8_to_path(*cfg.record_input_path);
+        state.input.clear();
+        state.input.title_id = title_id;
+        LOG_INFO("Recording input to {}", *cfg.record_input_path);
+        state.mode = ReplayMode::Record;
+    }
+
+    // the input is replayed on the same vblanks, the guest only does the same work on them if its time is also the same
+    LOG_WARN_IF((state.mode != ReplayMode::Off) && (parse_guest_clock_mode(cfg.guest_clock_mode) != GuestClockMode::DETERMINISTIC),
+        "guest-clock-mode is not deterministic, the replay may not follow the recorded run.");
+
+    if (cfg.frame_report_path.has_value()) {
+        state.report_path = fs_utils::utf8_to_path(*cfg.frame_report_path);
+        state.hash_frames = cfg.hash_frames;
+    }
+
+    return true;
+}
+
+void finish_replay(ReplayState &state) {
+    const std::lock_guard<std::mutex> guard(state.mutex);
+    if (state.mode == ReplayMode::Record) {
+        if (state.input.save(state.input_path))
+            LOG_INFO("Input recorded to {} ({} vblanks)", fs_utils::path_to_utf8(state.input_path), state.input.get_end_vcount());
+        else
+            LOG_ERROR("Input recording {} could not be written.", fs_utils::path_to_utf8(state.input_path));
+    }
+    state.mode = ReplayMode::Off;
+
+    if (state.report_path.empty())
+        return;
+
+    const replay::FrameStats stats = state.report.get_stats();
+    LOG_INFO("{} frames: average {:.3f} ms, p50 {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms, {} stutters",
+        stats.frame_count, stats.average, stats.p50, stats.p95, stats.p99, stats.max, stats.stutter_count);
+    LOG_INFO_IF(state.hash_frames, "Run hash: {:016x}", stats.run_hash);
+    if (!state.report.save(state.report_path))
+        LOG_ERROR("Frame report {} could not be written.", fs_utils::path_to_utf8(state.report_path));
+}
+
+void record_pad(ReplayState &state, uint64_t vcount, int port, const replay::PadInput &pad) {
+    if (state.mode != ReplayMode::Record)
+        return;
+
+    const std::lock_guard<std::mutex> guard(state.mutex);
+    state.input.add_pad(vcount, port, pad);
+}
+
+replay::PadInput get_replay_pad(ReplayState &state, uint64_t vcount, int port) {
+    const std::lock_guard<std::mutex> guard(state.mutex);
+    const replay::PadInput *pad = state.input.get_pad(vcount, port);
+    return pad ? *pad : replay::PadInput{};
+}
+
+void replay_touch(ReplayState &state, uint64_t vcount, int port, SceTouchData &touch) {
+    const ReplayMode mode = state.mode;
+    if (mode == ReplayMode::Off)
+        return;
+
+    const std::lock_guard<std::mutex> guard(state.mutex);
+    if (mode == ReplayMode::Record) {
+        state.input.add_touch(vcount, port, touch);
+        return;
+    }
+
+    const uint64_t timestamp = touch.timeStamp;
+    const SceTouchData *recorded = state.input.get_touch(vcount, port);
+    if (recorded)
+        touch = *recorded;
+    else
+        touch = {};
+    touch.timeStamp = timestamp;
+}
+
+void record_motion(ReplayState &state, uint64_t vcount, const replay::MotionSample &motion) {
+    if (state.mode != ReplayMode::Record)
+        return;
+
+    const std::lock_guard<std::mutex> guard(state.mutex);
+    state.input.add_motion(vcount, motion);
+}
+
+bool get_replay_motion(ReplayState &state, uint64_t vcount, replay::MotionSample &motion) {
+    const std::lock_guard<std::mutex> guard(state.mutex);
+    const replay::MotionSample *recorded = state.input.get_motion(vcount);
+    if (!recorded)
+        return false;
+
+    motion = *recorded;
+    return true;
+}
+
+void sync_replay_vblank(ReplayState &state, uint64_t vcount, bool guest_paused, const std::atomic<bool> &abort) {
+    const ReplayMode mode = state.mode;
+    if (mode == ReplayMode::Off)
+        return;
+
+    std::unique_lock<std::mutex> lock(state.mutex);
+    if (mode == ReplayMode::Record) {
+        state.input.add_flip_count(vcount, state.flip_count);
+        return;
+    }
+
+    // the vblank thread is paced by the host, it must not get ahead of a guest slower than when recording
+    const uint64_t flip_count = state.input.get_flip_count(vcount);
+    const auto deadline = std::chrono::steady_clock::now() + REPLAY_VBLANK_TIMEOUT;
+    while (!state.lost_sync && !guest_paused && !abort && (state.flip_count < flip_count)) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            state.lost_sync = true;
+            LOG_WARN("Vblank {} was recorded after {} guest flips, the guest is still at {}. The replay no longer follows the recorded run.", vcount, flip_count, state.flip_count);
+            return;
+        }
+        state.flip_cond.wait_for(lock, std::chrono::milliseconds(10));
+    }
+}
+
+bool is_replay_over(ReplayState &state, uint64_t vcount) {
+    if ((state.mode != ReplayMode::Replay) || state.finished || (vcount <= state.input.get_end_vcount()))
+        return false;
+
+    state.finished = true;
+    return true;
+}
+
+void add_replay_frame(ReplayState &state, uint64_t flip_count) {
+    if ((state.mode == ReplayMode::Off) && state.report_path.empty())
+        return;
+
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    {
+        const std::lock_guard<std::mutex> guard(state.mutex);
+        state.flip_count = flip_count;
+        if (!state.report_path.empty())
+            state.report.add_frame(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+    }
+    state.flip_cond.notify_all();
+}
+
+bool should_hash_frame(ReplayState &state, uint64_t flip) {
+    if (!state.hash_frames || (flip == 0))
+        return false;
+
+    const std::lock_guard<std::mutex> guard(state.mutex);
+    if (flip == state.last_hashed_frame)
+        return false;
+
+    state.last_hashed_frame = flip;
+    return true;
+}
+
+void add_replay_frame_hash(ReplayState &state, uint64_t frame, uint64_t hash) {
+    const std::lock_guard<std::mutex> guard(state.mutex);
+    state.report.add_frame_hash(frame, hash);
+}
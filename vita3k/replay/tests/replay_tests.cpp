@@ -0,0 +1,162 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include <replay/frame_report.h>
+#include <replay/input_recording.h>
+
+#include <gtest/gtest.h>
+
+using namespace replay;
+
+static SceTouchData make_touch(uint64_t timestamp, int16_t x, int16_t y) {
+    SceTouchData data{};
+    data.timeStamp = timestamp;
+    data.reportNum = 1;
+    data.report[0].id = 1;
+    data.report[0].x = x;
+    data.report[0].y = y;
+    return data;
+}
+
+TEST(input_recording, pad_is_held_until_it_changes) {
+    InputRecording recording;
+    PadInput pad{};
+    for (uint64_t vcount = 10; vcount < 20; vcount++)
+        recording.add_pad(vcount, 0, pad);
+    pad.buttons = 0x4000;
+    pad.lx = 0x10;
+    recording.add_pad(20, 0, pad);
+    recording.add_pad(21, 0, pad);
+
+    ASSERT_EQ(recording.get_pad(9, 0), nullptr);
+    ASSERT_EQ(recording.get_pad(15, 0)->buttons, 0);
+    ASSERT_EQ(recording.get_pad(15, 0)->lx, 0x80);
+    ASSERT_EQ(recording.get_pad(20, 0)->buttons, 0x4000);
+    ASSERT_EQ(recording.get_pad(1000, 0)->lx, 0x10);
+    ASSERT_EQ(recording.get_pad(20, 1), nullptr);
+    ASSERT_EQ(recording.get_end_vcount(), 21);
+}
+
+TEST(input_recording, touch_ignores_timestamps) {
+    InputRecording recording;
+    recording.add_touch(1, 0, make_touch(100, 960, 544));
+    recording.add_touch(2, 0, make_touch(200, 960, 544));
+    recording.add_touch(3, 0, make_touch(300, 0, 0));
+
+    ASSERT_EQ(recording.get_touch(2, 0)->report[0].x, 960);
+    ASSERT_EQ(recording.get_touch(2, 0)->timeStamp, 0);
+    ASSERT_EQ(recording.get_touch(3, 0)->report[0].x, 0);
+    ASSERT_EQ(recording.get_touch(3, 1), nullptr);
+}
+
+TEST(input_recording, motion_is_only_replayed_on_its_vblank) {
+    InputRecording recording;
+    MotionSample sample{};
+    sample.gyro = { 0.5f, 0.f, -0.5f };
+    sample.gyro_delta = 16666;
+    recording.add_motion(5, sample);
+    recording.add_motion(7, sample);
+
+    ASSERT_EQ(recording.get_motion(4), nullptr);
+    ASSERT_EQ(recording.get_motion(5)->gyro[2], -0.5f);
+    ASSERT_EQ(recording.get_motion(6), nullptr);
+    ASSERT_EQ(recording.get_motion(7)->gyro_delta, 16666);
+}
+
+TEST(input_recording, save_and_load) {
+    const fs::path path = fs::temp_directory_path() / fs::unique_path("replay-%%%%-%%%%.v3ki");
+
+    InputRecording recording;
+    recording.title_id = "PCSE00000";
+    PadInput pad{};
+    pad.buttons_ext = 0x400;
+    recording.add_pad(3, 0, pad);
+    recording.add_pad(8, 3, pad);
+    recording.add_touch(4, 1, make_touch(1234, 10, 20));
+    MotionSample sample{};
+    sample.accel = { 0.f, -1.f, 0.f };
+    recording.add_motion(6, sample);
+    recording.add_flip_count(2, 1);
+    recording.add_flip_count(5, 1);
+    recording.add_flip_count(7, 2);
+    ASSERT_TRUE(recording.save(path));
+
+    InputRecording loaded;
+    ASSERT_TRUE(loaded.load(path));
+    ASSERT_EQ(loaded.title_id, "PCSE00000");
+    ASSERT_EQ(loaded.get_end_vcount(), 8);
+    ASSERT_EQ(loaded.get_pad(5, 0)->buttons_ext, 0x400);
+    ASSERT_EQ(loaded.get_pad(5, 3), nullptr);
+    ASSERT_NE(loaded.get_pad(8, 3), nullptr);
+    ASSERT_EQ(loaded.get_touch(4, 1)->report[0].y, 20);
+    ASSERT_EQ(loaded.get_motion(6)->accel[1], -1.f);
+    ASSERT_EQ(loaded.get_flip_count(1), 0);
+    ASSERT_EQ(loaded.get_flip_count(6), 1);
+    ASSERT_EQ(loaded.get_flip_count(8), 2);
+
+    // a truncated recording is rejected
+    fs::resize_file(path, fs::file_size(path) - 1);
+    ASSERT_FALSE(loaded.load(path));
+    ASSERT_TRUE(loaded.empty());
+
+    // and so is one with more events than the file can hold, before anything is allocated
+    ASSERT_TRUE(recording.save(path));
+    {
+        fs::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        const uint64_t huge_count = ~0ull / 2;
+        // pad_counts[0] follows the magic, the version, the title id and end_vcount
+        file.seekp(4 + 4 + 16 + 8);
+        file.write(reinterpret_cast<const char *>(&huge_count), sizeof(huge_count));
+    }
+    ASSERT_FALSE(loaded.load(path));
+    ASSERT_TRUE(loaded.empty());
+
+    fs::remove(path);
+}
+
+TEST(frame_report, stats) {
+    FrameReport report;
+    uint64_t time = 1'000'000;
+    report.add_frame(time);
+    // 100 frames at 60 fps with 2 hitches
+    for (int i = 0; i < 100; i++) {
+        time += (i == 50 || i == 80) ? 50'000 : 16'667;
+        report.add_frame(time);
+    }
+
+    const FrameStats stats = report.get_stats();
+    ASSERT_EQ(stats.frame_count, 101);
+    ASSERT_NEAR(stats.p50, 16.667, 0.001);
+    ASSERT_NEAR(stats.p95, 16.667, 0.001);
+    ASSERT_NEAR(stats.p99, 50.0, 0.001);
+    ASSERT_NEAR(stats.max, 50.0, 0.001);
+    ASSERT_NEAR(stats.average, (98 * 16.667 + 2 * 50.0) / 100, 0.001);
+    ASSERT_EQ(stats.stutter_count, 2);
+}
+
+TEST(frame_report, run_hash_follows_the_frames) {
+    FrameReport a;
+    FrameReport b;
+    for (uint64_t frame = 1; frame <= 10; frame++) {
+        a.add_frame_hash(frame, frame * 0x9E3779B97F4A7C15ULL);
+        b.add_frame_hash(frame, frame * 0x9E3779B97F4A7C15ULL);
+    }
+    ASSERT_EQ(a.get_stats().run_hash, b.get_stats().run_hash);
+
+    b.add_frame_hash(11, 0);
+    ASSERT_NE(a.get_stats().run_hash, b.get_stats().run_hash);
+}
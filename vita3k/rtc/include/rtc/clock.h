@@ -0,0 +1,75 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+enum class GuestClockMode {
+    // Guest time follows host time
+    REAL_TIME,
+    // Guest time runs speed times faster than host time
+    SCALED,
+    // Guest time only moves when advanced, by one frame on each vblank
+    DETERMINISTIC,
+};
+
+/**
+ * @brief Source of every guest visible time: RTC, process and system time, kernel timers and vblank
+ *
+ * Changing the mode keeps guest time going from its current value, it never goes back.
+ */
+class GuestClock {
+public:
+    using HostClock = std::chrono::high_resolution_clock;
+
+    // Microseconds of guest time, with the origin of the host clock until the mode is changed
+    uint64_t now() const;
+
+    void set_mode(GuestClockMode mode, double speed = 1.0);
+    GuestClockMode get_mode() const { return mode.load(std::memory_order_acquire); }
+    double get_speed() const;
+
+    // Move deterministic guest time forward, ignored in the other modes
+    void advance(uint64_t guest_us);
+
+    // Host time it takes for duration of guest time to pass, used to pace the guest waits and vblank
+    std::chrono::microseconds to_host(uint64_t guest_us) const;
+
+private:
+    uint64_t now_locked() const;
+
+    mutable std::mutex mutex;
+    std::atomic<GuestClockMode> mode = GuestClockMode::REAL_TIME;
+    // guest = host + offset in real time mode
+    std::atomic<int64_t> offset = 0;
+    // guest = anchor_guest + (host - anchor_host) * speed in scaled mode
+    HostClock::time_point anchor_host;
+    uint64_t anchor_guest = 0;
+    double speed = 1.0;
+    std::atomic<uint64_t> deterministic_now = 0;
+};
+
+GuestClock &get_guest_clock();
+
+// "real-time", "scaled" or "deterministic", as stored in the config
+GuestClockMode parse_guest_clock_mode(const std::string &name);
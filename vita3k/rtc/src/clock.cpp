@@ -0,0 +1,98 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#include <rtc/clock.h>
+
+#include <util/log.h>
+
+#include <algorithm>
+
+static uint64_t get_host_time(GuestClock::HostClock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+}
+
+uint64_t GuestClock::now() const {
+    // real time is the default and must stay cheap, it is read on every guest time query
+    if (get_mode() == GuestClockMode::REAL_TIME)
+        return get_host_time(HostClock::now()) + offset.load(std::memory_order_relaxed);
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    return now_locked();
+}
+
+uint64_t GuestClock::now_locked() const {
+    switch (get_mode()) {
+    case GuestClockMode::REAL_TIME:
+        return get_host_time(HostClock::now()) + offset.load(std::memory_order_relaxed);
+    case GuestClockMode::SCALED: {
+        const auto elapsed = std::chrono::duration<double, std::micro>(HostClock::now() - anchor_host).count();
+        return anchor_guest + static_cast<uint64_t>(std::max(elapsed, 0.0) * speed);
+    }
+    case GuestClockMode::DETERMINISTIC:
+        return deterministic_now.load(std::memory_order_relaxed);
+    }
+    return 0;
+}
+
+void GuestClock::set_mode(GuestClockMode new_mode, double new_speed) {
+    const std::lock_guard<std::mutex> lock(mutex);
+    const uint64_t current = now_locked();
+    const auto host_now = HostClock::now();
+
+    speed = std::clamp(new_speed, 0.01, 100.0);
+    anchor_host = host_now;
+    anchor_guest = current;
+    offset.store(static_cast<int64_t>(current - get_host_time(host_now)), std::memory_order_relaxed);
+    deterministic_now.store(current, std::memory_order_relaxed);
+    mode.store(new_mode, std::memory_order_release);
+}
+
+double GuestClock::get_speed() const {
+    const std::lock_guard<std::mutex> lock(mutex);
+    return get_mode() == GuestClockMode::REAL_TIME ? 1.0 : speed;
+}
+
+void GuestClock::advance(uint64_t guest_us) {
+    if (get_mode() == GuestClockMode::DETERMINISTIC)
+        deterministic_now.fetch_add(guest_us, std::memory_order_relaxed);
+}
+
+std::chrono::microseconds GuestClock::to_host(uint64_t guest_us) const {
+    const double host_us = (get_mode() == GuestClockMode::REAL_TIME) ? guest_us : guest_us / get_speed();
+    // guest timeouts can be close to the maximum value
+    if (host_us >= static_cast<double>(std::chrono::microseconds::max().count()))
+        return std::chrono::microseconds::max();
+    return std::chrono::microseconds(static_cast<int64_t>(host_us));
+}
+
+GuestClock &get_guest_clock() {
+    static GuestClock clock;
+    return clock;
+}
+
+GuestClockMode parse_guest_clock_mode(const std::string &name) {
+    if (name == "real-time")
+        return GuestClockMode::REAL_TIME;
+    if (name == "scaled")
+        return GuestClockMode::SCALED;
+    if (name == "deterministic")
+        return GuestClockMode::DETERMINISTIC;
+
+    LOG_WARN("Unknown guest clock mode {}, using real-time", name);
+    return GuestClockMode::REAL_TIME;
+}
@@ -15,14 +15,13 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
+#include <rtc/clock.h>
 #include <rtc/rtc.h>
 
 #include <util/log.h>
 
 std::uint64_t rtc_ticks_since_epoch() {
-    const auto now = std::chrono::high_resolution_clock::now();
-    const auto now_timepoint = std::chrono::time_point_cast<VitaClocks>(now);
-    return now_timepoint.time_since_epoch().count();
+    return get_guest_clock().now();
 }
 
 std::uint64_t rtc_base_ticks() {
@@ -0,0 +1,107 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#include <rtc/clock.h>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace std::chrono_literals;
+
+TEST(guest_clock, real_time_follows_host_clock) {
+    GuestClock clock;
+    const auto host = std::chrono::duration_cast<std::chrono::microseconds>(GuestClock::HostClock::now().time_since_epoch()).count();
+    const uint64_t guest = clock.now();
+    ASSERT_GE(guest, static_cast<uint64_t>(host));
+    ASSERT_LT(guest - host, 100'000);
+    ASSERT_EQ(clock.to_host(1234), 1234us);
+
+    // guest timeouts close to the maximum value do not overflow
+    ASSERT_EQ(clock.to_host(UINT64_MAX), std::chrono::microseconds::max());
+}
+
+TEST(guest_clock, deterministic_only_moves_when_advanced) {
+    GuestClock clock;
+    clock.set_mode(GuestClockMode::DETERMINISTIC);
+    const uint64_t start = clock.now();
+
+    std::this_thread::sleep_for(5ms);
+    ASSERT_EQ(clock.now(), start);
+
+    clock.advance(16666);
+    clock.advance(16666);
+    ASSERT_EQ(clock.now(), start + 33332);
+
+    // the speed only paces the host waits
+    clock.set_mode(GuestClockMode::DETERMINISTIC, 4.0);
+    ASSERT_EQ(clock.now(), start + 33332);
+    ASSERT_EQ(clock.to_host(16666), 4166us);
+}
+
+TEST(guest_clock, scaled_runs_at_speed) {
+    GuestClock clock;
+    clock.set_mode(GuestClockMode::SCALED, 4.0);
+    const uint64_t guest_start = clock.now();
+    const auto host_start = GuestClock::HostClock::now();
+
+    std::this_thread::sleep_for(20ms);
+
+    const uint64_t guest_elapsed = clock.now() - guest_start;
+    const auto host_elapsed = std::chrono::duration_cast<std::chrono::microseconds>(GuestClock::HostClock::now() - host_start).count();
+    ASSERT_GE(guest_elapsed, 4 * 20'000);
+    ASSERT_LE(guest_elapsed, static_cast<uint64_t>(4 * host_elapsed));
+
+    // advancing is for the deterministic mode only
+    clock.advance(1'000'000'000);
+    ASSERT_LT(clock.now() - guest_start, 1'000'000'000);
+
+    ASSERT_EQ(clock.to_host(4000), 1000us);
+}
+
+TEST(guest_clock, mode_changes_never_go_back) {
+    GuestClock clock;
+    uint64_t last = clock.now();
+    const auto check = [&] {
+        const uint64_t now = clock.now();
+        ASSERT_GE(now, last);
+        last = now;
+    };
+
+    clock.set_mode(GuestClockMode::SCALED, 10.0);
+    std::this_thread::sleep_for(2ms);
+    check();
+
+    // guest time is now ahead of host time, going back to real time keeps it ahead
+    clock.set_mode(GuestClockMode::REAL_TIME);
+    check();
+    clock.set_mode(GuestClockMode::DETERMINISTIC);
+    check();
+    clock.advance(100);
+    check();
+    clock.set_mode(GuestClockMode::SCALED, 0.5);
+    check();
+    clock.set_mode(GuestClockMode::REAL_TIME);
+    check();
+}
+
+TEST(guest_clock, parses_config_names) {
+    ASSERT_EQ(parse_guest_clock_mode("real-time"), GuestClockMode::REAL_TIME);
+    ASSERT_EQ(parse_guest_clock_mode("scaled"), GuestClockMode::SCALED);
+    ASSERT_EQ(parse_guest_clock_mode("deterministic"), GuestClockMode::DETERMINISTIC);
+}
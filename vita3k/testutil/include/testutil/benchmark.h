@@ -0,0 +1,72 @@
+// Vita3K emulator project
+// Copyright (C) 2024 Vita3K team
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iomanip>
+#include <ratio>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Benchmarks are disabled tests that record their results as properties of the test, run them with
+ *   <module>-tests --gtest_also_run_disabled_tests --gtest_filter=*_benchmark --gtest_output=xml:<report>
+ * and read the results in the report.
+ */
+#define BENCHMARK_TEST(test_suite_name, name) TEST(test_suite_name, DISABLED_##name##_benchmark)
+#define BENCHMARK_TEST_F(test_fixture, name) TEST_F(test_fixture, DISABLED_##name##_benchmark)
+
+namespace testutil {
+
+// Record a value in the report of the running benchmark
+template <typename T>
+void record(const std::string &name, const T &value) {
+    testing::Message message;
+    if constexpr (std::is_floating_point_v<T>)
+        message << std::fixed << std::setprecision(3);
+    message << value;
+    testing::Test::RecordProperty(name, message.GetString());
+}
+
+// Record a duration as "<name>_<unit>" in the report of the running benchmark
+template <typename Duration = std::chrono::microseconds, typename Rep, typename Period>
+void record_time(const std::string &name, std::chrono::duration<Rep, Period> time) {
+    using Unit = typename Duration::period;
+    static_assert(std::is_same_v<Unit, std::milli> || std::is_same_v<Unit, std::micro> || std::is_same_v<Unit, std::nano>);
+    const char *suffix = std::is_same_v<Unit, std::milli> ? "_ms" : (std::is_same_v<Unit, std::micro> ? "_us" : "_ns");
+    record(name + suffix, std::chrono::duration<double, Unit>(time).count());
+}
+
+// Time taken by fn
+template <typename Fn>
+std::chrono::steady_clock::duration elapsed(Fn &&fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::steady_clock::now() - start;
+}
+
+// Run fn and record the time it took as "<name>_<unit>"
+template <typename Duration = std::chrono::microseconds, typename Fn>
+void measure(const std::string &name, Fn &&fn) {
+    record_time<Duration>(name, elapsed(std::forward<Fn>(fn)));
+}
+
+} // namespace testutil
@@ -6,7 +6,7 @@
 
 std::vector<SceFVector2> get_touchpad_fingers_pos(SceTouchPortType &port);
 int handle_touchpad_event(SDL_ControllerTouchpadEvent &touchpad);
-void touch_vsync_update(const EmuEnvState &emuenv);
+void touch_vsync_update(const EmuEnvState &emuenv, uint64_t vcount);
 int handle_touch_event(SDL_TouchFingerEvent &finger);
 int toggle_touchscreen();
 int touch_get(const SceUID thread_id, EmuEnvState &emuenv, const SceUInt32 &port, SceTouchData *pData, SceUInt32 count, bool is_peek);
@@ -19,6 +19,8 @@
 #include <display/state.h>
 #include <emuenv/state.h>
 #include <kernel/state.h>
+#include <replay/functions.h>
+#include <rtc/clock.h>
 #include <touch/functions.h>
 #include <touch/state.h>
 #include <touch/touch.h>
@@ -101,9 +103,8 @@ static SceTouchData recover_touchpad_events(const EmuEnvState &emuenv) {
     return touch_data;
 }
 
-void touch_vsync_update(const EmuEnvState &emuenv) {
-    std::chrono::time_point<std::chrono::steady_clock> ts = std::chrono::steady_clock::now();
-    uint64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(ts.time_since_epoch()).count();
+void touch_vsync_update(const EmuEnvState &emuenv, uint64_t vcount) {
+    uint64_t timestamp = get_guest_clock().now();
 
     // disable mouse support on android because the touchscreen is considered as a mouse, and this creates a mess
 #ifdef ANDROID
@@ -183,6 +184,10 @@ void touch_vsync_update(const EmuEnvState &emuenv) {
         }
     }
 
+    SceTouchData *buffers = touch_buffers[(touch_buffer_idx + 1) % MAX_TOUCH_BUFFER_SAVED];
+    for (int port = 0; port < 2; port++)
+        replay_touch(emuenv.replay, vcount, port, buffers[port]);
+
     touch_buffer_idx++;
     touch_buffer_idx %= MAX_TOUCH_BUFFER_SAVED;
 }
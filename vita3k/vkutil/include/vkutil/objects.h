@@ -24,6 +24,23 @@ namespace vkutil {
 
 void init(vma::Allocator vma_allocator);
 
+// What the memory allocated through vma is used for
+enum struct MemoryCategory : uint8_t {
+    Other,
+    TextureCache,
+    SurfaceCache,
+    RingBuffer,
+    Count
+};
+
+// Account the allocation in category, done by init_image and init_buffer
+// the memory is no longer accounted once the allocation is destroyed by an Image, a Buffer or a DestroyQueue
+void track_allocation(vma::Allocation allocation, MemoryCategory category);
+MemoryCategory get_allocation_category(vma::Allocation allocation);
+vk::DeviceSize get_allocation_size(vma::Allocation allocation);
+// bytes currently allocated for category
+vk::DeviceSize get_allocated_memory(MemoryCategory category);
+
 struct Image {
     vma::Allocation allocation;
     vk::Image image{};
@@ -37,6 +54,7 @@ struct Image {
 
     // should the existing image, view, sampler be destroyed when this image is destroyed?
     bool destroy_on_deletion = true;
+    MemoryCategory category = MemoryCategory::Other;
 
     Image();
     Image(uint32_t width, uint32_t height, vk::Format format);
@@ -68,6 +86,7 @@ struct Buffer {
     void *mapped_data = nullptr;
 
     bool destroy_on_deletion = true;
+    MemoryCategory category = MemoryCategory::Other;
 
     Buffer();
     Buffer(vk::DeviceSize size);
@@ -22,14 +22,50 @@
 #include <util/align.h>
 #include <util/log.h>
 
+#include <array>
+#include <atomic>
+
 namespace vkutil {
 
 static vma::Allocator allocator = nullptr;
 
+static std::array<std::atomic<vk::DeviceSize>, static_cast<size_t>(MemoryCategory::Count)> allocated_memory;
+
 void init(vma::Allocator vma_allocator) {
     allocator = vma_allocator;
 }
 
+void track_allocation(vma::Allocation allocation, MemoryCategory category) {
+    const vma::AllocationInfo info = allocator.getAllocationInfo(allocation);
+    // the category is stored in the user data, offset by one so that untracked allocations have none
+    allocator.setAllocationUserData(allocation, reinterpret_cast<void *>(static_cast<uintptr_t>(category) + 1));
+    allocated_memory[static_cast<size_t>(category)] += info.size;
+}
+
+MemoryCategory get_allocation_category(vma::Allocation allocation) {
+    const uintptr_t user_data = reinterpret_cast<uintptr_t>(allocator.getAllocationInfo(allocation).pUserData);
+    return user_data == 0 ? MemoryCategory::Other : static_cast<MemoryCategory>(user_data - 1);
+}
+
+vk::DeviceSize get_allocation_size(vma::Allocation allocation) {
+    return allocator.getAllocationInfo(allocation).size;
+}
+
+vk::DeviceSize get_allocated_memory(MemoryCategory category) {
+    return allocated_memory[static_cast<size_t>(category)];
+}
+
+// must be called before the allocation is destroyed
+static void untrack_allocation(vma::Allocation allocation) {
+    if (!allocation)
+        return;
+
+    const vma::AllocationInfo info = allocator.getAllocationInfo(allocation);
+    const uintptr_t user_data = reinterpret_cast<uintptr_t>(info.pUserData);
+    if (user_data != 0)
+        allocated_memory[user_data - 1] -= info.size;
+}
+
 Image::Image() = default;
 
 Image::Image(Image &&other) noexcept {
@@ -68,6 +104,7 @@ void Image::destroy() {
         view = nullptr;
     }
     if (image) {
+        untrack_allocation(allocation);
         allocator.destroyImage(image, allocation);
         image = nullptr;
     }
@@ -97,6 +134,7 @@ void Image::init_image(vk::ImageUsageFlags usage, vk::ComponentMapping mapping,
     };
 
     std::tie(image, allocation) = allocator.createImage(image_info, vma_auto_alloc);
+    track_allocation(allocation, category);
 
     // only create a view if one of these flags is set
     constexpr vk::ImageUsageFlags view_usages = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eStorage;
@@ -151,6 +189,7 @@ void Buffer::destroy() {
         return;
 
     if (buffer) {
+        untrack_allocation(allocation);
         allocator.destroyBuffer(buffer, allocation);
         buffer = nullptr;
     }
@@ -169,6 +208,7 @@ void Buffer::init_buffer(vk::BufferUsageFlags usage_flags, const vma::Allocation
     vma::AllocationInfo alloc_info;
     std::tie(buffer, allocation) = allocator.createBuffer(buffer_info, alloc_create_info, alloc_info);
     mapped_data = alloc_info.pMappedData;
+    track_allocation(allocation, category);
 }
 
 RingBuffer::RingBuffer(vk::BufferUsageFlags usage, const size_t capacity)
@@ -187,6 +227,7 @@ RingBuffer::RingBuffer(vk::BufferUsageFlags usage, const size_t capacity)
         buffer_capacity += 512;
 
     buffer = Buffer(buffer_capacity);
+    buffer.category = MemoryCategory::RingBuffer;
 }
 
 void RingBuffer::allocate(const uint32_t data_size) {
@@ -283,6 +324,7 @@ void DestroyQueue::destroy_objects() {
             // special case: this is a vma allocation
             auto image = std::bit_cast<vk::Image>(el);
             auto allocation = std::bit_cast<vma::Allocation>(destroy_list[idx++]);
+            untrack_allocation(allocation);
             allocator.destroyImage(image, allocation);
             break;
         }
@@ -291,6 +333,7 @@ void DestroyQueue::destroy_objects() {
             // special case: this is a vma allocation
             auto buffer = std::bit_cast<vk::Buffer>(el);
             auto allocation = std::bit_cast<vma::Allocation>(destroy_list[idx++]);
+            untrack_allocation(allocation);
             allocator.destroyBuffer(buffer, allocation);
             break;
         }